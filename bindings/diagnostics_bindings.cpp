@@ -44,7 +44,7 @@ void bind_diagnostics(py::module_& m) {
         .def("end_measurement", &DiagnosticsEngine::endMeasurement,
             "End performance measurement (RT-safe)")
         .def("analyze_audio", 
-            [](DiagnosticsEngine& self, py::array_t<float> buffer, int channels) {
+            [](DiagnosticsEngine& self, py::array_t<float, py::array::c_style | py::array::forcecast> buffer, int channels) {
                 auto info = buffer.request();
                 if (info.ndim != 1) {
                     throw std::runtime_error("Buffer must be 1-dimensional");
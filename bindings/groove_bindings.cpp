@@ -18,6 +18,18 @@ void bind_groove(py::module_& m) {
         .value("EIGHTH", RhythmQuantizer::GridResolution::Eighth)
         .value("SIXTEENTH", RhythmQuantizer::GridResolution::Sixteenth)
         .value("THIRTY_SECOND", RhythmQuantizer::GridResolution::ThirtySecond)
+        .value("QUARTER_TRIPLET", RhythmQuantizer::GridResolution::QuarterTriplet)
+        .value("EIGHTH_TRIPLET", RhythmQuantizer::GridResolution::EighthTriplet)
+        .value("SIXTEENTH_TRIPLET", RhythmQuantizer::GridResolution::SixteenthTriplet)
+        .export_values();
+    
+    // Onset detection function
+    py::enum_<OnsetDetector::Method>(m, "OnsetMethod")
+        .value("SPECTRAL_FLUX", OnsetDetector::Method::SpectralFlux)
+        .value("HIGH_FREQUENCY_CONTENT", OnsetDetector::Method::HighFrequencyContent)
+        .value("COMPLEX_DOMAIN", OnsetDetector::Method::ComplexDomain)
+        .value("PHASE_DEVIATION", OnsetDetector::Method::PhaseDeviation)
+        .value("SUPER_FLUX", OnsetDetector::Method::SuperFlux)
         .export_values();
     
     // GrooveAnalysis structure
@@ -25,8 +37,6 @@ void bind_groove(py::module_& m) {
         .def(py::init<>())
         .def_readonly("current_tempo", &GrooveEngine::GrooveAnalysis::currentTempo)
         .def_readonly("tempo_confidence", &GrooveEngine::GrooveAnalysis::tempoConfidence)
-        .def_readonly("onset_positions", &GrooveEngine::GrooveAnalysis::onsetPositions)
-        .def_readonly("onset_strengths", &GrooveEngine::GrooveAnalysis::onsetStrengths)
         .def_readonly("time_signature_num", &GrooveEngine::GrooveAnalysis::timeSignatureNum)
         .def_readonly("time_signature_den", &GrooveEngine::GrooveAnalysis::timeSignatureDen)
         .def_readonly("swing", &GrooveEngine::GrooveAnalysis::swing)
@@ -40,16 +50,19 @@ void bind_groove(py::module_& m) {
         .def(py::init<>())
         .def_readwrite("sample_rate", &GrooveEngine::Config::sampleRate)
         .def_readwrite("hop_size", &GrooveEngine::Config::hopSize)
+        .def_readwrite("onset_method", &GrooveEngine::Config::onsetMethod)
         .def_readwrite("min_tempo", &GrooveEngine::Config::minTempo)
         .def_readwrite("max_tempo", &GrooveEngine::Config::maxTempo)
         .def_readwrite("enable_quantization", &GrooveEngine::Config::enableQuantization)
-        .def_readwrite("quantization_strength", &GrooveEngine::Config::quantizationStrength);
+        .def_readwrite("quantization_strength", &GrooveEngine::Config::quantizationStrength)
+        .def_readwrite("grid_resolution", &GrooveEngine::Config::gridResolution)
+        .def_readwrite("swing_amount", &GrooveEngine::Config::swingAmount);
     
     // GrooveEngine
     py::class_<GrooveEngine>(m, "GrooveEngine")
         .def(py::init<const GrooveEngine::Config&>(),
             py::arg("config") = GrooveEngine::Config{})
-        .def("process_audio", [](GrooveEngine& self, py::array_t<float> buffer) {
+        .def("process_audio", [](GrooveEngine& self, py::array_t<float, py::array::c_style | py::array::forcecast> buffer) {
             py::buffer_info info = buffer.request();
             if (info.ndim != 1) {
                 throw std::runtime_error("Audio buffer must be 1-dimensional");
@@ -66,6 +79,31 @@ void bind_groove(py::module_& m) {
         .def("apply_swing", &GrooveEngine::applySwing,
             py::arg("position"),
             "Apply swing to position")
+        .def("get_onset_count", &GrooveEngine::getOnsetCount,
+            "Number of onsets in the history")
+        .def("get_onsets", [](const GrooveEngine& self) {
+            std::vector<uint64_t> positions;
+            std::vector<float> strengths;
+            for (size_t i = 0; i < self.getOnsetCount(); ++i) {
+                positions.push_back(self.getOnsetPosition(i));
+                strengths.push_back(self.getOnsetStrength(i));
+            }
+            return py::make_tuple(positions, strengths);
+        }, "Get the onset history (positions, strengths), oldest first")
+        .def("get_timing", [](const GrooveEngine& self) {
+            const auto& timing = self.getTimingInfo();
+            py::dict result;
+            result["tempo"] = timing.tempo.load();
+            result["bar_start"] = timing.barStart.load();
+            result["numerator"] = timing.numerator.load();
+            result["denominator"] = timing.denominator.load();
+            result["sample_position"] = timing.samplePosition.load();
+            return result;
+        }, "Get the tracked beat grid")
+        .def("set_parameter", &GrooveEngine::setParameter,
+            py::arg("parameter"), py::arg("value"),
+            "Set a parameter (0 onset sensitivity, 1 tempo smoothing, "
+            "2 quantization strength, 3 swing amount)")
         .def("update_config", &GrooveEngine::updateConfig,
             py::arg("config"),
             "Update engine configuration")
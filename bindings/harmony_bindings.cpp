@@ -1,17 +1,179 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 #include <pybind11/functional.h>
+#include <pybind11/numpy.h>
 #include "penta/harmony/HarmonyEngine.h"
 #include "penta/harmony/ChordAnalyzer.h"
+#include "penta/harmony/KeyProfileBank.h"
 #include "penta/harmony/ScaleDetector.h"
 #include "penta/harmony/VoiceLeading.h"
 #include "penta/common/RTTypes.h"
+#include <cstddef>
+#include <cstring>
 
 namespace py = pybind11;
 using namespace penta;
 using namespace penta::harmony;
 
+namespace {
+
+// Flat record for NumPy structured arrays (one per HarmonyFrame)
+struct TimelineRecord {
+    uint64_t sample_position;
+    uint16_t chord_pitch_classes;
+    uint8_t chord_root;
+    uint8_t chord_quality;
+    float chord_confidence;
+    uint8_t chord_bass;
+    uint8_t chord_inversion;
+    uint16_t scale_degrees;
+    uint8_t scale_tonic;
+    uint8_t scale_mode;
+    float scale_confidence;
+};
+
+// Same layout as HarmonyEngine::ChordEvent / ScaleEvent, so ring slots can be
+// viewed in place
+struct ChordEventRecord {
+    uint64_t sample_position;
+    uint16_t pitch_classes;
+    uint8_t root;
+    uint8_t quality;
+    float confidence;
+    uint8_t bass;
+    uint8_t inversion;
+};
+
+struct ScaleEventRecord {
+    uint64_t sample_position;
+    uint16_t degrees;
+    uint8_t tonic;
+    uint8_t mode;
+    float confidence;
+};
+
+static_assert(sizeof(ChordEventRecord) == sizeof(HarmonyEngine::ChordEvent));
+static_assert(offsetof(HarmonyEngine::ChordEvent, chord) == offsetof(ChordEventRecord, pitch_classes));
+static_assert(offsetof(Chord, confidence) == offsetof(ChordEventRecord, confidence) - 8);
+static_assert(offsetof(Chord, bass) == offsetof(ChordEventRecord, bass) - 8);
+static_assert(offsetof(Chord, inversion) == offsetof(ChordEventRecord, inversion) - 8);
+static_assert(sizeof(ScaleEventRecord) == sizeof(HarmonyEngine::ScaleEvent));
+static_assert(offsetof(HarmonyEngine::ScaleEvent, scale) == offsetof(ScaleEventRecord, degrees));
+static_assert(offsetof(Scale, confidence) == offsetof(ScaleEventRecord, confidence) - 8);
+
+// Consistent snapshot of the newest entries (one copy, no Python objects)
+template<typename Record, typename Event>
+py::array_t<Record> historySnapshot(
+    const HarmonyEngine& engine,
+    size_t maxCount,
+    size_t (HarmonyEngine::*getHistory)(Event*, size_t) const noexcept
+) {
+    std::vector<Event> events(std::min(maxCount, HarmonyEngine::kHistoryCapacity));
+    events.resize((engine.*getHistory)(events.data(), events.size()));
+    
+    py::array_t<Record> result(static_cast<py::ssize_t>(events.size()));
+    std::memcpy(result.mutable_data(), events.data(), events.size() * sizeof(Event));
+    return result;
+}
+
+// Zero-copy, read-only view of the raw ring slots (entry i lives at i % capacity).
+// Not synchronized with the audio thread; the view keeps the engine alive.
+template<typename Record, typename Ring>
+py::array_t<Record> historyView(const Ring& ring, py::handle owner) {
+    py::array_t<Record> view(
+        {static_cast<py::ssize_t>(Ring::kCapacity)},
+        static_cast<const Record*>(ring.data()),
+        owner);
+    view.attr("setflags")(py::arg("write") = false);
+    return view;
+}
+
+using U8Array = py::array_t<uint8_t, py::array::c_style | py::array::forcecast>;
+using U64Array = py::array_t<uint64_t, py::array::c_style | py::array::forcecast>;
+
+py::array_t<TimelineRecord> analyzeTimeline(
+    HarmonyEngine& engine,
+    U8Array pitches,
+    U8Array velocities,
+    U64Array timestamps,
+    uint64_t hopSamples
+) {
+    const size_t count = static_cast<size_t>(pitches.size());
+    if (velocities.size() != pitches.size() || timestamps.size() != pitches.size()) {
+        throw std::runtime_error("pitches, velocities and timestamps must have the same length");
+    }
+    
+    std::vector<Note> notes(count);
+    const uint8_t* p = pitches.data();
+    const uint8_t* v = velocities.data();
+    const uint64_t* t = timestamps.data();
+    for (size_t i = 0; i < count; ++i) {
+        notes[i] = Note(p[i], v[i], 0, t[i]);
+    }
+    
+    std::vector<HarmonyEngine::HarmonyFrame> frames;
+    {
+        py::gil_scoped_release release;
+        frames = engine.analyzeTimeline(notes.data(), notes.size(), hopSamples);
+    }
+    
+    py::array_t<TimelineRecord> result(static_cast<py::ssize_t>(frames.size()));
+    auto* out = result.mutable_data();
+    for (size_t i = 0; i < frames.size(); ++i) {
+        const auto& f = frames[i];
+        out[i] = TimelineRecord{
+            f.samplePosition,
+            f.chord.pitchClass.bits(), f.chord.root, f.chord.quality, f.chord.confidence,
+            f.chord.bass, f.chord.inversion,
+            f.scale.degrees.bits(), f.scale.tonic, f.scale.mode, f.scale.confidence
+        };
+    }
+    return result;
+}
+
+} // anonymous namespace
+
 void bind_harmony(py::module_& m) {
+    PYBIND11_NUMPY_DTYPE(TimelineRecord,
+        sample_position,
+        chord_pitch_classes, chord_root, chord_quality, chord_confidence,
+        chord_bass, chord_inversion,
+        scale_degrees, scale_tonic, scale_mode, scale_confidence);
+    PYBIND11_NUMPY_DTYPE(ChordEventRecord, sample_position, pitch_classes, root, quality, confidence,
+        bass, inversion);
+    PYBIND11_NUMPY_DTYPE(ScaleEventRecord, sample_position, degrees, tonic, mode, confidence);
+    
+    // 12-bit pitch class set (bit i = pitch class i)
+    py::class_<PitchClassSet>(m, "PitchClassSet")
+        .def(py::init<>())
+        .def(py::init<uint16_t>(), py::arg("bits"))
+        .def_static("from_pitch_classes", [](const std::vector<int>& pcs) {
+            PitchClassSet set;
+            for (int pc : pcs) set.set(((pc % 12) + 12) % 12);
+            return set;
+        }, py::arg("pitch_classes"))
+        .def_property_readonly("bits", &PitchClassSet::bits)
+        .def("count", &PitchClassSet::count)
+        .def("contains", &PitchClassSet::contains, py::arg("pitch_class"))
+        .def("rotate", &PitchClassSet::rotate, py::arg("semitones"))
+        .def("to_list", [](const PitchClassSet& s) {
+            std::vector<int> pcs;
+            for (int i = 0; i < 12; ++i) {
+                if (s.contains(i)) pcs.push_back(i);
+            }
+            return pcs;
+        })
+        .def("__len__", &PitchClassSet::count)
+        .def("__contains__", &PitchClassSet::contains)
+        .def("__or__", &PitchClassSet::operator|)
+        .def("__and__", &PitchClassSet::operator&)
+        .def("__xor__", &PitchClassSet::operator^)
+        .def("__eq__", &PitchClassSet::operator==)
+        .def("__int__", &PitchClassSet::bits)
+        .def("__repr__", [](const PitchClassSet& s) {
+            return "PitchClassSet(bits=" + std::to_string(s.bits()) + ")";
+        });
+    
     // Note structure
     py::class_<Note>(m, "Note")
         .def(py::init<>())
@@ -33,16 +195,23 @@ void bind_harmony(py::module_& m) {
         .def_readonly("root", &Chord::root)
         .def_readonly("quality", &Chord::quality)
         .def_readonly("confidence", &Chord::confidence)
+        .def_readonly("bass", &Chord::bass)
+        .def_readonly("inversion", &Chord::inversion)
+        .def_property_readonly("is_slash_chord", &Chord::isSlashChord)
+        .def_readonly_static("SLASH_BASS", &Chord::kSlashBass)
+        .def_readonly("pitch_class_set", &Chord::pitchClass)
         .def_property_readonly("pitch_classes", [](const Chord& c) {
             std::vector<int> pcs;
             for (int i = 0; i < 12; ++i) {
-                if (c.pitchClass[i]) pcs.push_back(i);
+                if (c.pitchClass.contains(i)) pcs.push_back(i);
             }
             return pcs;
         })
         .def("__repr__", [](const Chord& c) {
             return "Chord(root=" + std::to_string(c.root) + 
                    ", quality=" + std::to_string(c.quality) +
+                   ", bass=" + std::to_string(c.bass) +
+                   ", inversion=" + std::to_string(c.inversion) +
                    ", confidence=" + std::to_string(c.confidence) + ")";
         });
     
@@ -52,10 +221,11 @@ void bind_harmony(py::module_& m) {
         .def_readonly("tonic", &Scale::tonic)
         .def_readonly("mode", &Scale::mode)
         .def_readonly("confidence", &Scale::confidence)
+        .def_readonly("degree_set", &Scale::degrees)
         .def_property_readonly("degrees", [](const Scale& s) {
             std::vector<int> degs;
             for (int i = 0; i < 12; ++i) {
-                if (s.degrees[i]) degs.push_back(i);
+                if (s.degrees.contains(i)) degs.push_back(i);
             }
             return degs;
         })
@@ -65,13 +235,66 @@ void bind_harmony(py::module_& m) {
                    ", confidence=" + std::to_string(s.confidence) + ")";
         });
     
+    // Key-profile bank for scale detection
+    py::class_<KeyProfileBank, std::shared_ptr<KeyProfileBank>>(m, "KeyProfileBank")
+        .def(py::init<>())
+        .def_static("krumhansl_modes", &KeyProfileBank::krumhanslModes)
+        .def_static("temperley", &KeyProfileBank::temperley)
+        .def_static("aarden_essen", &KeyProfileBank::aardenEssen)
+        .def_static("extended", &KeyProfileBank::extended)
+        .def("add_scale_library", &KeyProfileBank::addScaleLibrary,
+            "Append harmonic/melodic minor, pentatonics, blues, whole-tone and octatonic templates")
+        .def("add_profile", &KeyProfileBank::addProfile,
+            py::arg("name"), py::arg("weights"),
+            "Append a 12-degree profile; returns its mode index (-1 if full)")
+        .def("add_scale_template", &KeyProfileBank::addScaleTemplate,
+            py::arg("name"), py::arg("degrees"))
+        .def("append", &KeyProfileBank::append, py::arg("other"))
+        .def("load_json", [](KeyProfileBank& self, const std::string& json) {
+            std::string error;
+            if (!self.loadJson(json, &error)) throw py::value_error(error);
+        }, py::arg("json"))
+        .def("load_json_file", [](KeyProfileBank& self, const std::string& path) {
+            std::string error;
+            if (!self.loadJsonFile(path, &error)) throw py::value_error(error);
+        }, py::arg("path"))
+        .def("find_profile", &KeyProfileBank::findProfile, py::arg("name"))
+        .def_property_readonly("names", [](const KeyProfileBank& self) {
+            std::vector<std::string> names;
+            for (size_t i = 0; i < self.getNumProfiles(); ++i) {
+                names.push_back(self.getProfile(i).name);
+            }
+            return names;
+        })
+        .def("__len__", &KeyProfileBank::getNumProfiles);
+    
+    // Key tracking
+    py::enum_<ScaleDetector::Timescale>(m, "Timescale")
+        .value("SHORT", ScaleDetector::Timescale::Short)
+        .value("MEDIUM", ScaleDetector::Timescale::Medium)
+        .value("LONG", ScaleDetector::Timescale::Long);
+    
+    py::class_<ScaleDetector::TrackingConfig>(m, "KeyTrackingConfig")
+        .def(py::init<>())
+        .def_readwrite("time_constants", &ScaleDetector::TrackingConfig::timeConstants)
+        .def_readwrite("switch_margin", &ScaleDetector::TrackingConfig::switchMargin)
+        .def_readwrite("min_hold_seconds", &ScaleDetector::TrackingConfig::minHoldSeconds);
+    
+    py::class_<ScaleDetector::ModulationEvent>(m, "ModulationEvent")
+        .def_readonly("sample_position", &ScaleDetector::ModulationEvent::samplePosition)
+        .def_readonly("confirmed_position", &ScaleDetector::ModulationEvent::confirmedPosition)
+        .def_readonly("from_scale", &ScaleDetector::ModulationEvent::from)
+        .def_readonly("to_scale", &ScaleDetector::ModulationEvent::to);
+    
     // HarmonyEngine configuration
     py::class_<HarmonyEngine::Config>(m, "HarmonyConfig")
         .def(py::init<>())
         .def_readwrite("sample_rate", &HarmonyEngine::Config::sampleRate)
         .def_readwrite("analysis_window_size", &HarmonyEngine::Config::analysisWindowSize)
+        .def_readwrite("analysis_hop_size", &HarmonyEngine::Config::analysisHopSize)
         .def_readwrite("enable_voice_leading", &HarmonyEngine::Config::enableVoiceLeading)
         .def_readwrite("enable_scale_detection", &HarmonyEngine::Config::enableScaleDetection)
+        .def_readwrite("weighted_chord_analysis", &HarmonyEngine::Config::weightedChordAnalysis)
         .def_readwrite("confidence_threshold", &HarmonyEngine::Config::confidenceThreshold);
     
     // HarmonyEngine
@@ -82,24 +305,121 @@ void bind_harmony(py::module_& m) {
             self.processNotes(notes.data(), notes.size());
         }, py::arg("notes"),
         "Process MIDI notes for harmony analysis")
+        .def("process_audio", [](HarmonyEngine& self, py::array_t<float, py::array::c_style | py::array::forcecast> buffer) {
+            py::buffer_info info = buffer.request();
+            if (info.ndim != 1) {
+                throw std::runtime_error("Audio buffer must be 1-dimensional");
+            }
+            self.processAudio(static_cast<float*>(info.ptr), info.shape[0]);
+        }, py::arg("buffer"),
+        "Process mono audio for chroma-based harmony analysis")
+        .def("get_chroma", &HarmonyEngine::getChroma,
+            "Get the latest audio chroma frame (12 pitch-class weights)")
         .def("get_current_chord", &HarmonyEngine::getCurrentChord,
             py::return_value_policy::copy,
             "Get currently detected chord")
         .def("get_current_scale", &HarmonyEngine::getCurrentScale,
             py::return_value_policy::copy,
             "Get currently detected scale")
-        .def("suggest_voice_leading", &HarmonyEngine::suggestVoiceLeading,
+        .def("analyze_timeline", &analyzeTimeline,
+            py::arg("pitches"), py::arg("velocities"), py::arg("timestamps"),
+            py::arg("hop_samples"),
+            "Analyze a whole timestamp-sorted note stream (velocity 0 = note off); "
+            "returns a NumPy structured array with one record per hop")
+        .def("get_bass_note", &HarmonyEngine::getBassNote,
+            "Get the lowest sounding MIDI pitch (-1 if none)")
+        .def("reset", &HarmonyEngine::reset,
+            "Clear active notes and analysis state")
+        .def("get_current_key", &HarmonyEngine::getCurrentKey,
+            py::return_value_policy::copy,
+            "Get the hysteresis-filtered key from multi-timescale tracking")
+        .def("get_tracked_scale", &HarmonyEngine::getTrackedScale,
+            py::arg("timescale"), py::return_value_policy::copy,
+            "Get the best scale on one tracking timescale")
+        .def("pop_modulations", [](HarmonyEngine& self) {
+            std::vector<HarmonyEngine::ModulationEvent> events;
+            HarmonyEngine::ModulationEvent event;
+            while (self.popModulation(event)) {
+                events.push_back(event);
+            }
+            return events;
+        }, "Drain pending key modulation events (oldest first)")
+        .def("set_key_tracking_config", &HarmonyEngine::setKeyTrackingConfig,
+            py::arg("config"),
+            "Set key tracking time constants and hysteresis")
+        .def("set_key_profile_bank", [](HarmonyEngine& self, const KeyProfileBank& bank) {
+            // Snapshot, so later edits from Python do not change the bank in
+            // use. The swap itself is unsynchronized: audio must be stopped
+            self.setKeyProfileBank(std::make_shared<const KeyProfileBank>(bank));
+        }, py::arg("bank"),
+            "Use a copy of bank for scale detection (Scale.mode indexes into it). "
+            "Call only while audio processing is stopped")
+        .def("scale_mode_name", [](const HarmonyEngine& self, size_t mode) {
+            const auto& bank = self.getKeyProfileBank();
+            return mode < bank.getNumProfiles() ? bank.getProfile(mode).name : std::string("Unknown");
+        }, py::arg("mode"),
+            "Name of the key profile a Scale.mode refers to")
+        .def("consume_harmony_changed", &HarmonyEngine::consumeHarmonyChanged,
+            "True if the active pitch-class set changed since the last call (clears the flag)")
+        .def("get_active_pitch_classes", &HarmonyEngine::getActivePitchClasses,
+            "Get the currently sounding pitch classes")
+        .def("suggest_voice_leading",
+            py::overload_cast<const Chord&, const std::vector<Note>&>(
+                &HarmonyEngine::suggestVoiceLeading, py::const_),
             py::arg("target_chord"), py::arg("current_voices"),
             "Get voice leading suggestions for target chord")
+        .def("plan_voice_leading", &HarmonyEngine::planVoiceLeading,
+            py::arg("chords"), py::arg("current_voices"),
+            "Voice a whole chord sequence jointly (one list of notes per chord)")
+        .def("plan_voice_leading", [](HarmonyEngine& self,
+                                      py::array_t<ChordEventRecord, py::array::c_style> history,
+                                      const std::vector<Note>& currentVoices) {
+            std::vector<Chord> chords(static_cast<size_t>(history.size()));
+            const ChordEventRecord* records = history.data();
+            for (size_t i = 0; i < chords.size(); ++i) {
+                chords[i].pitchClass = PitchClassSet(records[i].pitch_classes);
+                chords[i].root = records[i].root;
+                chords[i].quality = records[i].quality;
+                chords[i].confidence = records[i].confidence;
+                chords[i].bass = records[i].bass;
+                chords[i].inversion = records[i].inversion;
+            }
+            return self.planVoiceLeading(chords, currentVoices);
+        }, py::arg("chords"), py::arg("current_voices"),
+            "Voice the chords of a chord_history() array jointly (one list of notes per chord)")
         .def("update_config", &HarmonyEngine::updateConfig,
             py::arg("config"),
             "Update engine configuration")
-        .def("get_chord_history", &HarmonyEngine::getChordHistory,
+        .def("get_chord_history",
+            py::overload_cast<size_t>(&HarmonyEngine::getChordHistory, py::const_),
             py::arg("max_count") = 100,
-            "Get chord analysis history")
-        .def("get_scale_history", &HarmonyEngine::getScaleHistory,
+            "Get chord analysis history (oldest first)")
+        .def("get_scale_history",
+            py::overload_cast<size_t>(&HarmonyEngine::getScaleHistory, py::const_),
             py::arg("max_count") = 100,
-            "Get scale detection history");
+            "Get scale detection history (oldest first)")
+        .def("chord_history", [](const HarmonyEngine& self, size_t maxCount) {
+            return historySnapshot<ChordEventRecord>(self, maxCount, &HarmonyEngine::getChordHistory);
+        }, py::arg("max_count") = HarmonyEngine::kHistoryCapacity,
+            "Snapshot of the newest chord changes as a NumPy structured array "
+            "(sample_position, pitch_classes, root, quality, confidence, bass, inversion)")
+        .def("scale_history", [](const HarmonyEngine& self, size_t maxCount) {
+            return historySnapshot<ScaleEventRecord>(self, maxCount, &HarmonyEngine::getScaleHistory);
+        }, py::arg("max_count") = HarmonyEngine::kHistoryCapacity,
+            "Snapshot of the newest scale changes as a NumPy structured array "
+            "(sample_position, degrees, tonic, mode, confidence)")
+        .def("chord_history_view", [](py::object self) {
+            const auto& engine = self.cast<const HarmonyEngine&>();
+            return historyView<ChordEventRecord>(engine.getChordHistoryRing(), self);
+        }, "Zero-copy read-only view of the chord history ring slots (unsynchronized)")
+        .def("scale_history_view", [](py::object self) {
+            const auto& engine = self.cast<const HarmonyEngine&>();
+            return historyView<ScaleEventRecord>(engine.getScaleHistoryRing(), self);
+        }, "Zero-copy read-only view of the scale history ring slots (unsynchronized)")
+        .def_property_readonly("history_write_count", [](const HarmonyEngine& self) {
+            return self.getChordHistoryRing().getWriteCount();
+        }, "Total chord history entries written (slot = index % capacity)")
+        .def_readonly_static("history_capacity", &HarmonyEngine::kHistoryCapacity);
     
     // VoiceLeading configuration
     py::class_<VoiceLeading::Config>(m, "VoiceLeadingConfig")
@@ -107,5 +427,9 @@ void bind_harmony(py::module_& m) {
         .def_readwrite("max_voice_distance", &VoiceLeading::Config::maxVoiceDistance)
         .def_readwrite("parallel_penalty", &VoiceLeading::Config::parallelPenalty)
         .def_readwrite("contrary_bonus", &VoiceLeading::Config::contraryBonus)
-        .def_readwrite("allow_voice_crossing", &VoiceLeading::Config::allowVoiceCrossing);
+        .def_readwrite("allow_voice_crossing", &VoiceLeading::Config::allowVoiceCrossing)
+        .def_readwrite("max_search_nodes", &VoiceLeading::Config::maxSearchNodes)
+        .def_readwrite("max_search_micros", &VoiceLeading::Config::maxSearchMicros)
+        .def_readwrite("beam_width", &VoiceLeading::Config::beamWidth)
+        .def_readwrite("max_plan_candidates", &VoiceLeading::Config::maxPlanCandidates);
 }
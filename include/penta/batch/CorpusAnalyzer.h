@@ -0,0 +1,112 @@
+#pragma once
+
+#include "penta/batch/WorkStealingPool.h"
+#include "penta/common/RTTypes.h"
+#include "penta/groove/GrooveEngine.h"
+#include "penta/harmony/HarmonyEngine.h"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace penta::batch {
+
+/**
+ * Multi-core offline analysis of many independent tracks
+ * Runs one HarmonyEngine / GrooveEngine per work item on a work-stealing
+ * pool and gathers results into contiguous output buffers
+ */
+class CorpusAnalyzer {
+public:
+    struct Config {
+        size_t numThreads;      // 0 = hardware concurrency
+        uint64_t hopSamples;    // Harmony timeline frame spacing
+        harmony::HarmonyEngine::Config harmonyConfig;
+        groove::GrooveEngine::Config grooveConfig;
+        
+        Config()
+            : numThreads(0)
+            , hopSamples(kDefaultBufferSize)
+        {}
+    };
+    
+    // One timestamp-sorted note stream (not owned)
+    struct NoteStream {
+        const Note* notes;
+        size_t count;
+    };
+    
+    // One mono audio buffer (not owned)
+    struct AudioStream {
+        const float* samples;
+        size_t frames;
+    };
+    
+    struct HarmonyResults {
+        // Frames of item i are frames[offsets[i] .. offsets[i + 1])
+        std::vector<harmony::HarmonyEngine::HarmonyFrame> frames;
+        std::vector<size_t> offsets;
+        std::vector<uint8_t> completed;  // 0 if the item was skipped by cancel()
+        bool cancelled = false;
+    };
+    
+    struct GrooveSummary {
+        float tempo;
+        float tempoConfidence;
+        uint32_t timeSignatureNum;
+        uint32_t timeSignatureDen;
+        float swing;
+    };
+    
+    struct GrooveResults {
+        std::vector<GrooveSummary> summaries;  // One per item
+        // Onsets of item i are onsetPositions[onsetOffsets[i] .. onsetOffsets[i + 1])
+        std::vector<uint64_t> onsetPositions;
+        std::vector<float> onsetStrengths;
+        std::vector<size_t> onsetOffsets;
+        std::vector<uint8_t> completed;
+        bool cancelled = false;
+    };
+    
+    // Called as (completedItems, totalItems) after each item; calls are
+    // serialized but come from worker threads
+    using ProgressCallback = std::function<void(size_t, size_t)>;
+    
+    explicit CorpusAnalyzer(const Config& config = Config{});
+    ~CorpusAnalyzer();
+    
+    // Non-copyable, non-movable
+    CorpusAnalyzer(const CorpusAnalyzer&) = delete;
+    CorpusAnalyzer& operator=(const CorpusAnalyzer&) = delete;
+    
+    // Non-RT: Analyze every note stream; blocks until done or cancelled
+    HarmonyResults analyzeHarmony(
+        const std::vector<NoteStream>& items,
+        const ProgressCallback& progress = {}
+    );
+    
+    // Non-RT: Analyze every audio buffer; blocks until done or cancelled
+    GrooveResults analyzeGroove(
+        const std::vector<AudioStream>& items,
+        const ProgressCallback& progress = {}
+    );
+    
+    // Thread-safe: Skip all items not yet started by the running job, or
+    // by the next job if none is running. The request ends with that job.
+    void cancel() noexcept { cancelled_.store(true, std::memory_order_relaxed); }
+    
+    size_t getNumThreads() const noexcept { return pool_->getNumThreads(); }
+    
+private:
+    void reportProgress(const ProgressCallback& progress, size_t total);
+    
+    Config config_;
+    std::unique_ptr<WorkStealingPool> pool_;
+    
+    std::atomic<bool> cancelled_;
+    std::mutex progressMutex_;
+    size_t completedItems_;
+};
+
+} // namespace penta::batch
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "penta/batch/WorkStealingPool.h"
+#include "penta/common/RTTypes.h"
+#include "penta/harmony/VoiceLeading.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace penta::batch {
+
+/**
+ * Multi-core search for substitute chords under a melody
+ *
+ * Every bar's candidates are all ChordAnalyzer templates at all 12 roots.
+ * A candidate's melody fit is its ChordAnalyzer confidence against the
+ * sounding texture (candidate plus melody, so melody notes outside the
+ * chord cost confidence), scaled down for chord tones the melody does not
+ * sound, so a triad under its own tones beats the seventh chords that also
+ * hold them. It scores that fit minus voiceLeadingWeight times the
+ * voice-leading cost of moving into it from the previous bar and on to
+ * the next bar's chord; candidates VoiceLeading cannot voice either way
+ * are dropped, so a bar may get fewer than topK suggestions.
+ * The reference voicings of the original progression come from one
+ * VoiceLeading::planProgression() pass.
+ *
+ * Work is split into (bar, root) items on a work-stealing pool. Each item
+ * writes only its own result slots, and ranking happens after the join, so
+ * results do not depend on the thread count or scheduling (as long as
+ * voiceLeadingConfig.maxSearchMicros stays 0, its default here).
+ */
+class ReharmonizationEngine {
+public:
+    struct Config {
+        size_t numThreads;          // 0 = hardware concurrency
+        size_t topK;                // Most suggestions per bar
+        uint8_t numVoices;          // Voices of the reference voicings (1..VoiceLeading::kMaxVoices)
+        uint8_t lowestPitch;        // Bottom of the first reference voicing
+        float voiceLeadingWeight;   // Score lost per unit of voice-leading cost
+        harmony::VoiceLeading::Config voiceLeadingConfig;
+        
+        Config()
+            : numThreads(0)
+            , topK(5)
+            , numVoices(4)
+            , lowestPitch(55)
+            , voiceLeadingWeight(0.02f)
+        {
+            voiceLeadingConfig.maxSearchMicros = 0;  // Keep results independent of timing
+        }
+    };
+    
+    // One bar of the input (melody not owned)
+    struct Bar {
+        const Note* melody;
+        size_t melodyCount;
+        Chord chord;  // Current harmony; never suggested as its own alternative
+    };
+    
+    struct Suggestion {
+        Chord chord;              // Candidate; confidence is its melody fit
+        uint8_t templateIndex;    // ChordAnalyzer template
+        float score;              // confidence - voiceLeadingWeight * voiceLeadingCost
+        float voiceLeadingCost;   // Previous bar -> candidate -> next bar's chord
+        harmony::VoiceLeading::Voicing voicing;  // Candidate voiced from the previous bar
+    };
+    
+    struct Results {
+        // Suggestions of bar i are suggestions[offsets[i] .. offsets[i + 1]),
+        // best first (ties: lower root, then lower template index)
+        std::vector<Suggestion> suggestions;
+        std::vector<size_t> offsets;
+    };
+    
+    explicit ReharmonizationEngine(const Config& config = Config{});
+    ~ReharmonizationEngine();
+    
+    // Non-copyable, non-movable
+    ReharmonizationEngine(const ReharmonizationEngine&) = delete;
+    ReharmonizationEngine& operator=(const ReharmonizationEngine&) = delete;
+    
+    // Non-RT: Top-K alternative chords for every bar; blocks until done.
+    // Candidates with the same pitch classes are reported once.
+    Results suggest(const std::vector<Bar>& bars);
+    
+    size_t getNumThreads() const noexcept { return pool_->getNumThreads(); }
+    
+private:
+    // Close voicing of chord, numVoices chord tones upwards from lowestPitch
+    harmony::VoiceLeading::Voicing closeVoicing(const Chord& chord) const noexcept;
+    
+    Config config_;
+    std::unique_ptr<WorkStealingPool> pool_;
+    
+    // Shared by the workers: solve() keeps its search state on the stack
+    std::unique_ptr<harmony::VoiceLeading> voiceLeading_;
+};
+
+} // namespace penta::batch
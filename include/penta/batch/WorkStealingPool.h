@@ -0,0 +1,69 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace penta::batch {
+
+/**
+ * Work-stealing thread pool for offline (non-RT) analysis jobs
+ * Each worker drains its own deque and steals from the back of others
+ * when it runs dry, so uneven item costs still keep every core busy.
+ * Items are all dealt before a job starts, so a worker that finds every
+ * deque empty has nothing left to do and goes back to sleep.
+ */
+class WorkStealingPool {
+public:
+    // body(itemIndex, workerIndex)
+    using Body = std::function<void(size_t, size_t)>;
+    
+    // numThreads = 0 uses std::thread::hardware_concurrency()
+    explicit WorkStealingPool(size_t numThreads = 0);
+    ~WorkStealingPool();
+    
+    // Non-copyable, non-movable
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+    
+    // Non-RT: Run body for every index in [0, count) and block until done.
+    // Rethrows the first exception thrown by body (remaining items still run).
+    void parallelFor(size_t count, const Body& body);
+    
+    size_t getNumThreads() const noexcept { return workers_.size(); }
+    
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<size_t> items;
+    };
+    
+    void workerLoop(size_t workerIndex);
+    bool popLocal(size_t workerIndex, size_t& outItem);
+    bool steal(size_t thiefIndex, size_t& outItem);
+    void runItem(size_t item, size_t workerIndex);
+    
+    std::vector<std::unique_ptr<WorkerQueue>> queues_;
+    std::vector<std::thread> workers_;
+    
+    std::mutex jobMutex_;              // Serializes parallelFor callers
+    std::mutex stateMutex_;
+    std::condition_variable wakeWorkers_;
+    std::condition_variable jobDone_;
+    
+    const Body* body_;
+    uint64_t generation_;
+    size_t activeWorkers_;
+    bool stopping_;
+    
+    std::exception_ptr firstError_;
+};
+
+} // namespace penta::batch
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "penta/common/RTMemoryPool.h"
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+namespace penta {
+
+/**
+ * Real-time safe size-class allocator
+ * Routes each request to the smallest RTMemoryPool whose blocks fit it,
+ * so variable-size allocations stay lock-free and malloc-free
+ */
+class RTAllocator {
+public:
+    struct SizeClass {
+        size_t blockSize;
+        size_t numBlocks;
+        size_t numThreadCaches = 0;  // See RTMemoryPool
+    };
+    
+    // Default classes: 16 B .. 4 KB in powers of two
+    RTAllocator();
+    explicit RTAllocator(const std::vector<SizeClass>& sizeClasses);
+    ~RTAllocator();
+    
+    // Non-copyable, non-movable
+    RTAllocator(const RTAllocator&) = delete;
+    RTAllocator& operator=(const RTAllocator&) = delete;
+    
+    // RT-safe: Returns nullptr if no class fits or the fitting class is exhausted
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t)) noexcept;
+    
+    // RT-safe: Size-hinted fast path (size must match the allocate call)
+    void deallocate(void* ptr, size_t size) noexcept;
+    
+    // RT-safe: Finds the owning pool by address
+    void deallocate(void* ptr) noexcept;
+    
+    // RT-safe: True if ptr came from one of the pools
+    bool owns(const void* ptr) const noexcept;
+    
+    // Statistics (for diagnostics)
+    size_t getNumSizeClasses() const noexcept { return pools_.size(); }
+    const RTMemoryPool& getPool(size_t sizeClass) const noexcept { return *pools_[sizeClass]; }
+    size_t getMaxBlockSize() const noexcept;
+    
+private:
+    RTMemoryPool* findPool(size_t size, size_t alignment) noexcept;
+    
+    std::vector<std::unique_ptr<RTMemoryPool>> pools_;  // Ascending block size
+};
+
+/**
+ * std::pmr adapter over RTAllocator, e.g. std::pmr::vector<Note> on the audio thread
+ * Requests that no pool can serve go to upstream, which by default is
+ * std::pmr::null_memory_resource() (throws std::bad_alloc, never mallocs)
+ */
+class RTMemoryResource : public std::pmr::memory_resource {
+public:
+    explicit RTMemoryResource(
+        RTAllocator& allocator,
+        std::pmr::memory_resource* upstream = std::pmr::null_memory_resource()
+    ) noexcept;
+    
+    RTAllocator& getAllocator() const noexcept { return allocator_; }
+    
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+    
+    RTAllocator& allocator_;
+    std::pmr::memory_resource* upstream_;
+};
+
+} // namespace penta
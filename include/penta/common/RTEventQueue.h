@@ -0,0 +1,74 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace penta {
+
+/**
+ * Fixed-capacity single-producer, single-consumer event queue
+ *
+ * The producer (usually the audio thread) never blocks or allocates: when
+ * the consumer falls behind, new events are dropped and counted rather than
+ * overwriting unread ones. Head and tail live on separate cache lines.
+ */
+template<typename T, size_t Capacity>
+class RTEventQueue {
+public:
+    static_assert(std::is_trivially_copyable_v<T>, "Events must be trivially copyable");
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+    
+    static constexpr size_t kCapacity = Capacity;
+    
+    RTEventQueue() noexcept : head_(0), tail_(0), dropped_(0), slots_{} {}
+    
+    // Non-copyable, non-movable
+    RTEventQueue(const RTEventQueue&) = delete;
+    RTEventQueue& operator=(const RTEventQueue&) = delete;
+    
+    // RT-safe: Append an event (producer only). Returns false if full.
+    bool push(const T& event) noexcept {
+        const uint64_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_.load(std::memory_order_acquire) >= Capacity) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        
+        slots_[tail & (Capacity - 1)] = event;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+    
+    // Lock-free: Take the oldest event (consumer only). Returns false if empty.
+    bool pop(T& out) noexcept {
+        const uint64_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        
+        out = slots_[head & (Capacity - 1)];
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+    
+    // Approximate when called concurrently with push/pop
+    size_t size() const noexcept {
+        return static_cast<size_t>(tail_.load(std::memory_order_acquire) -
+                                   head_.load(std::memory_order_acquire));
+    }
+    bool empty() const noexcept { return size() == 0; }
+    
+    // Statistics (for diagnostics)
+    uint64_t getDroppedCount() const noexcept { return dropped_.load(std::memory_order_relaxed); }
+    
+private:
+    alignas(64) std::atomic<uint64_t> head_;  // Next event to pop
+    alignas(64) std::atomic<uint64_t> tail_;  // Next slot to fill
+    std::atomic<uint64_t> dropped_;
+    std::array<T, Capacity> slots_;
+};
+
+} // namespace penta
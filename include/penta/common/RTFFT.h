@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace penta {
+
+/**
+ * Allocation-free real-input FFT for analysis front ends
+ *
+ * A real transform of size N runs as a complex transform of size N/2 over
+ * the even/odd samples, followed by a split step that separates the two
+ * interleaved spectra. The complex transform fuses pairs of radix-2 stages
+ * into radix-4 passes (one radix-2 stage leads when log2(N/2) is odd), and
+ * passes with spans of 8 or more run as AVX2/FMA butterflies. Twiddles and
+ * the bit-reversal permutation are precomputed at construction; forward()
+ * only touches preallocated work buffers, so one instance serves one
+ * thread at a time.
+ */
+class RTFFT {
+public:
+    // size is rounded up to a power of two >= 4
+    explicit RTFFT(size_t size);
+    
+    size_t getSize() const noexcept { return size_; }
+    size_t getNumBins() const noexcept { return size_ / 2 + 1; }  // DC through Nyquist
+    
+    // RT-safe: Spectrum of size real samples into getNumBins() bins
+    void forward(const float* input, float* real, float* imag) noexcept;
+    
+    // RT-safe: Magnitude |X[k]| of every bin
+    void magnitudes(const float* input, float* magnitude) noexcept;
+    
+private:
+    void transformHalf(const float* input) noexcept;
+    
+    // Two radix-2 stages (spans span and 2 * span) in one pass
+    void radix4Pass(size_t span) noexcept;
+    void radix4PassScalar(size_t span) noexcept;
+    
+    size_t size_;
+    size_t half_;
+    
+    std::vector<size_t> bitReverse_;  // Half-size permutation
+    std::vector<float> twiddleReal_;  // W_2s^j = exp(-i pi j / s) at [s - 1 + j], per stage span s
+    std::vector<float> twiddleImag_;
+    std::vector<float> splitCos_;     // cos(2 pi k / size), k <= half
+    std::vector<float> splitSin_;
+    
+    // Work buffers (SoA complex)
+    std::vector<float> workReal_;
+    std::vector<float> workImag_;
+    std::vector<float> outReal_;
+    std::vector<float> outImag_;
+};
+
+} // namespace penta
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace penta {
+
+/**
+ * Preallocated ring-buffer framer for overlapped STFT analysis
+ *
+ * Accepts blocks of any size and queues one frame of frameSize samples
+ * every hopSize samples. Frames end on exact multiples of hopSize since
+ * reset; history before the first sample reads as silence, so the first
+ * frame is due after one hop. Frames are popped oldest-first, so callers
+ * can spread the analysis over later blocks instead of paying for every
+ * frame in the block that completed it. Up to maxPendingFrames frames
+ * can wait; beyond that the oldest are dropped, which bounds both memory
+ * and latency.
+ */
+class RTFramer {
+public:
+    RTFramer(size_t frameSize, size_t hopSize, size_t maxPendingFrames);
+    
+    size_t getFrameSize() const noexcept { return frameSize_; }
+    size_t getHopSize() const noexcept { return hopSize_; }
+    
+    // RT-safe: Append samples (a block larger than the ring keeps its tail)
+    void push(const float* samples, size_t count) noexcept;
+    
+    // RT-safe: Copy the oldest pending frame, oldest sample first, into
+    // frame (frameSize samples). frameEnd receives the sample position
+    // (since reset) one past its newest sample. Returns false if no frame
+    // is pending.
+    bool pop(float* frame, uint64_t& frameEnd) noexcept;
+    
+    // RT-safe: Frames ready to pop
+    size_t getPendingFrames() const noexcept;
+    
+    // RT-safe: Frames dropped because the backlog was full, since reset
+    uint64_t getDroppedFrames() const noexcept { return droppedFrames_; }
+    
+    // RT-safe: Samples pushed since reset
+    uint64_t getSamplePosition() const noexcept { return samplesWritten_; }
+    
+    // RT-safe: Clear the ring and the backlog
+    void reset() noexcept;
+    
+private:
+    size_t frameSize_;
+    size_t hopSize_;
+    size_t maxPendingFrames_;
+    
+    std::vector<float> ring_;   // Sample t lives at t % ring_.size()
+    uint64_t samplesWritten_;
+    uint64_t nextFrameEnd_;     // End of the oldest pending frame
+    uint64_t droppedFrames_;
+};
+
+} // namespace penta
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace penta {
+
+/**
+ * Fixed-capacity history ring: one RT writer, any number of lock-free readers
+ *
+ * The writer overwrites the oldest entry and never blocks or allocates.
+ * Readers copy the newest entries and discard any slot the writer may have
+ * lapped during the copy, so a snapshot is always a consistent, gap-free run
+ * of entries (possibly shorter than requested under heavy writing).
+ *
+ * Entries are stored as atomic 64-bit words (release stores, acquire loads),
+ * so T must be trivially copyable with a size that is a multiple of 8.
+ */
+template<typename T, size_t Capacity>
+class RTHistoryRing {
+public:
+    static_assert(std::is_trivially_copyable_v<T>, "History entries must be trivially copyable");
+    static_assert(sizeof(T) % sizeof(uint64_t) == 0, "History entry size must be a multiple of 8");
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+    
+    static constexpr size_t kCapacity = Capacity;
+    static constexpr size_t kWordsPerEntry = sizeof(T) / sizeof(uint64_t);
+    
+    RTHistoryRing() noexcept : writeCount_(0), writeStarted_(0) {
+        for (auto& word : words_) {
+            word.store(0, std::memory_order_relaxed);
+        }
+    }
+    
+    // Non-copyable, non-movable
+    RTHistoryRing(const RTHistoryRing&) = delete;
+    RTHistoryRing& operator=(const RTHistoryRing&) = delete;
+    
+    // RT-safe: Append an entry (single writer)
+    void push(const T& entry) noexcept {
+        const uint64_t index = writeCount_.load(std::memory_order_relaxed);
+        writeStarted_.store(index + 1, std::memory_order_relaxed);
+        
+        uint64_t words[kWordsPerEntry];
+        std::memcpy(words, &entry, sizeof(T));
+        
+        auto* slot = &words_[(index & (Capacity - 1)) * kWordsPerEntry];
+        for (size_t w = 0; w < kWordsPerEntry; ++w) {
+            slot[w].store(words[w], std::memory_order_release);
+        }
+        
+        writeCount_.store(index + 1, std::memory_order_release);
+    }
+    
+    // Lock-free: Copy up to maxCount of the newest entries into out, oldest
+    // first. Returns the number of entries copied.
+    size_t snapshot(T* out, size_t maxCount) const noexcept {
+        const uint64_t end = writeCount_.load(std::memory_order_acquire);
+        const uint64_t available = std::min<uint64_t>(end, Capacity);
+        const uint64_t count = std::min<uint64_t>(available, maxCount);
+        const uint64_t begin = end - count;
+        
+        for (uint64_t i = begin; i < end; ++i) {
+            uint64_t words[kWordsPerEntry];
+            const auto* slot = &words_[(i & (Capacity - 1)) * kWordsPerEntry];
+            for (size_t w = 0; w < kWordsPerEntry; ++w) {
+                words[w] = slot[w].load(std::memory_order_acquire);
+            }
+            std::memcpy(&out[i - begin], words, sizeof(T));
+        }
+        
+        // Having read any word of entry i + Capacity implies we now see
+        // writeStarted_ > i + Capacity, so every entry older than
+        // writeStarted_ - Capacity may be torn and is dropped
+        const uint64_t started = writeStarted_.load(std::memory_order_acquire);
+        const uint64_t firstIntact = started >= Capacity ? started - Capacity : 0;
+        if (firstIntact <= begin) {
+            return static_cast<size_t>(count);
+        }
+        
+        const uint64_t torn = std::min(firstIntact, end) - begin;
+        std::memmove(out, out + torn, static_cast<size_t>(count - torn) * sizeof(T));
+        return static_cast<size_t>(count - torn);
+    }
+    
+    // Total entries ever pushed (entry i lives in slot i % Capacity)
+    uint64_t getWriteCount() const noexcept { return writeCount_.load(std::memory_order_acquire); }
+    
+    // Raw slot storage (Capacity entries laid out as T) for zero-copy views.
+    // Unsynchronized: prefer snapshot() for consistent reads.
+    const void* data() const noexcept { return words_.data(); }
+    
+    // RT-safe: Forget all entries (writer side only)
+    void clear() noexcept {
+        writeCount_.store(0, std::memory_order_release);
+        writeStarted_.store(0, std::memory_order_release);
+    }
+    
+private:
+    static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t), "Atomic words must be lock-free and unpadded");
+    
+    std::array<std::atomic<uint64_t>, Capacity * kWordsPerEntry> words_;
+    alignas(64) std::atomic<uint64_t> writeCount_;  // Entries fully written
+    std::atomic<uint64_t> writeStarted_;            // Entries whose write has begun
+};
+
+} // namespace penta
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+
+namespace penta {
+
+enum class LogLevel {
+    Debug,
+    Info,
+    Warning,
+    Error
+};
+
+const char* logLevelString(LogLevel level) noexcept;
+
+// Raw argument kinds carried next to a static format string
+enum class LogArgType : uint8_t {
+    Int,
+    UInt,
+    Double,
+    Char,
+    Bool,
+    Pointer
+};
+
+static constexpr size_t kMaxLogArgs = 8;
+
+/**
+ * Structured log record: a pointer to a static printf-style format string
+ * plus raw argument bits. Formatting is deferred to the consumer thread
+ * (or to the offline decoder when written to a binary sink).
+ */
+struct LogRecord {
+    const char* format;
+    uint8_t argCount;
+    std::array<LogArgType, kMaxLogArgs> types;
+    std::array<uint64_t, kMaxLogArgs> args;
+};
+
+template<typename T>
+inline constexpr bool kIsLoggableArg =
+    (std::is_arithmetic_v<T> || std::is_enum_v<T> || std::is_pointer_v<T>) &&
+    !(std::is_pointer_v<T> && std::is_same_v<std::remove_cv_t<std::remove_pointer_t<T>>, char>);
+
+template<typename T>
+constexpr LogArgType logArgType() noexcept {
+    if constexpr (std::is_same_v<T, bool>) return LogArgType::Bool;
+    else if constexpr (std::is_same_v<T, char>) return LogArgType::Char;
+    else if constexpr (std::is_enum_v<T>) return logArgType<std::underlying_type_t<T>>();
+    else if constexpr (std::is_floating_point_v<T>) return LogArgType::Double;
+    else if constexpr (std::is_pointer_v<T>) return LogArgType::Pointer;
+    else if constexpr (std::is_signed_v<T>) return LogArgType::Int;
+    else return LogArgType::UInt;
+}
+
+template<typename T>
+constexpr uint64_t encodeLogArg(T value) noexcept {
+    if constexpr (std::is_enum_v<T>) return encodeLogArg(static_cast<std::underlying_type_t<T>>(value));
+    else if constexpr (std::is_floating_point_v<T>) return std::bit_cast<uint64_t>(static_cast<double>(value));
+    else if constexpr (std::is_pointer_v<T>) return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(value));
+    else if constexpr (std::is_signed_v<T>) return static_cast<uint64_t>(static_cast<int64_t>(value));
+    else return static_cast<uint64_t>(value);
+}
+
+// Non-RT: Expand a printf-style format with recorded arguments. Length
+// modifiers in the format are ignored; each conversion takes its width from
+// the recorded argument. %s is not supported (arguments are raw bits).
+void formatLogRecord(const LogRecord& record, std::string& out);
+
+/**
+ * Binary log stream writer (consumer side, non-RT)
+ *
+ * Layout: "PENTALOG" magic, uint32 version, then tagged records:
+ *   'F' uint32 id, uint32 length, bytes         - format string definition
+ *   'T' uint8 level, uint16 length, bytes       - preformatted text
+ *   'M' uint8 level, uint32 formatId, uint8 n,  - structured message
+ *       n type bytes, n uint64 args
+ * Each distinct format pointer is written once; messages refer to it by id.
+ * Integers are stored in host byte order.
+ */
+class BinaryLogWriter {
+public:
+    static constexpr char kMagic[8] = {'P', 'E', 'N', 'T', 'A', 'L', 'O', 'G'};
+    static constexpr uint32_t kVersion = 1;
+    
+    explicit BinaryLogWriter(std::ostream& out);
+    
+    void writeText(LogLevel level, const char* text);
+    void writeRecord(LogLevel level, const LogRecord& record);
+    
+private:
+    uint32_t formatId(const char* format);
+    
+    std::ostream& out_;
+    std::unordered_map<const char*, uint32_t> formatIds_;
+};
+
+// Non-RT: Decode a binary log stream into "[LEVEL] message" lines.
+// Returns false on a bad header or truncated/corrupt record.
+bool decodeBinaryLog(std::istream& in, std::ostream& out);
+
+} // namespace penta
@@ -1,62 +1,119 @@
 #pragma once
 
+#include "penta/common/RTLogFormat.h"
 #include <array>
 #include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
 #include <string>
 #include <thread>
 
 namespace penta {
 
-enum class LogLevel {
-    Debug,
-    Info,
-    Warning,
-    Error
-};
-
 /**
  * Real-time safe logging system
  * Uses lock-free queue to defer string formatting to non-RT thread
+ *
+ * The queue is a bounded multi-producer ring with a sequence number per
+ * slot, so any thread may log concurrently. Producers are wait-free: a
+ * full queue or kMaxEnqueueAttempts lost races drop the message and bump
+ * the dropped counter. The consumer sleeps on a futex-backed atomic wait
+ * and drains everything queued into a single buffered write per batch.
+ *
+ * logFormat() / PENTA_LOG_RT() enqueue a static format pointer plus raw
+ * argument bits (a few dozen bytes) instead of text; formatting happens on
+ * the consumer, or offline when a binary sink is attached.
  */
 class RTLogger {
 public:
     static constexpr size_t kMaxMessageSize = 256;
-    static constexpr size_t kQueueSize = 1024;
+    static constexpr size_t kQueueSize = 1024;  // Power of two
+    static constexpr int kMaxEnqueueAttempts = 8;
     
-    RTLogger();
+    explicit RTLogger(std::ostream& output);
+    RTLogger();  // Logs to std::cout
     ~RTLogger();
     
     // Non-copyable, non-movable
     RTLogger(const RTLogger&) = delete;
     RTLogger& operator=(const RTLogger&) = delete;
     
-    // RT-safe logging (lock-free)
+    // RT-safe logging (wait-free, any thread)
     void logRT(LogLevel level, const char* message) noexcept;
     
+    // RT-safe structured logging: format must be a static string (printf
+    // conversions, no %s); arguments are stored raw and formatted later
+    template<typename... Args>
+    void logFormat(LogLevel level, const char* format, Args... args) noexcept {
+        static_assert(sizeof...(Args) <= kMaxLogArgs, "Too many log arguments");
+        static_assert((kIsLoggableArg<Args> && ...),
+                      "Log arguments must be numbers, enums or non-string pointers");
+        
+        if (level < minLevel_.load(std::memory_order_relaxed)) {
+            return;
+        }
+        
+        LogRecord record;  // Only argCount entries are filled and copied
+        record.format = format;
+        record.argCount = static_cast<uint8_t>(sizeof...(Args));
+        [[maybe_unused]] size_t i = 0;
+        ((record.types[i] = logArgType<Args>(), record.args[i] = encodeLogArg(args), ++i), ...);
+        logRecord(level, record);
+    }
+    
     // Non-RT logging (for Python bridge)
     void log(LogLevel level, const std::string& message);
     
     // Control
     void start();
-    void stop();
+    void stop();  // Drains pending messages before returning
     void setMinLevel(LogLevel level) { minLevel_.store(level); }
     
+    // Non-RT: Write binary records to path instead of text (decode with
+    // penta-log-decode). Call while stopped; an empty path detaches the sink.
+    bool setBinarySink(const std::string& path);
+    
+    // Statistics (for diagnostics)
+    uint64_t getDroppedCount() const noexcept { return dropped_.load(std::memory_order_relaxed); }
+    
 private:
-    struct LogMessage {
+    static_assert((kQueueSize & (kQueueSize - 1)) == 0, "kQueueSize must be a power of two");
+    
+    struct alignas(64) LogMessage {
+        // == position: free for the producer that claims position
+        // == position + 1: published, ready for the consumer
+        std::atomic<size_t> sequence;
         LogLevel level;
-        std::array<char, kMaxMessageSize> text;
-        std::atomic<bool> ready;
+        bool structured;
+        union {
+            std::array<char, kMaxMessageSize> text;
+            LogRecord record;
+        };
         
-        LogMessage() : level(LogLevel::Info), text{}, ready(false) {}
+        LogMessage() : sequence(0), level(LogLevel::Info), structured(false), text{} {}
     };
     
+    LogMessage* claimSlot(size_t& position) noexcept;
+    void publish(LogMessage& msg, size_t position) noexcept;
+    void logRecord(LogLevel level, const LogRecord& record) noexcept;
+    
     void processingThread();
+    size_t drainBatch(std::string& buffer);
+    void wakeConsumer() noexcept;
     
     std::array<LogMessage, kQueueSize> messageQueue_;
-    std::atomic<size_t> writeIndex_;
-    std::atomic<size_t> readIndex_;
+    alignas(64) std::atomic<size_t> writeIndex_;   // Next position to claim (producers)
+    alignas(64) size_t readIndex_;                 // Next position to consume (consumer only)
+    std::atomic<uint32_t> wakeSequence_;           // Futex word the consumer waits on
+    std::atomic<bool> consumerWaiting_;
+    std::atomic<uint64_t> dropped_;
     std::atomic<LogLevel> minLevel_;
     std::atomic<bool> running_;
+    std::ostream& output_;
+    std::unique_ptr<std::ostream> binaryFile_;
+    std::unique_ptr<BinaryLogWriter> binaryWriter_;
     std::thread processingThread_;
 };
 
@@ -64,6 +121,13 @@ private:
 RTLogger& getLogger();
 
 // Convenience macros
+// PENTA_LOG_RT("voices=%d cost=%.2f", n, cost): the "" concatenation
+// rejects anything but a string literal as the format
+#define PENTA_LOG_RT(fmt, ...) \
+    penta::getLogger().logFormat(penta::LogLevel::Info, "" fmt "" __VA_OPT__(,) __VA_ARGS__)
+#define PENTA_LOG_RT_AT(level, fmt, ...) \
+    penta::getLogger().logFormat(level, "" fmt "" __VA_OPT__(,) __VA_ARGS__)
+
 #define PENTA_LOG_RT_DEBUG(msg) penta::getLogger().logRT(penta::LogLevel::Debug, msg)
 #define PENTA_LOG_RT_INFO(msg) penta::getLogger().logRT(penta::LogLevel::Info, msg)
 #define PENTA_LOG_RT_WARNING(msg) penta::getLogger().logRT(penta::LogLevel::Warning, msg)
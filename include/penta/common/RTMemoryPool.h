@@ -2,6 +2,7 @@
 
 #include <atomic>
 #include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <vector>
 
@@ -10,10 +11,42 @@ namespace penta {
 /**
  * Real-time safe memory pool allocator
  * Pre-allocates memory blocks to avoid malloc/free in audio thread
+ *
+ * The free list is a lock-free stack of block indices. Its head packs a
+ * version tag with the index, and links live outside the blocks, so a
+ * stale head can never win a CAS after the block was recycled (ABA-safe)
+ *
+ * Optionally, up to numThreadCaches threads each get a private magazine of
+ * free blocks. Allocation and deallocation then stay on the owning core and
+ * only touch the shared head once per kTransferBatch blocks. A thread's
+ * magazine is returned to the pool when the thread exits. Blocks parked in
+ * other threads' magazines are not visible to allocate(), so size the pool
+ * with numThreadCaches * kMagazineSize blocks of headroom.
+ *
+ * A thread binds to the caches of at most kMaxPoolsPerThread pools, and
+ * uses the shared list of any further pool. Bindings to destroyed pools
+ * are dropped only off the RT path: when the thread constructs a pool, or
+ * calls releaseDeadThreadBindings().
  */
 class RTMemoryPool {
 public:
-    explicit RTMemoryPool(size_t blockSize, size_t numBlocks);
+    // Blocks are aligned to min(block size, kMaxAlignment)
+    static constexpr size_t kMaxAlignment = 64;
+    
+    // Per-thread magazine capacity and shared-list transfer size
+    static constexpr uint32_t kMagazineSize = 32;
+    static constexpr uint32_t kTransferBatch = kMagazineSize / 2;
+    
+    // Pools whose thread caches one thread can use at once
+    static constexpr size_t kMaxPoolsPerThread = 8;
+    
+    struct ThreadCacheStats {
+        uint64_t hits = 0;        // Allocations served from the magazine
+        uint64_t misses = 0;      // Allocations that refilled from the shared list
+        size_t cachedBlocks = 0;  // Free blocks currently held in the magazine
+    };
+    
+    explicit RTMemoryPool(size_t blockSize, size_t numBlocks, size_t numThreadCaches = 0);
     ~RTMemoryPool();
     
     // Non-copyable, non-movable
@@ -26,20 +59,71 @@ public:
     // RT-safe deallocation (lock-free)
     void deallocate(void* ptr) noexcept;
     
+    // RT-safe: True if ptr points into this pool's storage
+    bool owns(const void* ptr) const noexcept {
+        auto* p = static_cast<const uint8_t*>(ptr);
+        return p >= base_ && p < base_ + blockSize_ * numBlocks_;
+    }
+    
     // Statistics (for diagnostics)
     size_t getBlockSize() const noexcept { return blockSize_; }
+    size_t getBlockAlignment() const noexcept { return alignment_; }
     size_t getTotalBlocks() const noexcept { return numBlocks_; }
     size_t getAvailableBlocks() const noexcept;
     
+    // Thread cache statistics (for diagnostics)
+    size_t getNumThreadCaches() const noexcept { return numThreadCaches_; }
+    ThreadCacheStats getThreadCacheStats() const noexcept;  // Calling thread
+    ThreadCacheStats getThreadCacheStats(size_t cacheIndex) const noexcept;
+    
+    // Non-RT (locks): Forget the calling thread's bindings to destroyed pools
+    static void releaseDeadThreadBindings();
+    
 private:
-    struct Block {
-        Block* next;
+    struct alignas(kMaxAlignment) ThreadCache {
+        std::atomic<bool> claimed{false};
+        std::atomic<uint32_t> count{0};
+        std::atomic<uint64_t> hits{0};
+        std::atomic<uint64_t> misses{0};
+        uint32_t blocks[kMagazineSize];  // Owner thread only
     };
     
+    // Thread-local pool -> cache bindings; flushes magazines on thread exit
+    struct ThreadCacheTable;
+    static ThreadCacheTable& threadCacheTable() noexcept;
+    
+    // Calling thread's cache, claimed on first use; nullptr if caching is off
+    // or all caches are taken
+    ThreadCache* acquireThreadCache() noexcept;
+    const ThreadCache* findThreadCache() const noexcept;
+    void releaseThreadCache(ThreadCache& cache) noexcept;
+    
+    // Shared free list: pop/push up to count blocks with a single CAS
+    uint32_t popBatch(uint32_t* indices, uint32_t maxCount) noexcept;
+    void pushBatch(const uint32_t* indices, uint32_t count) noexcept;
+    
+    uint8_t* blockAt(uint32_t index) const noexcept { return base_ + static_cast<size_t>(index) * blockSize_; }
+    
+    static constexpr uint32_t kNullIndex = 0xFFFFFFFFu;
+    
+    static constexpr uint64_t packHead(uint32_t tag, uint32_t index) noexcept {
+        return (static_cast<uint64_t>(tag) << 32) | index;
+    }
+    static constexpr uint32_t headIndex(uint64_t head) noexcept { return static_cast<uint32_t>(head); }
+    static constexpr uint32_t headTag(uint64_t head) noexcept { return static_cast<uint32_t>(head >> 32); }
+    
     std::vector<uint8_t> memory_;
-    std::atomic<Block*> freeList_;
+    uint8_t* base_;                                 // memory_ aligned up
+    std::unique_ptr<std::atomic<uint32_t>[]> next_; // Free list links, one per block
+    std::atomic<uint64_t> freeHead_;                // [tag:32 | index:32]
+    std::atomic<size_t> available_;                 // Blocks on the shared list
     size_t blockSize_;
     size_t numBlocks_;
+    size_t alignment_;
+    
+    std::unique_ptr<ThreadCache[]> caches_;
+    size_t numThreadCaches_;
+    uint64_t poolId_;                               // Unique per pool, never reused
 };
 
 /**
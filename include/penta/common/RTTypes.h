@@ -2,7 +2,10 @@
 
 #include <array>
 #include <atomic>
+#include <bit>
+#include <cstddef>
 #include <cstdint>
+#include <initializer_list>
 #include <vector>
 
 namespace penta {
@@ -25,21 +28,98 @@ struct Note {
         : pitch(p), velocity(v), channel(c), timestamp(t) {}
 };
 
+// Pitch class set packed into a 12-bit mask (bit i = pitch class i, C = 0)
+class PitchClassSet {
+public:
+    static constexpr uint16_t kAllBits = 0x0FFF;
+    
+    constexpr PitchClassSet() noexcept : bits_(0) {}
+    constexpr explicit PitchClassSet(uint16_t bits) noexcept
+        : bits_(static_cast<uint16_t>(bits & kAllBits)) {}
+    
+    // Build from a list of pitch classes, e.g. fromPitchClasses({0, 4, 7})
+    static constexpr PitchClassSet fromPitchClasses(std::initializer_list<int> pitchClasses) noexcept {
+        uint16_t bits = 0;
+        for (int pc : pitchClasses) {
+            bits |= static_cast<uint16_t>(1u << (((pc % 12) + 12) % 12));
+        }
+        return PitchClassSet(bits);
+    }
+    
+    // Adapters for the std::array<bool, 12> representation
+    static constexpr PitchClassSet fromArray(const std::array<bool, 12>& pitchClasses) noexcept {
+        uint16_t bits = 0;
+        for (size_t i = 0; i < 12; ++i) {
+            bits |= static_cast<uint16_t>(pitchClasses[i]) << i;
+        }
+        return PitchClassSet(bits);
+    }
+    
+    constexpr std::array<bool, 12> toArray() const noexcept {
+        std::array<bool, 12> pitchClasses{};
+        for (size_t i = 0; i < 12; ++i) {
+            pitchClasses[i] = contains(static_cast<int>(i));
+        }
+        return pitchClasses;
+    }
+    
+    constexpr uint16_t bits() const noexcept { return bits_; }
+    constexpr bool empty() const noexcept { return bits_ == 0; }
+    constexpr int count() const noexcept { return std::popcount(bits_); }
+    
+    constexpr bool contains(int pitchClass) const noexcept { return (bits_ >> pitchClass) & 1u; }
+    constexpr bool operator[](size_t pitchClass) const noexcept { return (bits_ >> pitchClass) & 1u; }
+    
+    constexpr void set(int pitchClass, bool value = true) noexcept {
+        const auto bit = static_cast<uint16_t>(1u << pitchClass);
+        bits_ = static_cast<uint16_t>(value ? (bits_ | bit) : (bits_ & ~bit));
+    }
+    constexpr void reset(int pitchClass) noexcept { set(pitchClass, false); }
+    constexpr void clear() noexcept { bits_ = 0; }
+    
+    // Transpose every pitch class up by `semitones` (negative = down)
+    constexpr PitchClassSet rotate(int semitones) const noexcept {
+        const int n = ((semitones % 12) + 12) % 12;
+        return PitchClassSet(static_cast<uint16_t>((bits_ << n) | (bits_ >> (12 - n))));
+    }
+    
+    // Lowest pitch class in the set (12 if empty)
+    constexpr int lowest() const noexcept { return bits_ ? std::countr_zero(bits_) : 12; }
+    
+    constexpr PitchClassSet operator|(PitchClassSet other) const noexcept { return PitchClassSet(static_cast<uint16_t>(bits_ | other.bits_)); }
+    constexpr PitchClassSet operator&(PitchClassSet other) const noexcept { return PitchClassSet(static_cast<uint16_t>(bits_ & other.bits_)); }
+    constexpr PitchClassSet operator^(PitchClassSet other) const noexcept { return PitchClassSet(static_cast<uint16_t>(bits_ ^ other.bits_)); }
+    constexpr PitchClassSet operator~() const noexcept { return PitchClassSet(static_cast<uint16_t>(~bits_)); }
+    constexpr PitchClassSet& operator|=(PitchClassSet other) noexcept { bits_ |= other.bits_; return *this; }
+    constexpr PitchClassSet& operator&=(PitchClassSet other) noexcept { bits_ &= other.bits_; return *this; }
+    
+    constexpr bool operator==(const PitchClassSet&) const noexcept = default;
+    
+private:
+    uint16_t bits_;
+};
+
 // Chord representation
 struct Chord {
-    std::array<bool, 12> pitchClass; // Pitch class set
+    PitchClassSet pitchClass;        // Pitch class set
     uint8_t root;                    // Root note (0-11)
     uint8_t quality;                 // Major, minor, dim, aug, etc.
     float confidence;                // 0.0-1.0
+    uint8_t bass;                    // Lowest sounding pitch class (root if unknown)
+    uint8_t inversion;               // Chord tones below the bass (0 = root position)
+    
+    // inversion of a slash chord, whose bass is not a chord tone
+    static constexpr uint8_t kSlashBass = 0xFF;
+    constexpr bool isSlashChord() const noexcept { return inversion == kSlashBass; }
     
-    Chord() : pitchClass{}, root(0), quality(0), confidence(0.0f) {}
+    Chord() : pitchClass{}, root(0), quality(0), confidence(0.0f), bass(0), inversion(0) {}
 };
 
 // Scale representation
 struct Scale {
-    std::array<bool, 12> degrees;    // Scale degrees
+    PitchClassSet degrees;           // Scale degrees
     uint8_t tonic;                   // Tonic note (0-11)
-    uint8_t mode;                    // Ionian, Dorian, etc.
+    uint8_t mode;                    // Key-profile index (Major, Minor, Dorian, ...)
     float confidence;                // 0.0-1.0
     
     Scale() : degrees{}, tonic(0), mode(0), confidence(0.0f) {}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "penta/common/RTTypes.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace penta::groove {
+
+/**
+ * Online beat tracking by forward filtering over tempo and beat phase
+ *
+ * The state space is a beat pointer (Krebs, Boeck & Widmer, ISMIR 2015):
+ * every beat period from maxTempo to minTempo, in whole hops, is a ring of
+ * that many phase states. Each hop every state advances one phase; the
+ * mass completing a beat starts the next one at a nearby period, weighted
+ * by exp(-tempoChangePenalty * |period ratio - 1|) and by an optional
+ * tempo prior, which leaves the metrical level to the onsets. An onset
+ * boosts the states within kBeatWidth of a beat by its strength, so phases
+ * and periods that keep putting beats on onsets take over the posterior.
+ *
+ * The beat phase is the circular mean of the posterior around the most
+ * likely period, so beats are placed between hops. Accent sums per beat
+ * of the bar pick the downbeat. Once the phase is concentrated the
+ * TimingInfo grid (tempo, barStart, samplePosition) is refreshed every
+ * hop; until then it keeps its previous grid, initially 120 BPM from
+ * sample 0.
+ *
+ * Everything is allocated on construction; a hop costs O(states +
+ * periods^2), a few thousand multiply-adds at the default rates.
+ */
+class BeatTracker {
+public:
+    struct Config {
+        double sampleRate;
+        size_t hopSize;             // Samples per processFrame() call
+        float minTempo;
+        float maxTempo;
+        uint32_t beatsPerBar;
+        uint32_t beatUnit;
+        float tempoChangePenalty;   // Higher holds the tempo more tightly
+        
+        Config()
+            : sampleRate(kDefaultSampleRate)
+            , hopSize(512)
+            , minTempo(60.0f)
+            , maxTempo(180.0f)
+            , beatsPerBar(4)
+            , beatUnit(4)
+            , tempoChangePenalty(100.0f)
+        {}
+    };
+    
+    static constexpr size_t kMaxBeatsPerBar = 16;
+    static constexpr float kBeatWidth = 1.0f / 32.0f;   // Beat states either side of a beat, in beats
+    
+    explicit BeatTracker(const Config& config = Config{});
+    ~BeatTracker() = default;
+    
+    // RT-safe: Advance to the hop starting at framePosition. onsetStrength
+    // (0-1) is the strength of an onset detected in that hop, 0 if none.
+    // Hops skipped since the previous call advance without observations.
+    void processFrame(float onsetStrength, uint64_t framePosition) noexcept;
+    
+    // RT-safe: Favour periods near an external tempo estimate, or half or
+    // double it (0 confidence removes the prior)
+    void setTempoPrior(float bpm, float confidence) noexcept;
+    
+    // RT-safe: Beats per bar (clamped to kMaxBeatsPerBar) and beat unit;
+    // forgets the downbeat
+    void setTimeSignature(uint32_t beatsPerBar, uint32_t beatUnit) noexcept;
+    
+    // RT-safe: Tracked grid, refreshed every hop once the phase is known
+    const TimingInfo& getTimingInfo() const noexcept { return timing_; }
+    
+    // RT-safe: Concentration of the beat phase (0 = unknown, 1 = certain)
+    float getConfidence() const noexcept { return confidence_; }
+    
+    // RT-safe: Position of the most recent beat and beats since reset
+    uint64_t getLastBeat() const noexcept;
+    uint64_t getBeatCount() const noexcept { return beatCount_; }
+    
+    const Config& getConfig() const noexcept { return config_; }
+    
+    // Non-RT: Rebuilds the state space, then resets
+    void updateConfig(const Config& config);
+    void reset() noexcept;
+    
+private:
+    void buildStateSpace();
+    
+    // One hop of the forward filter
+    void advance(float onsetStrength) noexcept;
+    void updateGrid(float onsetStrength, uint64_t framePosition) noexcept;
+    
+    Config config_;
+    double framesPerMinute_;
+    
+    // Tempo states, fastest first: state i is a ring of periods_[i] phases
+    // at probability_[offsets_[i]...], phase 0 in slot heads_[i]
+    std::vector<uint32_t> periods_;
+    std::vector<uint32_t> offsets_;
+    std::vector<uint32_t> heads_;
+    std::vector<uint32_t> beatWidths_;      // Beat states either side of phase 0
+    std::vector<float> probability_;
+    std::vector<float> slotCos_;            // cos / sin of 2 pi slot / period
+    std::vector<float> slotSin_;
+    
+    // Period changes at a beat from each period, row-normalised and banded
+    // (SoA, weights packed per source period)
+    std::vector<uint32_t> transitionStart_;
+    std::vector<uint32_t> transitionLength_;
+    std::vector<uint32_t> transitionOffset_;
+    std::vector<float> transitionWeights_;
+    
+    std::vector<float> tempoPrior_;
+    std::vector<float> beatEnds_;           // Mass completing a beat this hop
+    std::vector<float> beatStarts_;         // Mass starting a beat this hop
+    std::vector<float> tempoMass_;          // Per-period posterior summary
+    std::vector<float> tempoCos_;
+    std::vector<float> tempoSin_;
+    
+    std::array<float, kMaxBeatsPerBar> accents_;    // Onset strength per beat of the bar
+    
+    TimingInfo timing_;
+    float confidence_;
+    bool hasFrame_;
+    uint64_t lastFramePosition_;
+    bool hasBeat_;
+    double lastBeat_;
+    uint64_t beatCount_;
+};
+
+} // namespace penta::groove
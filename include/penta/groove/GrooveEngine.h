@@ -1,6 +1,7 @@
 #pragma once
 
 #include "penta/common/RTTypes.h"
+#include "penta/groove/BeatTracker.h"
 #include "penta/groove/OnsetDetector.h"
 #include "penta/groove/TempoEstimator.h"
 #include "penta/groove/RhythmQuantizer.h"
@@ -12,38 +13,55 @@ namespace penta::groove {
 /**
  * Main groove analysis engine
  * Combines onset detection, tempo estimation, and rhythm quantization
+ *
+ * Every analysed hop also steps a BeatTracker, with the tempo estimate as
+ * its tempo prior, so the engine keeps its own beat grid (TimingInfo) and
+ * quantizes and swings against it without a host transport.
  */
 class GrooveEngine {
 public:
     struct Config {
         double sampleRate;
-        size_t hopSize;
+        size_t hopSize;                 // Onset analysis hop; blocks may be any size
+        OnsetDetector::Method onsetMethod;
         float minTempo;
         float maxTempo;
         bool enableQuantization;
         float quantizationStrength;
+        RhythmQuantizer::GridResolution gridResolution;
+        float swingAmount;              // 0.0 = straight, 1.0 = maximum swing
         
         Config()
             : sampleRate(kDefaultSampleRate)
             , hopSize(512)
+            , onsetMethod(OnsetDetector::Method::SpectralFlux)
             , minTempo(60.0f)
             , maxTempo(180.0f)
             , enableQuantization(true)
             , quantizationStrength(0.8f)
+            , gridResolution(RhythmQuantizer::GridResolution::Sixteenth)
+            , swingAmount(0.0f)
         {}
     };
     
     struct GrooveAnalysis {
         float currentTempo;
         float tempoConfidence;
-        std::vector<uint64_t> onsetPositions;
-        std::vector<float> onsetStrengths;
         uint32_t timeSignatureNum;
         uint32_t timeSignatureDen;
         float swing;  // 0.0 = straight, 1.0 = maximum swing
     };
     
+    // setParameter() indices
+    enum Parameter : int {
+        OnsetSensitivity = 0,       // 0-1, see OnsetDetector::setSensitivity
+        TempoSmoothing = 1,         // 0-1, see TempoEstimator::setSmoothing
+        QuantizationStrength = 2,   // 0-1
+        SwingAmount = 3             // 0-1
+    };
+    
     explicit GrooveEngine(const Config& config = Config{});
+    explicit GrooveEngine(double sampleRate);
     ~GrooveEngine();
     
     // Non-copyable, movable
@@ -52,18 +70,41 @@ public:
     GrooveEngine(GrooveEngine&&) noexcept = default;
     GrooveEngine& operator=(GrooveEngine&&) noexcept = default;
     
-    // RT-safe: Process audio buffer for groove analysis
+    // Onsets kept in the history ring (oldest overwritten first)
+    static constexpr size_t kMaxOnsetHistory = 512;
+    
+    // RT-safe: Process audio buffer for groove analysis. Onset positions
+    // are sample-accurate regardless of block size.
     void processAudio(const float* buffer, size_t frames) noexcept;
+    void processBlock(const float* buffer, size_t frames) noexcept { processAudio(buffer, frames); }
     
     // RT-safe: Get current groove analysis
     const GrooveAnalysis& getAnalysis() const noexcept { return analysis_; }
     
-    // RT-safe: Quantize timestamp to grid
+    // RT-safe: The last kMaxOnsetHistory onsets, index 0 oldest
+    size_t getOnsetCount() const noexcept { return onsetCount_; }
+    uint64_t getOnsetPosition(size_t index) const noexcept;
+    float getOnsetStrength(size_t index) const noexcept;
+    
+    // RT-safe: Onsets found by the last processAudio() call; they are the
+    // newest in the history. Callers that need every onset of a long
+    // stream collect these after each call.
+    size_t getBlockOnsetCount() const noexcept { return blockOnsets_; }
+    float getCurrentTempo() const noexcept { return analysis_.currentTempo; }
+    
+    // RT-safe: Tracked beat grid (120 BPM from sample 0 until the tracker
+    // has locked on)
+    const TimingInfo& getTimingInfo() const noexcept { return beatTracker_->getTimingInfo(); }
+    
+    // RT-safe: Quantize timestamp to the tracked grid
     uint64_t quantizeToGrid(uint64_t timestamp) const noexcept;
     
-    // RT-safe: Get swing-adjusted position
+    // RT-safe: Get swing-adjusted position on the tracked grid
     uint64_t applySwing(uint64_t position) const noexcept;
     
+    // RT-safe: Set a Parameter; unknown indices are ignored
+    void setParameter(int parameter, float value) noexcept;
+    
     // Non-RT: Update configuration
     void updateConfig(const Config& config);
     
@@ -71,6 +112,12 @@ public:
     void reset();
     
 private:
+    OnsetDetector::Config onsetConfig() const noexcept;
+    TempoEstimator::Config tempoConfig() const noexcept;
+    BeatTracker::Config beatConfig() const noexcept;
+    RhythmQuantizer::Config quantizerConfig() const noexcept;
+    double samplesPerBeat(const TimingInfo& timing) const noexcept;
+    void recordOnset(uint64_t position, float strength) noexcept;
     void updateTempoEstimate() noexcept;
     void detectTimeSignature() noexcept;
     void analyzeSwing() noexcept;
@@ -80,10 +127,17 @@ private:
     
     std::unique_ptr<OnsetDetector> onsetDetector_;
     std::unique_ptr<TempoEstimator> tempoEstimator_;
+    std::unique_ptr<BeatTracker> beatTracker_;
     std::unique_ptr<RhythmQuantizer> quantizer_;
     
     uint64_t samplePosition_;
-    std::vector<uint64_t> onsetHistory_;
+    
+    // Onset history ring (kMaxOnsetHistory slots, SoA)
+    std::vector<uint64_t> onsetPositions_;
+    std::vector<float> onsetStrengths_;
+    size_t onsetHead_;          // Oldest onset
+    size_t onsetCount_;
+    size_t blockOnsets_;
 };
 
 } // namespace penta::groove
@@ -1,39 +1,83 @@
 #pragma once
 
+#include "penta/common/RTFFT.h"
+#include "penta/common/RTFramer.h"
 #include "penta/common/RTTypes.h"
+#include <memory>
 #include <vector>
 
 namespace penta::groove {
 
 /**
- * Real-time onset detection using spectral flux
- * Optimized for low-latency performance
+ * Real-time onset detection from a choice of spectral detection functions
+ *
+ * Input of any block size is framed by an RTFramer into overlapped frames
+ * of fftSize samples ending on exact multiples of hopSize. Each frame is
+ * Hann-windowed and transformed once, and Config::method turns that one
+ * spectrum into the onset detection function (ODF). Magnitudes are scaled
+ * so a full-scale sinusoid reads 1, and every method reads a full-scale
+ * click from silence about as spectral flux does, so one threshold suits
+ * them all. A frame is an onset when its ODF is still rising and exceeds
+ * the median of the last medianFrames values by threshold, and
+ * minTimeBetweenOnsets has passed since the previous onset. Peak picking
+ * is causal.
+ *
+ * By default every frame a block completes is analyzed in that process()
+ * call. A nonzero maxFramesPerBlock caps the analysis per call instead;
+ * frames completed beyond the cap wait in the framer for later calls,
+ * which spreads the FFTs of a large block over small ones but drops
+ * frames once more than maxPendingFrames wait, so the cap only suits
+ * hosts whose blocks average under (cap * hopSize) samples. Onset
+ * positions come from the frame timestamps, so they do not depend on
+ * block size or on how long a frame waited.
  */
 class OnsetDetector {
 public:
+    // Onset detection function
+    enum class Method : uint8_t {
+        SpectralFlux,           // Rectified magnitude rise per bin
+        HighFrequencyContent,   // Frequency-weighted magnitude; favours percussive attacks
+        ComplexDomain,          // Rectified distance from the phase-predicted spectrum; soft, tonal onsets
+        PhaseDeviation,         // Magnitude-weighted phase acceleration; pitched onsets without attack
+        SuperFlux               // Log filterbank rise over a max-filtered earlier frame; ignores vibrato
+    };
+    
     struct Config {
         double sampleRate;
         size_t fftSize;
         size_t hopSize;
-        float threshold;
+        Method method;
+        float threshold;            // ODF margin above the running median
         float minTimeBetweenOnsets; // seconds
+        size_t medianFrames;        // ODF frames in the adaptive median
+        size_t maxFramesPerBlock;   // Analysis budget per process() call (0 = every complete frame)
+        size_t maxPendingFrames;    // Backlog before the oldest frames are dropped
         
         Config()
             : sampleRate(kDefaultSampleRate)
             , fftSize(2048)
             , hopSize(512)
+            , method(Method::SpectralFlux)
             , threshold(0.3f)
             , minTimeBetweenOnsets(0.05f)
+            , medianFrames(8)
+            , maxFramesPerBlock(0)
+            , maxPendingFrames(16)
         {}
     };
     
     explicit OnsetDetector(const Config& config = Config{});
+    OnsetDetector(double sampleRate, size_t hopSize);
     ~OnsetDetector();
     
     // RT-safe: Process audio and detect onsets
     void process(const float* buffer, size_t frames) noexcept;
     
-    // RT-safe: Check if onset detected in last process call
+    // RT-safe: process(), then hasOnset()
+    bool processBlock(const float* buffer, size_t frames) noexcept;
+    
+    // RT-safe: Check if onset detected in last process call (the latest
+    // one if several frames were analyzed; see getFrameOnsetStrength)
     bool hasOnset() const noexcept { return onsetDetected_; }
     
     // RT-safe: Get onset strength (0.0-1.0)
@@ -42,27 +86,93 @@ public:
     // RT-safe: Get position of last onset (samples since last reset)
     uint64_t getOnsetPosition() const noexcept { return onsetPosition_; }
     
+    // RT-safe: Frames analyzed by the last process() call, oldest first.
+    // Frame i has the position an onset in it would get, and the strength
+    // of that onset or 0 if it held none.
+    size_t getAnalyzedFrames() const noexcept { return analyzedFrames_; }
+    uint64_t getFramePosition(size_t frame) const noexcept { return framePositions_[frame]; }
+    float getFrameOnsetStrength(size_t frame) const noexcept { return frameStrengths_[frame]; }
+    
+    // RT-safe: Completed frames still waiting for analysis
+    size_t getPendingFrames() const noexcept { return framer_.getPendingFrames(); }
+    
     // Configuration
     void setThreshold(float threshold) noexcept;
+    
+    // 0 = only the strongest onsets, 1 = most sensitive; maps onto threshold
+    // (0.5 is the default threshold of 0.3)
+    void setSensitivity(float sensitivity) noexcept;
+    
+    const Config& getConfig() const noexcept { return config_; }
+    
     void reset() noexcept;
     
 private:
-    void computeSpectralFlux(const float* buffer, size_t frames) noexcept;
-    void detectPeaks() noexcept;
+    void buildFilterbank();
+    
+    float computeDetectionFunction() noexcept;
+    float spectralFlux() const noexcept;
+    float highFrequencyContent() const noexcept;
+    float complexDomain() const noexcept;
+    float phaseDeviation() const noexcept;
+    float superFlux() noexcept;
+    
+    // Triangular band sums of a magnitude spectrum
+    void sumBands(const float* magnitude, float* bands) const noexcept;
+    void sumBandsSIMD(const float* magnitude, float* bands) const noexcept;
+    
+    // Returns true if the frame holds an onset
+    bool detectPeaks(float odf, uint64_t framePosition) noexcept;
     
     Config config_;
+    std::unique_ptr<RTFFT> fft_;
+    RTFramer framer_;
     
     std::vector<float> window_;
-    std::vector<float> fftBuffer_;
+    std::vector<float> fftBuffer_;      // Windowed analysis frame
     std::vector<float> spectrum_;
     std::vector<float> prevSpectrum_;
-    std::vector<float> fluxHistory_;
+    
+    // Scaled complex spectra of this frame and the two before it
+    // (ComplexDomain and PhaseDeviation)
+    std::vector<float> real_;
+    std::vector<float> imag_;
+    std::vector<float> prevReal_;
+    std::vector<float> prevImag_;
+    std::vector<float> prevReal2_;
+    std::vector<float> prevImag2_;
+    
+    // SuperFlux log filterbank: triangular bands, 24 per octave, whose
+    // weights sum to 1 in every covered bin (SoA, weights packed per band)
+    std::vector<uint32_t> bandStart_;
+    std::vector<uint32_t> bandLength_;
+    std::vector<uint32_t> bandOffset_;
+    std::vector<float> bandWeights_;
+    std::vector<float> bands_;
+    std::vector<float> bandHistory_;    // Last superFluxLag_ frames of log bands (ring)
+    size_t bandHistoryIndex_;
+    size_t superFluxLag_;
+    float logScale_;
+    float superFluxScale_;
+    
+    std::vector<float> fluxHistory_;    // Last medianFrames ODF values (ring)
+    std::vector<float> medianScratch_;
+    
+    float spectrumScale_;
+    float prevFlux_;
+    size_t historyIndex_;
+    uint64_t refractorySamples_;
+    
+    // Frames of the last process() call (room for maxFramesPerBlock)
+    std::vector<uint64_t> framePositions_;
+    std::vector<float> frameStrengths_;
+    size_t analyzedFrames_;
     
     bool onsetDetected_;
+    bool anyOnset_;
     float onsetStrength_;
     uint64_t onsetPosition_;
     uint64_t lastOnsetPosition_;
-    uint64_t sampleCounter_;
 };
 
 } // namespace penta::groove
@@ -7,16 +7,32 @@ namespace penta::groove {
 /**
  * Real-time rhythm quantization
  * Snaps timestamps to musical grid with configurable strength
+ *
+ * The grid is laid from a bar start at a beat length in samples, where a
+ * beat is one 1/timeSignatureDen note. Positions before the bar start
+ * snap to the same grid extended backwards. With swing enabled on a
+ * straight resolution, grid points pair up and the second of each pair
+ * moves from halfway through the pair to 50 + 25 * swingAmount percent
+ * (2/3 is triplet swing, 1 a dotted shuffle); quantize() snaps to that
+ * swung grid. Triplet resolutions are never swung.
+ *
+ * Besides the stateless calls that take the beat length and bar start,
+ * the quantizer keeps a tempo and bar start of its own for callers
+ * without a transport, set with setTempo() and setBarStart().
  */
 class RhythmQuantizer {
 public:
+    // Notes per whole note
     enum class GridResolution {
         Whole = 1,
         Half = 2,
         Quarter = 4,
         Eighth = 8,
         Sixteenth = 16,
-        ThirtySecond = 32
+        ThirtySecond = 32,
+        QuarterTriplet = 6,
+        EighthTriplet = 12,
+        SixteenthTriplet = 24
     };
     
     struct Config {
@@ -38,36 +54,57 @@ public:
     };
     
     explicit RhythmQuantizer(const Config& config = Config{});
+    explicit RhythmQuantizer(double sampleRate);
     ~RhythmQuantizer() = default;
     
     // RT-safe: Quantize sample position to grid
     uint64_t quantize(
         uint64_t samplePosition,
-        uint64_t samplesPerBeat,
+        double samplesPerBeat,
         uint64_t barStartPosition
     ) const noexcept;
     
-    // RT-safe: Apply swing to position
+    // RT-safe: Apply swing to position. Straight grid points move onto
+    // the swung grid and positions between them are stretched to match.
     uint64_t applySwing(
         uint64_t samplePosition,
-        uint64_t samplesPerBeat,
+        double samplesPerBeat,
         uint64_t barStartPosition
     ) const noexcept;
     
+    // RT-safe: Quantize / swing against the tempo and bar start set below
+    uint64_t quantize(uint64_t samplePosition) const noexcept;
+    uint64_t applySwing(uint64_t samplePosition) const noexcept;
+    
     // RT-safe: Get grid subdivision at position
     uint64_t getGridInterval(uint64_t samplesPerBeat) const noexcept;
     
+    // RT-safe: Grid for the single-argument calls (120 BPM from sample 0
+    // until set)
+    void setTempo(float bpm) noexcept;
+    void setBarStart(uint64_t barStartPosition) noexcept;
+    void setTimeSignature(uint32_t numerator, uint32_t denominator) noexcept;
+    void setGrid(GridResolution resolution) noexcept;
+    
+    // RT-safe: Set swingAmount; 0 turns swing off
+    void setSwing(float amount) noexcept;
+    
     // Configuration
     void updateConfig(const Config& config) noexcept;
+    const Config& getConfig() const noexcept { return config_; }
     
 private:
-    uint64_t findNearestGridPoint(
-        uint64_t position,
-        uint64_t gridInterval,
-        uint64_t barStart
-    ) const noexcept;
+    double gridInterval(double samplesPerBeat) const noexcept;
+    bool isSwung() const noexcept;
+    
+    // Nearest (swung) grid point, relative to the bar start
+    double findNearestGridPoint(double relative, double gridInterval) const noexcept;
     
     Config config_;
+    
+    double sampleRate_;
+    double samplesPerBeat_;
+    uint64_t barStart_;
 };
 
 } // namespace penta::groove
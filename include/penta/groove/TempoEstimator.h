@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <vector>
 
@@ -8,6 +9,19 @@ namespace penta::groove {
 /**
  * Real-time tempo estimation using autocorrelation
  * Tracks tempo changes with adaptive filtering
+ *
+ * The last historySize onsets live in a fixed-capacity ring. Every onset
+ * pair adds its inter-onset interval to a lag histogram, spread by a small
+ * Gaussian to absorb detector jitter, which makes the histogram the
+ * autocorrelation of the onset train. A new onset adds its pairs and the
+ * evicted one removes its own, so an update costs O(historySize).
+ *
+ * A comb-filter bank then scores every tempo from minTempo to maxTempo in
+ * kTempoStep steps by summing the histogram at the first kCombHarmonics
+ * multiples of the beat period, weighted by a log-Gaussian prior around
+ * 120 BPM that settles octave ambiguities. The best candidate is refined
+ * by parabolic interpolation and folded into the current tempo at
+ * adaptationRate. Confidence is the peak's salience over the mean score.
  */
 class TempoEstimator {
 public:
@@ -27,13 +41,19 @@ public:
         {}
     };
     
+    static constexpr float kTempoStep = 0.5f;       // BPM between comb filters
+    static constexpr size_t kCombHarmonics = 4;     // Beat multiples per comb
+    static constexpr double kLagResolution = 0.005; // Seconds per histogram bin
+    
     explicit TempoEstimator(const Config& config = Config{});
+    explicit TempoEstimator(double sampleRate);
     ~TempoEstimator() = default;
     
-    // RT-safe: Add onset time for tempo calculation
+    // RT-safe: Add onset time for tempo calculation. A position earlier
+    // than the previous onset restarts the history.
     void addOnset(uint64_t samplePosition) noexcept;
     
-    // RT-safe: Get current tempo estimate
+    // RT-safe: Get current tempo estimate (0 until one has been made)
     float getCurrentTempo() const noexcept { return currentTempo_; }
     
     // RT-safe: Get confidence of tempo estimate (0.0-1.0)
@@ -42,17 +62,44 @@ public:
     // RT-safe: Get samples per beat
     uint64_t getSamplesPerBeat() const noexcept;
     
-    // Configuration
-    void updateConfig(const Config& config) noexcept;
+    // RT-safe: 0 follows every estimate, 1 holds the current tempo;
+    // sets adaptationRate to 1 - smoothing
+    void setSmoothing(float smoothing) noexcept;
+    
+    const Config& getConfig() const noexcept { return config_; }
+    
+    // Non-RT: Reallocates the history and comb bank, then resets
+    void updateConfig(const Config& config);
     void reset() noexcept;
     
 private:
+    void buildCombBank();
+    
+    // Add (sign +1) or remove (sign -1) the intervals between the onset at
+    // ring slot `slot` and every other onset in the ring
+    void accumulatePairs(size_t slot, float sign) noexcept;
+    
     void estimateTempo() noexcept;
-    float autocorrelate(const std::vector<float>& intervals) const noexcept;
+    
+    // Comb response of every candidate into combScores_
+    void evaluateCombBank() noexcept;
+    void evaluateCombBankSIMD() noexcept;
     
     Config config_;
     
-    std::vector<uint64_t> onsetHistory_;
+    std::vector<uint64_t> onsetHistory_;    // Ring of historySize onsets
+    size_t historyHead_;                    // Oldest onset
+    size_t historyCount_;
+    
+    std::vector<float> lagHistogram_;       // Interval weight per kLagResolution bin
+    double binsPerSample_;
+    
+    // Comb bank (SoA, padded to a multiple of 8 with zero-prior candidates)
+    std::vector<float> combPeriods_;        // Beat period in histogram bins
+    std::vector<float> combPrior_;
+    std::vector<float> combScores_;
+    size_t numCandidates_;
+    
     float currentTempo_;
     float confidence_;
     uint64_t lastOnsetPosition_;
@@ -2,6 +2,8 @@
 
 #include "penta/common/RTTypes.h"
 #include <array>
+#include <cstddef>
+#include <cstdint>
 
 namespace penta::harmony {
 
@@ -14,53 +16,191 @@ public:
     ChordAnalyzer();
     ~ChordAnalyzer() = default;
     
-    // RT-safe: Analyze pitch class set and return chord
-    Chord analyze(const std::array<bool, 12>& pitchClassSet) noexcept;
+    // Bass argument when the register is unknown: root position is assumed
+    static constexpr int kNoBass = -1;
+    
+    // RT-safe: Analyze pitch class set and return chord. With a bass (the
+    // lowest sounding pitch class), the same pass also scores the reading
+    // rooted on the bass, which wins ties (A C E G over A is Am7, over C it
+    // is C6), and the upper structure without the bass: if that reads
+    // strictly better, the result is a slash chord (C E G over F# is C/F#).
+    // Fills Chord::bass and Chord::inversion.
+    Chord analyze(PitchClassSet pitchClassSet, int bass = kNoBass) noexcept;
+    Chord analyze(const std::array<bool, 12>& pitchClassSet) noexcept {
+        return analyze(PitchClassSet::fromArray(pitchClassSet));
+    }
     
     // RT-safe: Update with new pitch class set
-    void update(const std::array<bool, 12>& pitchClassSet) noexcept;
+    void update(PitchClassSet pitchClassSet, int bass = kNoBass) noexcept;
+    void update(const std::array<bool, 12>& pitchClassSet) noexcept {
+        update(PitchClassSet::fromArray(pitchClassSet));
+    }
+    
+    // RT-safe: Soft analysis of a pitch-class weight histogram (velocity- or
+    // decay-weighted). Weights are scaled so the strongest pitch class counts
+    // 1, and every template at every root is scored in one 12 x 384
+    // matrix-vector product: completeness is the template's share of weight,
+    // and weight outside the template is the (soft) extra-note count. A 0/1
+    // histogram scores exactly like analyze(). The chord's pitchClass holds
+    // the pitch classes with positive weight. bass works as in analyze().
+    Chord analyzeWeighted(const std::array<float, 12>& weights, int bass = kNoBass) noexcept;
+    void updateWeighted(const std::array<float, 12>& weights, int bass = kNoBass) noexcept;
     
     // RT-safe: Get current best chord match
     const Chord& getCurrentChord() const noexcept { return currentChord_; }
     
     // SIMD-optimized analysis (AVX2 when available, scalar fallback otherwise)
-    Chord analyzeSIMD(const std::array<bool, 12>& pitchClassSet) noexcept;
+    Chord analyzeSIMD(PitchClassSet pitchClassSet) noexcept;
+    Chord analyzeSIMD(const std::array<bool, 12>& pitchClassSet) noexcept {
+        return analyzeSIMD(PitchClassSet::fromArray(pitchClassSet));
+    }
+    
+    // Reference path: scores every template at every root (not used per block;
+    // kept for building and verifying the lookup table)
+    Chord analyzeExhaustive(PitchClassSet pitchClassSet) const noexcept;
+    Chord analyzeExhaustive(const std::array<bool, 12>& pitchClassSet) const noexcept {
+        return analyzeExhaustive(PitchClassSet::fromArray(pitchClassSet));
+    }
     
     // Configuration
     void setConfidenceThreshold(float threshold) noexcept;
     void setTemporalSmoothing(float factor) noexcept; // 0.0-1.0
     
+    // RT-safe: Clear current/previous chord (smoothing state)
+    void reset() noexcept;
+    
+    // One entry per 12-bit pitch class mask
+    static constexpr size_t kLookupTableSize = 1 << 12;
+    
+    // Chord templates, e.g. as candidates for reharmonization
+    static constexpr size_t kNumTemplates = 32;
+    
+    // Templates from here on (power chord, single note) are fragments, not
+    // chords: they never name the upper structure of a slash chord
+    static constexpr size_t kFirstPartialTemplate = 30;
+    
+    // An upper structure must have this many tones and beat the reading of
+    // the whole set by this much to turn it into a slash chord
+    static constexpr int kMinUpperStructureTones = 3;
+    static constexpr float kSlashChordMargin = 0.1f;
+    static Chord templateChord(size_t templateIndex, uint8_t root) noexcept;  // Confidence 1
+    static const char* templateName(size_t templateIndex) noexcept;
+    
+    // Confidence with which pitchClassSet matches a template at a root
+    // (the score analyze() ranks templates by)
+    static float templateConfidence(
+        PitchClassSet pitchClassSet,
+        size_t templateIndex,
+        uint8_t root
+    ) noexcept;
+    
 private:
     struct ChordTemplate {
-        std::array<bool, 12> pattern;
+        PitchClassSet pattern;
         uint8_t quality;
         const char* name;
     };
     
-    float scoreAgainstTemplate(
-        const std::array<bool, 12>& pitchClassSet,
+    // Packed best match for one pitch class mask (2 bytes, whole table is 8 KB)
+    struct LookupEntry {
+        uint16_t root : 4;
+        uint16_t quality : 5;
+        uint16_t scoreIndex : 7;  // Index into LookupTable::scores
+    };
+    
+    struct LookupTable {
+        std::array<LookupEntry, kLookupTableSize> entries;
+        std::array<float, 128> scores;  // Distinct best-match confidences
+        
+        // Best template with the root fixed at pitch class 0; rotating the
+        // input down by the bass gives the best reading rooted on the bass
+        std::array<uint8_t, kLookupTableSize> rootPositionTemplates;
+        
+        // Best match among the chord templates (before kFirstPartialTemplate),
+        // for reading upper structures
+        std::array<LookupEntry, kLookupTableSize> chordEntries;
+    };
+    
+    // Built once on first use (ChordAnalyzer constructor), read-only afterwards
+    static const LookupTable& lookupTable() noexcept;
+    static LookupTable buildLookupTable() noexcept;
+    
+    // Template indicator matrix for weighted analysis: column-major,
+    // row = root * kNumTemplates + template (the order findBestMatch scans)
+    static constexpr size_t kNumWeightedRows = 12 * kNumTemplates;
+    struct WeightedMatrix {
+        alignas(32) std::array<std::array<float, kNumWeightedRows>, 12> columns;
+        alignas(32) std::array<float, kNumWeightedRows> templateSizes;
+    };
+    
+    // Built once on first use (ChordAnalyzer constructor), read-only afterwards
+    static const WeightedMatrix& weightedMatrix() noexcept;
+    static WeightedMatrix buildWeightedMatrix() noexcept;
+    
+    // Best rows (root * kNumTemplates + template) of one analysis pass:
+    // overall, rooted on the bass, and of the upper structure (the input
+    // without the bass pitch class, among chord templates only). Bass rows
+    // score 0 without a bass.
+    struct BassMatch {
+        size_t bestRow = 0;
+        float bestScore = 0.0f;
+        size_t bassRow = 0;
+        float bassScore = 0.0f;
+        size_t upperRow = 0;
+        float upperScore = 0.0f;
+        int upperTones = 0;  // Pitch classes sounding above the bass
+    };
+    
+    // Pick the reading (root-position ties, slash chord only if its upper
+    // structure is a full chord that clearly reads better) and fill root, quality, confidence, bass and inversion
+    static void resolveBass(const BassMatch& match, int bass, Chord& outChord) noexcept;
+    
+    // Best rows for normalized weights summing to total (scalar and SIMD)
+    static void findBestMatchWeighted(
+        const std::array<float, 12>& weights,
+        float total,
+        int bass,
+        BassMatch& outMatch
+    ) noexcept;
+    static void findBestMatchWeightedSIMD(
+        const std::array<float, 12>& weights,
+        float total,
+        int bass,
+        BassMatch& outMatch
+    ) noexcept;
+    
+    void applySmoothing() noexcept;
+    
+    static void lookupBestMatch(
+        PitchClassSet pitchClassSet,
+        int bass,
+        Chord& outChord
+    ) noexcept;
+    
+    static float scoreAgainstTemplate(
+        PitchClassSet pitchClassSet,
         const ChordTemplate& template_,
         uint8_t root
-    ) const noexcept;
+    ) noexcept;
     
-    void findBestMatch(
-        const std::array<bool, 12>& pitchClassSet,
+    static void findBestMatch(
+        PitchClassSet pitchClassSet,
         Chord& outChord
     ) noexcept;
     
     // SIMD-optimized implementations
     float scoreAgainstTemplateSIMD(
-        const std::array<bool, 12>& pitchClassSet,
+        PitchClassSet pitchClassSet,
         const ChordTemplate& template_,
         uint8_t root
     ) const noexcept;
     
-    void findBestMatchSIMD(
-        const std::array<bool, 12>& pitchClassSet,
+    static void findBestMatchSIMD(
+        PitchClassSet pitchClassSet,
         Chord& outChord
     ) noexcept;
     
-    static const std::array<ChordTemplate, 32> kChordTemplates;
+    static const std::array<ChordTemplate, kNumTemplates> kChordTemplates;
     
     Chord currentChord_;
     Chord previousChord_;
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "penta/common/RTFFT.h"
+#include "penta/common/RTTypes.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace penta::harmony {
+
+/**
+ * Real-time chromagram from mono audio
+ *
+ * Every hopSize samples the newest fftSize samples are Hann-windowed and
+ * transformed, and the spectral peaks (local maxima of the magnitude) are
+ * folded onto 12 pitch classes through a sparse STFT-to-chroma matrix built
+ * at construction: each bin between minFrequency and maxFrequency maps to
+ * its nearest equal-tempered semitone. The result is scaled so the strongest pitch
+ * class is 1, with classes below chromaFloor zeroed, which is the input
+ * ChordAnalyzer::analyzeWeighted() and ScaleDetector expect.
+ */
+class ChromaExtractor {
+public:
+    struct Config {
+        double sampleRate;
+        size_t fftSize;           // Rounded up to a power of two
+        size_t hopSize;           // Samples between chroma frames
+        float minFrequency;       // Hz; bins below are ignored
+        float maxFrequency;       // Hz; bins above are ignored
+        float tuning;             // Frequency of A4 in Hz
+        float chromaFloor;        // Classes below this share of the peak read as absent
+        float silenceThreshold;   // RMS below which a frame has no chroma
+        
+        Config()
+            : sampleRate(kDefaultSampleRate)
+            , fftSize(4096)
+            , hopSize(1024)
+            , minFrequency(110.0f)
+            , maxFrequency(5000.0f)
+            , tuning(440.0f)
+            , chromaFloor(0.25f)
+            , silenceThreshold(1e-4f)
+        {}
+    };
+    
+    explicit ChromaExtractor(const Config& config = Config{});
+    ~ChromaExtractor();
+    
+    // Non-copyable, movable
+    ChromaExtractor(const ChromaExtractor&) = delete;
+    ChromaExtractor& operator=(const ChromaExtractor&) = delete;
+    ChromaExtractor(ChromaExtractor&&) noexcept = default;
+    ChromaExtractor& operator=(ChromaExtractor&&) noexcept = default;
+    
+    // RT-safe: Push mono samples. Returns true if a chroma frame completed
+    // in this block; if several did, only the newest is computed.
+    bool process(const float* buffer, size_t frames) noexcept;
+    
+    // RT-safe: Latest chroma frame (all zero while silent)
+    const std::array<float, 12>& getChroma() const noexcept { return chroma_; }
+    
+    // RT-safe: Sample position (since reset) at which the latest frame ends
+    uint64_t getFramePosition() const noexcept { return framePosition_; }
+    
+    // RT-safe: Sparse mapping size (non-zero entries of the chroma matrix)
+    size_t getMappingSize() const noexcept { return mapBins_.size(); }
+    
+    const Config& getConfig() const noexcept { return config_; }
+    
+    // RT-safe: Clear buffered audio and the current frame
+    void reset() noexcept;
+    
+private:
+    void buildMapping();
+    void computeFrame() noexcept;
+    
+    Config config_;
+    std::unique_ptr<RTFFT> fft_;
+    
+    std::vector<float> window_;
+    std::vector<float> ring_;       // Last fftSize input samples
+    std::vector<float> frame_;      // Windowed, unwrapped analysis frame
+    std::vector<float> magnitude_;
+    std::vector<float> peaks_;      // Magnitude at local maxima, else 0
+    
+    // Sparse STFT-to-chroma matrix (SoA, sorted by bin)
+    std::vector<uint32_t> mapBins_;
+    std::vector<uint8_t> mapClasses_;
+    std::vector<float> mapWeights_;
+    
+    std::array<float, 12> chroma_;
+    size_t writeIndex_;
+    uint64_t sampleCounter_;
+    uint64_t nextFrame_;       // Sample count at which the next frame is due
+    uint64_t framePosition_;
+};
+
+} // namespace penta::harmony
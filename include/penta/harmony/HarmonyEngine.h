@@ -1,9 +1,12 @@
 #pragma once
 
+#include "penta/common/RTHistoryRing.h"
 #include "penta/common/RTTypes.h"
 #include "penta/harmony/ChordAnalyzer.h"
+#include "penta/harmony/ChromaExtractor.h"
 #include "penta/harmony/ScaleDetector.h"
 #include "penta/harmony/VoiceLeading.h"
+#include <bit>
 #include <memory>
 #include <vector>
 
@@ -17,20 +20,47 @@ class HarmonyEngine {
 public:
     struct Config {
         double sampleRate;
-        size_t analysisWindowSize;
+        size_t analysisWindowSize;   // FFT size of audio chroma analysis
+        size_t analysisHopSize;      // Samples between audio chroma frames
         bool enableVoiceLeading;
         bool enableScaleDetection;
+        bool weightedChordAnalysis;  // Score chords from mean velocity per pitch class, not just presence
         float confidenceThreshold;
         
         Config()
             : sampleRate(kDefaultSampleRate)
-            , analysisWindowSize(2048)
+            , analysisWindowSize(4096)
+            , analysisHopSize(1024)
             , enableVoiceLeading(true)
             , enableScaleDetection(true)
+            , weightedChordAnalysis(true)
             , confidenceThreshold(0.5f)
         {}
     };
     
+    // History entries, stamped with the sample position of the block that
+    // changed the harmony (timestamp of its last note)
+    struct ChordEvent {
+        uint64_t samplePosition;
+        Chord chord;
+    };
+    
+    struct ScaleEvent {
+        uint64_t samplePosition;
+        Scale scale;
+    };
+    
+    static constexpr size_t kHistoryCapacity = 256;
+    using ChordHistory = RTHistoryRing<ChordEvent, kHistoryCapacity>;
+    using ScaleHistory = RTHistoryRing<ScaleEvent, kHistoryCapacity>;
+    
+    // One analysis frame of an offline timeline
+    struct HarmonyFrame {
+        uint64_t samplePosition;  // Start of the hop this frame covers
+        Chord chord;
+        Scale scale;
+    };
+    
     explicit HarmonyEngine(const Config& config = Config{});
     ~HarmonyEngine();
     
@@ -40,41 +70,178 @@ public:
     HarmonyEngine(HarmonyEngine&&) noexcept = default;
     HarmonyEngine& operator=(HarmonyEngine&&) noexcept = default;
     
-    // RT-safe: Analyze incoming MIDI notes
+    // RT-safe: Analyze incoming MIDI notes. Chord and scale are re-analyzed
+    // only when the block changes the active pitch-class set or the bass.
+    // With weightedChordAnalysis a change in the per-class velocity sums
+    // re-scores the chord as well; that is a harmony change (history entry,
+    // scale update) only if the chord changes.
     void processNotes(const Note* notes, size_t count) noexcept;
     
+    // RT-safe: Analyze mono audio (e.g. an audio-only stem). Every
+    // analysisHopSize samples a chroma frame is scored like weighted MIDI
+    // (see ChromaExtractor); history entries and key tracking are stamped
+    // with the frame's sample position since reset. Chroma carries no
+    // register, so chords report root position. Use either this or
+    // processNotes on one engine, not both.
+    void processAudio(const float* buffer, size_t frames) noexcept;
+    
+    // RT-safe: Latest audio chroma frame (pitch-class weights, peak 1)
+    const std::array<float, 12>& getChroma() const noexcept { return chromaExtractor_->getChroma(); }
+    
+    // RT-safe: True if the harmony changed (see processNotes; audio: the
+    // chord) since the last call; clears the flag. Lets callers skip downstream work.
+    bool consumeHarmonyChanged() noexcept {
+        bool changed = harmonyChanged_;
+        harmonyChanged_ = false;
+        return changed;
+    }
+    
+    // RT-safe: Active pitch classes and per-class state (maintained incrementally)
+    PitchClassSet getActivePitchClasses() const noexcept { return pitchClassSet_; }
+    uint8_t getActiveNoteCount(int pitchClass) const noexcept { return pitchClassCounts_[pitchClass]; }
+    uint16_t getVelocitySum(int pitchClass) const noexcept { return velocitySums_[pitchClass]; }
+    
+    // RT-safe: Lowest sounding MIDI pitch (-1 if none), O(1) from the
+    // active-pitch bitset. Its pitch class is the chord's bass.
+    int getBassNote() const noexcept {
+        if (activePitchBits_[0] != 0) return std::countr_zero(activePitchBits_[0]);
+        if (activePitchBits_[1] != 0) return 64 + std::countr_zero(activePitchBits_[1]);
+        return -1;
+    }
+    
     // RT-safe: Get current harmonic state
     const Chord& getCurrentChord() const noexcept { return currentChord_; }
     const Scale& getCurrentScale() const noexcept { return currentScale_; }
     
-    // RT-safe: Get voice leading suggestions
+    // RT-safe: Key tracking (see ScaleDetector::track), advanced by every
+    // processNotes block that carries notes
+    using Timescale = ScaleDetector::Timescale;
+    using ModulationEvent = ScaleDetector::ModulationEvent;
+    const Scale& getCurrentKey() const noexcept { return scaleDetector_->getCurrentKey(); }
+    const Scale& getTrackedScale(Timescale timescale) const noexcept {
+        return scaleDetector_->getTrackedScale(timescale);
+    }
+    
+    // Lock-free: Take the oldest pending key modulation (single consumer thread)
+    bool popModulation(ModulationEvent& out) noexcept { return scaleDetector_->popModulation(out); }
+    
+    // Get voice leading suggestions (allocates the result)
     std::vector<Note> suggestVoiceLeading(
         const Chord& targetChord,
         const std::vector<Note>& currentVoices
     ) const noexcept;
     
+    // RT-safe, allocation-free: Voice targetChord from currentVoices (up to
+    // VoiceLeading::kMaxVoices). Returns false if voice leading is disabled
+    // or no voicing exists; out is then a copy of currentVoices.
+    bool suggestVoiceLeading(
+        const Chord& targetChord,
+        const VoiceLeading::Voicing& currentVoices,
+        VoiceLeading::Voicing& out
+    ) const noexcept;
+    
+    // Non-RT: Voice a whole chord sequence jointly from currentVoices (up to
+    // VoiceLeading::kMaxVoices), one voicing per chord, voice order and note
+    // fields kept. Empty if voice leading is disabled or no plan exists.
+    // Plans reuse the engine's planning scratch: one plan at a time per
+    // engine, though suggestVoiceLeading may run alongside it.
+    std::vector<std::vector<Note>> planVoiceLeading(
+        const std::vector<Chord>& chords,
+        const std::vector<Note>& currentVoices
+    );
+    
+    // Non-RT: Analyze a whole timestamp-sorted note stream (velocity 0 = note off).
+    // Resets analysis state, then emits one frame per hopSamples from sample 0
+    // through the last note, as if processNotes were called once per hop.
+    std::vector<HarmonyFrame> analyzeTimeline(
+        const Note* notes,
+        size_t count,
+        uint64_t hopSamples
+    );
+    
+    // RT-safe: Same as above, writing into a caller-provided buffer.
+    // Returns the number of frames written (at most maxFrames).
+    size_t analyzeTimeline(
+        const Note* notes,
+        size_t count,
+        uint64_t hopSamples,
+        HarmonyFrame* outFrames,
+        size_t maxFrames
+    ) noexcept;
+    
+    // Number of frames analyzeTimeline produces for a sorted note stream
+    static size_t getTimelineFrameCount(
+        const Note* notes,
+        size_t count,
+        uint64_t hopSamples
+    ) noexcept;
+    
+    // RT-safe: Clear active notes and all analysis state
+    void reset() noexcept;
+    
     // Non-RT: Update configuration
     void updateConfig(const Config& config);
     
-    // Non-RT: Get analysis history
+    // Non-RT: Key tracking time constants and hysteresis (sampleRate is
+    // taken from the engine config)
+    void setKeyTrackingConfig(const ScaleDetector::TrackingConfig& config);
+    
+    // Non-RT: Key profiles used for scale detection (nullptr = default bank).
+    // Scale::mode is an index into this bank. Not synchronized with the
+    // audio thread: stop processNotes/processAudio (and getKeyProfileBank
+    // readers) first. The old bank is released on the calling thread unless
+    // the caller still holds it.
+    void setKeyProfileBank(std::shared_ptr<const KeyProfileBank> profiles);
+    const KeyProfileBank& getKeyProfileBank() const noexcept { return scaleDetector_->getProfileBank(); }
+    
+    // Non-RT: Get analysis history (oldest first, at most kHistoryCapacity).
+    // Safe to call from any thread while the audio thread runs processNotes.
     std::vector<Chord> getChordHistory(size_t maxCount = 100) const;
     std::vector<Scale> getScaleHistory(size_t maxCount = 100) const;
     
+    // Lock-free, allocation-free: Copy the newest history entries into out
+    // (oldest first). Returns the number of entries written.
+    size_t getChordHistory(ChordEvent* out, size_t maxCount) const noexcept {
+        return chordHistory_->snapshot(out, maxCount);
+    }
+    size_t getScaleHistory(ScaleEvent* out, size_t maxCount) const noexcept {
+        return scaleHistory_->snapshot(out, maxCount);
+    }
+    
+    // Underlying rings (e.g. for zero-copy views of the raw slots)
+    const ChordHistory& getChordHistoryRing() const noexcept { return *chordHistory_; }
+    const ScaleHistory& getScaleHistoryRing() const noexcept { return *scaleHistory_; }
+    
 private:
     void updateChordAnalysis() noexcept;
     void updateScaleDetection() noexcept;
+    ChromaExtractor::Config chromaConfig() const noexcept;
+    std::array<float, 12> velocityHistogram() const noexcept;
+    
+    // Chord template weights: mean held velocity per pitch class; uniform is
+    // set if every sounding class has the same weight
+    std::array<float, 12> chordWeights(bool& uniform) const noexcept;
     
     Config config_;
     
     std::unique_ptr<ChordAnalyzer> chordAnalyzer_;
     std::unique_ptr<ScaleDetector> scaleDetector_;
     std::unique_ptr<VoiceLeading> voiceLeading_;
+    std::unique_ptr<ChromaExtractor> chromaExtractor_;
+    std::unique_ptr<ChordHistory> chordHistory_;
+    std::unique_ptr<ScaleHistory> scaleHistory_;
     
     Chord currentChord_;
     Scale currentScale_;
     
-    std::array<uint8_t, 128> activeNotes_; // Note velocity (0 = off)
-    std::array<bool, 12> pitchClassSet_;   // Current pitch classes
+    std::array<uint8_t, 128> activeNotes_;      // Note velocity (0 = off)
+    std::array<uint64_t, 2> activePitchBits_;   // Bit p = pitch p sounding
+    std::array<uint8_t, 12> pitchClassCounts_;  // Active notes per pitch class
+    std::array<uint16_t, 12> velocitySums_;     // Sum of active velocities per pitch class
+    PitchClassSet pitchClassSet_;               // Current pitch classes (count > 0)
+    uint64_t lastTimestamp_;                    // Timestamp of the latest note seen
+    bool analysisValid_;                        // False until first analysis after reset
+    bool harmonyChanged_;
 };
 
 } // namespace penta::harmony
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace penta::harmony {
+
+/**
+ * Runtime bank of key profiles for ScaleDetector
+ *
+ * A profile is the expected weight of the 12 scale degrees above a tonic.
+ * The bank compiles every (profile, tonic) pair into one mean-centered,
+ * unit-norm row of a column-major (SoA) matrix, so correlating a histogram
+ * against every profile in every key is a single 12 x rows matrix-vector
+ * product no matter how many profiles are loaded.
+ *
+ * The profile index is what ScaleDetector reports as Scale::mode. Banks are
+ * built and edited off the audio thread, then shared read-only.
+ */
+class KeyProfileBank {
+public:
+    // Scale::mode is a uint8_t profile index
+    static constexpr size_t kMaxProfiles = 256;
+    
+    struct Profile {
+        std::string name;
+        std::array<float, 12> weights;  // Scale degree 0 (tonic) through 11
+    };
+    
+    KeyProfileBank() = default;
+    
+    // Built-in banks
+    static KeyProfileBank krumhanslModes();  // Krumhansl-Kessler major/minor + church modes
+    static KeyProfileBank temperley();       // Temperley (1999) major/minor
+    static KeyProfileBank aardenEssen();     // Aarden-Essen (2003) major/minor
+    static KeyProfileBank extended();        // krumhanslModes() + addScaleLibrary()
+    
+    // Shared krumhanslModes() bank used by default, built on first call
+    static std::shared_ptr<const KeyProfileBank> defaultBank();
+    
+    // Non-RT: Append harmonic/melodic minor, major/minor pentatonic, blues,
+    // whole-tone and both octatonic scales as tonic-weighted templates
+    void addScaleLibrary();
+    
+    // Non-RT: Append a profile. Returns its index, or -1 if the bank is full.
+    int addProfile(std::string name, const std::array<float, 12>& weights);
+    
+    // Non-RT: Template profile for a set of scale degrees (tonic weighted 2,
+    // other degrees 1, non-scale tones 0)
+    int addScaleTemplate(std::string name, const std::vector<int>& degrees);
+    
+    // Non-RT: Append every profile of another bank
+    bool append(const KeyProfileBank& other);
+    
+    // Non-RT: Append user profiles from JSON:
+    //   {"profiles": [{"name": "Hijaz", "degrees": [0, 1, 4, 5, 7, 8, 10]},
+    //                 {"name": "Custom", "weights": [12 numbers]}]}
+    // A top-level array of profile objects is accepted too; unknown keys are
+    // skipped, nested at most 64 levels deep. On error nothing is added,
+    // false is returned, and error (if given) describes the problem.
+    bool loadJson(std::string_view json, std::string* error = nullptr);
+    bool loadJsonFile(const std::string& path, std::string* error = nullptr);
+    
+    // Profiles
+    size_t getNumProfiles() const noexcept { return profiles_.size(); }
+    const Profile& getProfile(size_t index) const noexcept { return profiles_[index]; }
+    int findProfile(std::string_view name) const noexcept;
+    
+    // Compiled matrix: row = tonic * getNumProfiles() + profile, so ties
+    // resolve to the lower tonic, then the earlier profile
+    size_t getNumRows() const noexcept { return rowTonics_.size(); }
+    size_t getPaddedRows() const noexcept { return paddedRows_; }  // Multiple of 8
+    const float* getColumn(int pitchClass) const noexcept {
+        return coefficients_.data() + static_cast<size_t>(pitchClass) * paddedRows_;
+    }
+    uint8_t getRowTonic(size_t row) const noexcept { return rowTonics_[row]; }
+    uint8_t getRowProfile(size_t row) const noexcept { return rowProfiles_[row]; }
+    
+private:
+    void rebuild();
+    
+    std::vector<Profile> profiles_;
+    
+    // coefficients_[pc * paddedRows_ + row]; padding rows are zero
+    std::vector<float> coefficients_;
+    std::vector<uint8_t> rowTonics_;
+    std::vector<uint8_t> rowProfiles_;
+    size_t paddedRows_ = 0;
+};
+
+} // namespace penta::harmony
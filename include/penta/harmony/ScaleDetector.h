@@ -1,25 +1,70 @@
 #pragma once
 
+#include "penta/common/RTEventQueue.h"
 #include "penta/common/RTTypes.h"
+#include "penta/harmony/KeyProfileBank.h"
 #include <array>
+#include <cstddef>
+#include <memory>
 
 namespace penta::harmony {
 
 /**
  * Real-time scale detection using Krumhansl-Schmuckler algorithm
- * Enhanced with chromatic profile correlation
+ * Enhanced with chromatic profile correlation against a pluggable
+ * KeyProfileBank (Krumhansl-Kessler major/minor and church modes by default)
  */
 class ScaleDetector {
 public:
+    // Key tracking keeps one decayed histogram per timescale
+    enum class Timescale : uint8_t { Short = 0, Medium, Long };
+    static constexpr size_t kNumTimescales = 3;
+    
+    struct TrackingConfig {
+        double sampleRate;
+        std::array<float, kNumTimescales> timeConstants;  // Seconds, per Timescale
+        float switchMargin;    // Correlation lead a new key needs over the current key
+        float minHoldSeconds;  // How long that lead must last before a modulation is reported
+        
+        TrackingConfig()
+            : sampleRate(kDefaultSampleRate)
+            , timeConstants{{2.0f, 8.0f, 30.0f}}
+            , switchMargin(0.05f)
+            , minHoldSeconds(2.0f)
+        {}
+    };
+    
+    // Key change confirmed by the Medium timescale
+    struct ModulationEvent {
+        uint64_t samplePosition;     // Where the new key first took the lead
+        uint64_t confirmedPosition;  // Where the hold time ran out
+        Scale from;
+        Scale to;
+    };
+    
+    static constexpr size_t kModulationQueueCapacity = 64;
+    using ModulationQueue = RTEventQueue<ModulationEvent, kModulationQueueCapacity>;
+    
     ScaleDetector();
+    explicit ScaleDetector(std::shared_ptr<const KeyProfileBank> profiles);
     ~ScaleDetector() = default;
     
     // RT-safe: Analyze pitch class distribution
-    Scale analyze(const std::array<bool, 12>& pitchClassSet) noexcept;
+    Scale analyze(PitchClassSet pitchClassSet) noexcept;
+    Scale analyze(const std::array<bool, 12>& pitchClassSet) noexcept {
+        return analyze(PitchClassSet::fromArray(pitchClassSet));
+    }
     
     // RT-safe: Update with weighted pitch class histogram
     void update(const std::array<float, 12>& pitchClassWeights) noexcept;
     
+    // RT-safe: Best scale for a weighted histogram (stateless, no decay)
+    Scale analyzeHistogram(const std::array<float, 12>& histogram) const noexcept;
+    
+    // Reference path: per-profile Pearson correlation with on-the-fly rotation
+    // and statistics (not used per block; kept for verifying the matrix kernel)
+    Scale analyzeHistogramExhaustive(const std::array<float, 12>& histogram) const noexcept;
+    
     // RT-safe: Get current detected scale
     const Scale& getCurrentScale() const noexcept { return currentScale_; }
     
@@ -27,30 +72,94 @@ public:
     void setConfidenceThreshold(float threshold) noexcept;
     void setDecayFactor(float factor) noexcept; // Temporal decay
     
+    // RT-safe: Clear accumulated histogram, current scale and key tracking
+    void reset() noexcept;
+    
+    // RT-safe: Advance key tracking to samplePosition. pitchClassWeights are
+    // the weights sounding from samplePosition until the next call; each
+    // timescale's histogram is their exact exponential moving average over
+    // time. May push a ModulationEvent.
+    void track(const std::array<float, 12>& pitchClassWeights, uint64_t samplePosition) noexcept;
+    
+    // RT-safe: Best scale on one timescale, and the hysteresis-filtered key
+    const Scale& getTrackedScale(Timescale timescale) const noexcept {
+        return trackedScales_[static_cast<size_t>(timescale)];
+    }
+    const Scale& getCurrentKey() const noexcept { return currentKey_; }
+    
+    // Lock-free: Take the oldest pending modulation (single consumer thread)
+    bool popModulation(ModulationEvent& out) noexcept { return modulations_->pop(out); }
+    const ModulationQueue& getModulationQueue() const noexcept { return *modulations_; }
+    
+    // Non-RT: Configure key tracking (clears tracking state)
+    void setTrackingConfig(const TrackingConfig& config);
+    const TrackingConfig& getTrackingConfig() const noexcept { return trackingConfig_; }
+    
+    // RT-safe: Clear tracked histograms and key (pending events stay queued)
+    void resetTracking() noexcept;
+    
+    // Non-RT: Replace the key-profile bank (nullptr = KeyProfileBank::defaultBank()).
+    // Scale::mode indexes into this bank. The swap is not synchronized: call
+    // only while no other thread uses the detector.
+    void setProfileBank(std::shared_ptr<const KeyProfileBank> profiles);
+    const KeyProfileBank& getProfileBank() const noexcept { return *profiles_; }
+    
 private:
-    struct ScaleProfile {
-        std::array<float, 12> weights;
-        uint8_t mode;
-        const char* name;
-    };
+    // Best row of the bank's correlation matrix: dot(histogram, row) for every
+    // (profile, tonic) row, keeping the first row that beats the running best
+    // by more than tieSlack. Returns the row; bestScore receives its dot product.
+    static size_t findBestRow(
+        const KeyProfileBank& bank,
+        const std::array<float, 12>& histogram,
+        float tieSlack,
+        float& bestScore
+    ) noexcept;
+    static size_t findBestRowSIMD(
+        const KeyProfileBank& bank,
+        const std::array<float, 12>& histogram,
+        float tieSlack,
+        float& bestScore
+    ) noexcept;
     
-    float correlateWithProfile(
+    static float correlateWithProfile(
         const std::array<float, 12>& histogram,
-        const ScaleProfile& profile,
+        const KeyProfileBank::Profile& profile,
         uint8_t tonic
-    ) const noexcept;
+    ) noexcept;
     
-    void findBestScale(
+    // Returns the winning matrix row
+    size_t findBestScale(
         const std::array<float, 12>& histogram,
         Scale& outScale
-    ) noexcept;
+    ) const noexcept;
+    
+    // Pearson correlation of histogram with one matrix row
+    float correlateWithRow(const std::array<float, 12>& histogram, size_t row) const noexcept;
     
-    static const std::array<ScaleProfile, 7> kMajorMinorProfiles;
+    static float centeredNorm(const std::array<float, 12>& histogram) noexcept;
     
+    static void setScaleDegrees(const std::array<float, 12>& histogram, Scale& outScale) noexcept;
+    
+    std::shared_ptr<const KeyProfileBank> profiles_;
     Scale currentScale_;
     std::array<float, 12> pitchClassHistogram_;
     float confidenceThreshold_;
     float decayFactor_;
+    
+    // Key tracking
+    static constexpr size_t kNoRow = ~size_t{0};
+    
+    TrackingConfig trackingConfig_;
+    std::array<std::array<float, 12>, kNumTimescales> trackedHistograms_;
+    std::array<Scale, kNumTimescales> trackedScales_;
+    std::array<float, 12> heldWeights_;  // Weights since the last track() call
+    uint64_t trackedPosition_;
+    bool trackingStarted_;
+    Scale currentKey_;
+    size_t currentKeyRow_;               // kNoRow until a key is established
+    size_t pendingRow_;                  // Challenger holding a lead, or kNoRow
+    uint64_t pendingSince_;
+    std::unique_ptr<ModulationQueue> modulations_;
 };
 
 } // namespace penta::harmony
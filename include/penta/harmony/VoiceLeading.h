@@ -1,6 +1,10 @@
 #pragma once
 
 #include "penta/common/RTTypes.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <vector>
 
 namespace penta::harmony {
@@ -8,27 +12,112 @@ namespace penta::harmony {
 /**
  * Voice leading optimizer using minimal motion principles
  * Implements smooth voice transitions between chords
+ *
+ * The solver assigns every source voice a target pitch (a chord tone within
+ * an octave of where it is) by depth-first branch-and-bound over calculateCost:
+ * candidates are tried nearest-first, and a branch is cut as soon as its
+ * partial cost plus a lower bound for the unassigned voices cannot beat the
+ * best voicing found. All search state lives in fixed-size scratch on the
+ * caller's stack. A deadline bounds the worst case in time: the clock is
+ * read every kDeadlineCheckNodes nodes (a few microseconds of search), and
+ * the best voicing found so far is returned once maxSearchMicros passed.
+ * A node budget bounds it in work, independent of timing.
+ *
+ * planProgression() voices a whole chord sequence jointly: a Viterbi pass
+ * keeps the beamWidth cheapest partial paths per chord, scoring each
+ * transition with the batched calculateCosts(). Every chord's candidates
+ * are the voicings closest to the surviving paths' last voicings, so a
+ * progression can drift as far from the starting register as it leads.
  */
 class VoiceLeading {
 public:
+    static constexpr size_t kMaxVoices = 8;
+    
+    // Each voice may move at most an octave; that is also the search window
+    static constexpr int kMaxSearchRadius = 12;
+    static constexpr size_t kMaxCandidatesPerVoice = 2 * kMaxSearchRadius + 1;
+    
+    // Nodes searched between reads of the clock for maxSearchMicros
+    static constexpr uint32_t kDeadlineCheckNodes = 64;
+    
+    // Progression planning: each voice moves at most kPlanRadius semitones
+    // per chord, and the search for a path state's closest voicings visits
+    // at most kMaxPlanNodes partial voicings
+    static constexpr int kPlanRadius = 4;
+    static constexpr size_t kMaxPlanNodes = 8192;
+    
     struct Config {
         float maxVoiceDistance;  // Max semitones to move
         float parallelPenalty;    // Penalty for parallel motion
         float contraryBonus;      // Bonus for contrary motion
         bool allowVoiceCrossing;
+        uint32_t maxSearchNodes;  // Solver budget; best voicing so far is returned when hit
+        uint32_t maxSearchMicros; // Solver deadline, likewise; 0 = none (timing-independent results)
+        uint32_t beamWidth;          // Partial paths kept per chord by planProgression
+        uint32_t maxPlanCandidates;  // Candidate voicings per chord by planProgression, shared by the beam
         
         Config()
             : maxVoiceDistance(12.0f)
             , parallelPenalty(5.0f)
             , contraryBonus(2.0f)
             , allowVoiceCrossing(false)
+            , maxSearchNodes(4096)
+            , maxSearchMicros(50)
+            , beamWidth(16)
+            , maxPlanCandidates(256)
         {}
     };
     
+    // Fixed-size voicing, voice i = pitches[i]
+    struct Voicing {
+        std::array<uint8_t, kMaxVoices> pitches{};
+        uint8_t count = 0;
+    };
+    
+    struct SearchStats {
+        uint32_t nodes = 0;       // Partial voicings visited by the last solve
+        bool exhaustive = false;  // False if the node budget or deadline cut the search short
+        bool timedOut = false;    // True if the deadline did
+    };
+    
     explicit VoiceLeading(const Config& config = Config{});
-    ~VoiceLeading() = default;
+    ~VoiceLeading();
+    
+    // RT-safe, allocation-free: Voice the target chord from `from`, one target
+    // pitch per source voice, covering as many chord tones as there are voices,
+    // never doubling a pitch and (unless allowVoiceCrossing) never crossing
+    // voices. Returns the cost of `to` (calculateCost), or
+    // +infinity with to = from if no voicing exists. Fills `stats` if given.
+    // Searches keep their state on the stack (under 2 KB), so concurrent
+    // calls on one instance are safe.
+    float solve(
+        const Voicing& from,
+        const Chord& targetChord,
+        Voicing& to,
+        SearchStats* stats = nullptr
+    ) const noexcept;
     
-    // RT-safe: Find optimal voice leading from current to target chord
+    // Non-RT: Voice a chord sequence from `start`, minimizing the summed
+    // calculateCost of every transition (start -> path[0] -> ... ->
+    // path[numChords - 1]). Each voicing keeps start's voice count, covers
+    // min(voices, chord tones) chord tones without unisons and (unless
+    // allowVoiceCrossing) without crossings, and moves no voice more than
+    // kPlanRadius from the previous one. The result is exact when no chord
+    // has more than beamWidth candidates. Returns the total cost, or
+    // +infinity with path filled with start if some chord cannot be voiced.
+    // Scratch buffers only grow, so repeated plans of similar size do not
+    // allocate. Plans share the instance's scratch, hence non-const: run one
+    // plan at a time per instance (solve() may run alongside it).
+    float planProgression(
+        const Chord* chords,
+        size_t numChords,
+        const Voicing& start,
+        Voicing* path
+    );
+    
+    // Find optimal voice leading from current to target chord. Voice order is
+    // kept; with no current voices a close root-position voicing is returned.
+    // Allocates the returned vector; use solve() on the audio thread.
     std::vector<Note> findOptimalVoicing(
         const Chord& targetChord,
         const std::vector<Note>& currentVoices,
@@ -40,32 +129,64 @@ public:
         const std::vector<Note>& from,
         const std::vector<Note>& to
     ) const noexcept;
+    float calculateCost(const Voicing& from, const Voicing& to) const noexcept;
+    
+    // RT-safe: Score many candidate voicings against one source voicing,
+    // costs[k] = calculateCost(from, candidates[k]). Candidates are scored
+    // eight at a time with their pitches transposed into SIMD lanes.
+    void calculateCosts(
+        const Voicing& from,
+        const Voicing* candidates,
+        size_t count,
+        float* costs
+    ) const noexcept;
     
     // Configuration
     void updateConfig(const Config& config) noexcept;
+    const Config& getConfig() const noexcept { return config_; }
     
 private:
-    struct VoicingCandidate {
-        std::vector<Note> voices;
-        float cost;
-        
-        bool operator<(const VoicingCandidate& other) const {
-            return cost < other.cost;
-        }
-    };
-    
-    void generateVoicingCandidates(
-        const Chord& chord,
-        uint8_t octave,
-        std::vector<VoicingCandidate>& candidates
-    ) const noexcept;
+    struct SearchScratch;
+    struct PlanScratch;
     
+    // Cost terms of calculateCost: per-voice motion and per-pair interaction
     float calculateMotionCost(
         uint8_t fromPitch,
         uint8_t toPitch
     ) const noexcept;
     
+    float calculatePairCost(
+        int fromI, int fromJ,
+        int toI, int toJ
+    ) const noexcept;
+    
+    // Batched cost kernels (AVX2 when available, scalar fallback otherwise)
+    void calculateCostsScalar(
+        const Voicing& from,
+        const Voicing* candidates,
+        size_t count,
+        float* costs
+    ) const noexcept;
+    void calculateCostsSIMD(
+        const Voicing& from,
+        const Voicing* candidates,
+        size_t count,
+        float* costs
+    ) const noexcept;
+    
+    void search(SearchScratch& scratch, size_t depth, float partialCost) const noexcept;
+    
+    // Append the (at most) quota voicings of a chord closest to `anchor` to
+    // the plan candidates, closest first; returns how many were added
+    size_t enumerateVoicings(
+        PlanScratch& scratch,
+        const Voicing& anchor,
+        const Chord& chord,
+        size_t quota
+    ) const;
+    
     Config config_;
+    std::unique_ptr<PlanScratch> planScratch_;  // Grown on demand, reused
 };
 
 } // namespace penta::harmony
@@ -3,7 +3,7 @@ Penta Core Python API
 High-level Python interface to C++ engines
 """
 
-from typing import List, Optional, Tuple
+from typing import List, Optional, Tuple, Union
 import numpy as np
 
 import importlib
@@ -56,6 +56,43 @@ class HarmonyEngine:
         native_notes = [native.harmony.Note(pitch, vel) for pitch, vel in notes]
         self._engine.process_notes(native_notes)
     
+    def process_audio(self, audio: np.ndarray) -> None:
+        """
+        Analyze harmony from audio (e.g. an audio-only stem)
+        
+        Args:
+            audio: Audio buffer as numpy array (mono)
+        """
+        if audio.ndim != 1:
+            audio = audio.flatten()
+        
+        self._engine.process_audio(audio.astype(np.float32))
+    
+    def get_chroma(self) -> List[float]:
+        """Get the latest audio chroma frame (12 pitch-class weights, peak 1)"""
+        return list(self._engine.get_chroma())
+    
+    def analyze_timeline(self, notes: np.ndarray, hop_samples: int) -> np.ndarray:
+        """
+        Analyze a whole note stream in one native call
+        
+        Args:
+            notes: Array of shape (N, 3) with columns (pitch, velocity, timestamp),
+                   sorted by timestamp; velocity 0 marks a note off
+            hop_samples: Frame spacing in samples
+            
+        Returns:
+            NumPy structured array with one record per hop (sample_position,
+            chord_root, chord_quality, chord_confidence, scale_tonic, ...)
+        """
+        notes = np.asarray(notes)
+        return self._engine.analyze_timeline(
+            notes[:, 0].astype(np.uint8),
+            notes[:, 1].astype(np.uint8),
+            notes[:, 2].astype(np.uint64),
+            hop_samples
+        )
+    
     def get_current_chord(self) -> dict:
         """Get currently detected chord as dictionary"""
         chord = self._engine.get_current_chord()
@@ -63,6 +100,9 @@ class HarmonyEngine:
             'root': chord.root,
             'quality': chord.quality,
             'confidence': chord.confidence,
+            'bass': chord.bass,
+            'inversion': chord.inversion,
+            'is_slash_chord': chord.is_slash_chord,
             'pitch_classes': chord.pitch_classes,
             'name': self._chord_to_string(chord)
         }
@@ -78,6 +118,70 @@ class HarmonyEngine:
             'name': self._scale_to_string(scale)
         }
     
+    def get_current_key(self) -> dict:
+        """Get the key established by multi-timescale tracking"""
+        key = self._engine.get_current_key()
+        return {
+            'tonic': key.tonic,
+            'mode': key.mode,
+            'confidence': key.confidence,
+            'name': self._scale_to_string(key)
+        }
+    
+    def get_modulations(self) -> List[dict]:
+        """
+        Drain key modulations detected by the engine since the last call
+        
+        Returns:
+            List of dicts (oldest first) with sample_position (where the new
+            key took the lead), confirmed_position, from_key and to_key
+        """
+        return [{
+            'sample_position': event.sample_position,
+            'confirmed_position': event.confirmed_position,
+            'from_key': self._scale_to_string(event.from_scale),
+            'to_key': self._scale_to_string(event.to_scale),
+            'from_tonic': event.from_scale.tonic,
+            'to_tonic': event.to_scale.tonic,
+        } for event in self._engine.pop_modulations()]
+    
+    def set_key_profiles(self, bank=None, json_path: Optional[str] = None) -> None:
+        """
+        Choose the key profiles used for scale detection
+        
+        Call only while audio processing is stopped: the swap is not
+        synchronized with the audio thread.
+        
+        Args:
+            bank: native KeyProfileBank (default: extended built-in library)
+            json_path: Optional JSON file of user profiles appended to the bank
+        """
+        if bank is None:
+            bank = native.harmony.KeyProfileBank.extended()
+        if json_path is not None:
+            bank.load_json_file(json_path)
+        self._engine.set_key_profile_bank(bank)
+    
+    def get_chord_history(self, max_count: int = 256) -> np.ndarray:
+        """
+        Get recent chord changes without blocking the audio thread
+        
+        Returns:
+            NumPy structured array, oldest first, with fields (sample_position,
+            pitch_classes, root, quality, confidence, bass, inversion)
+        """
+        return self._engine.chord_history(max_count)
+    
+    def get_scale_history(self, max_count: int = 256) -> np.ndarray:
+        """
+        Get recent scale changes without blocking the audio thread
+        
+        Returns:
+            NumPy structured array, oldest first, with fields (sample_position,
+            degrees, tonic, mode, confidence)
+        """
+        return self._engine.scale_history(max_count)
+    
     def suggest_voice_leading(self, target_chord_root: int, 
                              current_voices: List[int]) -> List[int]:
         """
@@ -97,6 +201,22 @@ class HarmonyEngine:
         suggested = self._engine.suggest_voice_leading(target_chord, current_notes)
         return [note.pitch for note in suggested]
     
+    def plan_voice_leading(self, chords: Union[List, np.ndarray], current_voices: List[int]) -> List[List[int]]:
+        """
+        Voice a whole chord sequence in one joint solve
+        
+        Args:
+            chords: Chord objects, or the structured array returned by
+                get_chord_history
+            current_voices: List of current voice pitches
+            
+        Returns:
+            One list of voice pitches per chord (empty if no plan exists)
+        """
+        current_notes = [native.harmony.Note(pitch, 64) for pitch in current_voices]
+        plan = self._engine.plan_voice_leading(chords, current_notes)
+        return [[note.pitch for note in voicing] for voicing in plan]
+    
     @staticmethod
     def _chord_to_string(chord) -> str:
         """Convert chord to readable string"""
@@ -107,20 +227,17 @@ class HarmonyEngine:
             name = note_names[chord.root]
             if chord.quality < len(quality_names):
                 name += quality_names[chord.quality]
+            if chord.bass != chord.root and chord.bass < 12:
+                name += '/' + note_names[chord.bass]
             return name
         return "Unknown"
     
-    @staticmethod
-    def _scale_to_string(scale) -> str:
+    def _scale_to_string(self, scale) -> str:
         """Convert scale to readable string"""
         note_names = ['C', 'C#', 'D', 'D#', 'E', 'F', 'F#', 'G', 'G#', 'A', 'A#', 'B']
-        mode_names = ['Ionian', 'Dorian', 'Phrygian', 'Lydian', 'Mixolydian', 'Aeolian', 'Locrian']
         
         if scale.tonic < 12:
-            name = note_names[scale.tonic]
-            if scale.mode < len(mode_names):
-                name += ' ' + mode_names[scale.mode]
-            return name
+            return note_names[scale.tonic] + ' ' + self._engine.scale_mode_name(scale.mode)
         return "Unknown"
     
     @staticmethod
@@ -134,15 +251,22 @@ class HarmonyEngine:
 class GrooveEngine:
     """Python wrapper for C++ GrooveEngine with beat tracking"""
     
+    # Onset detection functions by name
+    ONSET_METHODS = ('spectral_flux', 'high_frequency_content', 'complex_domain',
+                     'phase_deviation', 'super_flux')
+    
     def __init__(self, sample_rate: float = 48000.0, min_tempo: float = 60.0, 
-                 max_tempo: float = 180.0):
+                 max_tempo: float = 180.0, onset_method: str = 'spectral_flux'):
         if native is None:
             raise RuntimeError("Native C++ module not available")
+        if onset_method not in self.ONSET_METHODS:
+            raise ValueError(f"Unknown onset method: {onset_method}")
         
         config = native.groove.GrooveConfig()
         config.sample_rate = sample_rate
         config.min_tempo = min_tempo
         config.max_tempo = max_tempo
+        config.onset_method = getattr(native.groove.OnsetMethod, onset_method.upper())
         
         self._engine = native.groove.GrooveEngine(config)
     
@@ -166,13 +290,17 @@ class GrooveEngine:
             'tempo_confidence': analysis.tempo_confidence,
             'time_signature': f"{analysis.time_signature_num}/{analysis.time_signature_den}",
             'swing': analysis.swing,
-            'onset_count': len(analysis.onset_positions)
+            'onset_count': self._engine.get_onset_count()
         }
     
     def quantize_timestamp(self, timestamp: int) -> int:
-        """Quantize timestamp to rhythmic grid"""
+        """Quantize timestamp to the tracked rhythmic grid"""
         return self._engine.quantize_to_grid(timestamp)
     
+    def get_beat_grid(self) -> dict:
+        """Get the tracked beat grid (tempo, bar start, sample position)"""
+        return self._engine.get_timing()
+    
     def get_tempo(self) -> float:
         """Get current tempo estimate in BPM"""
         return self._engine.get_analysis().current_tempo
@@ -291,9 +419,11 @@ class PentaCore:
             audio: Audio buffer (mono or stereo)
             midi_notes: Optional list of (pitch, velocity) tuples
         """
-        # Process MIDI for harmony
+        # Process MIDI for harmony; without MIDI, harmony comes from the audio
         if midi_notes:
             self.harmony.process_midi_notes(midi_notes)
+        else:
+            self.harmony.process_audio(audio)
         
         # Process audio for groove
         self.groove.process_audio(audio)
@@ -130,13 +130,30 @@ class ChordProgressionAnalyzer:
 
 
 class KeyModulationDetector:
-    """Detect key changes and modulations in music."""
+    """Detect key changes and modulations in music.
     
-    def __init__(self, window_size: int = 8):
+    When given a penta_core.HarmonyEngine, modulations come from the engine's
+    multi-timescale key tracker and are only collected here; add_scale() is
+    the fallback for scale dicts from other sources.
+    """
+    
+    def __init__(self, window_size: int = 8, engine=None):
         self.window_size = window_size
+        self.engine = engine
         self.scale_history: List[dict] = []
         self.modulations: List[dict] = []
     
+    def poll(self) -> List[dict]:
+        """Collect modulation events from the engine; returns the new ones."""
+        if self.engine is None:
+            return []
+        
+        events = self.engine.get_modulations()
+        for event in events:
+            event["relation"] = self._get_key_relation(event["from_tonic"], event["to_tonic"])
+        self.modulations.extend(events)
+        return events
+    
     def add_scale(self, scale: dict):
         """Add scale to history."""
         self.scale_history.append({
@@ -192,6 +209,7 @@ class KeyModulationDetector:
     
     def get_modulations(self) -> List[dict]:
         """Get detected modulations."""
+        self.poll()
         return self.modulations
 
 
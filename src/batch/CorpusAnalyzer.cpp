@@ -0,0 +1,147 @@
+#include "penta/batch/CorpusAnalyzer.h"
+#include <algorithm>
+
+namespace penta::batch {
+
+namespace {
+
+// Clears the cancel flag when a run ends, however it ends; clearing it at
+// the start instead would drop a cancel() issued just before or during startup
+class CancelReset {
+public:
+    explicit CancelReset(std::atomic<bool>& flag) noexcept : flag_(flag) {}
+    ~CancelReset() { flag_.store(false, std::memory_order_relaxed); }
+    
+    CancelReset(const CancelReset&) = delete;
+    CancelReset& operator=(const CancelReset&) = delete;
+    
+private:
+    std::atomic<bool>& flag_;
+};
+
+} // anonymous namespace
+
+CorpusAnalyzer::CorpusAnalyzer(const Config& config)
+    : config_(config)
+    , pool_(std::make_unique<WorkStealingPool>(config.numThreads))
+    , cancelled_(false)
+    , completedItems_(0)
+{
+}
+
+CorpusAnalyzer::~CorpusAnalyzer() = default;
+
+CorpusAnalyzer::HarmonyResults CorpusAnalyzer::analyzeHarmony(
+    const std::vector<NoteStream>& items,
+    const ProgressCallback& progress
+) {
+    CancelReset cancelReset(cancelled_);
+    completedItems_ = 0;
+    
+    HarmonyResults results;
+    results.completed.assign(items.size(), 0);
+    
+    // Frame counts are known up front, so every item writes straight into
+    // its slice of one contiguous buffer
+    results.offsets.resize(items.size() + 1, 0);
+    for (size_t i = 0; i < items.size(); ++i) {
+        results.offsets[i + 1] = results.offsets[i] +
+            harmony::HarmonyEngine::getTimelineFrameCount(
+                items[i].notes, items[i].count, config_.hopSamples);
+    }
+    results.frames.resize(results.offsets.back());
+    
+    pool_->parallelFor(items.size(), [&](size_t item, size_t) {
+        if (cancelled_.load(std::memory_order_relaxed)) {
+            return;
+        }
+        
+        harmony::HarmonyEngine engine(config_.harmonyConfig);
+        size_t begin = results.offsets[item];
+        engine.analyzeTimeline(
+            items[item].notes, items[item].count, config_.hopSamples,
+            results.frames.data() + begin, results.offsets[item + 1] - begin);
+        
+        results.completed[item] = 1;
+        reportProgress(progress, items.size());
+    });
+    
+    results.cancelled = std::find(results.completed.begin(), results.completed.end(), 0) !=
+                        results.completed.end();
+    return results;
+}
+
+CorpusAnalyzer::GrooveResults CorpusAnalyzer::analyzeGroove(
+    const std::vector<AudioStream>& items,
+    const ProgressCallback& progress
+) {
+    CancelReset cancelReset(cancelled_);
+    completedItems_ = 0;
+    
+    GrooveResults results;
+    results.summaries.assign(items.size(), GrooveSummary{});
+    results.completed.assign(items.size(), 0);
+    
+    // Onset counts are only known after analysis: keep per-item lists, then gather
+    std::vector<std::vector<uint64_t>> positions(items.size());
+    std::vector<std::vector<float>> strengths(items.size());
+    
+    const size_t hopSize = std::max<size_t>(1, config_.grooveConfig.hopSize);
+    
+    pool_->parallelFor(items.size(), [&](size_t item, size_t) {
+        if (cancelled_.load(std::memory_order_relaxed)) {
+            return;
+        }
+        
+        groove::GrooveEngine engine(config_.grooveConfig);
+        const auto& stream = items[item];
+        
+        // Feed hop-sized blocks, as a host would, collecting every onset:
+        // the engine only keeps the most recent ones
+        for (size_t offset = 0; offset < stream.frames; offset += hopSize) {
+            engine.processAudio(stream.samples + offset, std::min(hopSize, stream.frames - offset));
+            const size_t count = engine.getOnsetCount();
+            for (size_t i = count - engine.getBlockOnsetCount(); i < count; ++i) {
+                positions[item].push_back(engine.getOnsetPosition(i));
+                strengths[item].push_back(engine.getOnsetStrength(i));
+            }
+        }
+        
+        const auto& analysis = engine.getAnalysis();
+        results.summaries[item] = GrooveSummary{
+            analysis.currentTempo,
+            analysis.tempoConfidence,
+            analysis.timeSignatureNum,
+            analysis.timeSignatureDen,
+            analysis.swing
+        };
+        
+        results.completed[item] = 1;
+        reportProgress(progress, items.size());
+    });
+    
+    results.onsetOffsets.resize(items.size() + 1, 0);
+    for (size_t i = 0; i < items.size(); ++i) {
+        results.onsetOffsets[i + 1] = results.onsetOffsets[i] + positions[i].size();
+    }
+    results.onsetPositions.reserve(results.onsetOffsets.back());
+    results.onsetStrengths.reserve(results.onsetOffsets.back());
+    for (size_t i = 0; i < items.size(); ++i) {
+        results.onsetPositions.insert(results.onsetPositions.end(), positions[i].begin(), positions[i].end());
+        results.onsetStrengths.insert(results.onsetStrengths.end(), strengths[i].begin(), strengths[i].end());
+    }
+    
+    results.cancelled = std::find(results.completed.begin(), results.completed.end(), 0) !=
+                        results.completed.end();
+    return results;
+}
+
+void CorpusAnalyzer::reportProgress(const ProgressCallback& progress, size_t total) {
+    std::lock_guard<std::mutex> lock(progressMutex_);
+    ++completedItems_;
+    if (progress) {
+        progress(completedItems_, total);
+    }
+}
+
+} // namespace penta::batch
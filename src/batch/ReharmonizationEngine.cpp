@@ -0,0 +1,158 @@
+#include "penta/batch/ReharmonizationEngine.h"
+#include "penta/harmony/ChordAnalyzer.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace penta::batch {
+
+using harmony::ChordAnalyzer;
+using harmony::VoiceLeading;
+
+namespace {
+
+constexpr size_t kCandidatesPerRoot = ChordAnalyzer::kNumTemplates;
+constexpr size_t kCandidatesPerBar = 12 * kCandidatesPerRoot;
+
+// Share of the melody fit that rewards chord tones the melody sounds, so
+// among chords that hold the whole melody the leaner ones fit better
+constexpr float kMelodyCoverageWeight = 0.25f;
+
+} // anonymous namespace
+
+ReharmonizationEngine::ReharmonizationEngine(const Config& config)
+    : config_(config)
+    , pool_(std::make_unique<WorkStealingPool>(config.numThreads))
+{
+    config_.numVoices = std::clamp<uint8_t>(config_.numVoices, 1, VoiceLeading::kMaxVoices);
+    voiceLeading_ = std::make_unique<VoiceLeading>(config_.voiceLeadingConfig);
+}
+
+ReharmonizationEngine::~ReharmonizationEngine() = default;
+
+ReharmonizationEngine::Results ReharmonizationEngine::suggest(const std::vector<Bar>& bars) {
+    Results results;
+    results.offsets.assign(bars.size() + 1, 0);
+    if (bars.empty()) {
+        return results;
+    }
+    
+    // Reference voicings of the original progression
+    std::vector<Chord> progression(bars.size());
+    std::vector<PitchClassSet> melody(bars.size());
+    for (size_t b = 0; b < bars.size(); ++b) {
+        progression[b] = bars[b].chord;
+        for (size_t i = 0; i < bars[b].melodyCount; ++i) {
+            if (bars[b].melody[i].velocity > 0) {
+                melody[b].set(bars[b].melody[i].pitch % 12);
+            }
+        }
+    }
+    
+    const VoiceLeading::Voicing start = closeVoicing(bars[0].chord);
+    std::vector<VoiceLeading::Voicing> reference(bars.size(), start);
+    voiceLeading_->planProgression(progression.data(), progression.size(), start, reference.data());
+    
+    // Score every template at every root; item (bar, root) owns its slots
+    std::vector<Suggestion> candidates(bars.size() * kCandidatesPerBar);
+    
+    pool_->parallelFor(bars.size() * 12, [&](size_t item, size_t) {
+        const size_t bar = item / 12;
+        const auto root = static_cast<uint8_t>(item % 12);
+        const VoiceLeading& voiceLeading = *voiceLeading_;
+        const VoiceLeading::Voicing& previous = reference[bar > 0 ? bar - 1 : 0];
+        
+        for (size_t t = 0; t < kCandidatesPerRoot; ++t) {
+            Suggestion& out = candidates[bar * kCandidatesPerBar + root * kCandidatesPerRoot + t];
+            out.chord = ChordAnalyzer::templateChord(t, root);
+            out.templateIndex = static_cast<uint8_t>(t);
+            
+            // Melody fit: the sounding texture still reads as this chord,
+            // and the melody sounds as many of its tones as possible
+            const PitchClassSet tones = out.chord.pitchClass;
+            const float coverage = melody[bar].empty()
+                ? 1.0f
+                : static_cast<float>((tones & melody[bar]).count()) / static_cast<float>(tones.count());
+            out.chord.confidence = ChordAnalyzer::templateConfidence(tones | melody[bar], t, root)
+                * (1.0f - kMelodyCoverageWeight * (1.0f - coverage));
+            
+            // A candidate that cannot be voiced from the previous bar, or
+            // cannot lead on to the next bar's chord, is never suggested.
+            // The first bar has no previous chord: it is voiced from its own
+            // reference voicing without charging for the move
+            const float incoming = voiceLeading.solve(previous, out.chord, out.voicing);
+            float outgoing = 0.0f;
+            if (std::isfinite(incoming) && bar + 1 < bars.size() && !bars[bar + 1].chord.pitchClass.empty()) {
+                VoiceLeading::Voicing next;
+                outgoing = voiceLeading.solve(out.voicing, bars[bar + 1].chord, next);
+            }
+            if (!std::isfinite(incoming) || !std::isfinite(outgoing)) {
+                out.voiceLeadingCost = std::numeric_limits<float>::infinity();
+                out.score = -std::numeric_limits<float>::infinity();
+                continue;
+            }
+            
+            const float cost = (bar == 0 ? 0.0f : incoming) + outgoing;
+            out.voiceLeadingCost = cost;
+            out.score = out.chord.confidence - config_.voiceLeadingWeight * cost;
+        }
+    });
+    
+    // Rank per bar after the join: best score, then lower root, then lower
+    // template (candidate order), so scheduling cannot change the result
+    std::vector<uint32_t> order(kCandidatesPerBar);
+    results.suggestions.reserve(bars.size() * config_.topK);
+    
+    for (size_t bar = 0; bar < bars.size(); ++bar) {
+        const Suggestion* barCandidates = candidates.data() + bar * kCandidatesPerBar;
+        for (size_t i = 0; i < order.size(); ++i) {
+            order[i] = static_cast<uint32_t>(i);
+        }
+        std::stable_sort(order.begin(), order.end(), [barCandidates](uint32_t a, uint32_t b) {
+            return barCandidates[a].score > barCandidates[b].score;
+        });
+        
+        size_t taken = 0;
+        for (size_t i = 0; i < order.size() && taken < config_.topK; ++i) {
+            const Suggestion& candidate = barCandidates[order[i]];
+            if (!std::isfinite(candidate.score)) {
+                break;  // Infeasible candidates rank last
+            }
+            if (candidate.chord.pitchClass == bars[bar].chord.pitchClass) {
+                continue;  // The current chord is not an alternative
+            }
+            
+            const auto begin = results.suggestions.begin() + static_cast<std::ptrdiff_t>(results.offsets[bar]);
+            const bool duplicate = std::any_of(begin, results.suggestions.end(), [&candidate](const Suggestion& s) {
+                return s.chord.pitchClass == candidate.chord.pitchClass;
+            });
+            if (duplicate) {
+                continue;  // Same pitch classes under another root or name
+            }
+            
+            results.suggestions.push_back(candidate);
+            ++taken;
+        }
+        results.offsets[bar + 1] = results.suggestions.size();
+    }
+    
+    return results;
+}
+
+VoiceLeading::Voicing ReharmonizationEngine::closeVoicing(const Chord& chord) const noexcept {
+    VoiceLeading::Voicing voicing;
+    voicing.count = config_.numVoices;
+    
+    int pitch = config_.lowestPitch;
+    for (size_t v = 0; v < voicing.count; ++v) {
+        // Next chord tone at or above pitch (any pitch for an empty chord)
+        while (!chord.pitchClass.empty() && !chord.pitchClass.contains(pitch % 12)) {
+            ++pitch;
+        }
+        voicing.pitches[v] = static_cast<uint8_t>(std::min(pitch, 127));
+        ++pitch;
+    }
+    return voicing;
+}
+
+} // namespace penta::batch
@@ -0,0 +1,144 @@
+#include "penta/batch/WorkStealingPool.h"
+#include <algorithm>
+#include <utility>
+
+namespace penta::batch {
+
+WorkStealingPool::WorkStealingPool(size_t numThreads)
+    : body_(nullptr)
+    , generation_(0)
+    , activeWorkers_(0)
+    , stopping_(false)
+{
+    if (numThreads == 0) {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    
+    queues_.reserve(numThreads);
+    for (size_t i = 0; i < numThreads; ++i) {
+        queues_.push_back(std::make_unique<WorkerQueue>());
+    }
+    
+    workers_.reserve(numThreads);
+    for (size_t i = 0; i < numThreads; ++i) {
+        workers_.emplace_back(&WorkStealingPool::workerLoop, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(stateMutex_);
+        stopping_ = true;
+    }
+    wakeWorkers_.notify_all();
+    
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+void WorkStealingPool::parallelFor(size_t count, const Body& body) {
+    if (count == 0) {
+        return;
+    }
+    
+    std::lock_guard<std::mutex> jobLock(jobMutex_);
+    
+    // Deal contiguous index ranges so neighbouring items start on the same worker
+    const size_t numWorkers = queues_.size();
+    for (size_t w = 0; w < numWorkers; ++w) {
+        size_t begin = count * w / numWorkers;
+        size_t end = count * (w + 1) / numWorkers;
+        
+        std::lock_guard<std::mutex> lock(queues_[w]->mutex);
+        for (size_t i = begin; i < end; ++i) {
+            queues_[w]->items.push_back(i);
+        }
+    }
+    
+    std::unique_lock<std::mutex> lock(stateMutex_);
+    body_ = &body;
+    firstError_ = nullptr;
+    activeWorkers_ = numWorkers;
+    ++generation_;
+    wakeWorkers_.notify_all();
+    
+    // A worker only goes idle once no deque holds an item, so every item
+    // has run once the last worker is back to idle
+    jobDone_.wait(lock, [this] { return activeWorkers_ == 0; });
+    body_ = nullptr;
+    
+    if (firstError_) {
+        std::rethrow_exception(std::exchange(firstError_, nullptr));
+    }
+}
+
+void WorkStealingPool::workerLoop(size_t workerIndex) {
+    uint64_t seenGeneration = 0;
+    
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(stateMutex_);
+            wakeWorkers_.wait(lock, [&] { return stopping_ || generation_ != seenGeneration; });
+            if (stopping_) {
+                return;
+            }
+            seenGeneration = generation_;
+        }
+        
+        // No items are added mid-job: once every deque is empty, the rest
+        // are in flight on other workers and this one can go idle
+        size_t item = 0;
+        while (popLocal(workerIndex, item) || steal(workerIndex, item)) {
+            runItem(item, workerIndex);
+        }
+        
+        {
+            std::lock_guard<std::mutex> lock(stateMutex_);
+            if (--activeWorkers_ == 0) {
+                jobDone_.notify_all();
+            }
+        }
+    }
+}
+
+bool WorkStealingPool::popLocal(size_t workerIndex, size_t& outItem) {
+    auto& queue = *queues_[workerIndex];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.items.empty()) {
+        return false;
+    }
+    outItem = queue.items.front();
+    queue.items.pop_front();
+    return true;
+}
+
+bool WorkStealingPool::steal(size_t thiefIndex, size_t& outItem) {
+    const size_t numWorkers = queues_.size();
+    for (size_t offset = 1; offset < numWorkers; ++offset) {
+        auto& victim = *queues_[(thiefIndex + offset) % numWorkers];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.items.empty()) {
+            // Take from the far end, away from where the owner is working
+            outItem = victim.items.back();
+            victim.items.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::runItem(size_t item, size_t workerIndex) {
+    try {
+        (*body_)(item, workerIndex);
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(stateMutex_);
+        if (!firstError_) {
+            firstError_ = std::current_exception();
+        }
+    }
+}
+
+} // namespace penta::batch
@@ -0,0 +1,109 @@
+#include "penta/common/RTAllocator.h"
+#include <algorithm>
+
+namespace penta {
+
+namespace {
+
+std::vector<RTAllocator::SizeClass> defaultSizeClasses() {
+    return {
+        {16, 1024},
+        {32, 1024},
+        {64, 1024},
+        {128, 512},
+        {256, 256},
+        {512, 128},
+        {1024, 64},
+        {2048, 32},
+        {4096, 16},
+    };
+}
+
+} // anonymous namespace
+
+RTAllocator::RTAllocator()
+    : RTAllocator(defaultSizeClasses())
+{
+}
+
+RTAllocator::RTAllocator(const std::vector<SizeClass>& sizeClasses) {
+    pools_.reserve(sizeClasses.size());
+    for (const auto& sizeClass : sizeClasses) {
+        pools_.push_back(std::make_unique<RTMemoryPool>(
+            sizeClass.blockSize, sizeClass.numBlocks, sizeClass.numThreadCaches));
+    }
+    
+    std::sort(pools_.begin(), pools_.end(), [](const auto& a, const auto& b) {
+        return a->getBlockSize() < b->getBlockSize();
+    });
+}
+
+RTAllocator::~RTAllocator() = default;
+
+RTMemoryPool* RTAllocator::findPool(size_t size, size_t alignment) noexcept {
+    for (auto& pool : pools_) {
+        if (pool->getBlockSize() >= size && pool->getBlockAlignment() >= alignment) {
+            return pool.get();
+        }
+    }
+    return nullptr;
+}
+
+void* RTAllocator::allocate(size_t size, size_t alignment) noexcept {
+    RTMemoryPool* pool = findPool(size, alignment);
+    return pool ? pool->allocate() : nullptr;
+}
+
+void RTAllocator::deallocate(void* ptr, size_t size) noexcept {
+    if (!ptr) return;
+    
+    // Smallest fitting class first; larger classes only hold this size
+    // if the request had stricter alignment
+    for (auto& pool : pools_) {
+        if (pool->getBlockSize() >= size && pool->owns(ptr)) {
+            pool->deallocate(ptr);
+            return;
+        }
+    }
+}
+
+void RTAllocator::deallocate(void* ptr) noexcept {
+    deallocate(ptr, 0);
+}
+
+bool RTAllocator::owns(const void* ptr) const noexcept {
+    return std::any_of(pools_.begin(), pools_.end(),
+        [ptr](const auto& pool) { return pool->owns(ptr); });
+}
+
+size_t RTAllocator::getMaxBlockSize() const noexcept {
+    return pools_.empty() ? 0 : pools_.back()->getBlockSize();
+}
+
+RTMemoryResource::RTMemoryResource(RTAllocator& allocator, std::pmr::memory_resource* upstream) noexcept
+    : allocator_(allocator)
+    , upstream_(upstream ? upstream : std::pmr::null_memory_resource())
+{
+}
+
+void* RTMemoryResource::do_allocate(size_t bytes, size_t alignment) {
+    if (void* ptr = allocator_.allocate(bytes, alignment)) {
+        return ptr;
+    }
+    return upstream_->allocate(bytes, alignment);
+}
+
+void RTMemoryResource::do_deallocate(void* ptr, size_t bytes, size_t alignment) {
+    if (allocator_.owns(ptr)) {
+        allocator_.deallocate(ptr, bytes);
+    } else {
+        upstream_->deallocate(ptr, bytes, alignment);
+    }
+}
+
+bool RTMemoryResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    auto* rt = dynamic_cast<const RTMemoryResource*>(&other);
+    return rt && &rt->allocator_ == &allocator_;
+}
+
+} // namespace penta
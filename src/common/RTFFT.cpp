@@ -0,0 +1,146 @@
+#include "penta/common/RTFFT.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace penta {
+
+RTFFT::RTFFT(size_t size)
+    : size_(std::bit_ceil(std::max<size_t>(size, 4)))
+    , half_(size_ / 2)
+{
+    const int bits = std::countr_zero(half_);
+    bitReverse_.resize(half_);
+    for (size_t i = 0; i < half_; ++i) {
+        size_t reversed = 0;
+        for (int b = 0; b < bits; ++b) {
+            reversed |= ((i >> b) & 1u) << (bits - 1 - b);
+        }
+        bitReverse_[i] = reversed;
+    }
+    
+    // Tables are built in double precision, then rounded once
+    const double pi = 3.14159265358979323846;
+    // One table per radix-2 stage, stored back to back so a pass reads its
+    // twiddles contiguously
+    twiddleReal_.resize(std::max<size_t>(half_ - 1, 1));
+    twiddleImag_.resize(twiddleReal_.size());
+    for (size_t span = 1; span < half_; span <<= 1) {
+        for (size_t j = 0; j < span; ++j) {
+            twiddleReal_[span - 1 + j] = static_cast<float>(std::cos(pi * j / span));
+            twiddleImag_[span - 1 + j] = static_cast<float>(-std::sin(pi * j / span));
+        }
+    }
+    
+    splitCos_.resize(half_ + 1);
+    splitSin_.resize(half_ + 1);
+    for (size_t k = 0; k <= half_; ++k) {
+        splitCos_[k] = static_cast<float>(std::cos(2.0 * pi * k / size_));
+        splitSin_[k] = static_cast<float>(std::sin(2.0 * pi * k / size_));
+    }
+    
+    workReal_.resize(half_);
+    workImag_.resize(half_);
+    outReal_.resize(half_ + 1);
+    outImag_.resize(half_ + 1);
+}
+
+void RTFFT::transformHalf(const float* input) noexcept {
+    // Even samples are the real part, odd samples the imaginary part
+    for (size_t n = 0; n < half_; ++n) {
+        workReal_[bitReverse_[n]] = input[2 * n];
+        workImag_[bitReverse_[n]] = input[2 * n + 1];
+    }
+    
+    // Decimation in time. An odd stage count starts with a twiddle-free
+    // radix-2 stage so the rest pair up into radix-4 passes.
+    size_t span = 1;
+    if (std::countr_zero(half_) % 2 != 0) {
+        float* re = workReal_.data();
+        float* im = workImag_.data();
+        for (size_t a = 0; a < half_; a += 2) {
+            const float br = re[a + 1];
+            const float bi = im[a + 1];
+            re[a + 1] = re[a] - br;
+            im[a + 1] = im[a] - bi;
+            re[a] += br;
+            im[a] += bi;
+        }
+        span = 2;
+    }
+    for (; span < half_; span <<= 2) {
+        radix4Pass(span);
+    }
+}
+
+void RTFFT::radix4PassScalar(size_t span) noexcept {
+    float* re = workReal_.data();
+    float* im = workImag_.data();
+    const float* w1r = twiddleReal_.data() + span - 1;      // Stage of span
+    const float* w1i = twiddleImag_.data() + span - 1;
+    const float* w2r = twiddleReal_.data() + 2 * span - 1;  // Stage of 2 * span
+    const float* w2i = twiddleImag_.data() + 2 * span - 1;
+    
+    for (size_t start = 0; start < half_; start += 4 * span) {
+        for (size_t j = 0; j < span; ++j) {
+            const size_t a0 = start + j;
+            const size_t a1 = a0 + span;
+            const size_t a2 = a1 + span;
+            const size_t a3 = a2 + span;
+            
+            // First stage: (a0, a1) and (a2, a3) with W_2span^j
+            float tr = w1r[j] * re[a1] - w1i[j] * im[a1];
+            float ti = w1r[j] * im[a1] + w1i[j] * re[a1];
+            const float y0r = re[a0] + tr, y0i = im[a0] + ti;
+            const float y1r = re[a0] - tr, y1i = im[a0] - ti;
+            tr = w1r[j] * re[a3] - w1i[j] * im[a3];
+            ti = w1r[j] * im[a3] + w1i[j] * re[a3];
+            const float y2r = re[a2] + tr, y2i = im[a2] + ti;
+            const float y3r = re[a2] - tr, y3i = im[a2] - ti;
+            
+            // Second stage: (a0, a2) with W_4span^j, (a1, a3) with
+            // W_4span^(j + span) = -i W_4span^j
+            tr = w2r[j] * y2r - w2i[j] * y2i;
+            ti = w2r[j] * y2i + w2i[j] * y2r;
+            re[a0] = y0r + tr;
+            im[a0] = y0i + ti;
+            re[a2] = y0r - tr;
+            im[a2] = y0i - ti;
+            const float ur = w2r[j] * y3r - w2i[j] * y3i;
+            const float ui = w2r[j] * y3i + w2i[j] * y3r;
+            re[a1] = y1r + ui;
+            im[a1] = y1i - ur;
+            re[a3] = y1r - ui;
+            im[a3] = y1i + ur;
+        }
+    }
+}
+
+void RTFFT::forward(const float* input, float* real, float* imag) noexcept {
+    transformHalf(input);
+    
+    // Split Z into the spectra of the even (E) and odd (O) samples, then
+    // X[k] = E[k] + W_N^k O[k]
+    for (size_t k = 0; k <= half_; ++k) {
+        const size_t i = k % half_;
+        const size_t m = (half_ - k) % half_;
+        const float evenReal = 0.5f * (workReal_[i] + workReal_[m]);
+        const float evenImag = 0.5f * (workImag_[i] - workImag_[m]);
+        const float oddReal = 0.5f * (workImag_[i] + workImag_[m]);
+        const float oddImag = -0.5f * (workReal_[i] - workReal_[m]);
+        
+        const float c = splitCos_[k];
+        const float s = splitSin_[k];
+        real[k] = evenReal + c * oddReal + s * oddImag;
+        imag[k] = evenImag + c * oddImag - s * oddReal;
+    }
+}
+
+void RTFFT::magnitudes(const float* input, float* magnitude) noexcept {
+    forward(input, outReal_.data(), outImag_.data());
+    for (size_t k = 0; k <= half_; ++k) {
+        magnitude[k] = std::sqrt(outReal_[k] * outReal_[k] + outImag_[k] * outImag_[k]);
+    }
+}
+
+} // namespace penta
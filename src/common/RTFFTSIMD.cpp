@@ -0,0 +1,106 @@
+#include "penta/common/RTFFT.h"
+
+// SIMD intrinsics
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace penta {
+
+#ifdef __AVX2__
+
+namespace {
+
+// (ar + i ai)(br + i bi) for 8 lanes
+inline void complexMultiply(__m256 ar, __m256 ai, __m256 br, __m256 bi,
+                            __m256& outReal, __m256& outImag) noexcept {
+#ifdef __FMA__
+    outReal = _mm256_fmsub_ps(ar, br, _mm256_mul_ps(ai, bi));
+    outImag = _mm256_fmadd_ps(ar, bi, _mm256_mul_ps(ai, br));
+#else
+    outReal = _mm256_sub_ps(_mm256_mul_ps(ar, br), _mm256_mul_ps(ai, bi));
+    outImag = _mm256_add_ps(_mm256_mul_ps(ar, bi), _mm256_mul_ps(ai, br));
+#endif
+}
+
+} // anonymous namespace
+
+// AVX2 radix-4 pass: the SoA layout puts 8 consecutive butterflies of a
+// group in one register per leg, and each stage's twiddles are contiguous,
+// so every load is a plain unaligned vector load. Spans below 8 are too
+// short to fill a register and take the scalar pass.
+void RTFFT::radix4Pass(size_t span) noexcept {
+    if (span < 8) {
+        radix4PassScalar(span);
+        return;
+    }
+    
+    float* re = workReal_.data();
+    float* im = workImag_.data();
+    const float* w1r = twiddleReal_.data() + span - 1;
+    const float* w1i = twiddleImag_.data() + span - 1;
+    const float* w2r = twiddleReal_.data() + 2 * span - 1;
+    const float* w2i = twiddleImag_.data() + 2 * span - 1;
+    
+    for (size_t start = 0; start < half_; start += 4 * span) {
+        for (size_t j = 0; j < span; j += 8) {
+            float* r0 = re + start + j;
+            float* i0 = im + start + j;
+            float* r1 = r0 + span;
+            float* i1 = i0 + span;
+            float* r2 = r1 + span;
+            float* i2 = i1 + span;
+            float* r3 = r2 + span;
+            float* i3 = i2 + span;
+            
+            const __m256 w1Real = _mm256_loadu_ps(w1r + j);
+            const __m256 w1Imag = _mm256_loadu_ps(w1i + j);
+            const __m256 w2Real = _mm256_loadu_ps(w2r + j);
+            const __m256 w2Imag = _mm256_loadu_ps(w2i + j);
+            
+            // First stage: (a0, a1) and (a2, a3) with W_2span^j
+            __m256 tr, ti;
+            const __m256 x0r = _mm256_loadu_ps(r0);
+            const __m256 x0i = _mm256_loadu_ps(i0);
+            complexMultiply(w1Real, w1Imag, _mm256_loadu_ps(r1), _mm256_loadu_ps(i1), tr, ti);
+            const __m256 y0r = _mm256_add_ps(x0r, tr);
+            const __m256 y0i = _mm256_add_ps(x0i, ti);
+            const __m256 y1r = _mm256_sub_ps(x0r, tr);
+            const __m256 y1i = _mm256_sub_ps(x0i, ti);
+            
+            const __m256 x2r = _mm256_loadu_ps(r2);
+            const __m256 x2i = _mm256_loadu_ps(i2);
+            complexMultiply(w1Real, w1Imag, _mm256_loadu_ps(r3), _mm256_loadu_ps(i3), tr, ti);
+            const __m256 y2r = _mm256_add_ps(x2r, tr);
+            const __m256 y2i = _mm256_add_ps(x2i, ti);
+            const __m256 y3r = _mm256_sub_ps(x2r, tr);
+            const __m256 y3i = _mm256_sub_ps(x2i, ti);
+            
+            // Second stage: (a0, a2) with W_4span^j, (a1, a3) with -i W_4span^j
+            complexMultiply(w2Real, w2Imag, y2r, y2i, tr, ti);
+            _mm256_storeu_ps(r0, _mm256_add_ps(y0r, tr));
+            _mm256_storeu_ps(i0, _mm256_add_ps(y0i, ti));
+            _mm256_storeu_ps(r2, _mm256_sub_ps(y0r, tr));
+            _mm256_storeu_ps(i2, _mm256_sub_ps(y0i, ti));
+            
+            complexMultiply(w2Real, w2Imag, y3r, y3i, tr, ti);
+            _mm256_storeu_ps(r1, _mm256_add_ps(y1r, ti));
+            _mm256_storeu_ps(i1, _mm256_sub_ps(y1i, tr));
+            _mm256_storeu_ps(r3, _mm256_sub_ps(y1r, ti));
+            _mm256_storeu_ps(i3, _mm256_add_ps(y1i, tr));
+        }
+    }
+}
+
+#endif // __AVX2__
+
+// Scalar fallback when AVX2 not available
+#ifndef __AVX2__
+
+void RTFFT::radix4Pass(size_t span) noexcept {
+    radix4PassScalar(span);
+}
+
+#endif // __AVX2__
+
+} // namespace penta
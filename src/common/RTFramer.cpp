@@ -0,0 +1,80 @@
+#include "penta/common/RTFramer.h"
+#include <algorithm>
+#include <cstring>
+
+namespace penta {
+
+RTFramer::RTFramer(size_t frameSize, size_t hopSize, size_t maxPendingFrames)
+    : frameSize_(std::max<size_t>(frameSize, 1))
+    , hopSize_(std::clamp<size_t>(hopSize, 1, frameSize_))
+    , maxPendingFrames_(std::max<size_t>(maxPendingFrames, 1))
+    , samplesWritten_(0)
+    , nextFrameEnd_(0)
+    , droppedFrames_(0)
+{
+    // Room for the oldest pending frame plus the hops queued behind it
+    ring_.resize(frameSize_ + maxPendingFrames_ * hopSize_);
+    reset();
+}
+
+void RTFramer::push(const float* samples, size_t count) noexcept {
+    const size_t capacity = ring_.size();
+    if (count > capacity) {
+        samples += count - capacity;
+        samplesWritten_ += count - capacity;
+        count = capacity;
+    }
+    
+    const size_t writeIndex = static_cast<size_t>(samplesWritten_ % capacity);
+    const size_t first = std::min(count, capacity - writeIndex);
+    std::memcpy(ring_.data() + writeIndex, samples, first * sizeof(float));
+    std::memcpy(ring_.data(), samples + first, (count - first) * sizeof(float));
+    samplesWritten_ += count;
+    
+    const size_t pending = getPendingFrames();
+    if (pending > maxPendingFrames_) {
+        const size_t excess = pending - maxPendingFrames_;
+        nextFrameEnd_ += excess * hopSize_;
+        droppedFrames_ += excess;
+    }
+}
+
+bool RTFramer::pop(float* frame, uint64_t& frameEnd) noexcept {
+    if (nextFrameEnd_ > samplesWritten_) {
+        return false;
+    }
+    
+    // Leading samples from before the first push read as silence
+    size_t offset = 0;
+    if (nextFrameEnd_ < frameSize_) {
+        offset = static_cast<size_t>(frameSize_ - nextFrameEnd_);
+        std::fill(frame, frame + offset, 0.0f);
+    }
+    
+    const size_t capacity = ring_.size();
+    const size_t count = frameSize_ - offset;
+    const size_t readIndex = static_cast<size_t>((nextFrameEnd_ - count) % capacity);
+    const size_t first = std::min(count, capacity - readIndex);
+    std::memcpy(frame + offset, ring_.data() + readIndex, first * sizeof(float));
+    std::memcpy(frame + offset + first, ring_.data(), (count - first) * sizeof(float));
+    
+    frameEnd = nextFrameEnd_;
+    nextFrameEnd_ += hopSize_;
+    return true;
+}
+
+size_t RTFramer::getPendingFrames() const noexcept {
+    if (nextFrameEnd_ > samplesWritten_) {
+        return 0;
+    }
+    return static_cast<size_t>((samplesWritten_ - nextFrameEnd_) / hopSize_) + 1;
+}
+
+void RTFramer::reset() noexcept {
+    std::fill(ring_.begin(), ring_.end(), 0.0f);
+    samplesWritten_ = 0;
+    nextFrameEnd_ = hopSize_;
+    droppedFrames_ = 0;
+}
+
+} // namespace penta
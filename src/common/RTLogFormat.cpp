@@ -0,0 +1,225 @@
+#include "penta/common/RTLogFormat.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+namespace penta {
+
+namespace {
+
+constexpr char kFormatTag = 'F';
+constexpr char kTextTag = 'T';
+constexpr char kMessageTag = 'M';
+
+template<typename T>
+void writeRaw(std::ostream& out, T value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename T>
+bool readRaw(std::istream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+bool isFlagChar(char c) noexcept {
+    return std::strchr("-+ #0123456789.", c) != nullptr;
+}
+
+bool isLengthModifier(char c) noexcept {
+    return std::strchr("hlLqjzt", c) != nullptr;
+}
+
+int64_t asSigned(LogArgType type, uint64_t bits) noexcept {
+    if (type == LogArgType::Double) return static_cast<int64_t>(std::bit_cast<double>(bits));
+    return static_cast<int64_t>(bits);
+}
+
+double asDouble(LogArgType type, uint64_t bits) noexcept {
+    switch (type) {
+        case LogArgType::Double: return std::bit_cast<double>(bits);
+        case LogArgType::Int:    return static_cast<double>(static_cast<int64_t>(bits));
+        default:                 return static_cast<double>(bits);
+    }
+}
+
+// Format a single conversion; spec is "%[flags][width][.precision]"
+void appendConversion(std::string& out, std::string spec, char conversion,
+                      LogArgType type, uint64_t bits) {
+    char buffer[128];
+    int written = 0;
+    
+    switch (conversion) {
+        case 'd': case 'i':
+            spec += "lld";
+            written = std::snprintf(buffer, sizeof(buffer), spec.c_str(),
+                                    static_cast<long long>(asSigned(type, bits)));
+            break;
+        case 'u': case 'o': case 'x': case 'X':
+            spec += "ll";
+            spec += conversion;
+            written = std::snprintf(buffer, sizeof(buffer), spec.c_str(),
+                                    static_cast<unsigned long long>(asSigned(type, bits)));
+            break;
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+            spec += conversion;
+            written = std::snprintf(buffer, sizeof(buffer), spec.c_str(), asDouble(type, bits));
+            break;
+        case 'c':
+            spec += 'c';
+            written = std::snprintf(buffer, sizeof(buffer), spec.c_str(), static_cast<int>(bits));
+            break;
+        case 'p':
+            spec += 'p';
+            written = std::snprintf(buffer, sizeof(buffer), spec.c_str(),
+                                    reinterpret_cast<void*>(static_cast<uintptr_t>(bits)));
+            break;
+        default:
+            out += "<bad conversion>";
+            return;
+    }
+    
+    if (written > 0) {
+        out.append(buffer, std::min(static_cast<size_t>(written), sizeof(buffer) - 1));
+    }
+}
+
+} // anonymous namespace
+
+const char* logLevelString(LogLevel level) noexcept {
+    switch (level) {
+        case LogLevel::Debug:   return "DEBUG";
+        case LogLevel::Info:    return "INFO ";
+        case LogLevel::Warning: return "WARN ";
+        case LogLevel::Error:   return "ERROR";
+    }
+    return "";
+}
+
+void formatLogRecord(const LogRecord& record, std::string& out) {
+    size_t argIndex = 0;
+    
+    for (const char* p = record.format; *p; ++p) {
+        if (*p != '%') {
+            out += *p;
+            continue;
+        }
+        
+        if (p[1] == '%') {
+            out += '%';
+            ++p;
+            continue;
+        }
+        
+        std::string spec = "%";
+        ++p;
+        while (*p && isFlagChar(*p)) spec += *p++;
+        while (*p && isLengthModifier(*p)) ++p;
+        if (!*p) break;
+        
+        if (argIndex < record.argCount) {
+            appendConversion(out, spec, *p, record.types[argIndex], record.args[argIndex]);
+            ++argIndex;
+        } else {
+            out += "<missing>";
+        }
+    }
+}
+
+BinaryLogWriter::BinaryLogWriter(std::ostream& out)
+    : out_(out)
+{
+    out_.write(kMagic, sizeof(kMagic));
+    writeRaw(out_, kVersion);
+}
+
+uint32_t BinaryLogWriter::formatId(const char* format) {
+    auto it = formatIds_.find(format);
+    if (it != formatIds_.end()) {
+        return it->second;
+    }
+    
+    auto id = static_cast<uint32_t>(formatIds_.size());
+    formatIds_.emplace(format, id);
+    
+    auto length = static_cast<uint32_t>(std::strlen(format));
+    writeRaw(out_, kFormatTag);
+    writeRaw(out_, id);
+    writeRaw(out_, length);
+    out_.write(format, length);
+    return id;
+}
+
+void BinaryLogWriter::writeText(LogLevel level, const char* text) {
+    auto length = static_cast<uint16_t>(std::strlen(text));
+    writeRaw(out_, kTextTag);
+    writeRaw(out_, static_cast<uint8_t>(level));
+    writeRaw(out_, length);
+    out_.write(text, length);
+}
+
+void BinaryLogWriter::writeRecord(LogLevel level, const LogRecord& record) {
+    uint32_t id = formatId(record.format);
+    writeRaw(out_, kMessageTag);
+    writeRaw(out_, static_cast<uint8_t>(level));
+    writeRaw(out_, id);
+    writeRaw(out_, record.argCount);
+    out_.write(reinterpret_cast<const char*>(record.types.data()), record.argCount);
+    out_.write(reinterpret_cast<const char*>(record.args.data()), record.argCount * sizeof(uint64_t));
+}
+
+bool decodeBinaryLog(std::istream& in, std::ostream& out) {
+    char magic[sizeof(BinaryLogWriter::kMagic)];
+    uint32_t version = 0;
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, BinaryLogWriter::kMagic, sizeof(magic)) != 0 ||
+        !readRaw(in, version) || version != BinaryLogWriter::kVersion) {
+        return false;
+    }
+    
+    std::vector<std::string> formats;
+    std::string line;
+    char tag;
+    
+    while (readRaw(in, tag)) {
+        uint8_t level = 0;
+        line.clear();
+        
+        if (tag == kFormatTag) {
+            uint32_t id = 0;
+            uint32_t length = 0;
+            if (!readRaw(in, id) || !readRaw(in, length) || id != formats.size()) return false;
+            std::string format(length, '\0');
+            if (!in.read(format.data(), length)) return false;
+            formats.push_back(std::move(format));
+            continue;
+        } else if (tag == kTextTag) {
+            uint16_t length = 0;
+            if (!readRaw(in, level) || !readRaw(in, length)) return false;
+            std::string text(length, '\0');
+            if (!in.read(text.data(), length)) return false;
+            line = text;
+        } else if (tag == kMessageTag) {
+            uint32_t id = 0;
+            LogRecord record{};
+            if (!readRaw(in, level) || !readRaw(in, id) || !readRaw(in, record.argCount)) return false;
+            if (id >= formats.size() || record.argCount > kMaxLogArgs) return false;
+            if (!in.read(reinterpret_cast<char*>(record.types.data()), record.argCount) ||
+                !in.read(reinterpret_cast<char*>(record.args.data()), record.argCount * sizeof(uint64_t))) {
+                return false;
+            }
+            record.format = formats[id].c_str();
+            formatLogRecord(record, line);
+        } else {
+            return false;
+        }
+        
+        if (level > static_cast<uint8_t>(LogLevel::Error)) return false;
+        out << '[' << logLevelString(static_cast<LogLevel>(level)) << "] " << line << '\n';
+    }
+    
+    return in.eof();
+}
+
+} // namespace penta
@@ -1,16 +1,27 @@
 #include "penta/common/RTLogger.h"
+#include <fstream>
 #include <iostream>
 #include <cstring>
 
 namespace penta {
 
-static RTLogger* g_logger = nullptr;
-
-RTLogger::RTLogger()
+RTLogger::RTLogger(std::ostream& output)
     : writeIndex_(0)
     , readIndex_(0)
+    , wakeSequence_(0)
+    , consumerWaiting_(false)
+    , dropped_(0)
     , minLevel_(LogLevel::Info)
     , running_(false)
+    , output_(output)
+{
+    for (size_t i = 0; i < kQueueSize; ++i) {
+        messageQueue_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+RTLogger::RTLogger()
+    : RTLogger(std::cout)
 {
 }
 
@@ -18,86 +29,194 @@ RTLogger::~RTLogger() {
     stop();
 }
 
+RTLogger::LogMessage* RTLogger::claimSlot(size_t& position) noexcept {
+    // Bounded attempts keep producers wait-free
+    size_t pos = writeIndex_.load(std::memory_order_relaxed);
+    
+    for (int attempt = 0; attempt < kMaxEnqueueAttempts; ++attempt) {
+        LogMessage& slot = messageQueue_[pos & (kQueueSize - 1)];
+        size_t seq = slot.sequence.load(std::memory_order_acquire);
+        auto diff = static_cast<std::ptrdiff_t>(seq - pos);
+        
+        if (diff == 0) {
+            if (writeIndex_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                position = pos;
+                return &slot;
+            }
+        } else if (diff < 0) {
+            break;  // Queue full: consumer hasn't freed this slot yet
+        } else {
+            pos = writeIndex_.load(std::memory_order_relaxed);
+        }
+    }
+    
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+}
+
+void RTLogger::publish(LogMessage& msg, size_t position) noexcept {
+    // seq_cst: see wakeConsumer()
+    msg.sequence.store(position + 1, std::memory_order_seq_cst);
+    wakeConsumer();
+}
+
 void RTLogger::logRT(LogLevel level, const char* message) noexcept {
     if (level < minLevel_.load(std::memory_order_relaxed)) {
         return;
     }
     
-    size_t writeIdx = writeIndex_.load(std::memory_order_relaxed);
-    size_t nextIdx = (writeIdx + 1) % kQueueSize;
-    
-    // Check if queue is full
-    if (nextIdx == readIndex_.load(std::memory_order_acquire)) {
-        return;  // Drop message
-    }
+    size_t pos = 0;
+    LogMessage* msg = claimSlot(pos);
+    if (!msg) return;
     
-    auto& msg = messageQueue_[writeIdx];
-    msg.level = level;
+    msg->level = level;
+    msg->structured = false;
     
     // Copy message (RT-safe string copy)
     size_t len = 0;
     while (message[len] && len < kMaxMessageSize - 1) {
-        msg.text[len] = message[len];
+        msg->text[len] = message[len];
         ++len;
     }
-    msg.text[len] = '\0';
+    msg->text[len] = '\0';
+    
+    publish(*msg, pos);
+}
+
+void RTLogger::logRecord(LogLevel level, const LogRecord& record) noexcept {
+    size_t pos = 0;
+    LogMessage* msg = claimSlot(pos);
+    if (!msg) return;
+    
+    msg->level = level;
+    msg->structured = true;
+    msg->record.format = record.format;
+    msg->record.argCount = record.argCount;
+    for (size_t i = 0; i < record.argCount; ++i) {
+        msg->record.types[i] = record.types[i];
+        msg->record.args[i] = record.args[i];
+    }
     
-    msg.ready.store(true, std::memory_order_release);
-    writeIndex_.store(nextIdx, std::memory_order_release);
+    publish(*msg, pos);
+}
+
+void RTLogger::wakeConsumer() noexcept {
+    // Store-load pairing with processingThread (both seq_cst): either the
+    // consumer sees the published slot, or we see it waiting. Only then pay
+    // for the futex wake.
+    if (consumerWaiting_.load(std::memory_order_seq_cst)) {
+        wakeSequence_.fetch_add(1, std::memory_order_release);
+        wakeSequence_.notify_one();
+    }
 }
 
 void RTLogger::log(LogLevel level, const std::string& message) {
     logRT(level, message.c_str());
 }
 
+bool RTLogger::setBinarySink(const std::string& path) {
+    if (running_.load()) return false;
+    
+    binaryWriter_.reset();
+    binaryFile_.reset();
+    if (path.empty()) return true;
+    
+    auto file = std::make_unique<std::ofstream>(path, std::ios::binary | std::ios::trunc);
+    if (!file->is_open()) return false;
+    
+    binaryFile_ = std::move(file);
+    binaryWriter_ = std::make_unique<BinaryLogWriter>(*binaryFile_);
+    return true;
+}
+
 void RTLogger::start() {
-    running_.store(true);
+    if (running_.exchange(true)) return;
     processingThread_ = std::thread(&RTLogger::processingThread, this);
 }
 
 void RTLogger::stop() {
     running_.store(false);
+    wakeSequence_.fetch_add(1, std::memory_order_release);
+    wakeSequence_.notify_one();
     if (processingThread_.joinable()) {
         processingThread_.join();
     }
 }
 
-void RTLogger::processingThread() {
-    while (running_.load(std::memory_order_relaxed)) {
-        size_t readIdx = readIndex_.load(std::memory_order_relaxed);
-        
-        if (readIdx == writeIndex_.load(std::memory_order_acquire)) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
-            continue;
+size_t RTLogger::drainBatch(std::string& buffer) {
+    size_t count = 0;
+    
+    for (;;) {
+        LogMessage& msg = messageQueue_[readIndex_ & (kQueueSize - 1)];
+        if (msg.sequence.load(std::memory_order_acquire) != readIndex_ + 1) {
+            break;  // Empty, or the next producer is still copying
         }
         
-        auto& msg = messageQueue_[readIdx];
-        if (!msg.ready.load(std::memory_order_acquire)) {
-            continue;
+        if (binaryWriter_) {
+            if (msg.structured) {
+                binaryWriter_->writeRecord(msg.level, msg.record);
+            } else {
+                binaryWriter_->writeText(msg.level, msg.text.data());
+            }
+        } else {
+            buffer += '[';
+            buffer += logLevelString(msg.level);
+            buffer += "] ";
+            if (msg.structured) {
+                formatLogRecord(msg.record, buffer);
+            } else {
+                buffer += msg.text.data();
+            }
+            buffer += '\n';
         }
         
-        // Process message
-        const char* levelStr = "";
-        switch (msg.level) {
-            case LogLevel::Debug:   levelStr = "DEBUG"; break;
-            case LogLevel::Info:    levelStr = "INFO "; break;
-            case LogLevel::Warning: levelStr = "WARN "; break;
-            case LogLevel::Error:   levelStr = "ERROR"; break;
+        // Hand the slot to the producer one lap ahead
+        msg.sequence.store(readIndex_ + kQueueSize, std::memory_order_release);
+        ++readIndex_;
+        ++count;
+    }
+    
+    return count;
+}
+
+void RTLogger::processingThread() {
+    std::string buffer;
+    buffer.reserve(kQueueSize * 64);
+    
+    for (;;) {
+        const uint32_t wakeSeq = wakeSequence_.load(std::memory_order_acquire);
+        const bool running = running_.load(std::memory_order_acquire);
+        
+        if (drainBatch(buffer) > 0) {
+            // One buffered write and flush per batch
+            std::ostream& out = binaryFile_ ? *binaryFile_ : output_;
+            out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            out.flush();
+            buffer.clear();
+            continue;
         }
         
-        std::cout << "[" << levelStr << "] " << msg.text.data() << std::endl;
+        if (!running) break;
         
-        msg.ready.store(false, std::memory_order_release);
-        readIndex_.store((readIdx + 1) % kQueueSize, std::memory_order_release);
+        // Announce the wait, then re-check so a concurrent publish isn't lost
+        consumerWaiting_.store(true, std::memory_order_seq_cst);
+        const LogMessage& next = messageQueue_[readIndex_ & (kQueueSize - 1)];
+        if (next.sequence.load(std::memory_order_seq_cst) != readIndex_ + 1) {
+            wakeSequence_.wait(wakeSeq, std::memory_order_acquire);
+        }
+        consumerWaiting_.store(false, std::memory_order_relaxed);
     }
 }
 
 RTLogger& getLogger() {
-    if (!g_logger) {
-        g_logger = new RTLogger();
-        g_logger->start();
-    }
-    return *g_logger;
+    // Thread-safe one-time init; intentionally never destroyed so RT threads
+    // can still log during static destruction
+    static RTLogger* logger = [] {
+        auto* instance = new RTLogger();
+        instance->start();
+        return instance;
+    }();
+    return *logger;
 }
 
 } // namespace penta
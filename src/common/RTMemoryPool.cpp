@@ -1,70 +1,279 @@
 #include "penta/common/RTMemoryPool.h"
+#include <algorithm>
+#include <array>
 #include <cstring>
+#include <mutex>
 
 namespace penta {
 
-RTMemoryPool::RTMemoryPool(size_t blockSize, size_t numBlocks)
-    : blockSize_(blockSize)
-    , numBlocks_(numBlocks)
+namespace {
+
+std::atomic<uint64_t> gNextPoolId{1};
+
+// Ids of live pools that have thread caches. Guards thread-exit flushes
+// against concurrent pool destruction; never touched on the RT path.
+std::mutex& registryMutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+std::vector<uint64_t>& livePools() {
+    static std::vector<uint64_t> pools;
+    return pools;
+}
+
+bool isLive(uint64_t poolId) {
+    const auto& pools = livePools();
+    return std::find(pools.begin(), pools.end(), poolId) != pools.end();
+}
+
+} // anonymous namespace
+
+struct RTMemoryPool::ThreadCacheTable {
+    struct Entry {
+        uint64_t poolId;
+        RTMemoryPool* pool;
+        ThreadCache* cache;  // nullptr: no cache was free, use the shared list
+    };
+    
+    std::array<Entry, kMaxPoolsPerThread> entries{};
+    size_t size = 0;
+    
+    Entry* find(uint64_t poolId) noexcept {
+        for (size_t i = 0; i < size; ++i) {
+            if (entries[i].poolId == poolId) return &entries[i];
+        }
+        return nullptr;
+    }
+    
+    // Non-RT: caller holds registryMutex()
+    void evictDeadPools() {
+        size = static_cast<size_t>(std::remove_if(entries.begin(), entries.begin() + size,
+            [](const Entry& e) { return !isLive(e.poolId); }) - entries.begin());
+    }
+    
+    ~ThreadCacheTable() {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        for (size_t i = 0; i < size; ++i) {
+            if (entries[i].cache && isLive(entries[i].poolId)) {
+                entries[i].pool->releaseThreadCache(*entries[i].cache);
+            }
+        }
+    }
+};
+
+RTMemoryPool::ThreadCacheTable& RTMemoryPool::threadCacheTable() noexcept {
+    thread_local ThreadCacheTable table;
+    return table;
+}
+
+RTMemoryPool::RTMemoryPool(size_t blockSize, size_t numBlocks, size_t numThreadCaches)
+    : base_(nullptr)
+    , freeHead_(packHead(0, kNullIndex))
+    , available_(0)
+    , blockSize_(blockSize)
+    , numBlocks_(std::min<size_t>(numBlocks, kNullIndex))
+    , alignment_(0)
+    , numThreadCaches_(numThreadCaches)
+    , poolId_(gNextPoolId.fetch_add(1, std::memory_order_relaxed))
 {
     // Ensure minimum alignment
     constexpr size_t kAlignment = alignof(std::max_align_t);
-    blockSize_ = (blockSize + kAlignment - 1) & ~(kAlignment - 1);
+    blockSize_ = std::max(kAlignment, (blockSize + kAlignment - 1) & ~(kAlignment - 1));
     
-    // Allocate memory for all blocks
-    memory_.resize(blockSize_ * numBlocks_);
+    // Largest power of two dividing the block size, capped at kMaxAlignment
+    alignment_ = std::min(blockSize_ & (~blockSize_ + 1), kMaxAlignment);
     
-    // Build free list
-    Block* head = nullptr;
+    // Allocate memory for all blocks, with slack to align the base
+    memory_.resize(blockSize_ * numBlocks_ + kMaxAlignment);
+    auto address = reinterpret_cast<uintptr_t>(memory_.data());
+    base_ = memory_.data() + ((kMaxAlignment - (address % kMaxAlignment)) % kMaxAlignment);
+    
+    // Build free list in address order
+    next_ = std::make_unique<std::atomic<uint32_t>[]>(numBlocks_);
     for (size_t i = 0; i < numBlocks_; ++i) {
-        auto* block = reinterpret_cast<Block*>(memory_.data() + i * blockSize_);
-        block->next = head;
-        head = block;
+        next_[i].store(i + 1 < numBlocks_ ? static_cast<uint32_t>(i + 1) : kNullIndex,
+                       std::memory_order_relaxed);
     }
     
-    freeList_.store(head, std::memory_order_release);
+    available_.store(numBlocks_, std::memory_order_relaxed);
+    freeHead_.store(packHead(0, numBlocks_ > 0 ? 0 : kNullIndex), std::memory_order_release);
+    
+    if (numThreadCaches_ > 0) {
+        caches_ = std::make_unique<ThreadCache[]>(numThreadCaches_);
+        std::lock_guard<std::mutex> lock(registryMutex());
+        livePools().push_back(poolId_);
+        threadCacheTable().evictDeadPools();  // Off the RT path, lock already held
+    }
 }
 
-RTMemoryPool::~RTMemoryPool() = default;
+RTMemoryPool::~RTMemoryPool() {
+    if (numThreadCaches_ > 0) {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        auto& pools = livePools();
+        pools.erase(std::remove(pools.begin(), pools.end(), poolId_), pools.end());
+    }
+}
 
-void* RTMemoryPool::allocate() noexcept {
-    Block* head = freeList_.load(std::memory_order_acquire);
+uint32_t RTMemoryPool::popBatch(uint32_t* indices, uint32_t maxCount) noexcept {
+    uint64_t head = freeHead_.load(std::memory_order_acquire);
     
-    while (head != nullptr) {
-        Block* next = head->next;
-        if (freeList_.compare_exchange_weak(head, next,
-                                           std::memory_order_release,
+    while (headIndex(head) != kNullIndex) {
+        // Walk up to maxCount links. A concurrent push or pop may rewrite them
+        // under us, but it also bumps the tag, so the CAS below then fails
+        uint32_t count = 0;
+        uint32_t index = headIndex(head);
+        while (count < maxCount && index != kNullIndex) {
+            indices[count++] = index;
+            index = next_[index].load(std::memory_order_relaxed);
+        }
+        
+        if (freeHead_.compare_exchange_weak(head, packHead(headTag(head) + 1, index),
+                                           std::memory_order_acq_rel,
                                            std::memory_order_acquire)) {
-            return head;
+            available_.fetch_sub(count, std::memory_order_relaxed);
+            return count;
         }
     }
     
-    return nullptr;  // Pool exhausted
+    return 0;  // Pool exhausted
 }
 
-void RTMemoryPool::deallocate(void* ptr) noexcept {
-    if (!ptr) return;
+void RTMemoryPool::pushBatch(const uint32_t* indices, uint32_t count) noexcept {
+    if (count == 0) return;
+    
+    // Chain the batch privately, then splice it in with one CAS
+    for (uint32_t i = 0; i + 1 < count; ++i) {
+        next_[indices[i]].store(indices[i + 1], std::memory_order_relaxed);
+    }
     
-    auto* block = static_cast<Block*>(ptr);
-    Block* head = freeList_.load(std::memory_order_acquire);
+    const uint32_t last = indices[count - 1];
+    uint64_t head = freeHead_.load(std::memory_order_relaxed);
     
     do {
-        block->next = head;
-    } while (!freeList_.compare_exchange_weak(head, block,
+        next_[last].store(headIndex(head), std::memory_order_relaxed);
+    } while (!freeHead_.compare_exchange_weak(head, packHead(headTag(head) + 1, indices[0]),
                                              std::memory_order_release,
-                                             std::memory_order_acquire));
+                                             std::memory_order_relaxed));
+    
+    available_.fetch_add(count, std::memory_order_relaxed);
 }
 
-size_t RTMemoryPool::getAvailableBlocks() const noexcept {
-    size_t count = 0;
-    Block* current = freeList_.load(std::memory_order_acquire);
+RTMemoryPool::ThreadCache* RTMemoryPool::acquireThreadCache() noexcept {
+    if (numThreadCaches_ == 0) return nullptr;
+    
+    auto& table = threadCacheTable();
+    if (auto* entry = table.find(poolId_)) {
+        return entry->cache;
+    }
     
-    while (current != nullptr) {
-        ++count;
-        current = current->next;
+    // First use of this pool on this thread. With the table full, use the
+    // shared list: evicting dead pools here would lock on the RT path
+    if (table.size == table.entries.size()) {
+        return nullptr;
     }
     
-    return count;
+    ThreadCache* claimed = nullptr;
+    for (size_t i = 0; i < numThreadCaches_ && !claimed; ++i) {
+        bool expected = false;
+        if (caches_[i].claimed.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+            claimed = &caches_[i];
+            claimed->hits.store(0, std::memory_order_relaxed);
+            claimed->misses.store(0, std::memory_order_relaxed);
+        }
+    }
+    
+    table.entries[table.size++] = {poolId_, this, claimed};
+    return claimed;
+}
+
+void RTMemoryPool::releaseDeadThreadBindings() {
+    std::lock_guard<std::mutex> lock(registryMutex());
+    threadCacheTable().evictDeadPools();
+}
+
+const RTMemoryPool::ThreadCache* RTMemoryPool::findThreadCache() const noexcept {
+    if (numThreadCaches_ == 0) return nullptr;
+    
+    auto* entry = threadCacheTable().find(poolId_);
+    return entry ? entry->cache : nullptr;
+}
+
+void RTMemoryPool::releaseThreadCache(ThreadCache& cache) noexcept {
+    pushBatch(cache.blocks, cache.count.load(std::memory_order_relaxed));
+    cache.count.store(0, std::memory_order_relaxed);
+    cache.claimed.store(false, std::memory_order_release);
+}
+
+void* RTMemoryPool::allocate() noexcept {
+    uint32_t index;
+    
+    if (ThreadCache* cache = acquireThreadCache()) {
+        uint32_t count = cache->count.load(std::memory_order_relaxed);
+        
+        if (count > 0) {
+            cache->hits.store(cache->hits.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        } else {
+            cache->misses.store(cache->misses.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            count = popBatch(cache->blocks, kTransferBatch);
+            if (count == 0) return nullptr;  // Pool exhausted
+        }
+        
+        index = cache->blocks[--count];
+        cache->count.store(count, std::memory_order_relaxed);
+        return blockAt(index);
+    }
+    
+    return popBatch(&index, 1) ? blockAt(index) : nullptr;
+}
+
+void RTMemoryPool::deallocate(void* ptr) noexcept {
+    if (!ptr || !owns(ptr)) return;
+    
+    auto index = static_cast<uint32_t>(
+        (static_cast<uint8_t*>(ptr) - base_) / static_cast<ptrdiff_t>(blockSize_));
+    
+    if (ThreadCache* cache = acquireThreadCache()) {
+        uint32_t count = cache->count.load(std::memory_order_relaxed);
+        
+        // Full magazine: hand the older half back to the shared list
+        if (count == kMagazineSize) {
+            pushBatch(cache->blocks, kTransferBatch);
+            std::memmove(cache->blocks, cache->blocks + kTransferBatch,
+                         (kMagazineSize - kTransferBatch) * sizeof(uint32_t));
+            count -= kTransferBatch;
+        }
+        
+        cache->blocks[count++] = index;
+        cache->count.store(count, std::memory_order_relaxed);
+        return;
+    }
+    
+    pushBatch(&index, 1);
+}
+
+size_t RTMemoryPool::getAvailableBlocks() const noexcept {
+    size_t available = available_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < numThreadCaches_; ++i) {
+        available += caches_[i].count.load(std::memory_order_relaxed);
+    }
+    return available;
+}
+
+RTMemoryPool::ThreadCacheStats RTMemoryPool::getThreadCacheStats() const noexcept {
+    const ThreadCache* cache = findThreadCache();
+    return cache ? getThreadCacheStats(static_cast<size_t>(cache - caches_.get())) : ThreadCacheStats{};
+}
+
+RTMemoryPool::ThreadCacheStats RTMemoryPool::getThreadCacheStats(size_t cacheIndex) const noexcept {
+    ThreadCacheStats stats;
+    if (cacheIndex < numThreadCaches_) {
+        const ThreadCache& cache = caches_[cacheIndex];
+        stats.hits = cache.hits.load(std::memory_order_relaxed);
+        stats.misses = cache.misses.load(std::memory_order_relaxed);
+        stats.cachedBlocks = cache.count.load(std::memory_order_relaxed);
+    }
+    return stats;
 }
 
 } // namespace penta
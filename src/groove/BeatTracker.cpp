@@ -0,0 +1,344 @@
+#include "penta/groove/BeatTracker.h"
+#include <algorithm>
+#include <cmath>
+
+namespace penta::groove {
+
+namespace {
+
+constexpr double kTwoPi = 6.28318530717958647692;
+
+// Likelihood of a beat state over a non-beat state at an onset of strength 1
+constexpr float kOnsetGain = 4.0f;
+
+// Period changes less likely than this, relative to holding the period,
+// are dropped from the transition bands
+constexpr float kMinTransition = 1e-6f;
+
+// Tempo prior: log-Gaussian around the external estimate and its half and
+// double, since estimators often settle on a metrical level off by one
+constexpr double kTempoPriorOctaves = 0.25;
+
+// Periods either side of the most likely one that share its phase
+constexpr size_t kTempoNeighbours = 2;
+
+// Phase concentration needed before the grid follows the tracker
+constexpr float kMinConfidence = 0.5f;
+
+// Onsets within this many beats of a beat accent it; accents fade per beat
+constexpr double kAccentWindow = 0.125;
+constexpr float kAccentDecay = 0.95f;
+
+// Keep the unnormalised posterior within float range
+constexpr float kMinMass = 1e-20f;
+constexpr float kMaxMass = 1e20f;
+
+} // anonymous namespace
+
+BeatTracker::BeatTracker(const Config& config)
+    : config_(config)
+    , framesPerMinute_(0.0)
+    , accents_{}
+    , confidence_(0.0f)
+    , hasFrame_(false)
+    , lastFramePosition_(0)
+    , hasBeat_(false)
+    , lastBeat_(0.0)
+    , beatCount_(0)
+{
+    buildStateSpace();
+    reset();
+}
+
+void BeatTracker::buildStateSpace() {
+    config_.hopSize = std::max<size_t>(config_.hopSize, 1);
+    config_.minTempo = std::max(config_.minTempo, 1.0f);
+    config_.maxTempo = std::max(config_.maxTempo, config_.minTempo);
+    config_.beatsPerBar = std::clamp<uint32_t>(config_.beatsPerBar, 1, kMaxBeatsPerBar);
+    config_.beatUnit = std::max<uint32_t>(config_.beatUnit, 1);
+    framesPerMinute_ = 60.0 * config_.sampleRate / static_cast<double>(config_.hopSize);
+    
+    const auto minPeriod = static_cast<uint32_t>(
+        std::max(1.0, std::floor(framesPerMinute_ / config_.maxTempo)));
+    const auto maxPeriod = static_cast<uint32_t>(
+        std::max<double>(minPeriod, std::ceil(framesPerMinute_ / config_.minTempo)));
+    const size_t numTempi = maxPeriod - minPeriod + 1;
+    
+    periods_.resize(numTempi);
+    offsets_.resize(numTempi);
+    heads_.resize(numTempi);
+    beatWidths_.resize(numTempi);
+    slotCos_.clear();
+    slotSin_.clear();
+    for (size_t i = 0; i < numTempi; ++i) {
+        const uint32_t period = minPeriod + static_cast<uint32_t>(i);
+        periods_[i] = period;
+        offsets_[i] = static_cast<uint32_t>(slotCos_.size());
+        beatWidths_[i] = static_cast<uint32_t>(std::lround(period * kBeatWidth));
+        for (uint32_t slot = 0; slot < period; ++slot) {
+            const double angle = kTwoPi * slot / period;
+            slotCos_.push_back(static_cast<float>(std::cos(angle)));
+            slotSin_.push_back(static_cast<float>(std::sin(angle)));
+        }
+    }
+    probability_.resize(slotCos_.size());
+    
+    // Period changes at a beat, banded to the likely ones
+    transitionStart_.resize(numTempi);
+    transitionLength_.resize(numTempi);
+    transitionOffset_.resize(numTempi);
+    transitionWeights_.clear();
+    for (size_t i = 0; i < numTempi; ++i) {
+        std::vector<float> row(numTempi);
+        float sum = 0.0f;
+        for (size_t j = 0; j < numTempi; ++j) {
+            const double ratio = static_cast<double>(periods_[i]) / periods_[j];
+            row[j] = static_cast<float>(std::exp(-config_.tempoChangePenalty * std::abs(ratio - 1.0)));
+            sum += row[j];
+        }
+        size_t first = i;
+        size_t last = i;
+        while (first > 0 && row[first - 1] >= kMinTransition) --first;
+        while (last + 1 < numTempi && row[last + 1] >= kMinTransition) ++last;
+        transitionStart_[i] = static_cast<uint32_t>(first);
+        transitionLength_[i] = static_cast<uint32_t>(last - first + 1);
+        transitionOffset_[i] = static_cast<uint32_t>(transitionWeights_.size());
+        for (size_t j = first; j <= last; ++j) {
+            transitionWeights_.push_back(row[j] / sum);
+        }
+    }
+    
+    tempoPrior_.assign(numTempi, 1.0f);
+    beatEnds_.resize(numTempi);
+    beatStarts_.resize(numTempi);
+    tempoMass_.resize(numTempi);
+    tempoCos_.resize(numTempi);
+    tempoSin_.resize(numTempi);
+}
+
+void BeatTracker::processFrame(float onsetStrength, uint64_t framePosition) noexcept {
+    if (hasFrame_) {
+        if (framePosition <= lastFramePosition_) {
+            // Input restarted
+            reset();
+        } else {
+            // Dropped hops carry no observations; a gap longer than the
+            // slowest beat leaves nothing to keep in phase
+            const uint64_t skipped = std::min<uint64_t>(
+                (framePosition - lastFramePosition_) / config_.hopSize - 1, periods_.back());
+            for (uint64_t hop = 0; hop < skipped; ++hop) {
+                advance(0.0f);
+            }
+        }
+    }
+    
+    advance(std::clamp(onsetStrength, 0.0f, 1.0f));
+    updateGrid(onsetStrength, framePosition);
+    
+    hasFrame_ = true;
+    lastFramePosition_ = framePosition;
+    timing_.samplePosition.store(framePosition + config_.hopSize, std::memory_order_relaxed);
+}
+
+void BeatTracker::setTempoPrior(float bpm, float confidence) noexcept {
+    const float weight = std::clamp(confidence, 0.0f, 1.0f);
+    for (size_t i = 0; i < periods_.size(); ++i) {
+        if (bpm <= 0.0f || weight <= 0.0f) {
+            tempoPrior_[i] = 1.0f;
+            continue;
+        }
+        // Distance to the nearest of bpm / 2, bpm and 2 bpm
+        const double ratio = std::log2(framesPerMinute_ / periods_[i] / bpm);
+        const double octaves = std::min(std::abs(ratio), std::abs(std::abs(ratio) - 1.0)) / kTempoPriorOctaves;
+        tempoPrior_[i] = (1.0f - weight) + weight * static_cast<float>(std::exp(-0.5 * octaves * octaves));
+    }
+}
+
+void BeatTracker::setTimeSignature(uint32_t beatsPerBar, uint32_t beatUnit) noexcept {
+    config_.beatsPerBar = std::clamp<uint32_t>(beatsPerBar, 1, kMaxBeatsPerBar);
+    config_.beatUnit = std::max<uint32_t>(beatUnit, 1);
+    accents_.fill(0.0f);
+    timing_.numerator.store(config_.beatsPerBar, std::memory_order_relaxed);
+    timing_.denominator.store(config_.beatUnit, std::memory_order_relaxed);
+}
+
+uint64_t BeatTracker::getLastBeat() const noexcept {
+    return static_cast<uint64_t>(std::llround(std::max(lastBeat_, 0.0)));
+}
+
+void BeatTracker::updateConfig(const Config& config) {
+    config_ = config;
+    buildStateSpace();
+    reset();
+}
+
+void BeatTracker::reset() noexcept {
+    // Every period equally likely, every phase within a period equally likely
+    for (size_t i = 0; i < periods_.size(); ++i) {
+        const float mass = 1.0f / (static_cast<float>(periods_.size()) * periods_[i]);
+        std::fill_n(probability_.begin() + offsets_[i], periods_[i], mass);
+        heads_[i] = 0;
+    }
+    accents_.fill(0.0f);
+    confidence_ = 0.0f;
+    hasFrame_ = false;
+    lastFramePosition_ = 0;
+    hasBeat_ = false;
+    lastBeat_ = 0.0;
+    beatCount_ = 0;
+    
+    timing_.tempo.store(120.0, std::memory_order_relaxed);
+    timing_.barStart.store(0, std::memory_order_relaxed);
+    timing_.numerator.store(config_.beatsPerBar, std::memory_order_relaxed);
+    timing_.denominator.store(config_.beatUnit, std::memory_order_relaxed);
+    timing_.samplePosition.store(0, std::memory_order_relaxed);
+}
+
+void BeatTracker::advance(float onsetStrength) noexcept {
+    const size_t numTempi = periods_.size();
+    float* probability = probability_.data();
+    
+    // Every phase moves on one hop: phase 0 moves back one slot, into the
+    // slot of the phase that just completed its beat
+    for (size_t i = 0; i < numTempi; ++i) {
+        const uint32_t period = periods_[i];
+        heads_[i] = (heads_[i] + period - 1) % period;
+        beatEnds_[i] = probability[offsets_[i] + heads_[i]];
+    }
+    
+    // Completed beats start the next one at a nearby period
+    std::fill(beatStarts_.begin(), beatStarts_.end(), 0.0f);
+    for (size_t i = 0; i < numTempi; ++i) {
+        const float mass = beatEnds_[i];
+        if (mass == 0.0f) {
+            continue;
+        }
+        const float* weights = transitionWeights_.data() + transitionOffset_[i];
+        float* starts = beatStarts_.data() + transitionStart_[i];
+        for (uint32_t k = 0; k < transitionLength_[i]; ++k) {
+            starts[k] += mass * weights[k];
+        }
+    }
+    for (size_t i = 0; i < numTempi; ++i) {
+        probability[offsets_[i] + heads_[i]] = beatStarts_[i] * tempoPrior_[i];
+    }
+    
+    // An onset favours the states on a beat
+    if (onsetStrength > 0.0f) {
+        const float gain = 1.0f + kOnsetGain * onsetStrength;
+        for (size_t i = 0; i < numTempi; ++i) {
+            const uint32_t period = periods_[i];
+            const uint32_t width = beatWidths_[i];
+            for (uint32_t d = period - width; d <= period + width; ++d) {
+                probability[offsets_[i] + (heads_[i] + d) % period] *= gain;
+            }
+        }
+    }
+    
+    // Posterior summary per period: mass and phasor of its beat phase
+    float total = 0.0f;
+    for (size_t i = 0; i < numTempi; ++i) {
+        const float* p = probability + offsets_[i];
+        const float* cosine = slotCos_.data() + offsets_[i];
+        const float* sine = slotSin_.data() + offsets_[i];
+        float mass = 0.0f;
+        float re = 0.0f;
+        float im = 0.0f;
+        for (uint32_t slot = 0; slot < periods_[i]; ++slot) {
+            mass += p[slot];
+            re += p[slot] * cosine[slot];
+            im += p[slot] * sine[slot];
+        }
+        // Rotate so phase 0 (the head slot) reads angle 0
+        const float headCos = cosine[heads_[i]];
+        const float headSin = sine[heads_[i]];
+        tempoMass_[i] = mass;
+        tempoCos_[i] = re * headCos + im * headSin;
+        tempoSin_[i] = im * headCos - re * headSin;
+        total += mass;
+    }
+    
+    if (total < kMinMass || total > kMaxMass) {
+        const float scale = 1.0f / total;
+        for (float& p : probability_) p *= scale;
+        for (size_t i = 0; i < numTempi; ++i) {
+            tempoMass_[i] *= scale;
+            tempoCos_[i] *= scale;
+            tempoSin_[i] *= scale;
+        }
+    }
+}
+
+void BeatTracker::updateGrid(float onsetStrength, uint64_t framePosition) noexcept {
+    float total = 0.0f;
+    for (float mass : tempoMass_) total += mass;
+    if (!(total > 0.0f)) {
+        return;
+    }
+    
+    // Tempo and phase of the most likely period and its neighbours
+    const auto best = static_cast<size_t>(
+        std::max_element(tempoMass_.begin(), tempoMass_.end()) - tempoMass_.begin());
+    const size_t first = best > kTempoNeighbours ? best - kTempoNeighbours : 0;
+    const size_t last = std::min(best + kTempoNeighbours, periods_.size() - 1);
+    double mass = 0.0;
+    double tempoSum = 0.0;
+    double re = 0.0;
+    double im = 0.0;
+    for (size_t i = first; i <= last; ++i) {
+        mass += tempoMass_[i];
+        tempoSum += tempoMass_[i] * framesPerMinute_ / periods_[i];
+        re += tempoCos_[i];
+        im += tempoSin_[i];
+    }
+    confidence_ = std::clamp(static_cast<float>(std::hypot(re, im) / total), 0.0f, 1.0f);
+    if (confidence_ < kMinConfidence || !(mass > 0.0)) {
+        return;
+    }
+    
+    const double tempo = tempoSum / mass;
+    const double period = 60.0 * config_.sampleRate / tempo;
+    double phase = std::atan2(im, re) / kTwoPi;    // Beats since the last beat
+    if (phase < 0.0) phase += 1.0;
+    const double beat = static_cast<double>(framePosition) - phase * period;
+    
+    // Count beats as the estimate of the last one moves on
+    if (!hasBeat_) {
+        hasBeat_ = true;
+        beatCount_ = 1;
+    } else {
+        const double beats = std::round((beat - lastBeat_) / period);
+        if (beats >= 1.0) {
+            beatCount_ += static_cast<uint64_t>(beats);
+            const float decay = std::pow(kAccentDecay, static_cast<float>(beats));
+            for (float& accent : accents_) accent *= decay;
+        } else if (beats <= -1.0) {
+            beatCount_ -= std::min(beatCount_ - 1, static_cast<uint64_t>(-beats));
+        }
+    }
+    lastBeat_ = beat;
+    
+    // The most accented beat of the bar is the downbeat
+    const uint32_t beatsPerBar = config_.beatsPerBar;
+    if (onsetStrength > 0.0f) {
+        if (phase < kAccentWindow) {
+            accents_[beatCount_ % beatsPerBar] += onsetStrength;
+        } else if (phase > 1.0 - kAccentWindow) {
+            accents_[(beatCount_ + 1) % beatsPerBar] += onsetStrength;
+        }
+    }
+    const auto downbeat = static_cast<uint64_t>(
+        std::max_element(accents_.begin(), accents_.begin() + beatsPerBar) - accents_.begin());
+    const uint64_t beatInBar = (beatCount_ + beatsPerBar - downbeat) % beatsPerBar;
+    
+    double barStart = beat - static_cast<double>(beatInBar) * period;
+    if (barStart < 0.0) {
+        const double bar = beatsPerBar * period;
+        barStart += std::ceil(-barStart / bar) * bar;
+    }
+    
+    timing_.tempo.store(tempo, std::memory_order_relaxed);
+    timing_.barStart.store(static_cast<uint64_t>(std::llround(barStart)), std::memory_order_relaxed);
+}
+
+} // namespace penta::groove
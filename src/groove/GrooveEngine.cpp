@@ -1,64 +1,211 @@
 #include "penta/groove/GrooveEngine.h"
+#include <algorithm>
 
 namespace penta::groove {
 
+namespace {
+
+GrooveEngine::Config makeConfig(double sampleRate) {
+    GrooveEngine::Config config;
+    config.sampleRate = sampleRate;
+    return config;
+}
+
+} // anonymous namespace
+
 GrooveEngine::GrooveEngine(const Config& config)
     : config_(config)
     , analysis_{}
-    , onsetDetector_(std::make_unique<OnsetDetector>())
-    , tempoEstimator_(std::make_unique<TempoEstimator>())
-    , quantizer_(std::make_unique<RhythmQuantizer>())
+    , onsetDetector_(std::make_unique<OnsetDetector>(onsetConfig()))
+    , tempoEstimator_(std::make_unique<TempoEstimator>(tempoConfig()))
+    , beatTracker_(std::make_unique<BeatTracker>(beatConfig()))
+    , quantizer_(std::make_unique<RhythmQuantizer>(quantizerConfig()))
     , samplePosition_(0)
+    , onsetPositions_(kMaxOnsetHistory, 0)
+    , onsetStrengths_(kMaxOnsetHistory, 0.0f)
+    , onsetHead_(0)
+    , onsetCount_(0)
+    , blockOnsets_(0)
 {
     analysis_.currentTempo = 120.0f;
     analysis_.tempoConfidence = 0.0f;
     analysis_.timeSignatureNum = 4;
     analysis_.timeSignatureDen = 4;
     analysis_.swing = 0.0f;
-    // TODO: Week 3-4 implementation
+}
+
+GrooveEngine::GrooveEngine(double sampleRate)
+    : GrooveEngine(makeConfig(sampleRate))
+{
 }
 
 GrooveEngine::~GrooveEngine() = default;
 
 void GrooveEngine::processAudio(const float* buffer, size_t frames) noexcept {
+    blockOnsets_ = 0;
     if (onsetDetector_) {
         onsetDetector_->process(buffer, frames);
         
-        if (onsetDetector_->hasOnset()) {
-            uint64_t onsetPos = onsetDetector_->getOnsetPosition();
-            float onsetStrength = onsetDetector_->getOnsetStrength();
-            analysis_.onsetPositions.push_back(onsetPos);
-            analysis_.onsetStrengths.push_back(onsetStrength);
+        // Every analysed hop: its onset, if any, then one beat-tracker step
+        for (size_t frame = 0; frame < onsetDetector_->getAnalyzedFrames(); ++frame) {
+            const uint64_t position = onsetDetector_->getFramePosition(frame);
+            const float strength = onsetDetector_->getFrameOnsetStrength(frame);
+            if (strength > 0.0f) {
+                recordOnset(position, strength);
+                tempoEstimator_->addOnset(position);
+                updateTempoEstimate();
+            }
+            beatTracker_->processFrame(strength, position);
         }
     }
     
     samplePosition_ += frames;
 }
 
+uint64_t GrooveEngine::getOnsetPosition(size_t index) const noexcept {
+    return onsetPositions_[(onsetHead_ + index) % kMaxOnsetHistory];
+}
+
+float GrooveEngine::getOnsetStrength(size_t index) const noexcept {
+    return onsetStrengths_[(onsetHead_ + index) % kMaxOnsetHistory];
+}
+
 uint64_t GrooveEngine::quantizeToGrid(uint64_t timestamp) const noexcept {
-    // Stub implementation
-    return timestamp;
+    if (!config_.enableQuantization) {
+        return timestamp;
+    }
+    const TimingInfo& timing = beatTracker_->getTimingInfo();
+    return quantizer_->quantize(timestamp, samplesPerBeat(timing),
+                                timing.barStart.load(std::memory_order_relaxed));
 }
 
 uint64_t GrooveEngine::applySwing(uint64_t position) const noexcept {
-    // Stub implementation
-    return position;
+    const TimingInfo& timing = beatTracker_->getTimingInfo();
+    return quantizer_->applySwing(position, samplesPerBeat(timing),
+                                  timing.barStart.load(std::memory_order_relaxed));
+}
+
+void GrooveEngine::setParameter(int parameter, float value) noexcept {
+    value = std::clamp(value, 0.0f, 1.0f);
+    switch (parameter) {
+        case OnsetSensitivity:
+            onsetDetector_->setSensitivity(value);
+            break;
+        case TempoSmoothing:
+            tempoEstimator_->setSmoothing(value);
+            break;
+        case QuantizationStrength:
+            config_.quantizationStrength = value;
+            quantizer_->updateConfig(quantizerConfig());
+            break;
+        case SwingAmount:
+            config_.swingAmount = value;
+            quantizer_->setSwing(value);
+            break;
+        default:
+            break;
+    }
 }
 
 void GrooveEngine::updateConfig(const Config& config) {
+    const bool framingChanged = config.sampleRate != config_.sampleRate
+        || config.hopSize != config_.hopSize
+        || config.onsetMethod != config_.onsetMethod;
     config_ = config;
+    
+    if (framingChanged) {
+        onsetDetector_ = std::make_unique<OnsetDetector>(onsetConfig());
+    }
+    
+    const auto& tempo = tempoEstimator_->getConfig();
+    if (tempo.sampleRate != config_.sampleRate || tempo.minTempo != config_.minTempo
+        || tempo.maxTempo != config_.maxTempo) {
+        tempoEstimator_->updateConfig(tempoConfig());
+    }
+    
+    const auto& beat = beatTracker_->getConfig();
+    if (beat.sampleRate != config_.sampleRate || beat.hopSize != config_.hopSize
+        || beat.minTempo != config_.minTempo || beat.maxTempo != config_.maxTempo) {
+        beatTracker_->updateConfig(beatConfig());
+    }
+    
+    quantizer_->updateConfig(quantizerConfig());
 }
 
 void GrooveEngine::reset() {
     if (onsetDetector_) onsetDetector_->reset();
     if (tempoEstimator_) tempoEstimator_->reset();
+    if (beatTracker_) beatTracker_->reset();
     samplePosition_ = 0;
-    onsetHistory_.clear();
-    analysis_ = GrooveAnalysis{};
+    onsetHead_ = 0;
+    onsetCount_ = 0;
+    blockOnsets_ = 0;
+    analysis_.currentTempo = 120.0f;
+    analysis_.tempoConfidence = 0.0f;
+    analysis_.timeSignatureNum = 4;
+    analysis_.timeSignatureDen = 4;
+    analysis_.swing = 0.0f;
+}
+
+OnsetDetector::Config GrooveEngine::onsetConfig() const noexcept {
+    OnsetDetector::Config config;
+    config.sampleRate = config_.sampleRate;
+    config.hopSize = config_.hopSize;
+    config.method = config_.onsetMethod;
+    return config;
+}
+
+TempoEstimator::Config GrooveEngine::tempoConfig() const noexcept {
+    TempoEstimator::Config config;
+    config.sampleRate = config_.sampleRate;
+    config.minTempo = config_.minTempo;
+    config.maxTempo = config_.maxTempo;
+    return config;
+}
+
+BeatTracker::Config GrooveEngine::beatConfig() const noexcept {
+    BeatTracker::Config config;
+    config.sampleRate = config_.sampleRate;
+    config.hopSize = config_.hopSize;
+    config.minTempo = config_.minTempo;
+    config.maxTempo = config_.maxTempo;
+    return config;
+}
+
+RhythmQuantizer::Config GrooveEngine::quantizerConfig() const noexcept {
+    RhythmQuantizer::Config config;
+    config.resolution = config_.gridResolution;
+    config.strength = config_.quantizationStrength;
+    config.enableSwing = config_.swingAmount > 0.0f;
+    config.swingAmount = config_.swingAmount;
+    return config;
+}
+
+double GrooveEngine::samplesPerBeat(const TimingInfo& timing) const noexcept {
+    const double tempo = timing.tempo.load(std::memory_order_relaxed);
+    return tempo > 0.0 ? 60.0 * config_.sampleRate / tempo : 0.0;
+}
+
+void GrooveEngine::recordOnset(uint64_t position, float strength) noexcept {
+    if (onsetCount_ == kMaxOnsetHistory) {
+        onsetHead_ = (onsetHead_ + 1) % kMaxOnsetHistory;
+        --onsetCount_;
+    }
+    const size_t slot = (onsetHead_ + onsetCount_) % kMaxOnsetHistory;
+    onsetPositions_[slot] = position;
+    onsetStrengths_[slot] = strength;
+    ++onsetCount_;
+    ++blockOnsets_;
 }
 
 void GrooveEngine::updateTempoEstimate() noexcept {
-    // Stub implementation - TODO Week 3
+    // Keep the previous tempo until the estimator has one
+    const float tempo = tempoEstimator_->getCurrentTempo();
+    if (tempo > 0.0f) {
+        analysis_.currentTempo = tempo;
+        analysis_.tempoConfidence = tempoEstimator_->getConfidence();
+        beatTracker_->setTempoPrior(tempo, analysis_.tempoConfidence);
+    }
 }
 
 void GrooveEngine::detectTimeSignature() noexcept {
@@ -1,59 +1,380 @@
 #include "penta/groove/OnsetDetector.h"
+#include <algorithm>
+#include <cmath>
 
 namespace penta::groove {
 
+namespace {
+
+// Threshold at sensitivity 0; sensitivity 0.5 gives the 0.3 default
+constexpr float kMaxThreshold = 0.6f;
+
+// SuperFlux filterbank and reference frame (Boeck & Widmer, DAFx 2013)
+constexpr double kBandsPerOctave = 24.0;
+constexpr double kMinBandFrequency = 30.0;
+constexpr double kMaxBandFrequency = 17000.0;
+constexpr double kSuperFluxLagRatio = 0.5;  // Reference frame lag, in frames per window
+
+// Bins quieter than this have no usable phase
+constexpr float kMinPhaseMagnitude = 1e-9f;
+
+OnsetDetector::Config makeConfig(double sampleRate, size_t hopSize) {
+    OnsetDetector::Config config;
+    config.sampleRate = sampleRate;
+    config.hopSize = hopSize;
+    return config;
+}
+
+} // anonymous namespace
+
 OnsetDetector::OnsetDetector(const Config& config)
     : config_(config)
+    , fft_(std::make_unique<RTFFT>(config.fftSize))
+    , framer_(fft_->getSize(), config.hopSize, config.maxPendingFrames)
+    , bandHistoryIndex_(0)
+    , superFluxLag_(1)
+    , logScale_(1.0f)
+    , superFluxScale_(1.0f)
+    , spectrumScale_(0.0f)
+    , prevFlux_(0.0f)
+    , historyIndex_(0)
+    , refractorySamples_(0)
+    , analyzedFrames_(0)
     , onsetDetected_(false)
+    , anyOnset_(false)
     , onsetStrength_(0.0f)
     , onsetPosition_(0)
     , lastOnsetPosition_(0)
-    , sampleCounter_(0)
 {
+    config_.fftSize = framer_.getFrameSize();
+    config_.hopSize = framer_.getHopSize();
+    config_.medianFrames = std::max<size_t>(config_.medianFrames, 1);
+    // A call never finds more than the backlog waiting
+    config_.maxPendingFrames = std::max<size_t>(config_.maxPendingFrames, 1);
+    if (config_.maxFramesPerBlock == 0 || config_.maxFramesPerBlock > config_.maxPendingFrames) {
+        config_.maxFramesPerBlock = config_.maxPendingFrames;
+    }
+    refractorySamples_ = static_cast<uint64_t>(
+        std::max(0.0, config_.minTimeBetweenOnsets * config_.sampleRate));
+    
+    // Periodic Hann window; its sum is fftSize / 2, so scaling magnitudes by
+    // 4 / fftSize reads a full-scale sinusoid as 1
+    const double pi = 3.14159265358979323846;
+    window_.resize(config_.fftSize);
+    for (size_t n = 0; n < config_.fftSize; ++n) {
+        window_[n] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * pi * n / config_.fftSize));
+    }
+    spectrumScale_ = 4.0f / static_cast<float>(config_.fftSize);
+    
     // Pre-allocate buffers
+    const size_t numBins = fft_->getNumBins();
     fftBuffer_.resize(config_.fftSize);
-    spectrum_.resize(config_.fftSize / 2 + 1);
-    prevSpectrum_.resize(config_.fftSize / 2 + 1);
-    fluxHistory_.resize(100);
+    spectrum_.resize(numBins);
+    prevSpectrum_.resize(numBins);
+    for (auto* buffer : {&real_, &imag_, &prevReal_, &prevImag_, &prevReal2_, &prevImag2_}) {
+        buffer->resize(numBins);
+    }
+    fluxHistory_.resize(config_.medianFrames);
+    medianScratch_.resize(config_.medianFrames);
+    framePositions_.resize(config_.maxFramesPerBlock);
+    frameStrengths_.resize(config_.maxFramesPerBlock);
     
-    // TODO: Week 3 implementation - FFT-based spectral flux onset detection
-    // - Initialize Hann window
-    // - Setup FFT library integration
+    buildFilterbank();
+    reset();
+}
+
+OnsetDetector::OnsetDetector(double sampleRate, size_t hopSize)
+    : OnsetDetector(makeConfig(sampleRate, hopSize))
+{
 }
 
 OnsetDetector::~OnsetDetector() = default;
 
 void OnsetDetector::process(const float* buffer, size_t frames) noexcept {
-    // Stub implementation
-    (void)buffer;  // TODO: Week 3 - process audio buffer
     onsetDetected_ = false;
-    sampleCounter_ += frames;
+    analyzedFrames_ = 0;
+    if (buffer == nullptr) {
+        return;
+    }
+    
+    framer_.push(buffer, frames);
     
-    // TODO: Week 3 - implement spectral flux calculation
+    // Analyze the backlog oldest-first, within the per-block budget
+    uint64_t frameEnd = 0;
+    while (analyzedFrames_ < config_.maxFramesPerBlock) {
+        if (!framer_.pop(fftBuffer_.data(), frameEnd)) {
+            break;
+        }
+        const uint64_t framePosition = frameEnd - config_.hopSize;
+        const bool onset = detectPeaks(computeDetectionFunction(), framePosition);
+        framePositions_[analyzedFrames_] = framePosition;
+        frameStrengths_[analyzedFrames_] = onset ? onsetStrength_ : 0.0f;
+        ++analyzedFrames_;
+    }
+}
+
+bool OnsetDetector::processBlock(const float* buffer, size_t frames) noexcept {
+    process(buffer, frames);
+    return onsetDetected_;
 }
 
 void OnsetDetector::setThreshold(float threshold) noexcept {
     config_.threshold = threshold;
 }
 
+void OnsetDetector::setSensitivity(float sensitivity) noexcept {
+    config_.threshold = kMaxThreshold * (1.0f - std::clamp(sensitivity, 0.0f, 1.0f));
+}
+
 void OnsetDetector::reset() noexcept {
     onsetDetected_ = false;
+    analyzedFrames_ = 0;
+    anyOnset_ = false;
     onsetStrength_ = 0.0f;
     onsetPosition_ = 0;
     lastOnsetPosition_ = 0;
-    sampleCounter_ = 0;
-    std::fill(prevSpectrum_.begin(), prevSpectrum_.end(), 0.0f);
-    std::fill(fluxHistory_.begin(), fluxHistory_.end(), 0.0f);
+    historyIndex_ = 0;
+    bandHistoryIndex_ = 0;
+    prevFlux_ = 0.0f;
+    framer_.reset();
+    for (auto* buffer : {&prevSpectrum_, &prevReal_, &prevImag_, &prevReal2_, &prevImag2_,
+                         &bandHistory_, &fluxHistory_}) {
+        std::fill(buffer->begin(), buffer->end(), 0.0f);
+    }
 }
 
-void OnsetDetector::computeSpectralFlux(const float* buffer, size_t frames) noexcept {
-    // Stub - TODO Week 3
-    (void)buffer;
-    (void)frames;
+void OnsetDetector::buildFilterbank() {
+    const double binWidth = config_.sampleRate / static_cast<double>(config_.fftSize);
+    const size_t lastBin = fft_->getNumBins() - 1;
+    
+    // Band centres 24 per octave around A4, snapped to bins, duplicates
+    // dropped: low bands are single bins
+    std::vector<uint32_t> centres;
+    const double firstStep = std::ceil(kBandsPerOctave * std::log2(kMinBandFrequency / 440.0));
+    for (double step = firstStep;; step += 1.0) {
+        const double frequency = 440.0 * std::pow(2.0, step / kBandsPerOctave);
+        if (frequency > kMaxBandFrequency) {
+            break;
+        }
+        const auto bin = static_cast<uint32_t>(std::lround(frequency / binWidth));
+        if (bin > lastBin) {
+            break;
+        }
+        if (bin > 0 && (centres.empty() || bin > centres.back())) {
+            centres.push_back(bin);
+        }
+    }
+    
+    // Each triangle rises from the previous centre and falls to the next,
+    // so neighbouring weights sum to 1 between centres
+    for (size_t b = 0; b < centres.size(); ++b) {
+        const uint32_t centre = centres[b];
+        const uint32_t left = b > 0 ? centres[b - 1] : centre - 1;
+        const uint32_t right = b + 1 < centres.size() ? centres[b + 1] : centre + 1;
+        
+        bandStart_.push_back(left + 1);
+        bandLength_.push_back(right - left - 1);
+        bandOffset_.push_back(static_cast<uint32_t>(bandWeights_.size()));
+        for (uint32_t k = left + 1; k < right; ++k) {
+            bandWeights_.push_back(k <= centre
+                ? static_cast<float>(k - left) / static_cast<float>(centre - left)
+                : static_cast<float>(right - k) / static_cast<float>(right - centre));
+        }
+    }
+    
+    // Reference frame about half a window back, so the max filter compares
+    // against a frame that does not overlap the onset
+    superFluxLag_ = std::max<size_t>(1, static_cast<size_t>(std::lround(
+        kSuperFluxLagRatio * static_cast<double>(config_.fftSize) / config_.hopSize)));
+    bands_.resize(bandStart_.size());
+    bandHistory_.resize(superFluxLag_ * bandStart_.size());
+    
+    // Compression equals log(1 + |X|) on unscaled magnitudes, as in the
+    // paper. The output is then calibrated on a full-scale click, whose raw
+    // spectrum is 1 in every bin, to read like spectral flux from silence
+    logScale_ = 1.0f / spectrumScale_;
+    std::fill(spectrum_.begin(), spectrum_.end(), spectrumScale_);
+    sumBands(spectrum_.data(), bands_.data());
+    float click = 0.0f;
+    for (float band : bands_) {
+        click += std::log1p(logScale_ * band);
+    }
+    const float flux = spectrumScale_ * static_cast<float>(spectrum_.size());
+    superFluxScale_ = click > 0.0f ? flux / click : 1.0f;
 }
 
-void OnsetDetector::detectPeaks() noexcept {
-    // Stub - TODO Week 3
+float OnsetDetector::computeDetectionFunction() noexcept {
+    for (size_t n = 0; n < fftBuffer_.size(); ++n) {
+        fftBuffer_[n] *= window_[n];
+    }
+    
+    float odf = 0.0f;
+    const bool usesPhase = config_.method == Method::ComplexDomain
+        || config_.method == Method::PhaseDeviation;
+    if (usesPhase) {
+        fft_->forward(fftBuffer_.data(), real_.data(), imag_.data());
+        for (size_t k = 0; k < spectrum_.size(); ++k) {
+            real_[k] *= spectrumScale_;
+            imag_[k] *= spectrumScale_;
+            spectrum_[k] = std::sqrt(real_[k] * real_[k] + imag_[k] * imag_[k]);
+        }
+        
+        odf = config_.method == Method::ComplexDomain ? complexDomain() : phaseDeviation();
+        
+        // Shift the phase history: prev2 <- prev, prev <- current
+        std::swap(prevReal2_, prevReal_);
+        std::swap(prevImag2_, prevImag_);
+        std::swap(prevReal_, real_);
+        std::swap(prevImag_, imag_);
+    } else {
+        fft_->magnitudes(fftBuffer_.data(), spectrum_.data());
+        for (float& magnitude : spectrum_) {
+            magnitude *= spectrumScale_;
+        }
+        
+        switch (config_.method) {
+            case Method::HighFrequencyContent: odf = highFrequencyContent(); break;
+            case Method::SuperFlux:            odf = superFlux(); break;
+            default:                           odf = spectralFlux(); break;
+        }
+    }
+    
+    std::swap(prevSpectrum_, spectrum_);
+    return odf;
+}
+
+float OnsetDetector::spectralFlux() const noexcept {
+    // Half-wave rectified rise of each bin
+    float flux = 0.0f;
+    for (size_t k = 0; k < spectrum_.size(); ++k) {
+        flux += std::max(spectrum_[k] - prevSpectrum_[k], 0.0f);
+    }
+    return flux;
+}
+
+float OnsetDetector::highFrequencyContent() const noexcept {
+    // Weight 2k / (numBins - 1) averages 1 over the spectrum, so a flat
+    // (click) spectrum reads like its flux from silence
+    const float weightStep = 2.0f / static_cast<float>(spectrum_.size() - 1);
+    float hfc = 0.0f;
+    for (size_t k = 0; k < spectrum_.size(); ++k) {
+        hfc += weightStep * static_cast<float>(k) * spectrum_[k];
+    }
+    return hfc;
+}
+
+float OnsetDetector::complexDomain() const noexcept {
+    // Rectified complex domain (Dixon 2006): distance from the spectrum
+    // predicted by a steady magnitude and phase advance, X1 e^(i(phi1 - phi2)),
+    // counted only in bins that grew
+    float distance = 0.0f;
+    for (size_t k = 0; k < spectrum_.size(); ++k) {
+        if (spectrum_[k] < prevSpectrum_[k]) {
+            continue;
+        }
+        const float r1 = prevReal_[k], i1 = prevImag_[k];
+        const float r2 = prevReal2_[k], i2 = prevImag2_[k];
+        const float norm = prevSpectrum_[k] * std::sqrt(r2 * r2 + i2 * i2);
+        
+        // Predicted phasor X1 * conj(X2) / |X1 X2| (no advance without history)
+        float advanceReal = 1.0f, advanceImag = 0.0f;
+        if (norm > kMinPhaseMagnitude) {
+            advanceReal = (r1 * r2 + i1 * i2) / norm;
+            advanceImag = (i1 * r2 - r1 * i2) / norm;
+        }
+        const float targetReal = r1 * advanceReal - i1 * advanceImag;
+        const float targetImag = r1 * advanceImag + i1 * advanceReal;
+        distance += std::hypot(real_[k] - targetReal, imag_[k] - targetImag);
+    }
+    return distance;
+}
+
+float OnsetDetector::phaseDeviation() const noexcept {
+    // Weighted phase deviation (Dixon 2006): |phi - 2 phi1 + phi2| per bin,
+    // weighted by magnitude and by 2 / pi so random phases (mean deviation
+    // pi / 2) read like the magnitude sum
+    const float pi = 3.14159265358979323846f;
+    float deviation = 0.0f;
+    for (size_t k = 0; k < spectrum_.size(); ++k) {
+        const float r1 = prevReal_[k], i1 = prevImag_[k];
+        const float r2 = prevReal2_[k], i2 = prevImag2_[k];
+        if (spectrum_[k] < kMinPhaseMagnitude
+            || prevSpectrum_[k] * std::sqrt(r2 * r2 + i2 * i2) < kMinPhaseMagnitude) {
+            continue;
+        }
+        
+        // X * conj(X1)^2 * X2 has phase phi - 2 phi1 + phi2, already wrapped
+        const float ar = r1 * r1 - i1 * i1;      // X1^2
+        const float ai = 2.0f * r1 * i1;
+        const float br = ar * r2 + ai * i2;      // X1^2 * conj(X2)
+        const float bi = ai * r2 - ar * i2;
+        const float cr = real_[k] * br + imag_[k] * bi;  // X * conj(X1^2 conj(X2))
+        const float ci = imag_[k] * br - real_[k] * bi;
+        deviation += spectrum_[k] * std::fabs(std::atan2(ci, cr));
+    }
+    return deviation * (2.0f / pi);
+}
+
+float OnsetDetector::superFlux() noexcept {
+    sumBandsSIMD(spectrum_.data(), bands_.data());
+    for (float& band : bands_) {
+        band = std::log1p(logScale_ * band);
+    }
+    
+    // Rise over the maximum of each band and its neighbours superFluxLag_
+    // frames back; the max filter absorbs vibrato of up to a band
+    const size_t numBands = bands_.size();
+    float* reference = bandHistory_.data() + bandHistoryIndex_ * numBands;
+    float flux = 0.0f;
+    for (size_t b = 0; b < numBands; ++b) {
+        float filtered = reference[b];
+        if (b > 0) filtered = std::max(filtered, reference[b - 1]);
+        if (b + 1 < numBands) filtered = std::max(filtered, reference[b + 1]);
+        flux += std::max(bands_[b] - filtered, 0.0f);
+    }
+    
+    // The oldest frame's slot takes this one
+    std::copy(bands_.begin(), bands_.end(), reference);
+    bandHistoryIndex_ = (bandHistoryIndex_ + 1) % superFluxLag_;
+    return flux * superFluxScale_;
+}
+
+void OnsetDetector::sumBands(const float* magnitude, float* bands) const noexcept {
+    for (size_t b = 0; b < bandStart_.size(); ++b) {
+        const float* bins = magnitude + bandStart_[b];
+        const float* weights = bandWeights_.data() + bandOffset_[b];
+        float sum = 0.0f;
+        for (uint32_t i = 0; i < bandLength_[b]; ++i) {
+            sum += weights[i] * bins[i];
+        }
+        bands[b] = sum;
+    }
+}
+
+bool OnsetDetector::detectPeaks(float odf, uint64_t framePosition) noexcept {
+    // Adaptive threshold: median of the recent ODF plus the margin
+    std::copy(fluxHistory_.begin(), fluxHistory_.end(), medianScratch_.begin());
+    const auto middle = medianScratch_.begin() + medianScratch_.size() / 2;
+    std::nth_element(medianScratch_.begin(), middle, medianScratch_.end());
+    const float median = *middle;
+    
+    const bool rising = odf > prevFlux_;
+    const bool clear = !anyOnset_ || framePosition - lastOnsetPosition_ >= refractorySamples_;
+    const bool onset = rising && clear && odf > median + config_.threshold;
+    if (onset) {
+        // Excess over the median, compressed with the threshold as the knee
+        const float excess = odf - median;
+        onsetDetected_ = true;
+        onsetStrength_ = excess / (excess + std::max(config_.threshold, 1e-6f));
+        onsetPosition_ = framePosition;
+        lastOnsetPosition_ = framePosition;
+        anyOnset_ = true;
+    }
+    
+    fluxHistory_[historyIndex_] = odf;
+    historyIndex_ = (historyIndex_ + 1) % fluxHistory_.size();
+    prevFlux_ = odf;
+    return onset;
 }
 
 } // namespace penta::groove
@@ -0,0 +1,58 @@
+#include "penta/groove/OnsetDetector.h"
+
+// SIMD intrinsics
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace penta::groove {
+
+#ifdef __AVX2__
+
+// AVX2 band sums: each band's weights are packed contiguously and its bins
+// are contiguous in the spectrum, so a band is a dot product of two
+// unaligned streams reduced 8 bins per FMA. Single-bin low bands fall
+// through to the scalar tail.
+void OnsetDetector::sumBandsSIMD(const float* magnitude, float* bands) const noexcept {
+    for (size_t b = 0; b < bandStart_.size(); ++b) {
+        const float* bins = magnitude + bandStart_[b];
+        const float* weights = bandWeights_.data() + bandOffset_[b];
+        const size_t length = bandLength_[b];
+        
+        size_t i = 0;
+        float sum = 0.0f;
+        if (length >= 8) {
+            __m256 acc = _mm256_mul_ps(_mm256_loadu_ps(weights), _mm256_loadu_ps(bins));
+            for (i = 8; i + 8 <= length; i += 8) {
+#ifdef __FMA__
+                acc = _mm256_fmadd_ps(_mm256_loadu_ps(weights + i), _mm256_loadu_ps(bins + i), acc);
+#else
+                acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_loadu_ps(weights + i), _mm256_loadu_ps(bins + i)));
+#endif
+            }
+            
+            // Horizontal sum of the 8 lanes
+            __m128 half = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+            half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+            half = _mm_add_ss(half, _mm_movehdup_ps(half));
+            sum = _mm_cvtss_f32(half);
+        }
+        for (; i < length; ++i) {
+            sum += weights[i] * bins[i];
+        }
+        bands[b] = sum;
+    }
+}
+
+#endif // __AVX2__
+
+// Scalar fallback when AVX2 not available
+#ifndef __AVX2__
+
+void OnsetDetector::sumBandsSIMD(const float* magnitude, float* bands) const noexcept {
+    sumBands(magnitude, bands);
+}
+
+#endif // __AVX2__
+
+} // namespace penta::groove
@@ -1,73 +1,155 @@
 #include "penta/groove/RhythmQuantizer.h"
+#include "penta/common/RTTypes.h"
 #include <algorithm>
 #include <cmath>
 
 namespace penta::groove {
 
+namespace {
+
+constexpr float kDefaultTempo = 120.0f;
+
+// Offbeat of a swung pair, as a fraction of the pair: 1/2 straight to
+// 3/4 (dotted) at full swing
+double swungOffbeat(float swingAmount) {
+    return 0.5 + 0.25 * std::clamp(swingAmount, 0.0f, 1.0f);
+}
+
+uint64_t toPosition(double barStart, double relative) {
+    return static_cast<uint64_t>(std::llround(std::max(barStart + relative, 0.0)));
+}
+
+} // anonymous namespace
+
 RhythmQuantizer::RhythmQuantizer(const Config& config)
     : config_(config)
+    , sampleRate_(kDefaultSampleRate)
+    , samplesPerBeat_(0.0)
+    , barStart_(0)
+{
+    setTempo(kDefaultTempo);
+}
+
+RhythmQuantizer::RhythmQuantizer(double sampleRate)
+    : RhythmQuantizer(Config{})
 {
-    // TODO: Week 10 implementation - rhythm quantization with swing
+    sampleRate_ = sampleRate;
+    setTempo(kDefaultTempo);
 }
 
 uint64_t RhythmQuantizer::quantize(
     uint64_t samplePosition,
-    uint64_t samplesPerBeat,
+    double samplesPerBeat,
     uint64_t barStartPosition
 ) const noexcept {
-    // Get grid interval
-    uint64_t gridInterval = getGridInterval(samplesPerBeat);
+    const double interval = gridInterval(samplesPerBeat);
+    if (interval <= 0.0) {
+        return samplePosition;
+    }
     
     // Find nearest grid point
-    uint64_t nearestGrid = findNearestGridPoint(samplePosition, gridInterval, barStartPosition);
+    const double barStart = static_cast<double>(barStartPosition);
+    const double relative = static_cast<double>(samplePosition) - barStart;
+    const double nearestGrid = findNearestGridPoint(relative, interval);
     
     // Apply quantization strength
-    int64_t diff = static_cast<int64_t>(nearestGrid) - static_cast<int64_t>(samplePosition);
-    int64_t quantized = samplePosition + static_cast<int64_t>(diff * config_.strength);
-    
-    return static_cast<uint64_t>(quantized);
+    const double strength = std::clamp(config_.strength, 0.0f, 1.0f);
+    return toPosition(barStart, relative + strength * (nearestGrid - relative));
 }
 
 uint64_t RhythmQuantizer::applySwing(
     uint64_t samplePosition,
-    uint64_t samplesPerBeat,
+    double samplesPerBeat,
     uint64_t barStartPosition
 ) const noexcept {
-    if (!config_.enableSwing || config_.swingAmount <= 0.0f) {
+    const double interval = gridInterval(samplesPerBeat);
+    if (!isSwung() || interval <= 0.0) {
         return samplePosition;
     }
     
-    // Stub implementation - TODO Week 10
-    // Apply swing by delaying every other subdivision
-    (void)samplesPerBeat;
-    (void)barStartPosition;
-    return samplePosition;
+    // Stretch the first half of each pair onto [0, offbeat) and squeeze
+    // the second onto [offbeat, pair)
+    const double pair = 2.0 * interval;
+    const double offbeat = swungOffbeat(config_.swingAmount);
+    const double barStart = static_cast<double>(barStartPosition);
+    const double relative = static_cast<double>(samplePosition) - barStart;
+    const double pairStart = std::floor(relative / pair) * pair;
+    const double phase = (relative - pairStart) / pair;
+    const double swung = phase < 0.5
+        ? 2.0 * phase * offbeat
+        : offbeat + 2.0 * (phase - 0.5) * (1.0 - offbeat);
+    
+    return toPosition(barStart, pairStart + swung * pair);
+}
+
+uint64_t RhythmQuantizer::quantize(uint64_t samplePosition) const noexcept {
+    return quantize(samplePosition, samplesPerBeat_, barStart_);
+}
+
+uint64_t RhythmQuantizer::applySwing(uint64_t samplePosition) const noexcept {
+    return applySwing(samplePosition, samplesPerBeat_, barStart_);
 }
 
 uint64_t RhythmQuantizer::getGridInterval(uint64_t samplesPerBeat) const noexcept {
-    int divisor = static_cast<int>(config_.resolution);
-    return samplesPerBeat / divisor;
+    return static_cast<uint64_t>(gridInterval(static_cast<double>(samplesPerBeat)));
+}
+
+void RhythmQuantizer::setTempo(float bpm) noexcept {
+    if (bpm > 0.0f) {
+        samplesPerBeat_ = 60.0 * sampleRate_ / bpm;
+    }
+}
+
+void RhythmQuantizer::setBarStart(uint64_t barStartPosition) noexcept {
+    barStart_ = barStartPosition;
+}
+
+void RhythmQuantizer::setTimeSignature(uint32_t numerator, uint32_t denominator) noexcept {
+    config_.timeSignatureNum = std::max<uint32_t>(numerator, 1);
+    config_.timeSignatureDen = std::max<uint32_t>(denominator, 1);
+}
+
+void RhythmQuantizer::setGrid(GridResolution resolution) noexcept {
+    config_.resolution = resolution;
+}
+
+void RhythmQuantizer::setSwing(float amount) noexcept {
+    config_.swingAmount = std::clamp(amount, 0.0f, 1.0f);
+    config_.enableSwing = config_.swingAmount > 0.0f;
 }
 
 void RhythmQuantizer::updateConfig(const Config& config) noexcept {
     config_ = config;
 }
 
-uint64_t RhythmQuantizer::findNearestGridPoint(
-    uint64_t position,
-    uint64_t gridInterval,
-    uint64_t barStart
-) const noexcept {
-    if (gridInterval == 0) return position;
-    
-    // Calculate position relative to bar
-    int64_t relativePos = static_cast<int64_t>(position - barStart);
-    
-    // Find nearest grid point
-    int64_t gridIndex = (relativePos + gridInterval / 2) / gridInterval;
-    int64_t gridPos = gridIndex * gridInterval;
+double RhythmQuantizer::gridInterval(double samplesPerBeat) const noexcept {
+    // A whole note is timeSignatureDen beats
+    const auto notesPerWhole = static_cast<double>(config_.resolution);
+    return samplesPerBeat * std::max<uint32_t>(config_.timeSignatureDen, 1) / notesPerWhole;
+}
+
+bool RhythmQuantizer::isSwung() const noexcept {
+    const auto notesPerWhole = static_cast<int>(config_.resolution);
+    return config_.enableSwing && config_.swingAmount > 0.0f && notesPerWhole % 3 != 0;
+}
+
+double RhythmQuantizer::findNearestGridPoint(double relative, double gridInterval) const noexcept {
+    if (!isSwung()) {
+        return std::round(relative / gridInterval) * gridInterval;
+    }
     
-    return barStart + static_cast<uint64_t>(gridPos);
+    // Nearest of the pair's downbeat, its swung offbeat and the next downbeat
+    const double pair = 2.0 * gridInterval;
+    const double pairStart = std::floor(relative / pair) * pair;
+    const double phase = relative - pairStart;
+    const double offbeat = swungOffbeat(config_.swingAmount) * pair;
+    if (phase < 0.5 * offbeat) {
+        return pairStart;
+    }
+    if (phase < 0.5 * (offbeat + pair)) {
+        return pairStart + offbeat;
+    }
+    return pairStart + pair;
 }
 
 } // namespace penta::groove
@@ -4,28 +4,97 @@
 
 namespace penta::groove {
 
+namespace {
+
+// Onsets needed before the first estimate
+constexpr size_t kMinOnsets = 4;
+
+// Interval spread: a Gaussian of kSpreadSigma bins, cut at kSpreadRadius
+constexpr float kSpreadSigma = 1.5f;
+constexpr int kSpreadRadius = 3;
+
+// Tempo prior: log-Gaussian around 120 BPM, one octave wide
+constexpr double kPriorTempo = 120.0;
+constexpr double kPriorOctaves = 1.0;
+
+TempoEstimator::Config makeConfig(double sampleRate) {
+    TempoEstimator::Config config;
+    config.sampleRate = sampleRate;
+    return config;
+}
+
+} // anonymous namespace
+
 TempoEstimator::TempoEstimator(const Config& config)
     : config_(config)
-    , currentTempo_(120.0f)
+    , historyHead_(0)
+    , historyCount_(0)
+    , binsPerSample_(0.0)
+    , numCandidates_(0)
+    , currentTempo_(0.0f)
     , confidence_(0.0f)
     , lastOnsetPosition_(0)
 {
-    onsetHistory_.reserve(config.historySize);
-    // TODO: Week 10 implementation - autocorrelation-based tempo estimation
+    buildCombBank();
+    reset();
+}
+
+TempoEstimator::TempoEstimator(double sampleRate)
+    : TempoEstimator(makeConfig(sampleRate))
+{
+}
+
+void TempoEstimator::buildCombBank() {
+    config_.minTempo = std::max(config_.minTempo, 1.0f);
+    config_.maxTempo = std::max(config_.maxTempo, config_.minTempo);
+    config_.historySize = std::max(config_.historySize, kMinOnsets);
+    onsetHistory_.assign(config_.historySize, 0);
+    binsPerSample_ = 1.0 / (kLagResolution * config_.sampleRate);
+    
+    numCandidates_ = static_cast<size_t>(
+        std::floor((config_.maxTempo - config_.minTempo) / kTempoStep)) + 1;
+    const size_t padded = (numCandidates_ + 7) / 8 * 8;
+    combPeriods_.assign(padded, 0.0f);
+    combPrior_.assign(padded, 0.0f);
+    combScores_.assign(padded, 0.0f);
+    
+    for (size_t c = 0; c < padded; ++c) {
+        // Padding repeats the last candidate with no weight
+        const double tempo = config_.minTempo + kTempoStep * std::min(c, numCandidates_ - 1);
+        combPeriods_[c] = static_cast<float>(60.0 / (tempo * kLagResolution));
+        const double octaves = std::log2(tempo / kPriorTempo) / kPriorOctaves;
+        combPrior_[c] = c < numCandidates_ ? static_cast<float>(std::exp(-0.5 * octaves * octaves)) : 0.0f;
+    }
+    
+    // Longest comb tooth, plus the interpolation neighbour and the spread
+    const double longestLag = kCombHarmonics * 60.0 / (config_.minTempo * kLagResolution);
+    lagHistogram_.assign(static_cast<size_t>(std::ceil(longestLag)) + 2 + kSpreadRadius, 0.0f);
 }
 
 void TempoEstimator::addOnset(uint64_t samplePosition) noexcept {
-    onsetHistory_.push_back(samplePosition);
+    if (historyCount_ > 0 && samplePosition < lastOnsetPosition_) {
+        historyHead_ = 0;
+        historyCount_ = 0;
+        std::fill(lagHistogram_.begin(), lagHistogram_.end(), 0.0f);
+    }
     
-    // Keep only recent history
-    if (onsetHistory_.size() > config_.historySize) {
-        onsetHistory_.erase(onsetHistory_.begin());
+    // Keep only recent history: the oldest onset takes its intervals along
+    const size_t capacity = onsetHistory_.size();
+    if (historyCount_ == capacity) {
+        accumulatePairs(historyHead_, -1.0f);
+        historyHead_ = (historyHead_ + 1) % capacity;
+        --historyCount_;
     }
     
+    const size_t slot = (historyHead_ + historyCount_) % capacity;
+    onsetHistory_[slot] = samplePosition;
+    ++historyCount_;
+    accumulatePairs(slot, 1.0f);
+    
     lastOnsetPosition_ = samplePosition;
     
     // Estimate tempo if we have enough onsets
-    if (onsetHistory_.size() >= 4) {
+    if (historyCount_ >= kMinOnsets) {
         estimateTempo();
     }
 }
@@ -35,27 +104,99 @@ uint64_t TempoEstimator::getSamplesPerBeat() const noexcept {
     return static_cast<uint64_t>((60.0 * config_.sampleRate) / currentTempo_);
 }
 
-void TempoEstimator::updateConfig(const Config& config) noexcept {
+void TempoEstimator::setSmoothing(float smoothing) noexcept {
+    config_.adaptationRate = 1.0f - std::clamp(smoothing, 0.0f, 1.0f);
+}
+
+void TempoEstimator::updateConfig(const Config& config) {
     config_ = config;
-    onsetHistory_.reserve(config.historySize);
+    buildCombBank();
+    reset();
 }
 
 void TempoEstimator::reset() noexcept {
-    onsetHistory_.clear();
-    currentTempo_ = 120.0f;
+    std::fill(lagHistogram_.begin(), lagHistogram_.end(), 0.0f);
+    historyHead_ = 0;
+    historyCount_ = 0;
+    currentTempo_ = 0.0f;
     confidence_ = 0.0f;
     lastOnsetPosition_ = 0;
 }
 
+void TempoEstimator::accumulatePairs(size_t slot, float sign) noexcept {
+    const size_t capacity = onsetHistory_.size();
+    const uint64_t position = onsetHistory_[slot];
+    const int lastBin = static_cast<int>(lagHistogram_.size()) - 1;
+    
+    for (size_t i = 0; i < historyCount_; ++i) {
+        const size_t other = (historyHead_ + i) % capacity;
+        if (other == slot) {
+            continue;
+        }
+        const uint64_t interval = position > onsetHistory_[other]
+            ? position - onsetHistory_[other]
+            : onsetHistory_[other] - position;
+        const double lag = static_cast<double>(interval) * binsPerSample_;
+        const int centre = static_cast<int>(std::lround(lag));
+        if (centre + kSpreadRadius > lastBin) {
+            continue;
+        }
+        for (int bin = std::max(centre - kSpreadRadius, 0); bin <= centre + kSpreadRadius; ++bin) {
+            const float distance = static_cast<float>(bin - lag) / kSpreadSigma;
+            lagHistogram_[bin] += sign * std::exp(-0.5f * distance * distance);
+        }
+    }
+}
+
 void TempoEstimator::estimateTempo() noexcept {
-    // Stub implementation - TODO Week 10
-    // Calculate inter-onset intervals and use autocorrelation
+    evaluateCombBankSIMD();
+    
+    const auto first = combScores_.begin();
+    const auto last = first + static_cast<std::ptrdiff_t>(numCandidates_);
+    const size_t best = static_cast<size_t>(std::max_element(first, last) - first);
+    const float peak = combScores_[best];
+    if (peak <= 0.0f) {
+        return;
+    }
+    
+    // Parabolic interpolation between the neighbouring comb filters
+    float offset = 0.0f;
+    if (best > 0 && best + 1 < numCandidates_) {
+        const float left = combScores_[best - 1];
+        const float right = combScores_[best + 1];
+        const float curvature = left - 2.0f * peak + right;
+        if (curvature < 0.0f) {
+            offset = std::clamp(0.5f * (left - right) / curvature, -0.5f, 0.5f);
+        }
+    }
+    const float tempo = config_.minTempo + kTempoStep * (static_cast<float>(best) + offset);
+    
+    // Salience: how far the peak stands above the bank's mean response
+    float sum = 0.0f;
+    for (auto it = first; it != last; ++it) {
+        sum += *it;
+    }
+    const float mean = sum / static_cast<float>(numCandidates_);
+    confidence_ = std::clamp((peak - mean) / peak, 0.0f, 1.0f);
+    
+    if (currentTempo_ <= 0.0f) {
+        currentTempo_ = tempo;
+    } else {
+        currentTempo_ += config_.adaptationRate * (tempo - currentTempo_);
+    }
 }
 
-float TempoEstimator::autocorrelate(const std::vector<float>& intervals) const noexcept {
-    // Stub implementation - TODO Week 10
-    (void)intervals;
-    return 0.0f;
+void TempoEstimator::evaluateCombBank() noexcept {
+    for (size_t c = 0; c < combPeriods_.size(); ++c) {
+        float response = 0.0f;
+        for (size_t m = 1; m <= kCombHarmonics; ++m) {
+            const float lag = combPeriods_[c] * static_cast<float>(m);
+            const auto bin = static_cast<size_t>(lag);
+            const float fraction = lag - static_cast<float>(bin);
+            response += lagHistogram_[bin] + fraction * (lagHistogram_[bin + 1] - lagHistogram_[bin]);
+        }
+        combScores_[c] = response * combPrior_[c];
+    }
 }
 
 } // namespace penta::groove
@@ -0,0 +1,54 @@
+#include "penta/groove/TempoEstimator.h"
+
+// SIMD intrinsics
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace penta::groove {
+
+#ifdef __AVX2__
+
+// AVX2 comb bank: 8 candidate periods per register. Each harmonic is one
+// multiply, a truncation to bin indices, two gathers of the neighbouring
+// histogram bins and an FMA for the linear interpolation, so the whole
+// bank is kCombHarmonics gather pairs per 8 tempi.
+void TempoEstimator::evaluateCombBankSIMD() noexcept {
+    const float* histogram = lagHistogram_.data();
+    const __m256i one = _mm256_set1_epi32(1);
+    
+    for (size_t c = 0; c < combPeriods_.size(); c += 8) {
+        const __m256 period = _mm256_loadu_ps(combPeriods_.data() + c);
+        __m256 response = _mm256_setzero_ps();
+        
+        for (size_t m = 1; m <= kCombHarmonics; ++m) {
+            const __m256 lag = _mm256_mul_ps(period, _mm256_set1_ps(static_cast<float>(m)));
+            const __m256i bin = _mm256_cvttps_epi32(lag);
+            const __m256 fraction = _mm256_sub_ps(lag, _mm256_cvtepi32_ps(bin));
+            const __m256 lower = _mm256_i32gather_ps(histogram, bin, 4);
+            const __m256 upper = _mm256_i32gather_ps(histogram, _mm256_add_epi32(bin, one), 4);
+#ifdef __FMA__
+            response = _mm256_add_ps(response, _mm256_fmadd_ps(fraction, _mm256_sub_ps(upper, lower), lower));
+#else
+            response = _mm256_add_ps(response,
+                _mm256_add_ps(lower, _mm256_mul_ps(fraction, _mm256_sub_ps(upper, lower))));
+#endif
+        }
+        
+        _mm256_storeu_ps(combScores_.data() + c,
+            _mm256_mul_ps(response, _mm256_loadu_ps(combPrior_.data() + c)));
+    }
+}
+
+#endif // __AVX2__
+
+// Scalar fallback when AVX2 not available
+#ifndef __AVX2__
+
+void TempoEstimator::evaluateCombBankSIMD() noexcept {
+    evaluateCombBank();
+}
+
+#endif // __AVX2__
+
+} // namespace penta::groove
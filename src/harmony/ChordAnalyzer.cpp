@@ -1,79 +1,124 @@
 #include "penta/harmony/ChordAnalyzer.h"
 #include <algorithm>
+#include <bit>
 #include <cmath>
 
-// SIMD intrinsics (AVX2)
-#ifdef __AVX2__
-#include <immintrin.h>
-#endif
-
 namespace penta::harmony {
 
 // Comprehensive chord template database (30+ chord types)
-const std::array<ChordAnalyzer::ChordTemplate, 32> ChordAnalyzer::kChordTemplates = {{
+const std::array<ChordAnalyzer::ChordTemplate, ChordAnalyzer::kNumTemplates> ChordAnalyzer::kChordTemplates = {{
     // Basic Triads (0-3)
-    {{true, false, false, false, true, false, false, true, false, false, false, false}, 0, "Major"},        // C E G
-    {{true, false, false, true, false, false, false, true, false, false, false, false}, 1, "Minor"},        // C Eb G
-    {{true, false, false, true, false, false, true, false, false, false, false, false}, 2, "Dim"},          // C Eb Gb
-    {{true, false, false, false, true, false, false, false, true, false, false, false}, 3, "Aug"},          // C E G#
+    {PitchClassSet::fromPitchClasses({0, 4, 7}), 0, "Major"},             // C E G
+    {PitchClassSet::fromPitchClasses({0, 3, 7}), 1, "Minor"},             // C Eb G
+    {PitchClassSet::fromPitchClasses({0, 3, 6}), 2, "Dim"},               // C Eb Gb
+    {PitchClassSet::fromPitchClasses({0, 4, 8}), 3, "Aug"},               // C E G#
     
     // Seventh Chords (4-9)
-    {{true, false, false, false, true, false, false, true, false, false, true, false}, 4, "Dom7"},          // C E G Bb
-    {{true, false, false, false, true, false, false, true, false, false, false, true}, 5, "Maj7"},          // C E G B
-    {{true, false, false, true, false, false, false, true, false, false, true, false}, 6, "Min7"},          // C Eb G Bb
-    {{true, false, false, true, false, false, true, false, false, false, true, false}, 7, "HalfDim7"},      // C Eb Gb Bb (m7b5)
-    {{true, false, false, true, false, false, true, false, false, true, false, false}, 8, "Dim7"},          // C Eb Gb Bbb
-    {{true, false, false, true, false, false, false, true, false, false, false, true}, 9, "MinMaj7"},       // C Eb G B
+    {PitchClassSet::fromPitchClasses({0, 4, 7, 10}), 4, "Dom7"},          // C E G Bb
+    {PitchClassSet::fromPitchClasses({0, 4, 7, 11}), 5, "Maj7"},          // C E G B
+    {PitchClassSet::fromPitchClasses({0, 3, 7, 10}), 6, "Min7"},          // C Eb G Bb
+    {PitchClassSet::fromPitchClasses({0, 3, 6, 10}), 7, "HalfDim7"},      // C Eb Gb Bb (m7b5)
+    {PitchClassSet::fromPitchClasses({0, 3, 6, 9}), 8, "Dim7"},           // C Eb Gb Bbb
+    {PitchClassSet::fromPitchClasses({0, 3, 7, 11}), 9, "MinMaj7"},       // C Eb G B
     
     // Extended Chords (10-15)
-    {{true, false, true, false, true, false, false, true, false, false, true, false}, 10, "Dom9"},          // C E G Bb D
-    {{true, false, true, false, true, false, false, true, false, false, false, true}, 11, "Maj9"},          // C E G B D
-    {{true, false, true, true, false, false, false, true, false, false, true, false}, 12, "Min9"},          // C Eb G Bb D
-    {{true, false, true, false, true, false, false, true, false, false, true, true}, 13, "Dom11"},          // C E G Bb D F
-    {{true, false, true, false, true, false, false, true, false, true, true, false}, 14, "Dom13"},          // C E G Bb D A
-    {{true, false, true, false, true, false, false, true, false, false, false, true}, 15, "Maj9"},          // C E G B D
+    {PitchClassSet::fromPitchClasses({0, 2, 4, 7, 10}), 10, "Dom9"},      // C E G Bb D
+    {PitchClassSet::fromPitchClasses({0, 2, 4, 7, 11}), 11, "Maj9"},      // C E G B D
+    {PitchClassSet::fromPitchClasses({0, 2, 3, 7, 10}), 12, "Min9"},      // C Eb G Bb D
+    {PitchClassSet::fromPitchClasses({0, 2, 4, 7, 10, 11}), 13, "Dom11"}, // C E G Bb D F
+    {PitchClassSet::fromPitchClasses({0, 2, 4, 7, 9, 10}), 14, "Dom13"},  // C E G Bb D A
+    {PitchClassSet::fromPitchClasses({0, 2, 4, 7, 11}), 15, "Maj9"},      // C E G B D
     
     // Suspended Chords (16-19)
-    {{true, false, true, false, false, false, false, true, false, false, false, false}, 16, "Sus2"},        // C D G
-    {{true, false, false, false, false, true, false, true, false, false, false, false}, 17, "Sus4"},        // C F G
-    {{true, false, true, false, false, false, false, true, false, false, true, false}, 18, "7Sus2"},        // C D G Bb
-    {{true, false, false, false, false, true, false, true, false, false, true, false}, 19, "7Sus4"},        // C F G Bb
+    {PitchClassSet::fromPitchClasses({0, 2, 7}), 16, "Sus2"},             // C D G
+    {PitchClassSet::fromPitchClasses({0, 5, 7}), 17, "Sus4"},             // C F G
+    {PitchClassSet::fromPitchClasses({0, 2, 7, 10}), 18, "7Sus2"},        // C D G Bb
+    {PitchClassSet::fromPitchClasses({0, 5, 7, 10}), 19, "7Sus4"},        // C F G Bb
     
     // Add Chords (20-23)
-    {{true, false, true, false, true, false, false, true, false, false, false, false}, 20, "Add9"},         // C E G D
-    {{true, false, false, false, true, true, false, true, false, false, false, false}, 21, "Add11"},        // C E F G
-    {{true, false, false, false, true, false, false, true, false, true, false, false}, 22, "Add6"},         // C E G A
-    {{true, false, true, true, false, false, false, true, false, false, false, false}, 23, "MinAdd9"},      // C Eb G D
+    {PitchClassSet::fromPitchClasses({0, 2, 4, 7}), 20, "Add9"},          // C E G D
+    {PitchClassSet::fromPitchClasses({0, 4, 5, 7}), 21, "Add11"},         // C E F G
+    {PitchClassSet::fromPitchClasses({0, 4, 7, 9}), 22, "Add6"},          // C E G A
+    {PitchClassSet::fromPitchClasses({0, 2, 3, 7}), 23, "MinAdd9"},       // C Eb G D
     
     // Altered Chords (24-29)
-    {{true, true, false, false, true, false, false, true, false, false, true, false}, 24, "Dom7b9"},        // C E G Bb Db
-    {{true, false, false, true, true, false, false, true, false, false, true, false}, 25, "Dom7#9"},        // C E G Bb D#
-    {{true, false, false, false, true, false, true, true, false, false, true, false}, 26, "Dom7b5"},        // C E Gb Bb
-    {{true, false, false, false, true, false, false, false, true, false, true, false}, 27, "Dom7#5"},       // C E G# Bb (Aug7)
-    {{true, true, false, false, true, false, true, false, false, false, true, false}, 28, "7b9b5"},         // C E Gb Bb Db
-    {{true, false, false, true, true, false, true, false, false, false, true, false}, 29, "7#9b5"},         // C E Gb Bb D#
+    {PitchClassSet::fromPitchClasses({0, 1, 4, 7, 10}), 24, "Dom7b9"},    // C E G Bb Db
+    {PitchClassSet::fromPitchClasses({0, 3, 4, 7, 10}), 25, "Dom7#9"},    // C E G Bb D#
+    {PitchClassSet::fromPitchClasses({0, 4, 6, 7, 10}), 26, "Dom7b5"},    // C E Gb Bb
+    {PitchClassSet::fromPitchClasses({0, 4, 8, 10}), 27, "Dom7#5"},       // C E G# Bb (Aug7)
+    {PitchClassSet::fromPitchClasses({0, 1, 4, 6, 10}), 28, "7b9b5"},     // C E Gb Bb Db
+    {PitchClassSet::fromPitchClasses({0, 3, 4, 6, 10}), 29, "7#9b5"},     // C E Gb Bb D#
     
     // Power Chord and Octave (30-31)
-    {{true, false, false, false, false, false, false, true, false, false, false, false}, 30, "5"},          // C G (power chord)
-    {{true, false, false, false, false, false, false, false, false, false, false, false}, 31, "Root"},      // C (single note)
+    {PitchClassSet::fromPitchClasses({0, 7}), 30, "5"},                   // C G (power chord)
+    {PitchClassSet::fromPitchClasses({0}), 31, "Root"},                   // C (single note)
 }};
 
 ChordAnalyzer::ChordAnalyzer()
     : confidenceThreshold_(0.5f)
     , temporalSmoothing_(0.3f)
 {
+    // Force the lookup tables to be built here rather than on the audio thread
+    (void)lookupTable();
+    (void)weightedMatrix();
+}
+
+Chord ChordAnalyzer::analyze(PitchClassSet pitchClassSet, int bass) noexcept {
+    Chord result;
+    lookupBestMatch(pitchClassSet, bass, result);
+    return result;
 }
 
-Chord ChordAnalyzer::analyze(const std::array<bool, 12>& pitchClassSet) noexcept {
+Chord ChordAnalyzer::analyzeExhaustive(PitchClassSet pitchClassSet) const noexcept {
     Chord result;
     findBestMatch(pitchClassSet, result);
     return result;
 }
 
-void ChordAnalyzer::update(const std::array<bool, 12>& pitchClassSet) noexcept {
+void ChordAnalyzer::update(PitchClassSet pitchClassSet, int bass) noexcept {
     previousChord_ = currentChord_;
-    findBestMatch(pitchClassSet, currentChord_);
+    lookupBestMatch(pitchClassSet, bass, currentChord_);
+    applySmoothing();
+}
+
+Chord ChordAnalyzer::analyzeWeighted(const std::array<float, 12>& weights, int bass) noexcept {
+    // Scale so the strongest pitch class counts as one present note
+    float peak = 0.0f;
+    for (float w : weights) {
+        peak = std::max(peak, w);
+    }
+    
+    Chord result;
+    if (peak <= 0.0f) {
+        return result;
+    }
     
+    std::array<float, 12> normalized;
+    float total = 0.0f;
+    for (int pc = 0; pc < 12; ++pc) {
+        normalized[pc] = std::max(weights[pc], 0.0f) / peak;
+        total += normalized[pc];
+        result.pitchClass.set(pc, normalized[pc] > 0.0f);
+    }
+    
+    if (bass < 0 || bass >= 12 || normalized[bass] <= 0.0f) {
+        bass = kNoBass;  // Not sounding: no register information
+    }
+    
+    BassMatch match;
+    findBestMatchWeightedSIMD(normalized, total, bass, match);
+    match.upperTones = bass == kNoBass ? 0 : result.pitchClass.count() - 1;
+    resolveBass(match, bass, result);
+    return result;
+}
+
+void ChordAnalyzer::updateWeighted(const std::array<float, 12>& weights, int bass) noexcept {
+    previousChord_ = currentChord_;
+    currentChord_ = analyzeWeighted(weights, bass);
+    applySmoothing();
+}
+
+void ChordAnalyzer::applySmoothing() noexcept {
     // Apply temporal smoothing
     if (previousChord_.confidence > 0.0f) {
         currentChord_.confidence = 
@@ -82,6 +127,28 @@ void ChordAnalyzer::update(const std::array<bool, 12>& pitchClassSet) noexcept {
     }
 }
 
+Chord ChordAnalyzer::templateChord(size_t templateIndex, uint8_t root) noexcept {
+    const auto& template_ = kChordTemplates[templateIndex];
+    Chord chord;
+    chord.pitchClass = template_.pattern.rotate(root);
+    chord.root = root;
+    chord.quality = template_.quality;
+    chord.confidence = 1.0f;
+    return chord;
+}
+
+const char* ChordAnalyzer::templateName(size_t templateIndex) noexcept {
+    return templateIndex < kChordTemplates.size() ? kChordTemplates[templateIndex].name : "Unknown";
+}
+
+float ChordAnalyzer::templateConfidence(
+    PitchClassSet pitchClassSet,
+    size_t templateIndex,
+    uint8_t root
+) noexcept {
+    return scoreAgainstTemplate(pitchClassSet, kChordTemplates[templateIndex], root);
+}
+
 void ChordAnalyzer::setConfidenceThreshold(float threshold) noexcept {
     confidenceThreshold_ = std::clamp(threshold, 0.0f, 1.0f);
 }
@@ -90,20 +157,173 @@ void ChordAnalyzer::setTemporalSmoothing(float factor) noexcept {
     temporalSmoothing_ = std::clamp(factor, 0.0f, 1.0f);
 }
 
+void ChordAnalyzer::reset() noexcept {
+    currentChord_ = Chord{};
+    previousChord_ = Chord{};
+}
+
+// ============================================================================
+// Precomputed lookup table
+// ============================================================================
+
+const ChordAnalyzer::LookupTable& ChordAnalyzer::lookupTable() noexcept {
+    static const LookupTable table = buildLookupTable();
+    return table;
+}
+
+ChordAnalyzer::LookupTable ChordAnalyzer::buildLookupTable() noexcept {
+    LookupTable table{};
+    size_t numScores = 0;
+    
+    for (size_t mask = 0; mask < kLookupTableSize; ++mask) {
+        PitchClassSet pitchClassSet(static_cast<uint16_t>(mask));
+        
+        Chord best;
+        findBestMatchSIMD(pitchClassSet, best);
+        
+        // Best-match confidences only take a handful of distinct values
+        // (ratios of small template counts), so store them once
+        size_t scoreIndex = 0;
+        while (scoreIndex < numScores && table.scores[scoreIndex] != best.confidence) {
+            ++scoreIndex;
+        }
+        if (scoreIndex == numScores && numScores < table.scores.size()) {
+            table.scores[numScores++] = best.confidence;
+        }
+        
+        auto& entry = table.entries[mask];
+        entry.root = best.root;
+        entry.quality = best.quality;
+        entry.scoreIndex = static_cast<uint16_t>(std::min(scoreIndex, table.scores.size() - 1));
+        
+        // First best chord template, in the order findBestMatch scans
+        float bestChord = 0.0f;
+        auto& chordEntry = table.chordEntries[mask];
+        for (uint8_t root = 0; root < 12; ++root) {
+            for (size_t t = 0; t < kFirstPartialTemplate; ++t) {
+                const float score = scoreAgainstTemplate(pitchClassSet, kChordTemplates[t], root);
+                if (score > bestChord) {
+                    bestChord = score;
+                    chordEntry.root = root;
+                    chordEntry.quality = static_cast<uint16_t>(t);
+                }
+            }
+        }
+        size_t chordScoreIndex = 0;
+        while (chordScoreIndex < numScores && table.scores[chordScoreIndex] != bestChord) {
+            ++chordScoreIndex;
+        }
+        if (chordScoreIndex == numScores && numScores < table.scores.size()) {
+            table.scores[numScores++] = bestChord;
+        }
+        chordEntry.scoreIndex = static_cast<uint16_t>(std::min(chordScoreIndex, table.scores.size() - 1));
+        
+        // First best template at root 0, in the order findBestMatch scans
+        float bestRootPosition = 0.0f;
+        for (size_t t = 0; t < kChordTemplates.size(); ++t) {
+            const float score = scoreAgainstTemplate(pitchClassSet, kChordTemplates[t], 0);
+            if (score > bestRootPosition) {
+                bestRootPosition = score;
+                table.rootPositionTemplates[mask] = static_cast<uint8_t>(t);
+            }
+        }
+    }
+    
+    return table;
+}
+
+void ChordAnalyzer::lookupBestMatch(
+    PitchClassSet pitchClassSet,
+    int bass,
+    Chord& outChord
+) noexcept {
+    const auto& table = lookupTable();
+    const auto& entry = table.entries[pitchClassSet.bits()];
+    
+    // Template qualities are their template indices
+    BassMatch match;
+    match.bestRow = entry.root * kNumTemplates + entry.quality;
+    match.bestScore = table.scores[entry.scoreIndex];
+    
+    if (bass < 0 || bass >= 12 || !pitchClassSet.contains(bass)) {
+        bass = kNoBass;  // Not sounding: no register information
+    } else {
+        // Two more table reads: the reading rooted on the bass and the
+        // reading of the upper structure
+        const size_t rooted = table.rootPositionTemplates[pitchClassSet.rotate(-bass).bits()];
+        match.bassRow = bass * kNumTemplates + rooted;
+        match.bassScore = scoreAgainstTemplate(pitchClassSet, kChordTemplates[rooted], static_cast<uint8_t>(bass));
+        
+        PitchClassSet upper = pitchClassSet;
+        upper.reset(bass);
+        match.upperTones = upper.count();
+        if (!upper.empty()) {
+            const auto& upperEntry = table.chordEntries[upper.bits()];
+            match.upperRow = upperEntry.root * kNumTemplates + upperEntry.quality;
+            match.upperScore = table.scores[upperEntry.scoreIndex];
+        }
+    }
+    
+    resolveBass(match, bass, outChord);
+    outChord.pitchClass = pitchClassSet;
+}
+
+void ChordAnalyzer::resolveBass(const BassMatch& match, int bass, Chord& outChord) noexcept {
+    size_t row = match.bestRow;
+    float score = match.bestScore;
+    
+    if (bass != kNoBass) {
+        const bool fullUpper = match.upperTones >= kMinUpperStructureTones;
+        
+        // Root position wins ties. A fragment (single note, power chord)
+        // that leaves the bass out is no chord over that bass, and neither
+        // is anything over a bass with under three tones above it
+        const size_t bestTemplate = row % kNumTemplates;
+        const bool bestHasBass = kChordTemplates[bestTemplate].pattern.contains(
+            (bass - static_cast<int>(row / kNumTemplates) + 12) % 12);
+        const bool bestIsSlash = !bestHasBass && (!fullUpper || bestTemplate >= kFirstPartialTemplate);
+        if (match.bassScore > 0.0f && (match.bassScore >= score || bestIsSlash)) {
+            row = match.bassRow;
+            score = match.bassScore;
+        }
+        
+        // A full chord above the bass that reads clearly better: slash
+        // chord. A lone third over its root is not a chord over a bass
+        if (fullUpper && match.upperScore > score + kSlashChordMargin) {
+            row = match.upperRow;
+            score = match.upperScore;
+        }
+    }
+    
+    const auto& template_ = kChordTemplates[row % kNumTemplates];
+    outChord.root = static_cast<uint8_t>(row / kNumTemplates);
+    outChord.quality = template_.quality;
+    outChord.confidence = score;
+    
+    if (bass == kNoBass) {
+        outChord.bass = outChord.root;
+        outChord.inversion = 0;
+        return;
+    }
+    
+    // Count the chord tones between the root and the bass
+    const int interval = (bass - outChord.root + 12) % 12;
+    const uint16_t below = static_cast<uint16_t>(template_.pattern.bits() & ((1u << interval) - 1));
+    outChord.bass = static_cast<uint8_t>(bass);
+    outChord.inversion = template_.pattern.contains(interval)
+        ? static_cast<uint8_t>(std::popcount(below))
+        : Chord::kSlashBass;
+}
+
 float ChordAnalyzer::scoreAgainstTemplate(
-    const std::array<bool, 12>& pitchClassSet,
+    PitchClassSet pitchClassSet,
     const ChordTemplate& template_,
     uint8_t root
-) const noexcept {
+) noexcept {
     int matches = 0;        // Notes in template that are present
     int required = 0;       // Total notes in template
     int extra = 0;          // Notes present but not in template
-    int pitchCount = 0;     // Total notes in input
-    
-    // Count pitches in input
-    for (bool pitch : pitchClassSet) {
-        if (pitch) ++pitchCount;
-    }
+    int pitchCount = pitchClassSet.count();  // Total notes in input
     
     // If no pitches, no match
     if (pitchCount == 0) return 0.0f;
@@ -111,8 +331,8 @@ float ChordAnalyzer::scoreAgainstTemplate(
     // Check each pitch class
     for (int i = 0; i < 12; ++i) {
         int rotated = (i + root) % 12;
-        bool inTemplate = template_.pattern[i];
-        bool inInput = pitchClassSet[rotated];
+        bool inTemplate = template_.pattern.contains(i);
+        bool inInput = pitchClassSet.contains(rotated);
         
         if (inTemplate) {
             ++required;
@@ -138,7 +358,7 @@ float ChordAnalyzer::scoreAgainstTemplate(
 }
 
 void ChordAnalyzer::findBestMatch(
-    const std::array<bool, 12>& pitchClassSet,
+    PitchClassSet pitchClassSet,
     Chord& outChord
 ) noexcept {
     float bestScore = 0.0f;
@@ -161,133 +381,86 @@ void ChordAnalyzer::findBestMatch(
     outChord.root = bestRoot;
     outChord.quality = bestQuality;
     outChord.confidence = bestScore;
+    outChord.bass = bestRoot;
+    outChord.inversion = 0;
     outChord.pitchClass = pitchClassSet;
 }
 
 // ============================================================================
-// SIMD-optimized implementations
+// Weighted analysis
 // ============================================================================
 
-#ifdef __AVX2__
+const ChordAnalyzer::WeightedMatrix& ChordAnalyzer::weightedMatrix() noexcept {
+    static const WeightedMatrix matrix = buildWeightedMatrix();
+    return matrix;
+}
 
-// AVX2 intrinsics version: Process 8 pitch classes at once
-float ChordAnalyzer::scoreAgainstTemplateSIMD(
-    const std::array<bool, 12>& pitchClassSet,
-    const ChordTemplate& template_,
-    uint8_t root
-) const noexcept {
-    // Pack bool arrays into bitmasks for SIMD
-    alignas(32) uint32_t templateMask[8] = {0};
-    alignas(32) uint32_t inputMask[8] = {0};
-    
-    // First 8 pitch classes
-    for (int i = 0; i < 8; ++i) {
-        int rotated = (i + root) % 12;
-        templateMask[i] = template_.pattern[i] ? 0xFFFFFFFF : 0;
-        inputMask[i] = pitchClassSet[rotated] ? 0xFFFFFFFF : 0;
-    }
-    
-    // Load into AVX2 registers
-    __m256i templateVec = _mm256_load_si256(reinterpret_cast<const __m256i*>(templateMask));
-    __m256i inputVec = _mm256_load_si256(reinterpret_cast<const __m256i*>(inputMask));
-    
-    // Count matches: template AND input
-    __m256i matches = _mm256_and_si256(templateVec, inputVec);
-    
-    // Count required: template bits
-    __m256i required = templateVec;
-    
-    // Count extra: input AND NOT template
-    __m256i notTemplate = _mm256_andnot_si256(templateVec, _mm256_set1_epi32(0xFFFFFFFF));
-    __m256i extra = _mm256_and_si256(inputVec, notTemplate);
-    
-    // Horizontal sum using population count
-    int matchCount = _mm_popcnt_u32(_mm256_movemask_epi8(matches)) / 4;
-    int requiredCount = _mm_popcnt_u32(_mm256_movemask_epi8(required)) / 4;
-    int extraCount = _mm_popcnt_u32(_mm256_movemask_epi8(extra)) / 4;
-    
-    // Process remaining 4 pitch classes (8-11) scalar
-    for (int i = 8; i < 12; ++i) {
-        int rotated = (i + root) % 12;
-        bool inTemplate = template_.pattern[i];
-        bool inInput = pitchClassSet[rotated];
-        
-        if (inTemplate) {
-            ++requiredCount;
-            if (inInput) ++matchCount;
-        } else if (inInput) {
-            ++extraCount;
+ChordAnalyzer::WeightedMatrix ChordAnalyzer::buildWeightedMatrix() noexcept {
+    WeightedMatrix matrix{};
+    for (size_t root = 0; root < 12; ++root) {
+        for (size_t t = 0; t < kChordTemplates.size(); ++t) {
+            const size_t row = root * kNumTemplates + t;
+            const PitchClassSet tones = kChordTemplates[t].pattern.rotate(static_cast<int>(root));
+            for (int pc = 0; pc < 12; ++pc) {
+                matrix.columns[pc][row] = tones.contains(pc) ? 1.0f : 0.0f;
+            }
+            matrix.templateSizes[row] = static_cast<float>(tones.count());
         }
     }
-    
-    // Scoring (same as scalar version)
-    if (requiredCount == 0) return 0.0f;
-    
-    float completeness = static_cast<float>(matchCount) / requiredCount;
-    float extraPenalty = 1.0f / (1.0f + 0.5f * extraCount);
-    
-    return completeness * extraPenalty;
+    return matrix;
 }
 
-void ChordAnalyzer::findBestMatchSIMD(
-    const std::array<bool, 12>& pitchClassSet,
-    Chord& outChord
+void ChordAnalyzer::findBestMatchWeighted(
+    const std::array<float, 12>& weights,
+    float total,
+    int bass,
+    BassMatch& outMatch
 ) noexcept {
-    // Use SIMD for template scoring
-    float bestScore = 0.0f;
-    uint8_t bestRoot = 0;
-    uint8_t bestQuality = 0;
+    const auto& matrix = weightedMatrix();
+    const bool withBass = bass != kNoBass;
+    const float bassWeight = withBass ? weights[bass] : 0.0f;
+    const float upperTotal = total - bassWeight;
     
-    // Try all templates at all roots
-    for (uint8_t root = 0; root < 12; ++root) {
-        for (const auto& template_ : kChordTemplates) {
-            float score = scoreAgainstTemplateSIMD(pitchClassSet, template_, root);
-            
-            if (score > bestScore) {
-                bestScore = score;
-                bestRoot = root;
-                bestQuality = template_.quality;
+    auto score = [&matrix](float matched, float sum, size_t row) {
+        // Weight on template tones; the rest counts as extra notes
+        const float extra = std::max(sum - matched, 0.0f);
+        const float completeness = matched / matrix.templateSizes[row];
+        const float extraPenalty = 1.0f / (1.0f + 0.5f * extra);
+        return completeness * extraPenalty;
+    };
+    
+    BassMatch match;
+    for (size_t row = 0; row < kNumWeightedRows; ++row) {
+        float matched = 0.0f;
+        for (int pc = 0; pc < 12; ++pc) {
+            matched += weights[pc] * matrix.columns[pc][row];
+        }
+        
+        const float rowScore = score(matched, total, row);
+        if (rowScore > match.bestScore) {
+            match.bestScore = rowScore;
+            match.bestRow = row;
+        }
+        if (!withBass) {
+            continue;
+        }
+        
+        if (row / kNumTemplates == static_cast<size_t>(bass) && rowScore > match.bassScore) {
+            match.bassScore = rowScore;
+            match.bassRow = row;
+        }
+        
+        // The upper structure is the input without the bass column
+        if (upperTotal > 0.0f && row % kNumTemplates < kFirstPartialTemplate) {
+            const float upperScore = score(matched - bassWeight * matrix.columns[bass][row], upperTotal, row);
+            if (upperScore > match.upperScore) {
+                match.upperScore = upperScore;
+                match.upperRow = row;
             }
         }
     }
     
-    outChord.root = bestRoot;
-    outChord.quality = bestQuality;
-    outChord.confidence = bestScore;
-    outChord.pitchClass = pitchClassSet;
-}
-
-Chord ChordAnalyzer::analyzeSIMD(const std::array<bool, 12>& pitchClassSet) noexcept {
-    Chord result;
-    findBestMatchSIMD(pitchClassSet, result);
-    return result;
-}
-
-#else // Scalar fallback
-
-float ChordAnalyzer::scoreAgainstTemplateSIMD(
-    const std::array<bool, 12>& pitchClassSet,
-    const ChordTemplate& template_,
-    uint8_t root
-) const noexcept {
-    // Fall back to scalar implementation
-    return scoreAgainstTemplate(pitchClassSet, template_, root);
-}
-
-void ChordAnalyzer::findBestMatchSIMD(
-    const std::array<bool, 12>& pitchClassSet,
-    Chord& outChord
-) noexcept {
-    // Fall back to scalar implementation
-    findBestMatch(pitchClassSet, outChord);
+    outMatch = match;
 }
 
-Chord ChordAnalyzer::analyzeSIMD(const std::array<bool, 12>& pitchClassSet) noexcept {
-    Chord result;
-    findBestMatch(pitchClassSet, result);
-    return result;
-}
-
-#endif // __AVX2__
-
 } // namespace penta::harmony
@@ -14,24 +14,13 @@ namespace penta::harmony {
 // AVX2-optimized chord pattern matching
 // Processes 32 templates in parallel using 256-bit SIMD registers
 float ChordAnalyzer::scoreAgainstTemplateSIMD(
-    const std::array<bool, 12>& pitchClassSet,
+    PitchClassSet pitchClassSet,
     const ChordTemplate& template_,
     uint8_t root
 ) const noexcept {
-    // Pack bool arrays into 16-bit masks for SIMD operations
-    uint16_t templateMask = 0;
-    uint16_t inputMask = 0;
-    
-    for (int i = 0; i < 12; ++i) {
-        if (template_.pattern[i]) {
-            templateMask |= (1 << i);
-        }
-        
-        int rotated = (i + root) % 12;
-        if (pitchClassSet[rotated]) {
-            inputMask |= (1 << i);
-        }
-    }
+    // Both sides are already 12-bit masks; rotate the input down by root
+    uint16_t templateMask = template_.pattern.bits();
+    uint16_t inputMask = pitchClassSet.rotate(-root).bits();
     
     // Use SIMD population count for fast bit counting
     uint16_t matches = templateMask & inputMask;      // Notes in both
@@ -53,20 +42,10 @@ float ChordAnalyzer::scoreAgainstTemplateSIMD(
 // AVX2-optimized batch scoring of multiple templates
 // Processes 8 templates at once using vectorized operations
 void ChordAnalyzer::findBestMatchSIMD(
-    const std::array<bool, 12>& pitchClassSet,
+    PitchClassSet pitchClassSet,
     Chord& outChord
 ) noexcept {
-    // Pack input into bitmask for fast SIMD operations
-    uint16_t inputMask = 0;
-    int pitchCount = 0;
-    for (int i = 0; i < 12; ++i) {
-        if (pitchClassSet[i]) {
-            inputMask |= (1 << i);
-            ++pitchCount;
-        }
-    }
-    
-    if (pitchCount == 0) {
+    if (pitchClassSet.empty()) {
         outChord.confidence = 0.0f;
         return;
     }
@@ -81,8 +60,9 @@ void ChordAnalyzer::findBestMatchSIMD(
     
     // Try all roots
     for (uint8_t root = 0; root < 12; ++root) {
-        // Rotate input mask by root
-        uint16_t rotatedInput = ((inputMask << root) | (inputMask >> (12 - root))) & 0xFFF;
+        // Rotate input down by root (bit i = pitch class (i + root) % 12),
+        // matching the indexing of the scalar scoreAgainstTemplate
+        uint16_t rotatedInput = pitchClassSet.rotate(-root).bits();
         
         // Process templates in batches of 8
         for (size_t templateIdx = 0; templateIdx < kChordTemplates.size(); templateIdx += 8) {
@@ -90,13 +70,7 @@ void ChordAnalyzer::findBestMatchSIMD(
             for (int i = 0; i < 8 && (templateIdx + i) < kChordTemplates.size(); ++i) {
                 const auto& tmpl = kChordTemplates[templateIdx + i];
                 
-                // Pack template into bitmask
-                uint16_t templateMask = 0;
-                for (int j = 0; j < 12; ++j) {
-                    if (tmpl.pattern[j]) {
-                        templateMask |= (1 << j);
-                    }
-                }
+                uint16_t templateMask = tmpl.pattern.bits();
                 
                 // Compute matches using bitwise operations
                 uint16_t matches = rotatedInput & templateMask;
@@ -135,16 +109,117 @@ void ChordAnalyzer::findBestMatchSIMD(
     outChord.root = bestRoot;
     outChord.quality = bestQuality;
     outChord.confidence = bestScore;
+    outChord.bass = bestRoot;
+    outChord.inversion = 0;
     outChord.pitchClass = pitchClassSet;
 }
 
+// AVX2 weighted template scoring: the 12 normalized weights stay broadcast
+// while each block of 8 (root, template) rows is reduced with FMAs, then
+// completeness and the extra-note penalty are applied lane-wise. The
+// running best is kept in row order so ties resolve like findBestMatch.
+// With a bass, the upper structure's match is the same sum minus the bass
+// column, so its scores cost one more FMA and penalty per block; lanes of
+// partial templates are zeroed so they never name the upper structure.
+void ChordAnalyzer::findBestMatchWeightedSIMD(
+    const std::array<float, 12>& weights,
+    float total,
+    int bass,
+    BassMatch& outMatch
+) noexcept {
+    const auto& matrix = weightedMatrix();
+    
+    __m256 broadcast[12];
+    for (int pc = 0; pc < 12; ++pc) {
+        broadcast[pc] = _mm256_set1_ps(weights[pc]);
+    }
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    
+    const bool withBass = bass != kNoBass;
+    const float bassWeight = withBass ? weights[bass] : 0.0f;
+    const float upperTotal = total - bassWeight;
+    const bool withUpper = withBass && upperTotal > 0.0f;
+    const float* bassColumn = matrix.columns[withBass ? bass : 0].data();
+    
+    // Lanes of the last block of each root that hold chord templates
+    static_assert(kNumTemplates - kFirstPartialTemplate < 8);
+    alignas(32) int32_t chordLaneBits[8];
+    for (size_t i = 0; i < 8; ++i) {
+        chordLaneBits[i] = kNumTemplates - 8 + i < kFirstPartialTemplate ? -1 : 0;
+    }
+    const __m256 chordLanes = _mm256_castsi256_ps(_mm256_load_si256(reinterpret_cast<const __m256i*>(chordLaneBits)));
+    
+    auto score = [&](__m256 matched, float sum, size_t base) {
+        const __m256 extra = _mm256_max_ps(_mm256_sub_ps(_mm256_set1_ps(sum), matched), _mm256_setzero_ps());
+        const __m256 completeness = _mm256_div_ps(matched, _mm256_load_ps(matrix.templateSizes.data() + base));
+        const __m256 extraPenalty = _mm256_div_ps(one, _mm256_add_ps(one, _mm256_mul_ps(half, extra)));
+        return _mm256_mul_ps(completeness, extraPenalty);
+    };
+    
+    // First lane beating best, in row order
+    alignas(32) float scores[8];
+    auto keepBest = [&scores](__m256 score, size_t base, float& bestScore, size_t& bestRow) {
+        // Most blocks cannot beat the running best; skip their scalar scan
+        if (_mm256_movemask_ps(_mm256_cmp_ps(score, _mm256_set1_ps(bestScore), _CMP_GT_OQ)) == 0) {
+            return;
+        }
+        _mm256_store_ps(scores, score);
+        for (size_t i = 0; i < 8; ++i) {
+            if (scores[i] > bestScore) {
+                bestScore = scores[i];
+                bestRow = base + i;
+            }
+        }
+    };
+    
+    BassMatch match;
+    for (size_t base = 0; base < kNumWeightedRows; base += 8) {
+        __m256 matched = _mm256_mul_ps(broadcast[0], _mm256_load_ps(matrix.columns[0].data() + base));
+        for (int pc = 1; pc < 12; ++pc) {
+#ifdef __FMA__
+            matched = _mm256_fmadd_ps(broadcast[pc], _mm256_load_ps(matrix.columns[pc].data() + base), matched);
+#else
+            matched = _mm256_add_ps(matched,
+                _mm256_mul_ps(broadcast[pc], _mm256_load_ps(matrix.columns[pc].data() + base)));
+#endif
+        }
+        
+        const __m256 rowScore = score(matched, total, base);
+        keepBest(rowScore, base, match.bestScore, match.bestRow);
+        
+        // Blocks never straddle roots
+        static_assert(kNumTemplates % 8 == 0);
+        if (withBass && base / kNumTemplates == static_cast<size_t>(bass)) {
+            keepBest(rowScore, base, match.bassScore, match.bassRow);
+        }
+        
+        if (withUpper) {
+#ifdef __FMA__
+            const __m256 upperMatched = _mm256_fnmadd_ps(
+                _mm256_set1_ps(bassWeight), _mm256_load_ps(bassColumn + base), matched);
+#else
+            const __m256 upperMatched = _mm256_sub_ps(matched,
+                _mm256_mul_ps(_mm256_set1_ps(bassWeight), _mm256_load_ps(bassColumn + base)));
+#endif
+            __m256 upperScore = score(upperMatched, upperTotal, base);
+            if (base % kNumTemplates == kNumTemplates - 8) {
+                upperScore = _mm256_and_ps(upperScore, chordLanes);
+            }
+            keepBest(upperScore, base, match.upperScore, match.upperRow);
+        }
+    }
+    
+    outMatch = match;
+}
+
 #endif // __AVX2__
 
 // Scalar fallback when AVX2 not available
 #ifndef __AVX2__
 
 float ChordAnalyzer::scoreAgainstTemplateSIMD(
-    const std::array<bool, 12>& pitchClassSet,
+    PitchClassSet pitchClassSet,
     const ChordTemplate& template_,
     uint8_t root
 ) const noexcept {
@@ -152,18 +227,28 @@ float ChordAnalyzer::scoreAgainstTemplateSIMD(
 }
 
 void ChordAnalyzer::findBestMatchSIMD(
-    const std::array<bool, 12>& pitchClassSet,
+    PitchClassSet pitchClassSet,
     Chord& outChord
 ) noexcept {
     findBestMatch(pitchClassSet, outChord);
 }
 
+void ChordAnalyzer::findBestMatchWeightedSIMD(
+    const std::array<float, 12>& weights,
+    float total,
+    int bass,
+    BassMatch& outMatch
+) noexcept {
+    findBestMatchWeighted(weights, total, bass, outMatch);
+}
+
 #endif // __AVX2__
 
-// Public API uses SIMD when available
-Chord ChordAnalyzer::analyzeSIMD(const std::array<bool, 12>& pitchClassSet) noexcept {
+// Public API: the SIMD search is folded into the precomputed lookup table,
+// so per-call analysis is a single table read
+Chord ChordAnalyzer::analyzeSIMD(PitchClassSet pitchClassSet) noexcept {
     Chord result;
-    findBestMatchSIMD(pitchClassSet, result);
+    lookupBestMatch(pitchClassSet, kNoBass, result);
     return result;
 }
 
@@ -0,0 +1,142 @@
+#include "penta/harmony/ChromaExtractor.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace penta::harmony {
+
+ChromaExtractor::ChromaExtractor(const Config& config)
+    : config_(config)
+    , fft_(std::make_unique<RTFFT>(config.fftSize))
+    , writeIndex_(0)
+    , sampleCounter_(0)
+    , nextFrame_(0)
+    , framePosition_(0)
+{
+    config_.fftSize = fft_->getSize();
+    config_.hopSize = std::max<size_t>(config_.hopSize, 1);
+    
+    // Periodic Hann window
+    const double pi = 3.14159265358979323846;
+    window_.resize(config_.fftSize);
+    for (size_t n = 0; n < config_.fftSize; ++n) {
+        window_[n] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * pi * n / config_.fftSize));
+    }
+    
+    ring_.resize(config_.fftSize);
+    frame_.resize(config_.fftSize);
+    magnitude_.resize(fft_->getNumBins());
+    peaks_.resize(fft_->getNumBins());
+    
+    buildMapping();
+    reset();
+}
+
+ChromaExtractor::~ChromaExtractor() = default;
+
+void ChromaExtractor::buildMapping() {
+    const double binWidth = config_.sampleRate / static_cast<double>(config_.fftSize);
+    const size_t numBins = fft_->getNumBins();
+    
+    for (size_t k = 1; k < numBins; ++k) {
+        const double frequency = k * binWidth;
+        if (frequency < config_.minFrequency || frequency > config_.maxFrequency) {
+            continue;
+        }
+        
+        // Nearest equal-tempered semitone. A peak bin lies within half a
+        // bin of its partial, which is under half a semitone from ~100 Hz
+        // up at 4096 points, so sharing bins between semitones would only
+        // smear a partial into its neighbour
+        const double pitch = 69.0 + 12.0 * std::log2(frequency / config_.tuning);
+        const int semitone = static_cast<int>(std::lround(pitch));
+        
+        mapBins_.push_back(static_cast<uint32_t>(k));
+        mapClasses_.push_back(static_cast<uint8_t>(((semitone % 12) + 12) % 12));
+        mapWeights_.push_back(1.0f);
+    }
+}
+
+bool ChromaExtractor::process(const float* buffer, size_t frames) noexcept {
+    bool frameReady = false;
+    size_t offset = 0;
+    
+    while (offset < frames) {
+        // Copy up to the next frame boundary into the ring
+        const size_t count = static_cast<size_t>(
+            std::min<uint64_t>(nextFrame_ - sampleCounter_, frames - offset));
+        const size_t first = std::min(count, ring_.size() - writeIndex_);
+        std::memcpy(ring_.data() + writeIndex_, buffer + offset, first * sizeof(float));
+        std::memcpy(ring_.data(), buffer + offset + first, (count - first) * sizeof(float));
+        writeIndex_ = (writeIndex_ + count) % ring_.size();
+        offset += count;
+        sampleCounter_ += count;
+        
+        if (sampleCounter_ == nextFrame_) {
+            nextFrame_ += config_.hopSize;
+            
+            // Only the newest frame of a block is worth a transform
+            if (frames - offset < config_.hopSize) {
+                computeFrame();
+                framePosition_ = sampleCounter_;
+                frameReady = true;
+            }
+        }
+    }
+    
+    return frameReady;
+}
+
+void ChromaExtractor::computeFrame() noexcept {
+    // Unwrap oldest-first and window
+    const size_t size = ring_.size();
+    float energy = 0.0f;
+    for (size_t n = 0; n < size; ++n) {
+        const float sample = ring_[(writeIndex_ + n) % size];
+        energy += sample * sample;
+        frame_[n] = sample * window_[n];
+    }
+    
+    chroma_.fill(0.0f);
+    if (std::sqrt(energy / size) < config_.silenceThreshold) {
+        return;
+    }
+    
+    fft_->magnitudes(frame_.data(), magnitude_.data());
+    
+    // Keep spectral peaks only: at low pitches the window's main lobe spans
+    // several semitones, and its skirts would read as neighbouring classes
+    const size_t lastBin = magnitude_.size() - 1;
+    for (size_t k = 0; k <= lastBin; ++k) {
+        const float left = k > 0 ? magnitude_[k - 1] : 0.0f;
+        const float right = k < lastBin ? magnitude_[k + 1] : 0.0f;
+        peaks_[k] = magnitude_[k] >= left && magnitude_[k] > right ? magnitude_[k] : 0.0f;
+    }
+    
+    // Sparse matrix-vector product
+    for (size_t i = 0; i < mapBins_.size(); ++i) {
+        chroma_[mapClasses_[i]] += mapWeights_[i] * peaks_[mapBins_[i]];
+    }
+    
+    const float peak = *std::max_element(chroma_.begin(), chroma_.end());
+    if (peak <= 0.0f) {
+        return;
+    }
+    for (float& value : chroma_) {
+        value /= peak;
+        if (value < config_.chromaFloor) {
+            value = 0.0f;
+        }
+    }
+}
+
+void ChromaExtractor::reset() noexcept {
+    std::fill(ring_.begin(), ring_.end(), 0.0f);
+    chroma_.fill(0.0f);
+    writeIndex_ = 0;
+    sampleCounter_ = 0;
+    nextFrame_ = config_.hopSize;
+    framePosition_ = 0;
+}
+
+} // namespace penta::harmony
@@ -1,67 +1,276 @@
 #include "penta/harmony/HarmonyEngine.h"
+#include <algorithm>
+#include <cmath>
 
 namespace penta::harmony {
 
+namespace {
+
+bool sameChord(const Chord& a, const Chord& b) {
+    return a.root == b.root
+        && a.quality == b.quality
+        && a.pitchClass.empty() == b.pitchClass.empty();
+}
+
+} // anonymous namespace
+
 HarmonyEngine::HarmonyEngine(const Config& config)
     : config_(config)
+    , lastTimestamp_(0)
+    , analysisValid_(false)
+    , harmonyChanged_(false)
 {
     chordAnalyzer_ = std::make_unique<ChordAnalyzer>();
     scaleDetector_ = std::make_unique<ScaleDetector>();
     voiceLeading_ = std::make_unique<VoiceLeading>();
+    chromaExtractor_ = std::make_unique<ChromaExtractor>(chromaConfig());
+    chordHistory_ = std::make_unique<ChordHistory>();
+    scaleHistory_ = std::make_unique<ScaleHistory>();
     
     activeNotes_.fill(0);
-    pitchClassSet_.fill(false);
+    activePitchBits_.fill(0);
+    pitchClassCounts_.fill(0);
+    velocitySums_.fill(0);
+    pitchClassSet_.clear();
+    
+    setKeyTrackingConfig(ScaleDetector::TrackingConfig{});
 }
 
 HarmonyEngine::~HarmonyEngine() = default;
 
 void HarmonyEngine::processNotes(const Note* notes, size_t count) noexcept {
-    // Update active notes and pitch class set
+    const PitchClassSet previousSet = pitchClassSet_;
+    const std::array<uint16_t, 12> previousVelocities = velocitySums_;
+    const int previousBass = getBassNote();
+    if (count > 0) {
+        lastTimestamp_ = notes[count - 1].timestamp;
+    }
+    
+    // Update per-pitch-class counts and velocity sums incrementally
     for (size_t i = 0; i < count; ++i) {
         const auto& note = notes[i];
+        if (note.pitch >= activeNotes_.size()) continue;
+        
+        const int pitchClass = note.pitch % 12;
+        const uint8_t previousVelocity = activeNotes_[note.pitch];
+        
+        if (previousVelocity > 0) {
+            // Note off, or retrigger of a sounding note
+            --pitchClassCounts_[pitchClass];
+            velocitySums_[pitchClass] -= previousVelocity;
+        }
         
+        activeNotes_[note.pitch] = note.velocity;
+        const uint64_t bit = uint64_t{1} << (note.pitch & 63);
+        uint64_t& word = activePitchBits_[note.pitch >> 6];
         if (note.velocity > 0) {
-            activeNotes_[note.pitch] = note.velocity;
-            pitchClassSet_[note.pitch % 12] = true;
+            ++pitchClassCounts_[pitchClass];
+            velocitySums_[pitchClass] += note.velocity;
+            word |= bit;
         } else {
-            activeNotes_[note.pitch] = 0;
-            // Check if this was the last note of this pitch class
-            bool hasNote = false;
-            for (int j = note.pitch % 12; j < 128; j += 12) {
-                if (activeNotes_[j] > 0) {
-                    hasNote = true;
-                    break;
-                }
-            }
-            if (!hasNote) {
-                pitchClassSet_[note.pitch % 12] = false;
-            }
+            word &= ~bit;
         }
+        
+        pitchClassSet_.set(pitchClass, pitchClassCounts_[pitchClass] > 0);
+    }
+    
+    // Key tracking integrates over time, so it advances on every block with notes
+    if (count > 0 && config_.enableScaleDetection) {
+        scaleDetector_->track(velocityHistogram(), lastTimestamp_);
+    }
+    
+    // Dense input (arpeggiators, drum bleed) mostly leaves the set unchanged.
+    // A new bass octave alone cannot change the analysis; with weighted
+    // analysis a velocity change can.
+    const int bass = getBassNote();
+    const bool sameBass = (bass < 0) == (previousBass < 0) && bass % 12 == previousBass % 12;
+    const bool sameNotes = analysisValid_ && pitchClassSet_ == previousSet && sameBass;
+    const bool sameWeights = !config_.weightedChordAnalysis || velocitySums_ == previousVelocities;
+    if (sameNotes && sameWeights) {
+        return;
     }
     
+    // Velocities move with every note; they are a harmony change only if
+    // they change the chord
+    const Chord previous = currentChord_;
     updateChordAnalysis();
+    if (sameNotes && sameChord(currentChord_, previous)) {
+        return;
+    }
+    analysisValid_ = true;
+    harmonyChanged_ = true;
+    
+    chordHistory_->push({lastTimestamp_, currentChord_});
     
     if (config_.enableScaleDetection) {
         updateScaleDetection();
+        scaleHistory_->push({lastTimestamp_, currentScale_});
+    }
+}
+
+void HarmonyEngine::processAudio(const float* buffer, size_t frames) noexcept {
+    if (!chromaExtractor_->process(buffer, frames)) {
+        return;
+    }
+    
+    const auto& chroma = chromaExtractor_->getChroma();
+    const uint64_t position = chromaExtractor_->getFramePosition();
+    
+    if (config_.enableScaleDetection) {
+        scaleDetector_->track(chroma, position);
     }
+    
+    const Chord previous = currentChord_;
+    chordAnalyzer_->updateWeighted(chroma);
+    currentChord_ = chordAnalyzer_->getCurrentChord();
+    
+    // Chroma moves every frame; only a different chord is a harmony change
+    if (analysisValid_ && sameChord(currentChord_, previous)) {
+        return;
+    }
+    analysisValid_ = true;
+    harmonyChanged_ = true;
+    
+    chordHistory_->push({position, currentChord_});
+    
+    if (config_.enableScaleDetection) {
+        scaleDetector_->update(chroma);
+        currentScale_ = scaleDetector_->getCurrentScale();
+        scaleHistory_->push({position, currentScale_});
+    }
+}
+
+size_t HarmonyEngine::getTimelineFrameCount(
+    const Note* notes,
+    size_t count,
+    uint64_t hopSamples
+) noexcept {
+    if (count == 0 || hopSamples == 0) {
+        return 0;
+    }
+    return static_cast<size_t>(notes[count - 1].timestamp / hopSamples) + 1;
+}
+
+std::vector<HarmonyEngine::HarmonyFrame> HarmonyEngine::analyzeTimeline(
+    const Note* notes,
+    size_t count,
+    uint64_t hopSamples
+) {
+    std::vector<HarmonyFrame> frames(getTimelineFrameCount(notes, count, hopSamples));
+    size_t written = analyzeTimeline(notes, count, hopSamples, frames.data(), frames.size());
+    frames.resize(written);
+    return frames;
+}
+
+size_t HarmonyEngine::analyzeTimeline(
+    const Note* notes,
+    size_t count,
+    uint64_t hopSamples,
+    HarmonyFrame* outFrames,
+    size_t maxFrames
+) noexcept {
+    reset();
+    
+    if (hopSamples == 0) {
+        return 0;
+    }
+    
+    size_t numFrames = std::min(getTimelineFrameCount(notes, count, hopSamples), maxFrames);
+    size_t noteIndex = 0;
+    
+    for (size_t frame = 0; frame < numFrames; ++frame) {
+        uint64_t frameStart = static_cast<uint64_t>(frame) * hopSamples;
+        uint64_t frameEnd = frameStart + hopSamples;
+        
+        // Feed every note that starts inside this hop as one block
+        size_t blockStart = noteIndex;
+        while (noteIndex < count && notes[noteIndex].timestamp < frameEnd) {
+            ++noteIndex;
+        }
+        processNotes(notes + blockStart, noteIndex - blockStart);
+        
+        auto& out = outFrames[frame];
+        out.samplePosition = frameStart;
+        out.chord = currentChord_;
+        out.scale = currentScale_;
+    }
+    
+    return numFrames;
+}
+
+void HarmonyEngine::reset() noexcept {
+    activeNotes_.fill(0);
+    activePitchBits_.fill(0);
+    pitchClassCounts_.fill(0);
+    velocitySums_.fill(0);
+    pitchClassSet_.clear();
+    lastTimestamp_ = 0;
+    analysisValid_ = false;
+    harmonyChanged_ = false;
+    currentChord_ = Chord{};
+    currentScale_ = Scale{};
+    
+    if (chordAnalyzer_) chordAnalyzer_->reset();
+    if (chromaExtractor_) chromaExtractor_->reset();
+    if (scaleDetector_) scaleDetector_->reset();
+    if (chordHistory_) chordHistory_->clear();
+    if (scaleHistory_) scaleHistory_->clear();
 }
 
 void HarmonyEngine::updateChordAnalysis() noexcept {
-    chordAnalyzer_->update(pitchClassSet_);
+    const int bassNote = getBassNote();
+    const int bass = bassNote < 0 ? ChordAnalyzer::kNoBass : bassNote % 12;
+    
+    // A ghost note weighs less than a held root, but a doubled tone no
+    // more than a single one; with every tone at the same weight the
+    // presence lookup gives the same answer
+    bool uniform = true;
+    const std::array<float, 12> weights = chordWeights(uniform);
+    if (config_.weightedChordAnalysis && !uniform) {
+        chordAnalyzer_->updateWeighted(weights, bass);
+    } else {
+        chordAnalyzer_->update(pitchClassSet_, bass);
+    }
     currentChord_ = chordAnalyzer_->getCurrentChord();
 }
 
 void HarmonyEngine::updateScaleDetection() noexcept {
-    // Build weighted histogram from active notes
+    scaleDetector_->update(velocityHistogram());
+    currentScale_ = scaleDetector_->getCurrentScale();
+}
+
+ChromaExtractor::Config HarmonyEngine::chromaConfig() const noexcept {
+    ChromaExtractor::Config chroma;
+    chroma.sampleRate = config_.sampleRate;
+    chroma.fftSize = config_.analysisWindowSize;
+    chroma.hopSize = config_.analysisHopSize;
+    return chroma;
+}
+
+std::array<float, 12> HarmonyEngine::velocityHistogram() const noexcept {
+    // Weighted histogram from the running velocity sums
     std::array<float, 12> histogram{};
-    for (size_t i = 0; i < 128; ++i) {
-        if (activeNotes_[i] > 0) {
-            histogram[i % 12] += activeNotes_[i] / 127.0f;
+    for (int pc = 0; pc < 12; ++pc) {
+        histogram[pc] = velocitySums_[pc] / 127.0f;
+    }
+    return histogram;
+}
+
+std::array<float, 12> HarmonyEngine::chordWeights(bool& uniform) const noexcept {
+    // Mean held velocity per pitch class
+    std::array<float, 12> weights{};
+    float first = 0.0f;
+    uniform = true;
+    for (int pc = 0; pc < 12; ++pc) {
+        if (pitchClassCounts_[pc] == 0) continue;
+        weights[pc] = velocitySums_[pc] / (127.0f * pitchClassCounts_[pc]);
+        if (first == 0.0f) {
+            first = weights[pc];
+        } else if (weights[pc] != first) {
+            uniform = false;
         }
     }
-    
-    scaleDetector_->update(histogram);
-    currentScale_ = scaleDetector_->getCurrentScale();
+    return weights;
 }
 
 std::vector<Note> HarmonyEngine::suggestVoiceLeading(
@@ -75,8 +284,62 @@ std::vector<Note> HarmonyEngine::suggestVoiceLeading(
     return voiceLeading_->findOptimalVoicing(targetChord, currentVoices);
 }
 
+bool HarmonyEngine::suggestVoiceLeading(
+    const Chord& targetChord,
+    const VoiceLeading::Voicing& currentVoices,
+    VoiceLeading::Voicing& out
+) const noexcept {
+    if (!config_.enableVoiceLeading) {
+        out = currentVoices;
+        return false;
+    }
+    
+    return std::isfinite(voiceLeading_->solve(currentVoices, targetChord, out));
+}
+
+std::vector<std::vector<Note>> HarmonyEngine::planVoiceLeading(
+    const std::vector<Chord>& chords,
+    const std::vector<Note>& currentVoices
+) {
+    if (!config_.enableVoiceLeading || currentVoices.size() > VoiceLeading::kMaxVoices) {
+        return {};
+    }
+    
+    VoiceLeading::Voicing start;
+    start.count = static_cast<uint8_t>(currentVoices.size());
+    for (size_t i = 0; i < currentVoices.size(); ++i) {
+        start.pitches[i] = currentVoices[i].pitch;
+    }
+    
+    std::vector<VoiceLeading::Voicing> path(chords.size());
+    if (!std::isfinite(voiceLeading_->planProgression(chords.data(), chords.size(), start, path.data()))) {
+        return {};
+    }
+    
+    std::vector<std::vector<Note>> result(path.size(), currentVoices);
+    for (size_t t = 0; t < path.size(); ++t) {
+        for (size_t i = 0; i < currentVoices.size(); ++i) {
+            result[t][i].pitch = path[t].pitches[i];
+        }
+    }
+    return result;
+}
+
 void HarmonyEngine::updateConfig(const Config& config) {
+    const bool sampleRateChanged = config.sampleRate != config_.sampleRate;
+    const bool framingChanged = sampleRateChanged
+        || config.analysisWindowSize != config_.analysisWindowSize
+        || config.analysisHopSize != config_.analysisHopSize;
     config_ = config;
+    analysisValid_ = false;  // Re-analyze on the next block
+    
+    if (sampleRateChanged) {
+        setKeyTrackingConfig(scaleDetector_->getTrackingConfig());
+    }
+    
+    if (framingChanged) {
+        chromaExtractor_ = std::make_unique<ChromaExtractor>(chromaConfig());
+    }
     
     if (chordAnalyzer_) {
         chordAnalyzer_->setConfidenceThreshold(config.confidenceThreshold);
@@ -87,16 +350,40 @@ void HarmonyEngine::updateConfig(const Config& config) {
     }
 }
 
+void HarmonyEngine::setKeyTrackingConfig(const ScaleDetector::TrackingConfig& config) {
+    ScaleDetector::TrackingConfig tracking = config;
+    tracking.sampleRate = config_.sampleRate;
+    scaleDetector_->setTrackingConfig(tracking);
+}
+
+void HarmonyEngine::setKeyProfileBank(std::shared_ptr<const KeyProfileBank> profiles) {
+    scaleDetector_->setProfileBank(std::move(profiles));
+    currentScale_ = Scale{};
+    analysisValid_ = false;  // Re-analyze on the next block
+}
+
 std::vector<Chord> HarmonyEngine::getChordHistory(size_t maxCount) const {
-    // TODO: Implement chord history tracking
-    (void)maxCount;  // Suppress unused parameter warning
-    return {currentChord_};
+    std::vector<ChordEvent> events(std::min(maxCount, kHistoryCapacity));
+    events.resize(getChordHistory(events.data(), events.size()));
+    
+    std::vector<Chord> chords;
+    chords.reserve(events.size());
+    for (const auto& event : events) {
+        chords.push_back(event.chord);
+    }
+    return chords;
 }
 
 std::vector<Scale> HarmonyEngine::getScaleHistory(size_t maxCount) const {
-    // TODO: Implement scale history tracking
-    (void)maxCount;  // Suppress unused parameter warning
-    return {currentScale_};
+    std::vector<ScaleEvent> events(std::min(maxCount, kHistoryCapacity));
+    events.resize(getScaleHistory(events.data(), events.size()));
+    
+    std::vector<Scale> scales;
+    scales.reserve(events.size());
+    for (const auto& event : events) {
+        scales.push_back(event.scale);
+    }
+    return scales;
 }
 
 } // namespace penta::harmony
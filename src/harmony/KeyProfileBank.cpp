@@ -0,0 +1,441 @@
+#include "penta/harmony/KeyProfileBank.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+namespace penta::harmony {
+
+namespace {
+
+std::array<float, 12> templateWeights(const std::vector<int>& degrees) {
+    std::array<float, 12> weights{};
+    for (int degree : degrees) {
+        weights[((degree % 12) + 12) % 12] = 1.0f;
+    }
+    weights[0] = 2.0f;  // Tonic emphasis separates rotations of symmetric scales
+    return weights;
+}
+
+// Deepest nesting of skipped (unknown) values; deeper input fails to load
+// rather than recursing without bound
+constexpr size_t kMaxSkipDepth = 64;
+
+// Minimal JSON reader for profile files: objects, arrays, strings, numbers,
+// true/false/null. Unknown keys are skipped; only the profile schema is kept.
+class ProfileJsonParser {
+public:
+    explicit ProfileJsonParser(std::string_view text) : text_(text) {}
+    
+    bool parse(std::vector<KeyProfileBank::Profile>& out) {
+        skipWhitespace();
+        if (peek() == '[') {
+            if (!parseProfileArray(out)) return false;
+        } else if (peek() == '{') {
+            bool sawProfiles = false;
+            bool ok = parseObject([&](const std::string& key) {
+                if (key == "profiles") {
+                    sawProfiles = true;
+                    return parseProfileArray(out);
+                }
+                return skipValue();
+            });
+            if (!ok) return false;
+            if (!sawProfiles) return fail("missing \"profiles\" array");
+        } else {
+            return fail("expected object or array");
+        }
+        
+        skipWhitespace();
+        if (pos_ != text_.size()) return fail("trailing characters");
+        return true;
+    }
+    
+    const std::string& error() const { return error_; }
+    
+private:
+    template<typename OnKey>
+    bool parseObject(OnKey&& onKey) {
+        if (!expect('{')) return false;
+        skipWhitespace();
+        if (consume('}')) return true;
+        
+        while (true) {
+            std::string key;
+            skipWhitespace();
+            if (!parseString(key)) return false;
+            skipWhitespace();
+            if (!expect(':')) return false;
+            skipWhitespace();
+            if (!onKey(key)) return false;
+            skipWhitespace();
+            if (consume('}')) return true;
+            if (!expect(',')) return false;
+        }
+    }
+    
+    template<typename OnElement>
+    bool parseArray(OnElement&& onElement) {
+        if (!expect('[')) return false;
+        skipWhitespace();
+        if (consume(']')) return true;
+        
+        while (true) {
+            skipWhitespace();
+            if (!onElement()) return false;
+            skipWhitespace();
+            if (consume(']')) return true;
+            if (!expect(',')) return false;
+        }
+    }
+    
+    bool parseProfileArray(std::vector<KeyProfileBank::Profile>& out) {
+        return parseArray([&]() { return parseProfile(out); });
+    }
+    
+    bool parseProfile(std::vector<KeyProfileBank::Profile>& out) {
+        KeyProfileBank::Profile profile;
+        profile.weights.fill(0.0f);
+        std::vector<int> degrees;
+        bool hasName = false;
+        bool hasWeights = false;
+        bool hasDegrees = false;
+        
+        bool ok = parseObject([&](const std::string& key) {
+            if (key == "name") {
+                hasName = true;
+                return parseString(profile.name);
+            }
+            if (key == "weights") {
+                size_t count = 0;
+                hasWeights = true;
+                bool parsed = parseArray([&]() {
+                    double value = 0.0;
+                    if (!parseNumber(value)) return false;
+                    if (count >= 12) return fail("\"weights\" needs exactly 12 numbers");
+                    profile.weights[count++] = static_cast<float>(value);
+                    return true;
+                });
+                if (parsed && count != 12) return fail("\"weights\" needs exactly 12 numbers");
+                return parsed;
+            }
+            if (key == "degrees") {
+                hasDegrees = true;
+                return parseArray([&]() {
+                    double value = 0.0;
+                    if (!parseNumber(value)) return false;
+                    if (value < 0.0 || value > 11.0 || value != std::floor(value)) {
+                        return fail("scale degrees must be integers 0-11");
+                    }
+                    degrees.push_back(static_cast<int>(value));
+                    return true;
+                });
+            }
+            return skipValue();
+        });
+        
+        if (!ok) return false;
+        if (!hasName) return fail("profile without \"name\"");
+        if (hasWeights == hasDegrees) {
+            return fail("profile \"" + profile.name + "\" needs either \"weights\" or \"degrees\"");
+        }
+        if (hasDegrees) {
+            profile.weights = templateWeights(degrees);
+        }
+        if (std::all_of(profile.weights.begin(), profile.weights.end(),
+                        [&](float w) { return w == profile.weights[0]; })) {
+            return fail("profile \"" + profile.name + "\" is flat");
+        }
+        
+        out.push_back(std::move(profile));
+        return true;
+    }
+    
+    bool parseString(std::string& out) {
+        if (!expect('"')) return false;
+        out.clear();
+        
+        while (pos_ < text_.size()) {
+            char c = text_[pos_++];
+            if (c == '"') return true;
+            if (c != '\\') {
+                out.push_back(c);
+                continue;
+            }
+            if (pos_ >= text_.size()) break;
+            char escaped = text_[pos_++];
+            switch (escaped) {
+                case '"': case '\\': case '/': out.push_back(escaped); break;
+                case 'b': out.push_back('\b'); break;
+                case 'f': out.push_back('\f'); break;
+                case 'n': out.push_back('\n'); break;
+                case 'r': out.push_back('\r'); break;
+                case 't': out.push_back('\t'); break;
+                case 'u': {
+                    // Keep ASCII code points; others become '?'
+                    if (pos_ + 4 > text_.size()) return fail("truncated \\u escape");
+                    unsigned long code = std::strtoul(std::string(text_.substr(pos_, 4)).c_str(), nullptr, 16);
+                    out.push_back(code < 0x80 ? static_cast<char>(code) : '?');
+                    pos_ += 4;
+                    break;
+                }
+                default:
+                    return fail("invalid escape");
+            }
+        }
+        return fail("unterminated string");
+    }
+    
+    bool parseNumber(double& out) {
+        const size_t start = pos_;
+        while (pos_ < text_.size() && (std::isdigit(static_cast<unsigned char>(text_[pos_])) ||
+                                       text_[pos_] == '-' || text_[pos_] == '+' ||
+                                       text_[pos_] == '.' || text_[pos_] == 'e' || text_[pos_] == 'E')) {
+            ++pos_;
+        }
+        if (pos_ == start) return fail("expected number");
+        
+        const std::string token(text_.substr(start, pos_ - start));
+        char* end = nullptr;
+        out = std::strtod(token.c_str(), &end);
+        if (end != token.c_str() + token.size() || !std::isfinite(out)) {
+            pos_ = start;
+            return fail("invalid number");
+        }
+        return true;
+    }
+    
+    bool skipValue() {
+        skipWhitespace();
+        switch (peek()) {
+            case '{': case '[': return skipContainer();
+            case '"': { std::string ignored; return parseString(ignored); }
+            case 't': return literal("true");
+            case 'f': return literal("false");
+            case 'n': return literal("null");
+            default: { double ignored; return parseNumber(ignored); }
+        }
+    }
+    
+    bool skipContainer() {
+        if (skipDepth_ >= kMaxSkipDepth) {
+            return fail("nesting deeper than " + std::to_string(kMaxSkipDepth) + " levels");
+        }
+        ++skipDepth_;
+        const bool ok = peek() == '{'
+            ? parseObject([&](const std::string&) { return skipValue(); })
+            : parseArray([&]() { return skipValue(); });
+        --skipDepth_;
+        return ok;
+    }
+    
+    bool literal(std::string_view word) {
+        if (text_.substr(pos_, word.size()) != word) return fail("invalid literal");
+        pos_ += word.size();
+        return true;
+    }
+    
+    void skipWhitespace() {
+        while (pos_ < text_.size() && std::isspace(static_cast<unsigned char>(text_[pos_]))) ++pos_;
+    }
+    
+    char peek() const { return pos_ < text_.size() ? text_[pos_] : '\0'; }
+    
+    bool consume(char c) {
+        if (peek() != c) return false;
+        ++pos_;
+        return true;
+    }
+    
+    bool expect(char c) {
+        if (consume(c)) return true;
+        return fail(std::string("expected '") + c + "'");
+    }
+    
+    bool fail(const std::string& message) {
+        if (error_.empty()) {
+            error_ = message + " at offset " + std::to_string(pos_);
+        }
+        return false;
+    }
+    
+    std::string_view text_;
+    size_t pos_ = 0;
+    size_t skipDepth_ = 0;
+    std::string error_;
+};
+
+} // anonymous namespace
+
+// ============================================================================
+// Built-in banks
+// ============================================================================
+
+KeyProfileBank KeyProfileBank::krumhanslModes() {
+    KeyProfileBank bank;
+    
+    // Krumhansl & Kessler 1982 probe-tone ratings; the modal profiles permute
+    // the major/minor ratings onto each mode's degrees
+    bank.addProfile("Major",      {6.35f, 2.23f, 3.48f, 2.33f, 4.38f, 4.09f, 2.52f, 5.19f, 2.39f, 3.66f, 2.29f, 2.88f});
+    bank.addProfile("Minor",      {6.33f, 2.68f, 3.52f, 5.38f, 2.60f, 3.53f, 2.54f, 4.75f, 3.98f, 2.69f, 3.34f, 3.17f});
+    bank.addProfile("Dorian",     {6.35f, 2.23f, 3.48f, 4.38f, 2.33f, 4.09f, 2.52f, 5.19f, 3.66f, 2.39f, 2.29f, 2.88f});
+    bank.addProfile("Phrygian",   {6.33f, 3.52f, 2.68f, 5.38f, 2.60f, 3.53f, 2.54f, 4.75f, 2.69f, 3.98f, 3.34f, 3.17f});
+    bank.addProfile("Lydian",     {6.35f, 2.23f, 3.48f, 2.33f, 4.38f, 2.52f, 4.09f, 5.19f, 2.39f, 3.66f, 2.29f, 2.88f});
+    bank.addProfile("Mixolydian", {6.35f, 2.23f, 3.48f, 2.33f, 4.38f, 4.09f, 2.52f, 5.19f, 2.39f, 3.66f, 2.88f, 2.29f});
+    bank.addProfile("Locrian",    {6.33f, 3.52f, 2.68f, 5.38f, 2.60f, 3.53f, 4.75f, 2.54f, 2.69f, 3.98f, 3.34f, 3.17f});
+    return bank;
+}
+
+KeyProfileBank KeyProfileBank::temperley() {
+    KeyProfileBank bank;
+    
+    // Temperley 1999, "What's Key for Key?"
+    bank.addProfile("Temperley Major", {5.0f, 2.0f, 3.5f, 2.0f, 4.5f, 4.0f, 2.0f, 4.5f, 2.0f, 3.5f, 1.5f, 4.0f});
+    bank.addProfile("Temperley Minor", {5.0f, 2.0f, 3.5f, 4.5f, 2.0f, 4.0f, 2.0f, 4.5f, 3.5f, 2.0f, 1.5f, 4.0f});
+    return bank;
+}
+
+KeyProfileBank KeyProfileBank::aardenEssen() {
+    KeyProfileBank bank;
+    
+    // Aarden 2003, pitch-class distributions of the Essen folksong collection
+    bank.addProfile("Aarden-Essen Major", {17.7661f, 0.145624f, 14.9265f, 0.160186f, 19.8049f, 11.3587f,
+                                           0.291248f, 22.062f, 0.145624f, 8.15494f, 0.232998f, 4.95122f});
+    bank.addProfile("Aarden-Essen Minor", {18.2648f, 0.737619f, 14.0499f, 16.8599f, 0.702494f, 14.4362f,
+                                           0.702494f, 18.6161f, 4.56621f, 1.93186f, 7.37619f, 1.75623f});
+    return bank;
+}
+
+KeyProfileBank KeyProfileBank::extended() {
+    KeyProfileBank bank = krumhanslModes();
+    bank.addScaleLibrary();
+    return bank;
+}
+
+std::shared_ptr<const KeyProfileBank> KeyProfileBank::defaultBank() {
+    static const auto bank = std::make_shared<const KeyProfileBank>(krumhanslModes());
+    return bank;
+}
+
+void KeyProfileBank::addScaleLibrary() {
+    addScaleTemplate("Harmonic Minor",         {0, 2, 3, 5, 7, 8, 11});
+    addScaleTemplate("Melodic Minor",          {0, 2, 3, 5, 7, 9, 11});
+    addScaleTemplate("Major Pentatonic",       {0, 2, 4, 7, 9});
+    addScaleTemplate("Minor Pentatonic",       {0, 3, 5, 7, 10});
+    addScaleTemplate("Blues",                  {0, 3, 5, 6, 7, 10});
+    addScaleTemplate("Whole Tone",             {0, 2, 4, 6, 8, 10});
+    addScaleTemplate("Octatonic (Half-Whole)", {0, 1, 3, 4, 6, 7, 9, 10});
+    addScaleTemplate("Octatonic (Whole-Half)", {0, 2, 3, 5, 6, 8, 9, 11});
+}
+
+// ============================================================================
+// Editing
+// ============================================================================
+
+int KeyProfileBank::addProfile(std::string name, const std::array<float, 12>& weights) {
+    if (profiles_.size() >= kMaxProfiles) {
+        return -1;
+    }
+    
+    profiles_.push_back({std::move(name), weights});
+    rebuild();
+    return static_cast<int>(profiles_.size() - 1);
+}
+
+int KeyProfileBank::addScaleTemplate(std::string name, const std::vector<int>& degrees) {
+    return addProfile(std::move(name), templateWeights(degrees));
+}
+
+bool KeyProfileBank::append(const KeyProfileBank& other) {
+    if (profiles_.size() + other.profiles_.size() > kMaxProfiles) {
+        return false;
+    }
+    
+    profiles_.insert(profiles_.end(), other.profiles_.begin(), other.profiles_.end());
+    rebuild();
+    return true;
+}
+
+bool KeyProfileBank::loadJson(std::string_view json, std::string* error) {
+    std::vector<Profile> parsed;
+    ProfileJsonParser parser(json);
+    
+    if (!parser.parse(parsed)) {
+        if (error) *error = parser.error();
+        return false;
+    }
+    if (profiles_.size() + parsed.size() > kMaxProfiles) {
+        if (error) *error = "bank would exceed " + std::to_string(kMaxProfiles) + " profiles";
+        return false;
+    }
+    
+    for (auto& profile : parsed) {
+        profiles_.push_back(std::move(profile));
+    }
+    rebuild();
+    return true;
+}
+
+bool KeyProfileBank::loadJsonFile(const std::string& path, std::string* error) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        if (error) *error = "cannot open " + path;
+        return false;
+    }
+    
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    return loadJson(contents.str(), error);
+}
+
+int KeyProfileBank::findProfile(std::string_view name) const noexcept {
+    for (size_t i = 0; i < profiles_.size(); ++i) {
+        if (profiles_[i].name == name) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+// ============================================================================
+// Compiled matrix
+// ============================================================================
+
+void KeyProfileBank::rebuild() {
+    const size_t numProfiles = profiles_.size();
+    const size_t numRows = numProfiles * 12;
+    paddedRows_ = (numRows + 7) & ~size_t{7};
+    
+    coefficients_.assign(12 * paddedRows_, 0.0f);
+    rowTonics_.resize(numRows);
+    rowProfiles_.resize(numRows);
+    
+    for (size_t p = 0; p < numProfiles; ++p) {
+        const auto& weights = profiles_[p].weights;
+        
+        float mean = 0.0f;
+        for (float w : weights) mean += w;
+        mean /= 12.0f;
+        
+        float norm = 0.0f;
+        for (float w : weights) norm += (w - mean) * (w - mean);
+        norm = std::sqrt(norm);
+        
+        for (uint8_t tonic = 0; tonic < 12; ++tonic) {
+            const size_t row = tonic * numProfiles + p;
+            
+            // Profile degree d sits on pitch class (tonic + d) % 12
+            for (int degree = 0; degree < 12; ++degree) {
+                coefficients_[((tonic + degree) % 12) * paddedRows_ + row] =
+                    norm > 0.0f ? (weights[degree] - mean) / norm : 0.0f;
+            }
+            
+            rowTonics_[row] = tonic;
+            rowProfiles_[row] = static_cast<uint8_t>(p);
+        }
+    }
+}
+
+} // namespace penta::harmony
@@ -5,43 +5,35 @@
 
 namespace penta::harmony {
 
-// Krumhansl-Schmuckler key profiles
-// Based on empirical research of perceived stability of pitch classes in major/minor keys
-const std::array<ScaleDetector::ScaleProfile, 7> ScaleDetector::kMajorMinorProfiles = {{
-    // Major profile (Ionian) - empirical weights from Krumhansl & Kessler 1982
-    {{6.35f, 2.23f, 3.48f, 2.33f, 4.38f, 4.09f, 2.52f, 5.19f, 2.39f, 3.66f, 2.29f, 2.88f}, 0, "Major"},
-    
-    // Minor profile (Aeolian) - empirical weights
-    {{6.33f, 2.68f, 3.52f, 5.38f, 2.60f, 3.53f, 2.54f, 4.75f, 3.98f, 2.69f, 3.34f, 3.17f}, 1, "Minor"},
-    
-    // Dorian mode
-    {{6.35f, 2.23f, 3.48f, 4.38f, 2.33f, 4.09f, 2.52f, 5.19f, 3.66f, 2.39f, 2.29f, 2.88f}, 2, "Dorian"},
-    
-    // Phrygian mode
-    {{6.33f, 3.52f, 2.68f, 5.38f, 2.60f, 3.53f, 2.54f, 4.75f, 2.69f, 3.98f, 3.34f, 3.17f}, 3, "Phrygian"},
-    
-    // Lydian mode
-    {{6.35f, 2.23f, 3.48f, 2.33f, 4.38f, 2.52f, 4.09f, 5.19f, 2.39f, 3.66f, 2.29f, 2.88f}, 4, "Lydian"},
-    
-    // Mixolydian mode
-    {{6.35f, 2.23f, 3.48f, 2.33f, 4.38f, 4.09f, 2.52f, 5.19f, 2.39f, 3.66f, 2.88f, 2.29f}, 5, "Mixolydian"},
-    
-    // Locrian mode
-    {{6.33f, 3.52f, 2.68f, 5.38f, 2.60f, 3.53f, 4.75f, 2.54f, 2.69f, 3.98f, 3.34f, 3.17f}, 6, "Locrian"},
-}};
+namespace {
+
+// Correlations closer than this count as ties and keep the earlier
+// (lower tonic, then lower profile) candidate. Modes of one pitch
+// collection tie exactly on unweighted input, and without this the
+// winner would depend on float summation order.
+constexpr float kTieTolerance = 1e-5f;
+
+} // anonymous namespace
 
 ScaleDetector::ScaleDetector()
+    : ScaleDetector(nullptr)
+{
+}
+
+ScaleDetector::ScaleDetector(std::shared_ptr<const KeyProfileBank> profiles)
     : confidenceThreshold_(0.5f)
     , decayFactor_(0.95f)
+    , modulations_(std::make_unique<ModulationQueue>())
 {
     pitchClassHistogram_.fill(0.0f);
+    setProfileBank(std::move(profiles));
 }
 
-Scale ScaleDetector::analyze(const std::array<bool, 12>& pitchClassSet) noexcept {
-    // Convert boolean pitch class set to weighted histogram
+Scale ScaleDetector::analyze(PitchClassSet pitchClassSet) noexcept {
+    // Convert pitch class set to weighted histogram
     std::array<float, 12> histogram;
     for (int i = 0; i < 12; ++i) {
-        histogram[i] = pitchClassSet[i] ? 1.0f : 0.0f;
+        histogram[i] = pitchClassSet.contains(i) ? 1.0f : 0.0f;
     }
     
     Scale result;
@@ -49,6 +41,38 @@ Scale ScaleDetector::analyze(const std::array<bool, 12>& pitchClassSet) noexcept
     return result;
 }
 
+Scale ScaleDetector::analyzeHistogram(const std::array<float, 12>& histogram) const noexcept {
+    Scale result;
+    findBestScale(histogram, result);
+    return result;
+}
+
+Scale ScaleDetector::analyzeHistogramExhaustive(const std::array<float, 12>& histogram) const noexcept {
+    float bestCorrelation = -1.0f;
+    uint8_t bestTonic = 0;
+    uint8_t bestMode = 0;
+    
+    // Try all profiles at all tonics
+    for (uint8_t tonic = 0; tonic < 12; ++tonic) {
+        for (size_t p = 0; p < profiles_->getNumProfiles(); ++p) {
+            float correlation = correlateWithProfile(histogram, profiles_->getProfile(p), tonic);
+            
+            if (correlation > bestCorrelation + kTieTolerance) {
+                bestCorrelation = correlation;
+                bestTonic = tonic;
+                bestMode = static_cast<uint8_t>(p);
+            }
+        }
+    }
+    
+    Scale result;
+    result.tonic = bestTonic;
+    result.mode = bestMode;
+    result.confidence = (bestCorrelation + 1.0f) * 0.5f;
+    setScaleDegrees(histogram, result);
+    return result;
+}
+
 void ScaleDetector::update(const std::array<float, 12>& pitchClassWeights) noexcept {
     // Apply temporal decay to existing histogram
     for (int i = 0; i < 12; ++i) {
@@ -68,17 +92,163 @@ void ScaleDetector::setDecayFactor(float factor) noexcept {
     decayFactor_ = std::clamp(factor, 0.0f, 1.0f);
 }
 
+void ScaleDetector::reset() noexcept {
+    pitchClassHistogram_.fill(0.0f);
+    currentScale_ = Scale{};
+    resetTracking();
+}
+
+void ScaleDetector::setProfileBank(std::shared_ptr<const KeyProfileBank> profiles) {
+    if (!profiles || profiles->getNumProfiles() == 0) {
+        profiles = KeyProfileBank::defaultBank();
+    }
+    profiles_ = std::move(profiles);
+    currentScale_ = Scale{};
+    resetTracking();  // Tracked rows index the old bank
+}
+
+// ============================================================================
+// Multi-timescale key tracking
+// ============================================================================
+
+void ScaleDetector::track(const std::array<float, 12>& pitchClassWeights, uint64_t samplePosition) noexcept {
+    if (trackingStarted_ && samplePosition > trackedPosition_) {
+        // Held weights were constant since the last call, so blending them in
+        // with 1 - decay is the exact continuous-time moving average
+        const double elapsed = static_cast<double>(samplePosition - trackedPosition_);
+        std::array<float, kNumTimescales> decay;
+        for (size_t t = 0; t < kNumTimescales; ++t) {
+            const double tau = trackingConfig_.timeConstants[t] * trackingConfig_.sampleRate;
+            decay[t] = tau > 0.0 ? static_cast<float>(std::exp(-elapsed / tau)) : 0.0f;
+        }
+        
+        // One pass over the pitch classes updates every timescale
+        for (int pc = 0; pc < 12; ++pc) {
+            const float held = heldWeights_[pc];
+            for (size_t t = 0; t < kNumTimescales; ++t) {
+                auto& bin = trackedHistograms_[t][pc];
+                bin = held + (bin - held) * decay[t];
+            }
+        }
+    }
+    
+    heldWeights_ = pitchClassWeights;
+    trackedPosition_ = std::max(trackedPosition_, samplePosition);
+    if (!trackingStarted_) {
+        trackingStarted_ = true;
+        return;
+    }
+    
+    constexpr size_t medium = static_cast<size_t>(Timescale::Medium);
+    size_t rows[kNumTimescales];
+    for (size_t t = 0; t < kNumTimescales; ++t) {
+        rows[t] = findBestScale(trackedHistograms_[t], trackedScales_[t]);
+    }
+    
+    const auto& histogram = trackedHistograms_[medium];
+    if (centeredNorm(histogram) < 1e-6f) {
+        return;  // Nothing heard yet
+    }
+    
+    const size_t candidateRow = rows[medium];
+    const Scale& candidate = trackedScales_[medium];
+    
+    if (currentKeyRow_ == kNoRow) {
+        // First key is established without an event
+        currentKeyRow_ = candidateRow;
+        currentKey_ = candidate;
+        return;
+    }
+    
+    if (candidateRow == currentKeyRow_) {
+        currentKey_ = candidate;  // Refresh confidence and degrees
+        pendingRow_ = kNoRow;
+        return;
+    }
+    
+    // Hysteresis: the challenger must lead by switchMargin for minHoldSeconds
+    const float lead = (candidate.confidence * 2.0f - 1.0f) - correlateWithRow(histogram, currentKeyRow_);
+    if (lead <= trackingConfig_.switchMargin) {
+        pendingRow_ = kNoRow;
+        return;
+    }
+    
+    if (pendingRow_ != candidateRow) {
+        pendingRow_ = candidateRow;
+        pendingSince_ = samplePosition;
+    }
+    
+    const double heldSamples = static_cast<double>(samplePosition - pendingSince_);
+    if (heldSamples >= trackingConfig_.minHoldSeconds * trackingConfig_.sampleRate) {
+        modulations_->push({pendingSince_, samplePosition, currentKey_, candidate});
+        currentKeyRow_ = candidateRow;
+        currentKey_ = candidate;
+        pendingRow_ = kNoRow;
+    }
+}
+
+void ScaleDetector::setTrackingConfig(const TrackingConfig& config) {
+    trackingConfig_ = config;
+    resetTracking();
+}
+
+void ScaleDetector::resetTracking() noexcept {
+    for (auto& histogram : trackedHistograms_) {
+        histogram.fill(0.0f);
+    }
+    trackedScales_.fill(Scale{});
+    heldWeights_.fill(0.0f);
+    trackedPosition_ = 0;
+    trackingStarted_ = false;
+    currentKey_ = Scale{};
+    currentKeyRow_ = kNoRow;
+    pendingRow_ = kNoRow;
+    pendingSince_ = 0;
+}
+
+// ============================================================================
+// Profile matrix search
+// ============================================================================
+
+size_t ScaleDetector::findBestRow(
+    const KeyProfileBank& bank,
+    const std::array<float, 12>& histogram,
+    float tieSlack,
+    float& bestScore
+) noexcept {
+    const size_t numRows = bank.getNumRows();
+    const float* columns[12];
+    for (int pc = 0; pc < 12; ++pc) {
+        columns[pc] = bank.getColumn(pc);
+    }
+    
+    size_t bestRow = 0;
+    bestScore = 0.0f;
+    
+    for (size_t row = 0; row < numRows; ++row) {
+        float score = 0.0f;
+        for (int pc = 0; pc < 12; ++pc) {
+            score += histogram[pc] * columns[pc][row];
+        }
+        if (row == 0 || score > bestScore + tieSlack) {
+            bestScore = score;
+            bestRow = row;
+        }
+    }
+    return bestRow;
+}
+
 float ScaleDetector::correlateWithProfile(
     const std::array<float, 12>& histogram,
-    const ScaleProfile& profile,
+    const KeyProfileBank::Profile& profile,
     uint8_t tonic
-) const noexcept {
+) noexcept {
     // Pearson correlation coefficient between histogram and profile
     
-    // Rotate profile to match tonic
+    // Rotate profile to match tonic (pitch class i is degree i - tonic)
     std::array<float, 12> rotatedProfile;
     for (int i = 0; i < 12; ++i) {
-        rotatedProfile[i] = profile.weights[(i + tonic) % 12];
+        rotatedProfile[i] = profile.weights[(i + 12 - tonic) % 12];
     }
     
     // Calculate means
@@ -109,38 +279,60 @@ float ScaleDetector::correlateWithProfile(
     return numerator / denominator;
 }
 
-void ScaleDetector::findBestScale(
+size_t ScaleDetector::findBestScale(
     const std::array<float, 12>& histogram,
     Scale& outScale
-) noexcept {
-    float bestCorrelation = -1.0f;
-    uint8_t bestTonic = 0;
-    uint8_t bestMode = 0;
+) const noexcept {
+    // Profile rows are already unit-norm
+    const float norm = centeredNorm(histogram);
     
-    // Try all profiles at all tonics
-    for (uint8_t tonic = 0; tonic < 12; ++tonic) {
-        for (const auto& profile : kMajorMinorProfiles) {
-            float correlation = correlateWithProfile(histogram, profile, tonic);
-            
-            if (correlation > bestCorrelation) {
-                bestCorrelation = correlation;
-                bestTonic = tonic;
-                bestMode = profile.mode;
-            }
-        }
+    float bestCorrelation = 0.0f;
+    size_t bestRow = 0;
+    
+    if (norm >= 1e-6f) {
+        // Every profile at every tonic as one matrix-vector product
+        float bestScore = 0.0f;
+        bestRow = findBestRowSIMD(*profiles_, histogram, kTieTolerance * norm, bestScore);
+        bestCorrelation = std::clamp(bestScore / norm, -1.0f, 1.0f);
     }
     
     // Convert correlation (-1 to 1) to confidence (0 to 1)
     // Scale and shift so that correlation of 0 gives confidence of 0.5
-    float confidence = (bestCorrelation + 1.0f) * 0.5f;
+    outScale.tonic = profiles_->getRowTonic(bestRow);
+    outScale.mode = profiles_->getRowProfile(bestRow);
+    outScale.confidence = (bestCorrelation + 1.0f) * 0.5f;
+    setScaleDegrees(histogram, outScale);
+    return bestRow;
+}
+
+float ScaleDetector::correlateWithRow(const std::array<float, 12>& histogram, size_t row) const noexcept {
+    const float norm = centeredNorm(histogram);
+    if (norm < 1e-6f) {
+        return 0.0f;
+    }
     
-    outScale.tonic = bestTonic;
-    outScale.mode = bestMode;
-    outScale.confidence = confidence;
+    float score = 0.0f;
+    for (int pc = 0; pc < 12; ++pc) {
+        score += histogram[pc] * profiles_->getColumn(pc)[row];
+    }
+    return std::clamp(score / norm, -1.0f, 1.0f);
+}
+
+float ScaleDetector::centeredNorm(const std::array<float, 12>& histogram) noexcept {
+    float mean = 0.0f;
+    for (float h : histogram) mean += h;
+    mean /= 12.0f;
     
+    float variance = 0.0f;
+    for (float h : histogram) variance += (h - mean) * (h - mean);
+    return std::sqrt(variance);
+}
+
+void ScaleDetector::setScaleDegrees(const std::array<float, 12>& histogram, Scale& outScale) noexcept {
     // Copy the pitch class histogram to scale degrees
+    outScale.degrees.clear();
     for (int i = 0; i < 12; ++i) {
-        outScale.degrees[i] = histogram[i] > 0.1f;  // Threshold for boolean representation
+        outScale.degrees.set(i, histogram[i] > 0.1f);  // Threshold for set membership
     }
 }
 
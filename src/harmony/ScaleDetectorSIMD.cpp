@@ -0,0 +1,83 @@
+#include "penta/harmony/ScaleDetector.h"
+#include <algorithm>
+#include <limits>
+
+// SIMD intrinsics
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace penta::harmony {
+
+#ifdef __AVX2__
+
+// AVX2 profile correlation: the 12 histogram bins stay broadcast in registers
+// while each 8-row block of the column-major bank is reduced with FMAs, so
+// the cost is linear in the number of rows with no per-profile setup. The
+// running argmax is kept per block, in row order, to preserve tie-breaking.
+size_t ScaleDetector::findBestRowSIMD(
+    const KeyProfileBank& bank,
+    const std::array<float, 12>& histogram,
+    float tieSlack,
+    float& bestScore
+) noexcept {
+    const size_t numRows = bank.getNumRows();
+    const size_t paddedRows = bank.getPaddedRows();
+    const float* matrix = bank.getColumn(0);
+    
+    __m256 weights[12];
+    for (int pc = 0; pc < 12; ++pc) {
+        weights[pc] = _mm256_set1_ps(histogram[pc]);
+    }
+    
+    // Row 0 always beats the initial score
+    size_t bestRow = 0;
+    bestScore = std::numeric_limits<float>::lowest();
+    alignas(32) float scores[8];
+    
+    for (size_t base = 0; base < numRows; base += 8) {
+        const float* block = matrix + base;
+        __m256 acc = _mm256_mul_ps(weights[0], _mm256_loadu_ps(block));
+        for (int pc = 1; pc < 12; ++pc) {
+#ifdef __FMA__
+            acc = _mm256_fmadd_ps(weights[pc], _mm256_loadu_ps(block + pc * paddedRows), acc);
+#else
+            acc = _mm256_add_ps(acc, _mm256_mul_ps(weights[pc], _mm256_loadu_ps(block + pc * paddedRows)));
+#endif
+        }
+        
+        // Most blocks cannot beat the running best; skip their scalar scan
+        const __m256 threshold = _mm256_set1_ps(bestScore + tieSlack);
+        if (_mm256_movemask_ps(_mm256_cmp_ps(acc, threshold, _CMP_GT_OQ)) == 0) {
+            continue;
+        }
+        _mm256_store_ps(scores, acc);
+        
+        const size_t count = std::min<size_t>(8, numRows - base);
+        for (size_t i = 0; i < count; ++i) {
+            if (scores[i] > bestScore + tieSlack) {
+                bestScore = scores[i];
+                bestRow = base + i;
+            }
+        }
+    }
+    return bestRow;
+}
+
+#endif // __AVX2__
+
+// Scalar fallback when AVX2 not available
+#ifndef __AVX2__
+
+size_t ScaleDetector::findBestRowSIMD(
+    const KeyProfileBank& bank,
+    const std::array<float, 12>& histogram,
+    float tieSlack,
+    float& bestScore
+) noexcept {
+    return findBestRow(bank, histogram, tieSlack, bestScore);
+}
+
+#endif // __AVX2__
+
+} // namespace penta::harmony
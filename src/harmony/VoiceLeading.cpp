@@ -1,15 +1,574 @@
 #include "penta/harmony/VoiceLeading.h"
 #include <algorithm>
+#include <bit>
+#include <chrono>
 #include <cmath>
 #include <limits>
 
 namespace penta::harmony {
 
+// Branch-and-bound state of one solve, kept on its stack
+struct VoiceLeading::SearchScratch {
+    size_t numVoices = 0;
+    bool keepOrder = false;          // Voices searched low to high, targets ascending
+    uint8_t order[kMaxVoices] = {};  // Search position -> voice index
+    int from[kMaxVoices] = {};
+    int requiredTones = 0;  // Distinct chord tones the voicing must cover
+    
+    // Candidate target pitches per voice, nearest (cheapest) first
+    uint8_t candidatePitch[kMaxVoices][kMaxCandidatesPerVoice] = {};
+    float candidateMotion[kMaxVoices][kMaxCandidatesPerVoice] = {};
+    uint8_t numCandidates[kMaxVoices] = {};
+    
+    // restMotion[d]: least motion cost voices d.. can still add
+    float restMotion[kMaxVoices + 1] = {};
+    
+    // Pair terms: contrary motion only depends on how many voices move up and
+    // down, parallels only on pairs a fifth or octave apart (perfectMask[d]
+    // holds the earlier search positions that are)
+    float contraryBonus = 0.0f;
+    float parallelPenalty = 0.0f;
+    uint8_t perfectMask[kMaxVoices] = {};
+    
+    // Current partial voicing
+    int current[kMaxVoices] = {};
+    int motion[kMaxVoices] = {};
+    int movingUp = 0;
+    int movingDown = 0;
+    uint8_t pitchClassUses[12] = {};
+    int coveredTones = 0;
+    uint64_t usedPitches[2] = {};
+    
+    // Incumbent
+    int best[kMaxVoices] = {};
+    float bestCost = 0.0f;
+    bool found = false;
+    
+    uint32_t budget = 0;
+    bool hasDeadline = false;
+    std::chrono::steady_clock::time_point deadline;
+    SearchStats stats;
+};
+
+// Progression planner state; vectors only grow and are reused across plans
+struct VoiceLeading::PlanScratch {
+    // Per-voice options for the chord being enumerated, in search order and
+    // nearest the anchor first
+    uint8_t order[kMaxVoices] = {};
+    int options[kMaxVoices][2 * kPlanRadius + 1] = {};
+    uint32_t optionDistance[kMaxVoices][2 * kPlanRadius + 1] = {};
+    uint8_t numOptions[kMaxVoices] = {};
+    uint32_t restDistance[kMaxVoices + 1] = {};  // Least distance voices d.. add
+    
+    // Closest voicings to one anchor so far; kept is a max-heap of
+    // displacement << 32 | slot in enumerated
+    std::vector<Voicing> enumerated;
+    std::vector<uint64_t> kept;
+    
+    // Candidate voicings of the current chord, per anchor in beam order
+    std::vector<Voicing> candidates;
+    std::vector<uint64_t> seen;  // Packed pitches of the kept candidates
+    
+    // Viterbi: cheapest way into each candidate, and the surviving beam
+    std::vector<float> transition;
+    std::vector<float> pathCost;
+    std::vector<uint32_t> pathFrom;
+    std::vector<uint32_t> rank;
+    std::vector<Voicing> beam;      // [chord * beamWidth + state]
+    std::vector<uint32_t> back;     // Beam state of the previous chord
+    std::vector<float> beamCost;
+    std::vector<float> nextBeamCost;
+};
+
 VoiceLeading::VoiceLeading(const Config& config)
     : config_(config)
+    , planScratch_(std::make_unique<PlanScratch>())
 {
 }
 
+VoiceLeading::~VoiceLeading() = default;
+
+float VoiceLeading::solve(
+    const Voicing& from,
+    const Chord& targetChord,
+    Voicing& to,
+    SearchStats* stats
+) const noexcept {
+    SearchScratch s;
+    
+    const size_t n = std::min<size_t>(from.count, kMaxVoices);
+    const int chordTones = static_cast<int>(targetChord.pitchClass.count());
+    to = from;
+    to.count = static_cast<uint8_t>(n);
+    
+    if (n == 0) {
+        s.stats.exhaustive = true;
+        if (stats) *stats = s.stats;
+        return 0.0f;
+    }
+    if (chordTones == 0) {
+        if (stats) *stats = s.stats;
+        return std::numeric_limits<float>::infinity();
+    }
+    
+    s.numVoices = n;
+    s.requiredTones = std::min(static_cast<int>(n), chordTones);
+    s.budget = std::max<uint32_t>(config_.maxSearchNodes, 1);
+    s.hasDeadline = config_.maxSearchMicros > 0;
+    if (s.hasDeadline) {
+        s.deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(config_.maxSearchMicros);
+    }
+    
+    // With crossing disallowed it is a hard constraint, not just a penalty:
+    // search voices from the lowest up and keep their targets ascending
+    s.keepOrder = !config_.allowVoiceCrossing;
+    for (size_t v = 0; v < n; ++v) {
+        s.order[v] = static_cast<uint8_t>(v);
+    }
+    if (s.keepOrder) {
+        std::stable_sort(s.order, s.order + n, [&from](uint8_t a, uint8_t b) {
+            return from.pitches[a] < from.pitches[b];
+        });
+    }
+    
+    // Chord tones within an octave either side, ordered by distance
+    for (size_t v = 0; v < n; ++v) {
+        const int origin = from.pitches[s.order[v]];
+        s.from[v] = origin;
+        uint8_t count = 0;
+        
+        auto addCandidate = [&](int pitch) {
+            if (pitch < 0 || pitch > 127 || !targetChord.pitchClass.contains(pitch % 12)) return;
+            s.candidatePitch[v][count] = static_cast<uint8_t>(pitch);
+            s.candidateMotion[v][count] = calculateMotionCost(static_cast<uint8_t>(origin), static_cast<uint8_t>(pitch));
+            ++count;
+        };
+        
+        addCandidate(origin);
+        for (int distance = 1; distance <= kMaxSearchRadius; ++distance) {
+            addCandidate(origin + distance);
+            addCandidate(origin - distance);
+        }
+        s.numCandidates[v] = count;
+    }
+    
+    // Crossings never reach the search (forbidden by order, or allowed and
+    // free), so the pair terms are contrary motion and parallels
+    s.contraryBonus = config_.contraryBonus;
+    s.parallelPenalty = config_.parallelPenalty;
+    for (size_t d = 0; d < n; ++d) {
+        s.perfectMask[d] = 0;
+        for (size_t i = 0; i < d; ++i) {
+            const int interval = std::abs(s.from[i] - s.from[d]);
+            if (interval == 7 || interval == 12) {
+                s.perfectMask[d] |= static_cast<uint8_t>(1u << i);
+            }
+        }
+    }
+    
+    s.restMotion[n] = 0.0f;
+    for (size_t d = n; d-- > 0;) {
+        const float minMotion = s.numCandidates[d] > 0 ? s.candidateMotion[d][0] : 0.0f;
+        s.restMotion[d] = s.restMotion[d + 1] + minMotion;
+    }
+    
+    std::fill(std::begin(s.pitchClassUses), std::end(s.pitchClassUses), uint8_t{0});
+    s.coveredTones = 0;
+    s.usedPitches[0] = s.usedPitches[1] = 0;
+    s.movingUp = s.movingDown = 0;
+    s.bestCost = std::numeric_limits<float>::infinity();
+    s.found = false;
+    s.stats.exhaustive = true;
+    
+    search(s, 0, 0.0f);
+    
+    if (stats) *stats = s.stats;
+    if (!s.found) {
+        return std::numeric_limits<float>::infinity();
+    }
+    
+    for (size_t v = 0; v < n; ++v) {
+        to.pitches[s.order[v]] = static_cast<uint8_t>(s.best[v]);
+    }
+    return calculateCost(from, to);
+}
+
+namespace {
+
+// Empty slot of the plan's candidate set; packed pitches stay below 128
+constexpr uint64_t kEmptySlot = ~uint64_t{0};
+
+// Most voice pairs that can end up in contrary motion once `remaining` more
+// voices join `up` rising and `down` falling ones
+int maxContraryPairs(int up, int down, int remaining) noexcept {
+    const int split = std::clamp((down + remaining - up) / 2, 0, remaining);
+    const int low = (up + split) * (down + remaining - split);
+    const int high = split < remaining ? (up + split + 1) * (down + remaining - split - 1) : low;
+    return std::max(low, high);
+}
+
+} // anonymous namespace
+
+void VoiceLeading::search(SearchScratch& s, size_t depth, float partialCost) const noexcept {
+    const size_t n = s.numVoices;
+    if (depth == n) {
+        if (partialCost < s.bestCost) {
+            s.bestCost = partialCost;
+            std::copy(s.current, s.current + n, s.best);
+            s.found = true;
+        }
+        return;
+    }
+    
+    const int remainingAfter = static_cast<int>(n - depth - 1);
+    const float bonus = std::max(0.0f, s.contraryBonus);
+    const float parallelFloor = std::min(0.0f, s.parallelPenalty) *
+        static_cast<float>(n * (n - 1) / 2 - depth * (depth + 1) / 2);
+    
+    // Lower bound on everything but this voice's own motion, for a voice
+    // moving up, down or staying: contrary pairs it forms now, plus the most
+    // the unassigned voices could still form, plus their least motion
+    auto restBound = [&](int up, int down) {
+        const int gained = maxContraryPairs(up, down, remainingAfter) - up * down;
+        return s.restMotion[depth + 1] - bonus * static_cast<float>(gained) + parallelFloor;
+    };
+    const float boundUp = -s.contraryBonus * static_cast<float>(s.movingDown) +
+                          restBound(s.movingUp + 1, s.movingDown);
+    const float boundDown = -s.contraryBonus * static_cast<float>(s.movingUp) +
+                            restBound(s.movingUp, s.movingDown + 1);
+    const float boundStay = restBound(s.movingUp, s.movingDown);
+    const float boundAny = std::min({boundUp, boundDown, boundStay});
+    
+    for (uint8_t c = 0; c < s.numCandidates[depth]; ++c) {
+        const float motionCost = s.candidateMotion[depth][c];
+        
+        // Candidates are sorted by motion, so no later one can do better
+        if (partialCost + motionCost + boundAny >= s.bestCost) {
+            break;
+        }
+        
+        const int pitch = s.candidatePitch[depth][c];
+        if (s.keepOrder && depth > 0 && pitch <= s.current[depth - 1]) {
+            continue;
+        }
+        
+        const uint64_t pitchBit = uint64_t{1} << (pitch & 63);
+        if (s.usedPitches[pitch >> 6] & pitchBit) {
+            continue;  // No unisons between voices
+        }
+        
+        const int pitchClass = pitch % 12;
+        const int covered = s.coveredTones + (s.pitchClassUses[pitchClass] == 0 ? 1 : 0);
+        if (s.requiredTones - covered > remainingAfter) {
+            continue;  // Too few voices left to complete the chord
+        }
+        
+        if (s.stats.nodes >= s.budget) {
+            s.stats.exhaustive = false;
+            return;
+        }
+        ++s.stats.nodes;
+        if (s.hasDeadline && s.stats.nodes % kDeadlineCheckNodes == 0
+            && std::chrono::steady_clock::now() >= s.deadline) {
+            s.stats.exhaustive = false;
+            s.stats.timedOut = true;
+            return;
+        }
+        
+        const int motion = pitch - s.from[depth];
+        float cost = partialCost + motionCost;
+        float bound = boundStay;
+        if (motion > 0) {
+            cost -= s.contraryBonus * static_cast<float>(s.movingDown);
+            bound = restBound(s.movingUp + 1, s.movingDown);
+        } else if (motion < 0) {
+            cost -= s.contraryBonus * static_cast<float>(s.movingUp);
+            bound = restBound(s.movingUp, s.movingDown + 1);
+        }
+        if (motion != 0) {
+            for (uint32_t mask = s.perfectMask[depth]; mask != 0; mask &= mask - 1) {
+                if (s.motion[std::countr_zero(mask)] == motion) {
+                    cost += s.parallelPenalty;  // Parallel fifth or octave
+                }
+            }
+        }
+        if (cost + bound >= s.bestCost) {
+            continue;
+        }
+        
+        s.current[depth] = pitch;
+        s.motion[depth] = motion;
+        s.movingUp += motion > 0 ? 1 : 0;
+        s.movingDown += motion < 0 ? 1 : 0;
+        s.usedPitches[pitch >> 6] |= pitchBit;
+        ++s.pitchClassUses[pitchClass];
+        const int previousCovered = s.coveredTones;
+        s.coveredTones = covered;
+        
+        search(s, depth + 1, cost);
+        
+        s.coveredTones = previousCovered;
+        --s.pitchClassUses[pitchClass];
+        s.usedPitches[pitch >> 6] &= ~pitchBit;
+        s.movingUp -= motion > 0 ? 1 : 0;
+        s.movingDown -= motion < 0 ? 1 : 0;
+        
+        if (!s.stats.exhaustive) {
+            return;  // Budget or deadline exhausted below
+        }
+    }
+}
+
+size_t VoiceLeading::enumerateVoicings(
+    PlanScratch& s,
+    const Voicing& anchor,
+    const Chord& chord,
+    size_t quota
+) const {
+    const size_t n = anchor.count;
+    const int required = std::min(static_cast<int>(n), static_cast<int>(chord.pitchClass.count()));
+    
+    // Same ordering rule as solve(): with crossing disallowed, voices are
+    // enumerated from the lowest up and their targets kept ascending
+    const bool keepOrder = !config_.allowVoiceCrossing;
+    for (size_t v = 0; v < n; ++v) {
+        s.order[v] = static_cast<uint8_t>(v);
+    }
+    if (keepOrder) {
+        // Insertion sort: stable, and no buffer for a handful of voices
+        for (size_t v = 1; v < n; ++v) {
+            const uint8_t voice = s.order[v];
+            size_t d = v;
+            for (; d > 0 && anchor.pitches[s.order[d - 1]] > anchor.pitches[voice]; --d) {
+                s.order[d] = s.order[d - 1];
+            }
+            s.order[d] = voice;
+        }
+    }
+    for (size_t d = 0; d < n; ++d) {
+        const int origin = anchor.pitches[s.order[d]];
+        s.numOptions[d] = 0;
+        
+        auto addOption = [&](int pitch, uint32_t distance) {
+            if (pitch >= 0 && pitch <= 127 && chord.pitchClass.contains(pitch % 12)) {
+                s.options[d][s.numOptions[d]] = pitch;
+                s.optionDistance[d][s.numOptions[d]] = distance;
+                ++s.numOptions[d];
+            }
+        };
+        
+        addOption(origin, 0);
+        for (int distance = 1; distance <= kPlanRadius; ++distance) {
+            addOption(origin + distance, static_cast<uint32_t>(distance));
+            addOption(origin - distance, static_cast<uint32_t>(distance));
+        }
+        if (s.numOptions[d] == 0) {
+            return 0;
+        }
+    }
+    s.restDistance[n] = 0;
+    for (size_t d = n; d-- > 0;) {
+        s.restDistance[d] = s.restDistance[d + 1] + s.optionDistance[d][0];
+    }
+    
+    s.enumerated.clear();
+    s.kept.clear();
+    uint32_t farthest = std::numeric_limits<uint32_t>::max();  // Once quota are kept
+    
+    // Iterative depth-first branch-and-bound over total displacement: once
+    // quota voicings are kept, branches that cannot beat the farthest are cut
+    int current[kMaxVoices] = {};
+    uint8_t next[kMaxVoices] = {};
+    uint8_t pitchClassUses[12] = {};
+    uint64_t usedPitches[2] = {};
+    int covered = 0;
+    uint32_t distance = 0;
+    size_t depth = 0;
+    size_t nodes = 0;
+    
+    auto release = [&](size_t d) {
+        const int pitch = current[d];
+        usedPitches[pitch >> 6] &= ~(uint64_t{1} << (pitch & 63));
+        covered -= --pitchClassUses[pitch % 12] == 0 ? 1 : 0;
+        distance -= s.optionDistance[d][next[d] - 1];
+    };
+    
+    while (nodes < kMaxPlanNodes) {
+        if (next[depth] == s.numOptions[depth]) {
+            if (depth == 0) {
+                break;
+            }
+            next[depth] = 0;
+            --depth;
+            release(depth);
+            continue;
+        }
+        
+        const uint32_t step = s.optionDistance[depth][next[depth]];
+        if (distance + step + s.restDistance[depth + 1] >= farthest) {
+            next[depth] = s.numOptions[depth];  // Options are nearest first
+            continue;
+        }
+        const int pitch = s.options[depth][next[depth]++];
+        if (keepOrder && depth > 0 && pitch <= current[depth - 1]) {
+            continue;
+        }
+        if (usedPitches[pitch >> 6] & (uint64_t{1} << (pitch & 63))) {
+            continue;  // No unisons between voices
+        }
+        const int coveredWith = covered + (pitchClassUses[pitch % 12] == 0 ? 1 : 0);
+        if (required - coveredWith > static_cast<int>(n - depth - 1)) {
+            continue;  // Too few voices left to complete the chord
+        }
+        ++nodes;
+        
+        current[depth] = pitch;
+        usedPitches[pitch >> 6] |= uint64_t{1} << (pitch & 63);
+        ++pitchClassUses[pitch % 12];
+        covered = coveredWith;
+        distance += step;
+        
+        if (depth + 1 < n) {
+            ++depth;
+            continue;
+        }
+        
+        Voicing voicing;
+        voicing.count = static_cast<uint8_t>(n);
+        for (size_t d = 0; d < n; ++d) {
+            voicing.pitches[s.order[d]] = static_cast<uint8_t>(current[d]);
+        }
+        uint64_t slot = s.enumerated.size();
+        if (s.kept.size() < quota) {
+            s.enumerated.push_back(voicing);
+        } else {
+            // Replaces the farthest kept voicing
+            std::pop_heap(s.kept.begin(), s.kept.end());
+            slot = s.kept.back() & 0xFFFFFFFFu;
+            s.enumerated[slot] = voicing;
+            s.kept.pop_back();
+        }
+        s.kept.push_back(uint64_t{distance} << 32 | slot);
+        std::push_heap(s.kept.begin(), s.kept.end());
+        if (s.kept.size() == quota) {
+            farthest = static_cast<uint32_t>(s.kept.front() >> 32);
+        }
+        release(depth);
+    }
+    
+    std::sort(s.kept.begin(), s.kept.end());
+    for (uint64_t key : s.kept) {
+        s.candidates.push_back(s.enumerated[key & 0xFFFFFFFFu]);
+    }
+    return s.kept.size();
+}
+
+float VoiceLeading::planProgression(
+    const Chord* chords,
+    size_t numChords,
+    const Voicing& start,
+    Voicing* path
+) {
+    std::fill(path, path + numChords, start);
+    if (numChords == 0 || start.count == 0) {
+        return 0.0f;
+    }
+    if (start.count > kMaxVoices) {
+        return std::numeric_limits<float>::infinity();
+    }
+    
+    auto& s = *planScratch_;
+    const size_t beamWidth = std::max<uint32_t>(config_.beamWidth, 1);
+    if (s.beam.size() < numChords * beamWidth) {
+        s.beam.resize(numChords * beamWidth);
+        s.back.resize(numChords * beamWidth);
+    }
+    s.beamCost.resize(beamWidth);
+    s.nextBeamCost.resize(beamWidth);
+    
+    // Before the first chord the beam is just the starting voicing
+    s.beamCost[0] = 0.0f;
+    size_t beamSize = 1;
+    
+    for (size_t t = 0; t < numChords; ++t) {
+        // Candidates continue the surviving paths, each state's closest
+        // voicings sharing the candidate budget
+        const size_t quota = std::max<size_t>(config_.maxPlanCandidates / beamSize, 1);
+        s.candidates.clear();
+        for (size_t b = 0; b < beamSize; ++b) {
+            enumerateVoicings(s, t == 0 ? start : s.beam[(t - 1) * beamWidth + b], chords[t], quota);
+        }
+        
+        // Neighbouring states share most of their voicings; keep the first
+        // of each, found through an open-addressed set of packed pitches
+        size_t tableSize = 16;
+        while (tableSize < 2 * s.candidates.size()) tableSize *= 2;
+        s.seen.assign(tableSize, kEmptySlot);
+        size_t numCandidates = 0;
+        for (size_t c = 0; c < s.candidates.size(); ++c) {
+            const auto key = std::bit_cast<uint64_t>(s.candidates[c].pitches);
+            size_t slot = static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> 32) & (tableSize - 1);
+            while (s.seen[slot] != kEmptySlot && s.seen[slot] != key) {
+                slot = (slot + 1) & (tableSize - 1);
+            }
+            if (s.seen[slot] == key) {
+                continue;
+            }
+            s.seen[slot] = key;
+            s.candidates[numCandidates++] = s.candidates[c];
+        }
+        s.candidates.resize(numCandidates);
+        
+        if (numCandidates == 0) {
+            std::fill(path, path + numChords, start);
+            return std::numeric_limits<float>::infinity();
+        }
+        
+        s.transition.resize(numCandidates);
+        s.pathCost.assign(numCandidates, std::numeric_limits<float>::infinity());
+        s.pathFrom.assign(numCandidates, 0);
+        
+        // Relax every candidate from every surviving state; on ties the
+        // earlier (cheaper) state wins
+        for (size_t b = 0; b < beamSize; ++b) {
+            const Voicing& previous = t == 0 ? start : s.beam[(t - 1) * beamWidth + b];
+            calculateCostsSIMD(previous, s.candidates.data(), numCandidates, s.transition.data());
+            for (size_t c = 0; c < numCandidates; ++c) {
+                const float cost = s.beamCost[b] + s.transition[c];
+                if (cost < s.pathCost[c]) {
+                    s.pathCost[c] = cost;
+                    s.pathFrom[c] = static_cast<uint32_t>(b);
+                }
+            }
+        }
+        
+        // The cheapest paths survive, cheapest first
+        const size_t survivors = std::min(beamWidth, numCandidates);
+        s.rank.resize(numCandidates);
+        for (size_t c = 0; c < numCandidates; ++c) {
+            s.rank[c] = static_cast<uint32_t>(c);
+        }
+        std::partial_sort(s.rank.begin(), s.rank.begin() + survivors, s.rank.end(), [&s](uint32_t a, uint32_t b) {
+            return s.pathCost[a] != s.pathCost[b] ? s.pathCost[a] < s.pathCost[b] : a < b;
+        });
+        for (size_t i = 0; i < survivors; ++i) {
+            s.beam[t * beamWidth + i] = s.candidates[s.rank[i]];
+            s.back[t * beamWidth + i] = s.pathFrom[s.rank[i]];
+            s.nextBeamCost[i] = s.pathCost[s.rank[i]];
+        }
+        std::swap(s.beamCost, s.nextBeamCost);
+        beamSize = survivors;
+    }
+    
+    // Trace the cheapest final state back to the first chord
+    size_t state = 0;
+    for (size_t t = numChords; t-- > 0;) {
+        path[t] = s.beam[t * beamWidth + state];
+        state = s.back[t * beamWidth + state];
+    }
+    return s.beamCost[0];
+}
+
 std::vector<Note> VoiceLeading::findOptimalVoicing(
     const Chord& targetChord,
     const std::vector<Note>& currentVoices,
@@ -21,7 +580,7 @@ std::vector<Note> VoiceLeading::findOptimalVoicing(
         
         // Extract chord tones from pitch class set
         for (int i = 0; i < 12; ++i) {
-            if (targetChord.pitchClass[i]) {
+            if (targetChord.pitchClass.contains(i)) {
                 Note note;
                 note.pitch = targetOctave * 12 + i;
                 note.velocity = 80;
@@ -33,28 +592,26 @@ std::vector<Note> VoiceLeading::findOptimalVoicing(
         return result;
     }
     
-    // Generate candidate voicings
-    std::vector<VoicingCandidate> candidates;
-    generateVoicingCandidates(targetChord, targetOctave, candidates);
-    
-    if (candidates.empty()) {
-        return currentVoices;  // Fallback to current voicing
+    if (currentVoices.size() > kMaxVoices) {
+        return currentVoices;  // Beyond the solver's fixed capacity
     }
     
-    // Find voicing with minimum cost from current voices
-    float minCost = std::numeric_limits<float>::max();
-    const VoicingCandidate* bestCandidate = nullptr;
+    Voicing from;
+    from.count = static_cast<uint8_t>(currentVoices.size());
+    for (size_t i = 0; i < currentVoices.size(); ++i) {
+        from.pitches[i] = currentVoices[i].pitch;
+    }
     
-    for (const auto& candidate : candidates) {
-        float cost = calculateCost(currentVoices, candidate.voices);
-        
-        if (cost < minCost) {
-            minCost = cost;
-            bestCandidate = &candidate;
-        }
+    Voicing to;
+    if (!std::isfinite(solve(from, targetChord, to))) {
+        return currentVoices;  // Fallback to current voicing
     }
     
-    return bestCandidate ? bestCandidate->voices : currentVoices;
+    std::vector<Note> result = currentVoices;
+    for (size_t i = 0; i < result.size(); ++i) {
+        result[i].pitch = to.pitches[i];
+    }
+    return result;
 }
 
 float VoiceLeading::calculateCost(
@@ -65,6 +622,17 @@ float VoiceLeading::calculateCost(
         return std::numeric_limits<float>::max();
     }
     
+    if (from.size() <= kMaxVoices) {
+        Voicing fromVoicing;
+        Voicing toVoicing;
+        fromVoicing.count = toVoicing.count = static_cast<uint8_t>(from.size());
+        for (size_t i = 0; i < from.size(); ++i) {
+            fromVoicing.pitches[i] = from[i].pitch;
+            toVoicing.pitches[i] = to[i].pitch;
+        }
+        return calculateCost(fromVoicing, toVoicing);
+    }
+    
     float totalCost = 0.0f;
     
     // Calculate individual voice motion costs
@@ -72,121 +640,61 @@ float VoiceLeading::calculateCost(
         totalCost += calculateMotionCost(from[i].pitch, to[i].pitch);
     }
     
-    // Penalize parallel motion
+    // Parallels, contrary motion and crossings per voice pair
     for (size_t i = 0; i < from.size(); ++i) {
         for (size_t j = i + 1; j < from.size(); ++j) {
-            int interval1 = std::abs(static_cast<int>(from[i].pitch) - static_cast<int>(from[j].pitch));
-            int interval2 = std::abs(static_cast<int>(to[i].pitch) - static_cast<int>(to[j].pitch));
-            int motion1 = static_cast<int>(to[i].pitch) - static_cast<int>(from[i].pitch);
-            int motion2 = static_cast<int>(to[j].pitch) - static_cast<int>(from[j].pitch);
-            
-            // Parallel fifths and octaves are heavily penalized
-            if ((interval1 == 7 || interval1 == 12) && interval1 == interval2 && 
-                motion1 == motion2 && motion1 != 0) {
-                totalCost += config_.parallelPenalty;
-            }
-        }
-    }
-    
-    // Reward contrary motion
-    for (size_t i = 0; i < from.size(); ++i) {
-        for (size_t j = i + 1; j < from.size(); ++j) {
-            int motion1 = static_cast<int>(to[i].pitch) - static_cast<int>(from[i].pitch);
-            int motion2 = static_cast<int>(to[j].pitch) - static_cast<int>(from[j].pitch);
-            
-            // Voices moving in opposite directions
-            if ((motion1 > 0 && motion2 < 0) || (motion1 < 0 && motion2 > 0)) {
-                totalCost -= config_.contraryBonus;
-            }
-        }
-    }
-    
-    // Penalize voice crossing if not allowed
-    if (!config_.allowVoiceCrossing) {
-        for (size_t i = 0; i < to.size(); ++i) {
-            for (size_t j = i + 1; j < to.size(); ++j) {
-                bool crossing = 
-                    (from[i].pitch < from[j].pitch && to[i].pitch > to[j].pitch) ||
-                    (from[i].pitch > from[j].pitch && to[i].pitch < to[j].pitch);
-                
-                if (crossing) {
-                    totalCost += config_.parallelPenalty * 2.0f;
-                }
-            }
+            totalCost += calculatePairCost(from[i].pitch, from[j].pitch, to[i].pitch, to[j].pitch);
         }
     }
     
     return totalCost;
 }
 
-void VoiceLeading::updateConfig(const Config& config) noexcept {
-    config_ = config;
+float VoiceLeading::calculateCost(const Voicing& from, const Voicing& to) const noexcept {
+    float cost = 0.0f;
+    calculateCostsSIMD(from, &to, 1, &cost);
+    return cost;
 }
 
-void VoiceLeading::generateVoicingCandidates(
-    const Chord& chord,
-    uint8_t octave,
-    std::vector<VoicingCandidate>& candidates
+void VoiceLeading::calculateCosts(
+    const Voicing& from,
+    const Voicing* candidates,
+    size_t count,
+    float* costs
+) const noexcept {
+    calculateCostsSIMD(from, candidates, count, costs);
+}
+
+void VoiceLeading::calculateCostsScalar(
+    const Voicing& from,
+    const Voicing* candidates,
+    size_t count,
+    float* costs
 ) const noexcept {
-    // Extract chord tones
-    std::vector<uint8_t> chordTones;
-    for (int i = 0; i < 12; ++i) {
-        if (chord.pitchClass[i]) {
-            chordTones.push_back(i);
+    for (size_t k = 0; k < count; ++k) {
+        const Voicing& to = candidates[k];
+        if (from.count != to.count || from.count > kMaxVoices) {
+            costs[k] = std::numeric_limits<float>::max();
+            continue;
         }
-    }
-    
-    if (chordTones.empty()) {
-        return;
-    }
-    
-    // Generate voicings in multiple octaves (for flexibility)
-    for (int oct = octave - 1; oct <= octave + 1; ++oct) {
-        if (oct < 0 || oct > 8) continue;
         
-        VoicingCandidate candidate;
-        
-        for (uint8_t tone : chordTones) {
-            Note note;
-            note.pitch = oct * 12 + tone;
-            note.velocity = 80;
-            note.timestamp = 0.0;
-            candidate.voices.push_back(note);
+        float totalCost = 0.0f;
+        for (size_t i = 0; i < from.count; ++i) {
+            totalCost += calculateMotionCost(from.pitches[i], to.pitches[i]);
         }
-        
-        // Sort voices by pitch (low to high)
-        std::sort(candidate.voices.begin(), candidate.voices.end(),
-            [](const Note& a, const Note& b) { return a.pitch < b.pitch; });
-        
-        candidate.cost = 0.0f;  // Will be calculated later
-        candidates.push_back(candidate);
-    }
-    
-    // Generate inversions (different bass notes)
-    for (size_t bassIndex = 1; bassIndex < chordTones.size(); ++bassIndex) {
-        VoicingCandidate candidate;
-        
-        // Start with a different chord tone in the bass
-        for (size_t i = 0; i < chordTones.size(); ++i) {
-            size_t toneIndex = (bassIndex + i) % chordTones.size();
-            uint8_t tone = chordTones[toneIndex];
-            
-            Note note;
-            note.pitch = octave * 12 + tone;
-            // Adjust octave for lower voices if needed
-            if (i > 0 && note.pitch <= candidate.voices.back().pitch) {
-                note.pitch += 12;
+        for (size_t i = 0; i < from.count; ++i) {
+            for (size_t j = i + 1; j < from.count; ++j) {
+                totalCost += calculatePairCost(from.pitches[i], from.pitches[j], to.pitches[i], to.pitches[j]);
             }
-            note.velocity = 80;
-            note.timestamp = 0.0;
-            candidate.voices.push_back(note);
         }
-        
-        candidate.cost = 0.0f;
-        candidates.push_back(candidate);
+        costs[k] = totalCost;
     }
 }
 
+void VoiceLeading::updateConfig(const Config& config) noexcept {
+    config_ = config;
+}
+
 float VoiceLeading::calculateMotionCost(
     uint8_t fromPitch,
     uint8_t toPitch
@@ -202,4 +710,37 @@ float VoiceLeading::calculateMotionCost(
     return distance;
 }
 
+float VoiceLeading::calculatePairCost(
+    int fromI, int fromJ,
+    int toI, int toJ
+) const noexcept {
+    float cost = 0.0f;
+    
+    const int interval1 = std::abs(fromI - fromJ);
+    const int interval2 = std::abs(toI - toJ);
+    const int motion1 = toI - fromI;
+    const int motion2 = toJ - fromJ;
+    
+    // Parallel fifths and octaves are heavily penalized
+    if ((interval1 == 7 || interval1 == 12) && interval1 == interval2 &&
+        motion1 == motion2 && motion1 != 0) {
+        cost += config_.parallelPenalty;
+    }
+    
+    // Reward contrary motion (voices moving in opposite directions)
+    if ((motion1 > 0 && motion2 < 0) || (motion1 < 0 && motion2 > 0)) {
+        cost -= config_.contraryBonus;
+    }
+    
+    // Penalize voice crossing if not allowed
+    if (!config_.allowVoiceCrossing) {
+        const bool crossing = (fromI < fromJ && toI > toJ) || (fromI > fromJ && toI < toJ);
+        if (crossing) {
+            cost += config_.parallelPenalty * 2.0f;
+        }
+    }
+    
+    return cost;
+}
+
 } // namespace penta::harmony
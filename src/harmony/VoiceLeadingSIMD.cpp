@@ -0,0 +1,147 @@
+#include "penta/harmony/VoiceLeading.h"
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+
+// SIMD intrinsics
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace penta::harmony {
+
+#ifdef __AVX2__
+
+// AVX2 batched voice-leading cost: eight candidate voicings per pass, one
+// per lane, with each voice's target pitches transposed into a register.
+// All pair terms of calculatePairCost collapse into lane counters:
+//  - contrary pairs are (voices moving up) * (voices moving down)
+//  - parallels are only possible for pairs a fifth or octave apart in the
+//    source voicing, and need equal non-zero motion
+//  - crossings only need the target order of pairs whose source order is known
+// so every pair costs one or two compare/mask operations for all eight lanes.
+void VoiceLeading::calculateCostsSIMD(
+    const Voicing& from,
+    const Voicing* candidates,
+    size_t count,
+    float* costs
+) const noexcept {
+    const size_t n = from.count;
+    if (n > kMaxVoices) {
+        std::fill(costs, costs + count, std::numeric_limits<float>::max());
+        return;
+    }
+    
+    // Pair classes depend on the source voicing only
+    uint8_t perfectPairs[kMaxVoices * kMaxVoices][2];
+    uint8_t orderedPairs[kMaxVoices * kMaxVoices][2];  // [lower, upper] source voice
+    size_t numPerfect = 0;
+    size_t numOrdered = 0;
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = i + 1; j < n; ++j) {
+            const int fromI = from.pitches[i];
+            const int fromJ = from.pitches[j];
+            const int interval = std::abs(fromI - fromJ);
+            if (interval == 7 || interval == 12) {
+                perfectPairs[numPerfect][0] = static_cast<uint8_t>(i);
+                perfectPairs[numPerfect][1] = static_cast<uint8_t>(j);
+                ++numPerfect;
+            }
+            if (!config_.allowVoiceCrossing && fromI != fromJ) {
+                orderedPairs[numOrdered][0] = static_cast<uint8_t>(fromI < fromJ ? i : j);
+                orderedPairs[numOrdered][1] = static_cast<uint8_t>(fromI < fromJ ? j : i);
+                ++numOrdered;
+            }
+        }
+    }
+    
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256 maxDistance = _mm256_set1_ps(config_.maxVoiceDistance);
+    const __m256 parallelPenalty = _mm256_set1_ps(config_.parallelPenalty);
+    const __m256 crossingPenalty = _mm256_set1_ps(config_.parallelPenalty * 2.0f);
+    const __m256 contraryBonus = _mm256_set1_ps(config_.contraryBonus);
+    
+    alignas(32) int32_t lanes[kMaxVoices][8];
+    alignas(32) float blockCosts[8];
+    __m256i target[kMaxVoices];
+    __m256i motion[kMaxVoices];
+    
+    for (size_t base = 0; base < count; base += 8) {
+        const size_t blockSize = std::min<size_t>(8, count - base);
+        
+        // Transpose to SoA; unused lanes repeat the source (zero cost)
+        for (size_t v = 0; v < n; ++v) {
+            for (size_t k = 0; k < 8; ++k) {
+                lanes[v][k] = k < blockSize ? candidates[base + k].pitches[v] : from.pitches[v];
+            }
+        }
+        
+        __m256 totalCost = _mm256_setzero_ps();
+        __m256i movingUp = zero;
+        __m256i movingDown = zero;
+        for (size_t v = 0; v < n; ++v) {
+            target[v] = _mm256_load_si256(reinterpret_cast<const __m256i*>(lanes[v]));
+            motion[v] = _mm256_sub_epi32(target[v], _mm256_set1_epi32(from.pitches[v]));
+            
+            // Motion cost, doubled past maxVoiceDistance
+            const __m256 distance = _mm256_cvtepi32_ps(_mm256_abs_epi32(motion[v]));
+            const __m256 leap = _mm256_cmp_ps(distance, maxDistance, _CMP_GT_OQ);
+            totalCost = _mm256_add_ps(totalCost,
+                _mm256_blendv_ps(distance, _mm256_add_ps(distance, distance), leap));
+            
+            // Compare masks are -1, so subtracting counts them
+            movingUp = _mm256_sub_epi32(movingUp, _mm256_cmpgt_epi32(motion[v], zero));
+            movingDown = _mm256_sub_epi32(movingDown, _mm256_cmpgt_epi32(zero, motion[v]));
+        }
+        
+        __m256i parallels = zero;
+        for (size_t p = 0; p < numPerfect; ++p) {
+            const __m256i motionI = motion[perfectPairs[p][0]];
+            const __m256i same = _mm256_cmpeq_epi32(motionI, motion[perfectPairs[p][1]]);
+            const __m256i still = _mm256_cmpeq_epi32(motionI, zero);
+            parallels = _mm256_sub_epi32(parallels, _mm256_andnot_si256(still, same));
+        }
+        
+        __m256i crossings = zero;
+        for (size_t p = 0; p < numOrdered; ++p) {
+            crossings = _mm256_sub_epi32(crossings,
+                _mm256_cmpgt_epi32(target[orderedPairs[p][0]], target[orderedPairs[p][1]]));
+        }
+        
+        const __m256i contrary = _mm256_mullo_epi32(movingUp, movingDown);
+#ifdef __FMA__
+        totalCost = _mm256_fmadd_ps(parallelPenalty, _mm256_cvtepi32_ps(parallels), totalCost);
+        totalCost = _mm256_fnmadd_ps(contraryBonus, _mm256_cvtepi32_ps(contrary), totalCost);
+        totalCost = _mm256_fmadd_ps(crossingPenalty, _mm256_cvtepi32_ps(crossings), totalCost);
+#else
+        totalCost = _mm256_add_ps(totalCost, _mm256_mul_ps(parallelPenalty, _mm256_cvtepi32_ps(parallels)));
+        totalCost = _mm256_sub_ps(totalCost, _mm256_mul_ps(contraryBonus, _mm256_cvtepi32_ps(contrary)));
+        totalCost = _mm256_add_ps(totalCost, _mm256_mul_ps(crossingPenalty, _mm256_cvtepi32_ps(crossings)));
+#endif
+
+        _mm256_store_ps(blockCosts, totalCost);
+        for (size_t k = 0; k < blockSize; ++k) {
+            costs[base + k] = candidates[base + k].count == from.count
+                ? blockCosts[k]
+                : std::numeric_limits<float>::max();
+        }
+    }
+}
+
+#endif // __AVX2__
+
+// Scalar fallback when AVX2 not available
+#ifndef __AVX2__
+
+void VoiceLeading::calculateCostsSIMD(
+    const Voicing& from,
+    const Voicing* candidates,
+    size_t count,
+    float* costs
+) const noexcept {
+    calculateCostsScalar(from, candidates, count, costs);
+}
+
+#endif // __AVX2__
+
+} // namespace penta::harmony
@@ -0,0 +1,321 @@
+#include <gtest/gtest.h>
+#include "penta/batch/CorpusAnalyzer.h"
+#include "penta/batch/ReharmonizationEngine.h"
+#include "penta/batch/WorkStealingPool.h"
+#include "penta/harmony/ChordAnalyzer.h"
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+using namespace penta;
+using namespace penta::batch;
+
+// ========== WorkStealingPool Tests ==========
+
+TEST(WorkStealingPoolTest, RunsEveryItemExactlyOnce) {
+    WorkStealingPool pool(4);
+    std::vector<std::atomic<int>> hits(1000);
+    
+    pool.parallelFor(hits.size(), [&](size_t item, size_t worker) {
+        EXPECT_LT(worker, pool.getNumThreads());
+        hits[item].fetch_add(1);
+    });
+    
+    for (const auto& h : hits) {
+        EXPECT_EQ(h.load(), 1);
+    }
+}
+
+TEST(WorkStealingPoolTest, ReusableAcrossJobs) {
+    WorkStealingPool pool(3);
+    std::atomic<size_t> total{0};
+    
+    for (int job = 0; job < 20; ++job) {
+        pool.parallelFor(50, [&](size_t, size_t) { total.fetch_add(1); });
+    }
+    
+    EXPECT_EQ(total.load(), 1000u);
+}
+
+TEST(WorkStealingPoolTest, PropagatesExceptions) {
+    WorkStealingPool pool(2);
+    std::atomic<size_t> ran{0};
+    
+    EXPECT_THROW(pool.parallelFor(10, [&](size_t item, size_t) {
+        ran.fetch_add(1);
+        if (item == 3) throw std::runtime_error("bad item");
+    }), std::runtime_error);
+    
+    EXPECT_EQ(ran.load(), 10u);
+}
+
+// ========== CorpusAnalyzer Tests ==========
+
+class CorpusAnalyzerTest : public ::testing::Test {
+protected:
+    static std::vector<Note> triad(uint8_t root, uint64_t at) {
+        return {
+            Note{static_cast<uint8_t>(root), 80, 0, at},
+            Note{static_cast<uint8_t>(root + 4), 80, 0, at},
+            Note{static_cast<uint8_t>(root + 7), 80, 0, at},
+        };
+    }
+};
+
+TEST_F(CorpusAnalyzerTest, MatchesSingleEngineAndGathersContiguously) {
+    CorpusAnalyzer::Config config;
+    config.numThreads = 4;
+    config.hopSamples = 1024;
+    CorpusAnalyzer analyzer(config);
+    
+    // Tracks of different lengths, one major triad per track
+    std::vector<std::vector<Note>> tracks;
+    for (uint8_t i = 0; i < 24; ++i) {
+        tracks.push_back(triad(static_cast<uint8_t>(48 + i % 12), i * 2048u));
+    }
+    
+    std::vector<CorpusAnalyzer::NoteStream> items;
+    for (const auto& t : tracks) {
+        items.push_back({t.data(), t.size()});
+    }
+    
+    size_t lastProgress = 0;
+    auto results = analyzer.analyzeHarmony(items, [&](size_t done, size_t total) {
+        EXPECT_EQ(total, items.size());
+        EXPECT_EQ(done, lastProgress + 1);  // Serialized, monotonic
+        lastProgress = done;
+    });
+    
+    EXPECT_FALSE(results.cancelled);
+    EXPECT_EQ(lastProgress, items.size());
+    ASSERT_EQ(results.offsets.size(), items.size() + 1);
+    EXPECT_EQ(results.offsets.back(), results.frames.size());
+    
+    harmony::HarmonyEngine reference(config.harmonyConfig);
+    for (size_t i = 0; i < items.size(); ++i) {
+        auto expected = reference.analyzeTimeline(items[i].notes, items[i].count, config.hopSamples);
+        ASSERT_EQ(results.offsets[i + 1] - results.offsets[i], expected.size());
+        
+        const auto& last = results.frames[results.offsets[i + 1] - 1];
+        EXPECT_EQ(last.chord.root, expected.back().chord.root);
+        EXPECT_EQ(last.chord.root, i % 12);
+        EXPECT_EQ(last.chord.quality, 0);
+    }
+}
+
+TEST_F(CorpusAnalyzerTest, CancelSkipsRemainingItems) {
+    CorpusAnalyzer::Config config;
+    config.numThreads = 2;
+    CorpusAnalyzer analyzer(config);
+    
+    auto track = triad(60, 0);
+    std::vector<CorpusAnalyzer::NoteStream> items(200, {track.data(), track.size()});
+    
+    auto results = analyzer.analyzeHarmony(items, [&](size_t done, size_t) {
+        if (done == 10) analyzer.cancel();
+    });
+    
+    size_t completed = 0;
+    for (auto c : results.completed) completed += c;
+    
+    EXPECT_TRUE(results.cancelled);
+    EXPECT_GE(completed, 10u);
+    EXPECT_LT(completed, items.size());
+}
+
+TEST_F(CorpusAnalyzerTest, CancelBeforeStartAppliesToNextRunOnly) {
+    CorpusAnalyzer::Config config;
+    config.numThreads = 2;
+    CorpusAnalyzer analyzer(config);
+    
+    auto track = triad(60, 0);
+    std::vector<CorpusAnalyzer::NoteStream> items(20, {track.data(), track.size()});
+    
+    analyzer.cancel();
+    auto cancelled = analyzer.analyzeHarmony(items);
+    EXPECT_TRUE(cancelled.cancelled);
+    for (auto c : cancelled.completed) {
+        EXPECT_EQ(c, 0);
+    }
+    
+    auto results = analyzer.analyzeHarmony(items);
+    EXPECT_FALSE(results.cancelled);
+}
+
+TEST_F(CorpusAnalyzerTest, AnalyzesAudioBuffers) {
+    CorpusAnalyzer::Config config;
+    config.numThreads = 2;
+    CorpusAnalyzer analyzer(config);
+    
+    std::vector<std::vector<float>> buffers(5, std::vector<float>(48000, 0.0f));
+    std::vector<CorpusAnalyzer::AudioStream> items;
+    for (const auto& b : buffers) {
+        items.push_back({b.data(), b.size()});
+    }
+    
+    auto results = analyzer.analyzeGroove(items);
+    
+    EXPECT_FALSE(results.cancelled);
+    ASSERT_EQ(results.summaries.size(), items.size());
+    ASSERT_EQ(results.onsetOffsets.size(), items.size() + 1);
+    EXPECT_EQ(results.onsetOffsets.back(), results.onsetPositions.size());
+    EXPECT_EQ(results.onsetPositions.size(), results.onsetStrengths.size());
+}
+
+TEST_F(CorpusAnalyzerTest, CollectsEveryOnsetOfLongTracks) {
+    CorpusAnalyzer::Config config;
+    config.numThreads = 2;
+    CorpusAnalyzer analyzer(config);
+    
+    // More onsets than a GrooveEngine keeps in its history
+    const size_t clicks = groove::GrooveEngine::kMaxOnsetHistory + 100;
+    std::vector<float> track(clicks * 6000 + 4096, 0.0f);
+    for (size_t i = 0; i < clicks; ++i) {
+        track[i * 6000 + 100] = 1.0f;
+    }
+    std::vector<CorpusAnalyzer::AudioStream> items(2, {track.data(), track.size()});
+    
+    auto results = analyzer.analyzeGroove(items);
+    
+    ASSERT_EQ(results.onsetOffsets.size(), items.size() + 1);
+    EXPECT_EQ(results.onsetOffsets[1], clicks);
+    EXPECT_EQ(results.onsetOffsets[2], 2 * clicks);
+    for (size_t i = 1; i < clicks; ++i) {
+        EXPECT_GT(results.onsetPositions[i], results.onsetPositions[i - 1]);
+    }
+}
+
+// ========== ReharmonizationEngine Tests ==========
+
+class ReharmonizationEngineTest : public ::testing::Test {
+protected:
+    static Chord chord(std::initializer_list<int> pitchClasses) {
+        Chord c;
+        c.pitchClass = PitchClassSet::fromPitchClasses(pitchClasses);
+        return c;
+    }
+    
+    // I - vi - IV - V with a short melody per bar
+    void SetUp() override {
+        melodies = {
+            {Note{64, 90}, Note{67, 80}},  // E G over C
+            {Note{69, 90}, Note{72, 80}},  // A C over Am
+            {Note{65, 90}, Note{69, 80}},  // F A over F
+            {Note{67, 90}, Note{71, 80}},  // G B over G
+        };
+        const Chord progression[] = {
+            chord({0, 4, 7}), chord({9, 0, 4}), chord({5, 9, 0}), chord({7, 11, 2})
+        };
+        for (size_t b = 0; b < melodies.size(); ++b) {
+            bars.push_back({melodies[b].data(), melodies[b].size(), progression[b]});
+        }
+    }
+    
+    std::vector<std::vector<Note>> melodies;
+    std::vector<ReharmonizationEngine::Bar> bars;
+};
+
+TEST_F(ReharmonizationEngineTest, SuggestsRankedAlternativesPerBar) {
+    ReharmonizationEngine::Config config;
+    config.numThreads = 2;
+    config.topK = 6;
+    ReharmonizationEngine engine(config);
+    
+    auto results = engine.suggest(bars);
+    ASSERT_EQ(results.offsets.size(), bars.size() + 1);
+    EXPECT_EQ(results.offsets.back(), results.suggestions.size());
+    
+    for (size_t b = 0; b < bars.size(); ++b) {
+        ASSERT_EQ(results.offsets[b + 1] - results.offsets[b], config.topK);
+        
+        PitchClassSet melody;
+        for (const auto& note : melodies[b]) {
+            melody.set(note.pitch % 12);
+        }
+        
+        for (size_t i = results.offsets[b]; i < results.offsets[b + 1]; ++i) {
+            const auto& s = results.suggestions[i];
+            EXPECT_NE(s.chord.pitchClass, bars[b].chord.pitchClass);
+            EXPECT_NEAR(s.score, s.chord.confidence - config.voiceLeadingWeight * s.voiceLeadingCost, 1e-5f);
+            if (i > results.offsets[b]) {
+                EXPECT_LE(s.score, results.suggestions[i - 1].score);
+            }
+            for (size_t j = results.offsets[b]; j < i; ++j) {
+                EXPECT_NE(s.chord.pitchClass, results.suggestions[j].chord.pitchClass);
+            }
+        }
+        
+        // The best alternative harmonizes every melody note
+        const auto& best = results.suggestions[results.offsets[b]];
+        EXPECT_EQ(best.chord.pitchClass & melody, melody) << "bar " << b;
+        
+        // Among chords holding the melody, fewer unsounded tones fit better
+        for (size_t i = results.offsets[b]; i < results.offsets[b + 1]; ++i) {
+            for (size_t j = results.offsets[b]; j < results.offsets[b + 1]; ++j) {
+                const auto& lean = results.suggestions[i].chord;
+                const auto& rich = results.suggestions[j].chord;
+                if ((lean.pitchClass & melody) == melody && (rich.pitchClass & melody) == melody
+                    && lean.pitchClass.count() < rich.pitchClass.count()) {
+                    EXPECT_GT(lean.confidence, rich.confidence) << "bar " << b;
+                }
+            }
+        }
+    }
+}
+
+TEST_F(ReharmonizationEngineTest, NeverSuggestsUnvoiceableChords) {
+    ReharmonizationEngine::Config config;
+    config.numThreads = 2;
+    config.topK = 12 * harmony::ChordAnalyzer::kNumTemplates;
+    ReharmonizationEngine engine(config);
+    
+    // A lone C major bar is voiced from its close voicing G3 C4 E4 G4
+    std::vector<ReharmonizationEngine::Bar> single = {{nullptr, 0, chord({0, 4, 7})}};
+    harmony::VoiceLeading::Voicing reference;
+    reference.pitches = {55, 60, 64, 67};
+    reference.count = 4;
+    
+    harmony::VoiceLeading voiceLeading(config.voiceLeadingConfig);
+    std::vector<PitchClassSet> infeasible;
+    for (size_t t = 0; t < harmony::ChordAnalyzer::kNumTemplates; ++t) {
+        for (uint8_t root = 0; root < 12; ++root) {
+            harmony::VoiceLeading::Voicing voicing;
+            if (!std::isfinite(voiceLeading.solve(reference, harmony::ChordAnalyzer::templateChord(t, root), voicing))) {
+                infeasible.push_back(harmony::ChordAnalyzer::templateChord(t, root).pitchClass);
+            }
+        }
+    }
+    ASSERT_FALSE(infeasible.empty());
+    
+    auto results = engine.suggest(single);
+    ASSERT_FALSE(results.suggestions.empty());
+    for (const auto& s : results.suggestions) {
+        EXPECT_TRUE(std::isfinite(s.score));
+        EXPECT_TRUE(std::isfinite(s.voiceLeadingCost));
+        for (const auto& pitchClasses : infeasible) {
+            EXPECT_NE(s.chord.pitchClass, pitchClasses);
+        }
+    }
+}
+
+TEST_F(ReharmonizationEngineTest, ResultsDoNotDependOnThreadCount) {
+    ReharmonizationEngine::Config config;
+    config.topK = 8;
+    config.numThreads = 1;
+    ReharmonizationEngine serial(config);
+    config.numThreads = 4;
+    ReharmonizationEngine parallel(config);
+    
+    auto expected = serial.suggest(bars);
+    auto actual = parallel.suggest(bars);
+    
+    ASSERT_EQ(actual.offsets, expected.offsets);
+    ASSERT_EQ(actual.suggestions.size(), expected.suggestions.size());
+    for (size_t i = 0; i < actual.suggestions.size(); ++i) {
+        EXPECT_EQ(actual.suggestions[i].chord.root, expected.suggestions[i].chord.root);
+        EXPECT_EQ(actual.suggestions[i].templateIndex, expected.suggestions[i].templateIndex);
+        EXPECT_EQ(actual.suggestions[i].score, expected.suggestions[i].score);
+        EXPECT_EQ(actual.suggestions[i].voicing.pitches, expected.suggestions[i].voicing.pitches);
+    }
+}
@@ -1,13 +1,80 @@
+#include "penta/common/RTFramer.h"
 #include "penta/groove/OnsetDetector.h"
 #include "penta/groove/TempoEstimator.h"
+#include "penta/groove/BeatTracker.h"
 #include "penta/groove/RhythmQuantizer.h"
 #include "penta/groove/GrooveEngine.h"
 #include <gtest/gtest.h>
 #include <cmath>
 #include <chrono>
+#include <vector>
 
 using namespace penta::groove;
 
+// ========== RTFramer Tests ==========
+
+namespace {
+
+// Block sizes a host might switch between, 16 to 4096 (about 500 on average)
+constexpr size_t kHostBlockSizes[] = {16, 32, 4096, 64, 128, 700, 16, 256, 96, 32, 48, 512};
+
+} // anonymous namespace
+
+TEST(RTFramerTest, EmitsHopAlignedFramesForAnyBlockSize) {
+    constexpr size_t frameSize = 1024;
+    constexpr size_t hopSize = 256;
+    penta::RTFramer framer(frameSize, hopSize, 32);
+    
+    // Sample t has value t + 1, so every frame can be checked exactly
+    std::vector<float> signal(40000);
+    for (size_t t = 0; t < signal.size(); ++t) {
+        signal[t] = static_cast<float>(t + 1);
+    }
+    
+    std::vector<float> frame(frameSize);
+    uint64_t expectedEnd = hopSize;
+    size_t offset = 0;
+    size_t block = 0;
+    while (offset < signal.size()) {
+        const size_t frames = std::min(kHostBlockSizes[block++ % std::size(kHostBlockSizes)],
+                                       signal.size() - offset);
+        framer.push(signal.data() + offset, frames);
+        offset += frames;
+        
+        uint64_t frameEnd = 0;
+        while (framer.pop(frame.data(), frameEnd)) {
+            ASSERT_EQ(frameEnd, expectedEnd);
+            for (size_t n = 0; n < frameSize; ++n) {
+                const int64_t t = static_cast<int64_t>(frameEnd - frameSize + n);
+                const float expected = t < 0 ? 0.0f : static_cast<float>(t + 1);
+                ASSERT_EQ(frame[n], expected) << "frame ending " << frameEnd << " sample " << n;
+            }
+            expectedEnd += hopSize;
+        }
+    }
+    
+    EXPECT_EQ(framer.getSamplePosition(), signal.size());
+    EXPECT_EQ(expectedEnd, (signal.size() / hopSize + 1) * hopSize);
+    EXPECT_EQ(framer.getDroppedFrames(), 0u);
+}
+
+TEST(RTFramerTest, DropsOldestFramesBeyondBacklog) {
+    penta::RTFramer framer(512, 128, 4);
+    std::vector<float> block(4096, 0.5f);
+    framer.push(block.data(), block.size());
+    
+    // 32 frames completed, only the newest 4 are kept
+    EXPECT_EQ(framer.getPendingFrames(), 4u);
+    EXPECT_EQ(framer.getDroppedFrames(), 28u);
+    
+    std::vector<float> frame(512);
+    uint64_t frameEnd = 0;
+    ASSERT_TRUE(framer.pop(frame.data(), frameEnd));
+    EXPECT_EQ(frameEnd, 4096u - 3 * 128);
+    EXPECT_EQ(frame.front(), 0.5f);
+    EXPECT_EQ(framer.getPendingFrames(), 3u);
+}
+
 // ========== OnsetDetector Tests ==========
 
 class OnsetDetectorTest : public ::testing::Test {
@@ -77,6 +144,217 @@ TEST_F(OnsetDetectorTest, RespondsToSensitivityChanges) {
     EXPECT_TRUE(highSens || !lowSens);
 }
 
+TEST_F(OnsetDetectorTest, FindsEveryClickOfATrain) {
+    // Clicks every 11025 samples (240 BPM) over a quiet noise floor
+    constexpr size_t blockSize = 512;
+    constexpr size_t interval = 11025;
+    constexpr size_t totalSamples = interval * 8;
+    
+    std::vector<float> signal(totalSamples);
+    uint32_t seed = 12345;
+    for (size_t i = 0; i < totalSamples; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        signal[i] = 0.001f * (static_cast<float>(seed >> 8) / 8388608.0f - 1.0f);
+        if (i % interval == 300) {
+            signal[i] = 1.0f;
+        }
+    }
+    
+    std::vector<uint64_t> onsets;
+    for (size_t offset = 0; offset < totalSamples; offset += blockSize) {
+        if (detector->processBlock(signal.data() + offset, blockSize)) {
+            onsets.push_back(detector->getOnsetPosition());
+            EXPECT_GT(detector->getOnsetStrength(), 0.5f);
+            EXPECT_LE(detector->getOnsetStrength(), 1.0f);
+        }
+    }
+    
+    // One onset per click, within a hop of it
+    ASSERT_EQ(onsets.size(), 8u);
+    for (size_t i = 0; i < onsets.size(); ++i) {
+        const double click = static_cast<double>(i * interval + 300);
+        EXPECT_NEAR(static_cast<double>(onsets[i]), click, blockSize);
+    }
+}
+
+TEST_F(OnsetDetectorTest, OnsetPositionsDoNotDependOnBlockSize) {
+    constexpr size_t interval = 9000;
+    std::vector<float> signal(interval * 10, 0.0f);
+    for (size_t i = 0; i < 10; ++i) {
+        signal[i * interval + 1234] = (i % 2 == 0) ? 1.0f : 0.6f;
+    }
+    
+    auto run = [&signal](OnsetDetector& onsetDetector, bool varyBlocks) {
+        std::vector<uint64_t> onsets;
+        size_t offset = 0;
+        size_t block = 0;
+        size_t analyzedBefore = 0;
+        // Trailing silence drains frames still waiting for analysis
+        std::vector<float> padded(signal);
+        padded.resize(signal.size() + 16 * 512, 0.0f);
+        while (offset < padded.size()) {
+            const size_t blockSize = varyBlocks ? kHostBlockSizes[block++ % std::size(kHostBlockSizes)] : 512;
+            const size_t frames = std::min(blockSize, padded.size() - offset);
+            if (onsetDetector.processBlock(padded.data() + offset, frames)) {
+                onsets.push_back(onsetDetector.getOnsetPosition());
+            }
+            offset += frames;
+            
+            // At most one frame is analyzed per call
+            const size_t analyzed = offset / 512 - onsetDetector.getPendingFrames();
+            EXPECT_LE(analyzed, analyzedBefore + 1);
+            analyzedBefore = analyzed;
+        }
+        return onsets;
+    };
+    
+    // Budget of one frame per call, so the backlog is exercised
+    OnsetDetector::Config budgeted;
+    budgeted.sampleRate = 44100.0;
+    budgeted.maxFramesPerBlock = 1;
+    OnsetDetector fixed(budgeted);
+    OnsetDetector varying(budgeted);
+    const auto expected = run(fixed, false);
+    const auto actual = run(varying, true);
+    
+    ASSERT_EQ(expected.size(), 10u);
+    EXPECT_EQ(actual, expected);
+}
+
+TEST_F(OnsetDetectorTest, LargeBlocksKeepEveryOnset) {
+    // 40 clicks at 48 kHz, fed in steady blocks up to 8 hops long
+    constexpr size_t interval = 12000;
+    std::vector<float> signal(interval * 40, 0.0f);
+    for (size_t i = 0; i < 40; ++i) {
+        signal[i * interval + 777] = 1.0f;
+    }
+    
+    auto run = [&signal](size_t blockSize) {
+        OnsetDetector onsetDetector(48000.0, 512);
+        std::vector<uint64_t> onsets;
+        for (size_t offset = 0; offset + blockSize <= signal.size(); offset += blockSize) {
+            onsetDetector.process(signal.data() + offset, blockSize);
+            for (size_t frame = 0; frame < onsetDetector.getAnalyzedFrames(); ++frame) {
+                if (onsetDetector.getFrameOnsetStrength(frame) > 0.0f) {
+                    onsets.push_back(onsetDetector.getFramePosition(frame));
+                }
+            }
+            // Every complete frame is analyzed in the block that completes it
+            EXPECT_EQ(onsetDetector.getPendingFrames(), 0u);
+        }
+        return onsets;
+    };
+    
+    const auto expected = run(512);
+    ASSERT_EQ(expected.size(), 40u);
+    for (size_t blockSize : {1024u, 2048u, 4096u}) {
+        EXPECT_EQ(run(blockSize), expected) << "block size " << blockSize;
+    }
+}
+
+TEST_F(OnsetDetectorTest, HonorsMinTimeBetweenOnsets) {
+    OnsetDetector::Config config;
+    config.sampleRate = 44100.0;
+    config.hopSize = 256;
+    config.minTimeBetweenOnsets = 0.1f;
+    OnsetDetector refractory(config);
+    
+    // Two clicks 30 ms apart, then a third well after the refractory period
+    std::vector<float> signal(44100, 0.0f);
+    signal[1000] = 1.0f;
+    signal[1000 + 1323] = 1.0f;
+    signal[1000 + 8820] = 1.0f;
+    
+    int onsets = 0;
+    for (size_t offset = 0; offset < signal.size(); offset += 256) {
+        const size_t frames = std::min<size_t>(256, signal.size() - offset);
+        onsets += refractory.processBlock(signal.data() + offset, frames) ? 1 : 0;
+    }
+    
+    EXPECT_EQ(onsets, 2);
+}
+
+namespace {
+
+using Method = OnsetDetector::Method;
+
+std::vector<uint64_t> detectOnsets(Method method, float threshold, const std::vector<float>& signal) {
+    OnsetDetector::Config config;
+    config.sampleRate = 44100.0;
+    config.method = method;
+    config.threshold = threshold;
+    OnsetDetector detector(config);
+    
+    std::vector<uint64_t> onsets;
+    for (size_t offset = 0; offset + 512 <= signal.size(); offset += 512) {
+        if (detector.processBlock(signal.data() + offset, 512)) {
+            onsets.push_back(detector.getOnsetPosition());
+        }
+    }
+    return onsets;
+}
+
+} // anonymous namespace
+
+TEST_F(OnsetDetectorTest, MagnitudeMethodsFindEveryClick) {
+    // One click per 250 ms over a quiet noise floor
+    std::vector<float> signal(11025 * 8);
+    uint32_t seed = 12345;
+    for (size_t i = 0; i < signal.size(); ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        signal[i] = 0.001f * (static_cast<float>(seed >> 8) / 8388608.0f - 1.0f);
+        if (i % 11025 == 300) {
+            signal[i] = 1.0f;
+        }
+    }
+    
+    for (Method method : {Method::SpectralFlux, Method::HighFrequencyContent,
+                          Method::ComplexDomain, Method::SuperFlux}) {
+        EXPECT_EQ(detectOnsets(method, 0.3f, signal).size(), 8u)
+            << "method " << static_cast<int>(method);
+    }
+}
+
+TEST_F(OnsetDetectorTest, PhaseMethodsFindLegatoPitchChanges) {
+    // A fading-in sine that changes pitch every 0.5 s at constant level
+    // with continuous phase: no attack for magnitude flux to catch
+    constexpr double sampleRate = 44100.0;
+    const double frequencies[] = {220.0, 247.0, 262.0, 294.0, 330.0, 349.0, 392.0, 440.0};
+    std::vector<float> signal(static_cast<size_t>(sampleRate * 4));
+    double phase = 0.0;
+    for (size_t i = 0; i < signal.size(); ++i) {
+        const double t = i / sampleRate;
+        phase += 2.0 * M_PI * frequencies[static_cast<size_t>(t / 0.5) % 8] / sampleRate;
+        signal[i] = static_cast<float>(0.5 * std::min(1.0, t / 0.3) * std::sin(phase));
+    }
+    
+    for (Method method : {Method::ComplexDomain, Method::PhaseDeviation}) {
+        const auto onsets = detectOnsets(method, 0.3f, signal);
+        ASSERT_EQ(onsets.size(), 7u) << "method " << static_cast<int>(method);
+        for (size_t i = 0; i < onsets.size(); ++i) {
+            EXPECT_NEAR(onsets[i] / sampleRate, 0.5 * (i + 1), 0.03);
+        }
+    }
+    EXPECT_LT(detectOnsets(Method::SpectralFlux, 0.3f, signal).size(), 7u);
+}
+
+TEST_F(OnsetDetectorTest, SuperFluxSuppressesVibrato) {
+    // One note at 0.5 s, then +-1 semitone vibrato at 6 Hz
+    constexpr double sampleRate = 44100.0;
+    std::vector<float> signal(static_cast<size_t>(sampleRate * 4), 0.0f);
+    double phase = 0.0;
+    for (size_t i = static_cast<size_t>(sampleRate * 0.5); i < signal.size(); ++i) {
+        const double t = i / sampleRate;
+        phase += 2.0 * M_PI * 880.0 * std::pow(2.0, std::sin(2.0 * M_PI * 6.0 * t) / 12.0) / sampleRate;
+        signal[i] = static_cast<float>(0.5 * std::sin(phase));
+    }
+    
+    const auto superFlux = detectOnsets(Method::SuperFlux, 0.1f, signal);
+    ASSERT_EQ(superFlux.size(), 1u);
+    EXPECT_NEAR(superFlux[0] / sampleRate, 0.5, 0.03);
+    EXPECT_GT(detectOnsets(Method::SpectralFlux, 0.1f, signal).size(), 1u);
+}
+
 // ========== TempoEstimator Tests ==========
 
 class TempoEstimatorTest : public ::testing::Test {
@@ -141,6 +419,158 @@ TEST_F(TempoEstimatorTest, SmoothsTempoChanges) {
     EXPECT_NE(tempo1, tempo2);
 }
 
+TEST_F(TempoEstimatorTest, TracksJitteredOnsets) {
+    // 128 BPM with up to +-8 ms of detector jitter
+    constexpr double samplesPerBeat = 44100.0 * 60.0 / 128.0;
+    uint32_t seed = 7;
+    for (int beat = 0; beat < 24; ++beat) {
+        seed = seed * 1664525u + 1013904223u;
+        const double jitter = (static_cast<double>(seed >> 8) / 16777216.0 - 0.5) * 0.016 * 44100.0;
+        estimator->addOnset(static_cast<uint64_t>(1000.0 + beat * samplesPerBeat + jitter));
+    }
+    
+    EXPECT_NEAR(estimator->getCurrentTempo(), 128.0f, 1.5f);
+    EXPECT_GT(estimator->getConfidence(), 0.5f);
+}
+
+TEST_F(TempoEstimatorTest, ConfidenceComesFromPeakSalience) {
+    TempoEstimator irregular(44100.0);
+    uint64_t position = 0;
+    uint32_t seed = 99;
+    for (int i = 0; i < 24; ++i) {
+        estimator->addOnset(static_cast<uint64_t>(i) * 22050);
+        
+        // Intervals drawn from 0.2 s to 1.1 s
+        seed = seed * 1664525u + 1013904223u;
+        position += static_cast<uint64_t>((0.2 + 0.9 * (seed >> 8) / 16777216.0) * 44100.0);
+        irregular.addOnset(position);
+    }
+    
+    EXPECT_GT(estimator->getConfidence(), irregular.getConfidence() + 0.2f);
+}
+
+TEST_F(TempoEstimatorTest, FollowsTempoChangesAtAdaptationRate) {
+    TempoEstimator::Config config;
+    config.sampleRate = 44100.0;
+    config.adaptationRate = 0.2f;
+    config.historySize = 8;
+    TempoEstimator adaptive(config);
+    
+    // 100 BPM, then 130 BPM
+    uint64_t position = 0;
+    for (int i = 0; i < 16; ++i, position += 26460) {
+        adaptive.addOnset(position);
+    }
+    EXPECT_NEAR(adaptive.getCurrentTempo(), 100.0f, 1.0f);
+    
+    std::vector<float> tempi;
+    for (int i = 0; i < 32; ++i, position += 20354) {
+        adaptive.addOnset(position);
+        tempi.push_back(adaptive.getCurrentTempo());
+    }
+    
+    // No jump on the first new onset, then convergence without overshoot
+    EXPECT_LT(tempi.front(), 115.0f);
+    for (float tempo : tempi) {
+        EXPECT_LE(tempo, 131.0f);
+    }
+    EXPECT_NEAR(tempi.back(), 130.0f, 1.0f);
+}
+
+TEST_F(TempoEstimatorTest, HistoryStaysExactOverLongRuns) {
+    // The ring and the incremental histogram must not drift
+    for (uint64_t i = 0; i < 20000; ++i) {
+        estimator->addOnset(i * 22050);
+    }
+    
+    EXPECT_NEAR(estimator->getCurrentTempo(), 120.0f, 0.5f);
+    EXPECT_EQ(estimator->getSamplesPerBeat(), static_cast<uint64_t>(44100.0 * 60.0 / estimator->getCurrentTempo()));
+}
+
+// ========== BeatTracker Tests ==========
+
+namespace {
+
+constexpr size_t kTrackerHop = 512;
+
+// Steps the tracker through hops [firstHop, lastHop) with an onset of
+// strength 0.5 at firstOnset and at every beat of bpm after it, every
+// fourth one (from the first) accented to 1. Returns the position of the
+// hop holding the last onset.
+uint64_t feedOnsetTrain(BeatTracker& tracker, uint64_t firstHop, uint64_t lastHop,
+                        double firstOnset, double bpm) {
+    const double samplesPerBeat = 44100.0 * 60.0 / bpm;
+    double onset = firstOnset;
+    size_t beat = 0;
+    uint64_t lastOnsetHop = 0;
+    for (uint64_t hop = firstHop; hop < lastHop; ++hop) {
+        const uint64_t position = hop * kTrackerHop;
+        float strength = 0.0f;
+        if (onset < static_cast<double>(position + kTrackerHop)) {
+            strength = beat++ % 4 == 0 ? 1.0f : 0.5f;
+            onset += samplesPerBeat;
+            lastOnsetHop = position;
+        }
+        tracker.processFrame(strength, position);
+    }
+    return lastOnsetHop;
+}
+
+BeatTracker::Config trackerConfig() {
+    BeatTracker::Config config;
+    config.sampleRate = 44100.0;
+    config.hopSize = kTrackerHop;
+    return config;
+}
+
+} // anonymous namespace
+
+TEST(BeatTrackerTest, KeepsDefaultGridUntilLocked) {
+    BeatTracker tracker(trackerConfig());
+    for (uint64_t hop = 0; hop < 200; ++hop) {
+        tracker.processFrame(0.0f, hop * kTrackerHop);
+    }
+    
+    const auto& timing = tracker.getTimingInfo();
+    EXPECT_LT(tracker.getConfidence(), 0.5f);
+    EXPECT_EQ(timing.tempo.load(), 120.0);
+    EXPECT_EQ(timing.barStart.load(), 0u);
+    EXPECT_EQ(timing.samplePosition.load(), 200 * kTrackerHop);
+}
+
+TEST(BeatTrackerTest, LocksOntoAnOnsetTrain) {
+    BeatTracker tracker(trackerConfig());
+    const uint64_t lastOnset = feedOnsetTrain(tracker, 0, 1200, 7000.0, 123.0);
+    
+    // Beats land on the hops holding the onsets, to within a hop
+    EXPECT_GT(tracker.getConfidence(), 0.9f);
+    EXPECT_NEAR(tracker.getTimingInfo().tempo.load(), 123.0, 1.0);
+    EXPECT_NEAR(static_cast<double>(tracker.getLastBeat()), static_cast<double>(lastOnset),
+                static_cast<double>(kTrackerHop));
+}
+
+TEST(BeatTrackerTest, DownbeatFollowsAccents) {
+    BeatTracker tracker(trackerConfig());
+    constexpr double firstOnset = 7000.0;
+    feedOnsetTrain(tracker, 0, 1200, firstOnset, 110.0);
+    
+    // Bars start on the accented onsets
+    const double bar = 4.0 * 44100.0 * 60.0 / 110.0;
+    const double sinceAccent = std::fmod(
+        static_cast<double>(tracker.getTimingInfo().barStart.load()) - firstOnset + 0.5 * bar, bar) - 0.5 * bar;
+    EXPECT_NEAR(sinceAccent, 0.0, static_cast<double>(kTrackerHop));
+}
+
+TEST(BeatTrackerTest, RelocksAfterATempoChange) {
+    BeatTracker tracker(trackerConfig());
+    feedOnsetTrain(tracker, 0, 1200, 7000.0, 123.0);
+    const uint64_t lastOnset = feedOnsetTrain(tracker, 1200, 2600, 1200.0 * kTrackerHop + 3000.0, 100.0);
+    
+    EXPECT_NEAR(tracker.getTimingInfo().tempo.load(), 100.0, 1.0);
+    EXPECT_NEAR(static_cast<double>(tracker.getLastBeat()), static_cast<double>(lastOnset),
+                static_cast<double>(kTrackerHop));
+}
+
 // ========== RhythmQuantizer Tests ==========
 
 class RhythmQuantizerTest : public ::testing::Test {
@@ -203,6 +633,35 @@ TEST_F(RhythmQuantizerTest, SupportsTriplets) {
     EXPECT_NEAR(quantized, 7350, 100);
 }
 
+TEST_F(RhythmQuantizerTest, SwungGridMatchesApplySwing) {
+    RhythmQuantizer::Config config = quantizer->getConfig();
+    config.strength = 1.0f;
+    quantizer->updateConfig(config);
+    quantizer->setGrid(RhythmQuantizer::GridResolution::Eighth);
+    quantizer->setSwing(2.0f / 3.0f);
+    
+    // Triplet swing: the offbeat eighth sits 2/3 of the way through the beat
+    EXPECT_EQ(quantizer->applySwing(11025), 14700u);
+    EXPECT_EQ(quantizer->applySwing(22050), 22050u);
+    EXPECT_EQ(quantizer->quantize(13000), 14700u);
+    EXPECT_EQ(quantizer->quantize(19000), 22050u);
+    
+    // Triplet grids are never swung
+    quantizer->setGrid(RhythmQuantizer::GridResolution::EighthTriplet);
+    EXPECT_EQ(quantizer->applySwing(7350), 7350u);
+}
+
+TEST_F(RhythmQuantizerTest, ExtendsGridBeforeBarStart) {
+    RhythmQuantizer::Config config = quantizer->getConfig();
+    config.strength = 1.0f;
+    quantizer->updateConfig(config);
+    quantizer->setGrid(RhythmQuantizer::GridResolution::Quarter);
+    quantizer->setBarStart(100000);
+    
+    EXPECT_EQ(quantizer->quantize(99000), 100000u);
+    EXPECT_EQ(quantizer->quantize(78000), 77950u);
+}
+
 // ========== GrooveEngine Tests ==========
 
 class GrooveEngineTest : public ::testing::Test {
@@ -236,6 +695,106 @@ TEST_F(GrooveEngineTest, RespondsToParameterChanges) {
     EXPECT_NO_THROW(engine->processBlock(nullptr, 0));
 }
 
+TEST_F(GrooveEngineTest, TracksSlowTempiWithoutDoubling) {
+    // Early tempo estimates of slow click tracks tend to be double time
+    for (const double bpm : {62.0, 66.0, 70.0}) {
+        GrooveEngine slow(44100.0);
+        const double samplesPerBeat = 44100.0 * 60.0 / bpm;
+        std::vector<float> signal(44100 * 30, 0.0f);
+        for (double t = 7000.0; t + 64.0 < signal.size(); t += samplesPerBeat) {
+            const auto click = static_cast<size_t>(t);
+            for (size_t n = 0; n < 32; ++n) {
+                signal[click + n] = std::exp(-static_cast<float>(n) / 8.0f) * (n % 2 ? -1.0f : 1.0f);
+            }
+        }
+        for (size_t offset = 0; offset + 512 <= signal.size(); offset += 512) {
+            slow.processBlock(signal.data() + offset, 512);
+        }
+        
+        EXPECT_NEAR(slow.getTimingInfo().tempo.load(), bpm, 1.0) << bpm << " BPM";
+    }
+}
+
+TEST_F(GrooveEngineTest, KeepsNewestOnsetsInARing) {
+    GrooveEngine dense(48000.0);
+    
+    // 600 clicks 3000 samples apart in 4096-sample blocks, so some blocks
+    // hold two onsets
+    constexpr size_t interval = 3000;
+    constexpr size_t clicks = 600;
+    std::vector<float> signal(interval * clicks + 8192, 0.0f);
+    for (size_t i = 0; i < clicks; ++i) {
+        signal[i * interval + 500] = 1.0f;
+    }
+    
+    size_t found = 0;
+    size_t twoInABlock = 0;
+    for (size_t offset = 0; offset + 4096 <= signal.size(); offset += 4096) {
+        dense.processBlock(signal.data() + offset, 4096);
+        found += dense.getBlockOnsetCount();
+        twoInABlock += dense.getBlockOnsetCount() == 2 ? 1 : 0;
+    }
+    
+    EXPECT_EQ(found, clicks);
+    EXPECT_GT(twoInABlock, 0u);
+    ASSERT_EQ(dense.getOnsetCount(), GrooveEngine::kMaxOnsetHistory);
+    
+    // The newest kMaxOnsetHistory onsets, oldest first, each within a hop
+    // of its click
+    const size_t firstKept = clicks - GrooveEngine::kMaxOnsetHistory;
+    for (size_t i = 0; i < dense.getOnsetCount(); ++i) {
+        const double click = static_cast<double>((firstKept + i) * interval + 500);
+        EXPECT_NEAR(static_cast<double>(dense.getOnsetPosition(i)), click, 512.0);
+        EXPECT_GT(dense.getOnsetStrength(i), 0.0f);
+    }
+}
+
+TEST_F(GrooveEngineTest, QuantizesToTrackedGridWithoutTransport) {
+    GrooveEngine::Config config;
+    config.sampleRate = 44100.0;
+    config.gridResolution = RhythmQuantizer::GridResolution::Eighth;
+    config.quantizationStrength = 1.0f;
+    GrooveEngine tracked(config);
+    
+    // 110 BPM clicks, every fourth one louder
+    const double samplesPerBeat = 44100.0 * 60.0 / 110.0;
+    std::vector<float> signal(44100 * 12, 0.0f);
+    std::vector<uint64_t> clicks;
+    for (double t = 13000.0; t + 64.0 < signal.size(); t += samplesPerBeat) {
+        const float gain = clicks.size() % 4 == 0 ? 1.0f : 0.5f;
+        clicks.push_back(static_cast<uint64_t>(t));
+        for (size_t n = 0; n < 32; ++n) {
+            signal[clicks.back() + n] = gain * std::exp(-static_cast<float>(n) / 8.0f) * (n % 2 ? -1.0f : 1.0f);
+        }
+    }
+    for (size_t offset = 0; offset + 512 <= signal.size(); offset += 512) {
+        tracked.processBlock(signal.data() + offset, 512);
+    }
+    
+    const auto& timing = tracked.getTimingInfo();
+    EXPECT_NEAR(timing.tempo.load(), 110.0, 1.0);
+    EXPECT_GE(timing.samplePosition.load(), signal.size() - 512);
+    
+    // Off-grid positions around the recent clicks snap back onto them
+    for (size_t i = clicks.size() - 8; i < clicks.size(); ++i) {
+        const auto click = static_cast<double>(clicks[i]);
+        EXPECT_NEAR(static_cast<double>(tracked.quantizeToGrid(clicks[i] + 1500)), click, 512.0);
+        EXPECT_NEAR(static_cast<double>(tracked.quantizeToGrid(clicks[i] - 1500)), click, 512.0);
+    }
+    
+    // The bar starts on a loud click
+    const double bar = 4.0 * samplesPerBeat;
+    const double sinceLoud = std::fmod(
+        static_cast<double>(timing.barStart.load()) - 13000.0 + 0.5 * bar, bar) - 0.5 * bar;
+    EXPECT_NEAR(sinceLoud, 0.0, 512.0);
+    
+    // Full swing moves the offbeat eighth to three quarters of the beat
+    tracked.setParameter(GrooveEngine::SwingAmount, 1.0f);
+    const uint64_t click = clicks[clicks.size() - 2];
+    EXPECT_NEAR(static_cast<double>(tracked.applySwing(click + static_cast<uint64_t>(samplesPerBeat / 2))),
+                click + 0.75 * samplesPerBeat, 512.0);
+}
+
 // ========== Performance Benchmarks ==========
 
 class GroovePerformanceBenchmark : public ::testing::Test {
@@ -273,6 +832,36 @@ TEST_F(GroovePerformanceBenchmark, OnsetDetectionUnder150Microseconds) {
     EXPECT_LT(avgMicros, 150.0);  // Target: <150μs per 512-sample block
 }
 
+TEST_F(GroovePerformanceBenchmark, EveryOnsetMethodUnder150Microseconds) {
+    constexpr int iterations = 1000;
+    
+    for (auto method : {OnsetDetector::Method::SpectralFlux, OnsetDetector::Method::HighFrequencyContent,
+                        OnsetDetector::Method::ComplexDomain, OnsetDetector::Method::PhaseDeviation,
+                        OnsetDetector::Method::SuperFlux}) {
+        OnsetDetector::Config config;
+        config.sampleRate = 44100.0;
+        config.method = method;
+        OnsetDetector methodDetector(config);
+        
+        auto start = std::chrono::high_resolution_clock::now();
+        
+        for (int i = 0; i < iterations; ++i) {
+            volatile bool result = methodDetector.processBlock(testSignal.data(), 512);
+            (void)result;
+        }
+        
+        auto end = std::chrono::high_resolution_clock::now();
+        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+        
+        double avgMicros = static_cast<double>(duration.count()) / iterations;
+        
+        std::cout << "Average onset detection time (method " << static_cast<int>(method)
+                  << "): " << avgMicros << " μs\n";
+        
+        EXPECT_LT(avgMicros, 150.0);
+    }
+}
+
 TEST_F(GroovePerformanceBenchmark, TempoEstimationUnder200Microseconds) {
     TempoEstimator estimator(44100.0);
     constexpr int iterations = 1000;
@@ -295,6 +884,27 @@ TEST_F(GroovePerformanceBenchmark, TempoEstimationUnder200Microseconds) {
     EXPECT_LT(avgMicros, 200.0);
 }
 
+TEST_F(GroovePerformanceBenchmark, BeatTrackingUnder50Microseconds) {
+    BeatTracker tracker(trackerConfig());
+    constexpr int iterations = 10000;
+    
+    auto start = std::chrono::high_resolution_clock::now();
+    
+    for (int i = 0; i < iterations; ++i) {
+        // An onset every 43 hops (about 120 BPM)
+        tracker.processFrame(i % 43 == 0 ? 0.8f : 0.0f, static_cast<uint64_t>(i) * kTrackerHop);
+    }
+    
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    
+    double avgMicros = static_cast<double>(duration.count()) / iterations;
+    
+    std::cout << "Average beat tracking time: " << avgMicros << " μs\n";
+    
+    EXPECT_LT(avgMicros, 50.0);  // Per 512-sample hop
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -1,13 +1,63 @@
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cmath>
+#include <ctime>
+#include <functional>
+#include <limits>
+#include <thread>
+#include <vector>
+#include "penta/common/RTEventQueue.h"
+#include "penta/common/RTFFT.h"
 #include "penta/harmony/HarmonyEngine.h"
 #include "penta/harmony/ChordAnalyzer.h"
+#include "penta/harmony/ChromaExtractor.h"
+#include "penta/harmony/KeyProfileBank.h"
 #include "penta/harmony/ScaleDetector.h"
 #include "penta/harmony/VoiceLeading.h"
 
 using namespace penta;
 using namespace penta::harmony;
 
+// ========== PitchClassSet Tests ==========
+
+TEST(PitchClassSetTest, RoundTripsBoolArray) {
+    std::array<bool, 12> cMajor = {
+        true,  false, false, false, true,  false,
+        false, true,  false, false, false, false
+    };
+    
+    PitchClassSet set = PitchClassSet::fromArray(cMajor);
+    
+    EXPECT_EQ(set, PitchClassSet::fromPitchClasses({0, 4, 7}));
+    EXPECT_EQ(set.count(), 3);
+    EXPECT_EQ(set.toArray(), cMajor);
+}
+
+TEST(PitchClassSetTest, RotateTransposesAndWraps) {
+    PitchClassSet bMajor = PitchClassSet::fromPitchClasses({11, 3, 6});
+    
+    EXPECT_EQ(bMajor.rotate(1), PitchClassSet::fromPitchClasses({0, 4, 7}));
+    EXPECT_EQ(bMajor.rotate(-11), PitchClassSet::fromPitchClasses({0, 4, 7}));
+    EXPECT_EQ(bMajor.rotate(12), bMajor);
+    EXPECT_EQ(bMajor.lowest(), 3);
+}
+
+TEST(PitchClassSetTest, UnionAndIntersection) {
+    PitchClassSet a = PitchClassSet::fromPitchClasses({0, 4, 7});
+    PitchClassSet b = PitchClassSet::fromPitchClasses({4, 7, 11});
+    
+    EXPECT_EQ((a | b).count(), 4);
+    EXPECT_EQ(a & b, PitchClassSet::fromPitchClasses({4, 7}));
+    EXPECT_EQ((~a).count(), 9);
+}
+
+TEST(PitchClassSetTest, ChordPacksDensely) {
+    EXPECT_LE(sizeof(Chord), 12u);  // Set, root, quality, confidence, bass, inversion
+    EXPECT_LE(sizeof(Scale), 8u);
+}
+
 // ========== ChordAnalyzer Tests ==========
 
 class ChordAnalyzerTest : public ::testing::Test {
@@ -67,6 +117,193 @@ TEST_F(ChordAnalyzerTest, SIMDMatchesScalar) {
     EXPECT_NEAR(scalarResult.confidence, simdResult.confidence, 0.01f);
 }
 
+TEST_F(ChordAnalyzerTest, LookupTableMatchesExhaustiveSearchForEveryMask) {
+    for (uint32_t mask = 0; mask < ChordAnalyzer::kLookupTableSize; ++mask) {
+        std::array<bool, 12> pitchClasses{};
+        for (int i = 0; i < 12; ++i) {
+            pitchClasses[i] = (mask >> i) & 1u;
+        }
+        
+        Chord expected = analyzer->analyzeExhaustive(pitchClasses);
+        Chord lookup = analyzer->analyze(pitchClasses);
+        Chord simd = analyzer->analyzeSIMD(pitchClasses);
+        
+        ASSERT_EQ(lookup.root, expected.root) << "mask " << mask;
+        ASSERT_EQ(lookup.quality, expected.quality) << "mask " << mask;
+        ASSERT_FLOAT_EQ(lookup.confidence, expected.confidence) << "mask " << mask;
+        ASSERT_EQ(lookup.pitchClass.bits(), mask) << "mask " << mask;
+        
+        ASSERT_EQ(simd.root, expected.root) << "mask " << mask;
+        ASSERT_EQ(simd.quality, expected.quality) << "mask " << mask;
+        ASSERT_FLOAT_EQ(simd.confidence, expected.confidence) << "mask " << mask;
+    }
+}
+
+TEST_F(ChordAnalyzerTest, WeightedMatchesExhaustiveSearchForBinaryWeights) {
+    for (uint32_t mask = 0; mask < ChordAnalyzer::kLookupTableSize; ++mask) {
+        std::array<bool, 12> pitchClasses{};
+        std::array<float, 12> weights{};
+        for (int i = 0; i < 12; ++i) {
+            pitchClasses[i] = (mask >> i) & 1u;
+            weights[i] = pitchClasses[i] ? 1.0f : 0.0f;
+        }
+        
+        Chord expected = analyzer->analyzeExhaustive(pitchClasses);
+        Chord weighted = analyzer->analyzeWeighted(weights);
+        
+        ASSERT_EQ(weighted.root, expected.root) << "mask " << mask;
+        ASSERT_EQ(weighted.quality, expected.quality) << "mask " << mask;
+        ASSERT_FLOAT_EQ(weighted.confidence, expected.confidence) << "mask " << mask;
+        ASSERT_EQ(weighted.pitchClass.bits(), mask) << "mask " << mask;
+    }
+}
+
+TEST_F(ChordAnalyzerTest, WeightedMatchesLookupWithBassForBinaryWeights) {
+    for (uint32_t mask = 1; mask < ChordAnalyzer::kLookupTableSize; ++mask) {
+        PitchClassSet pitchClasses(static_cast<uint16_t>(mask));
+        std::array<float, 12> weights{};
+        for (int i = 0; i < 12; ++i) {
+            weights[i] = pitchClasses.contains(i) ? 1.0f : 0.0f;
+        }
+        
+        for (int bass = 0; bass < 12; ++bass) {
+            if (!pitchClasses.contains(bass)) continue;
+            
+            Chord expected = analyzer->analyze(pitchClasses, bass);
+            Chord weighted = analyzer->analyzeWeighted(weights, bass);
+            
+            ASSERT_EQ(weighted.root, expected.root) << "mask " << mask << " bass " << bass;
+            ASSERT_EQ(weighted.quality, expected.quality) << "mask " << mask << " bass " << bass;
+            ASSERT_FLOAT_EQ(weighted.confidence, expected.confidence) << "mask " << mask << " bass " << bass;
+            ASSERT_EQ(weighted.bass, bass);
+            ASSERT_EQ(weighted.inversion, expected.inversion) << "mask " << mask << " bass " << bass;
+        }
+    }
+}
+
+TEST_F(ChordAnalyzerTest, ReportsInversionFromBass) {
+    const auto cMajor = PitchClassSet::fromPitchClasses({0, 4, 7});
+    
+    Chord rootPosition = analyzer->analyze(cMajor, 0);
+    EXPECT_EQ(rootPosition.root, 0);
+    EXPECT_EQ(rootPosition.bass, 0);
+    EXPECT_EQ(rootPosition.inversion, 0);
+    
+    Chord first = analyzer->analyze(cMajor, 4);
+    EXPECT_EQ(first.root, 0);
+    EXPECT_EQ(first.quality, 0);
+    EXPECT_EQ(first.bass, 4);
+    EXPECT_EQ(first.inversion, 1);
+    
+    Chord second = analyzer->analyze(cMajor, 7);
+    EXPECT_EQ(second.root, 0);
+    EXPECT_EQ(second.inversion, 2);
+    EXPECT_FALSE(second.isSlashChord());
+    
+    // G7 over F is the third inversion
+    Chord third = analyzer->analyze(PitchClassSet::fromPitchClasses({7, 11, 2, 5}), 5);
+    EXPECT_EQ(third.root, 7);
+    EXPECT_EQ(third.quality, 4);
+    EXPECT_EQ(third.inversion, 3);
+    
+    // Without a bass, root position is assumed
+    Chord unknown = analyzer->analyze(cMajor);
+    EXPECT_EQ(unknown.bass, 0);
+    EXPECT_EQ(unknown.inversion, 0);
+}
+
+TEST_F(ChordAnalyzerTest, BassDisambiguatesSlashChords) {
+    // A C E G is Am7 or C6; the bass decides
+    const auto am7 = PitchClassSet::fromPitchClasses({9, 0, 4, 7});
+    Chord overA = analyzer->analyze(am7, 9);
+    EXPECT_EQ(overA.root, 9);
+    EXPECT_EQ(overA.quality, 6);   // Min7
+    EXPECT_EQ(overA.inversion, 0);
+    
+    Chord overC = analyzer->analyze(am7, 0);
+    EXPECT_EQ(overC.root, 0);
+    EXPECT_EQ(overC.quality, 22);  // Add6
+    EXPECT_EQ(overC.inversion, 0);
+    
+    // C major over F#: no template holds all four, the triad above does
+    Chord slash = analyzer->analyze(PitchClassSet::fromPitchClasses({0, 4, 6, 7}), 6);
+    EXPECT_EQ(slash.root, 0);
+    EXPECT_EQ(slash.quality, 0);
+    EXPECT_EQ(slash.bass, 6);
+    EXPECT_TRUE(slash.isSlashChord());
+    EXPECT_FLOAT_EQ(slash.confidence, 1.0f);
+    
+    // The same holds for weighted input
+    std::array<float, 12> weights{};
+    weights[0] = 0.9f;
+    weights[4] = 0.8f;
+    weights[6] = 1.0f;
+    weights[7] = 0.85f;
+    Chord weighted = analyzer->analyzeWeighted(weights, 6);
+    EXPECT_EQ(weighted.root, 0);
+    EXPECT_EQ(weighted.quality, 0);
+    EXPECT_TRUE(weighted.isSlashChord());
+}
+
+TEST_F(ChordAnalyzerTest, DyadOverItsRootIsNotASlashChord) {
+    // The tone above the bass alone matches the single-note template
+    // perfectly; that must not read as E/C or C/A
+    Chord majorThird = analyzer->analyze(PitchClassSet::fromPitchClasses({0, 4}), 0);
+    EXPECT_EQ(majorThird.root, 0);
+    EXPECT_EQ(majorThird.quality, 0);  // Major
+    EXPECT_EQ(majorThird.inversion, 0);
+    
+    Chord minorThird = analyzer->analyze(PitchClassSet::fromPitchClasses({9, 0}), 9);
+    EXPECT_EQ(minorThird.root, 9);
+    EXPECT_EQ(minorThird.quality, 1);  // Minor
+    EXPECT_EQ(minorThird.inversion, 0);
+    
+    // Same for weighted input, also when the upper tone is the louder one
+    std::array<float, 12> weights{};
+    weights[0] = 1.0f;
+    weights[4] = 1.0f;
+    Chord weighted = analyzer->analyzeWeighted(weights, 0);
+    EXPECT_EQ(weighted.root, 0);
+    EXPECT_EQ(weighted.quality, 0);
+    EXPECT_FALSE(weighted.isSlashChord());
+    
+    weights = {};
+    weights[9] = 0.6f;
+    weights[0] = 1.0f;
+    weighted = analyzer->analyzeWeighted(weights, 9);
+    EXPECT_EQ(weighted.root, 9);
+    EXPECT_EQ(weighted.quality, 1);
+    EXPECT_FALSE(weighted.isSlashChord());
+}
+
+TEST_F(ChordAnalyzerTest, GhostNotesWeighLessThanHeldTones) {
+    // Loud C major triad with a ghosted Bb
+    std::array<float, 12> weights{};
+    weights[0] = 100.0f;
+    weights[4] = 90.0f;
+    weights[7] = 95.0f;
+    weights[10] = 8.0f;
+    
+    // As a set this is C7; weighted, the Bb barely counts
+    Chord asSet = analyzer->analyze(PitchClassSet::fromPitchClasses({0, 4, 7, 10}));
+    EXPECT_EQ(asSet.quality, 4);
+    
+    Chord weighted = analyzer->analyzeWeighted(weights);
+    EXPECT_EQ(weighted.root, 0);
+    EXPECT_EQ(weighted.quality, 0);  // Major
+    EXPECT_GT(weighted.confidence, 0.85f);
+    EXPECT_TRUE(weighted.pitchClass.contains(10));
+    
+    // A full-strength Bb makes it a dominant seventh again
+    weights[10] = 90.0f;
+    EXPECT_EQ(analyzer->analyzeWeighted(weights).quality, 4);
+    
+    // Scale invariant, and silent input gives no chord
+    for (auto& w : weights) w *= 0.25f;
+    EXPECT_EQ(analyzer->analyzeWeighted(weights).quality, 4);
+    EXPECT_EQ(analyzer->analyzeWeighted(std::array<float, 12>{}).confidence, 0.0f);
+}
+
 // ========== Performance Benchmarks ==========
 
 class PerformanceBenchmark : public ::testing::Test {
@@ -98,37 +335,288 @@ TEST_F(PerformanceBenchmark, ChordAnalysisUnder50Microseconds) {
     EXPECT_LT(avgMicros, 50.0);  // Target: <50μs per analysis
 }
 
-TEST_F(PerformanceBenchmark, SIMDFasterThanScalar) {
+TEST_F(PerformanceBenchmark, WeightedChordAnalysisUnder2Microseconds) {
     constexpr int iterations = 10000;
+    std::array<float, 12> weights = {
+        0.9f, 0.0f, 0.1f, 0.0f, 0.8f, 0.05f, 0.0f, 0.7f, 0.0f, 0.0f, 0.6f, 0.0f
+    };
     
-    // Scalar version
-    auto scalarStart = std::chrono::high_resolution_clock::now();
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        weights[i % 12] += 0.001f;  // Keep the call from being hoisted
+        volatile Chord result = analyzer.analyzeWeighted(weights);
+        (void)result;
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    
+    auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+    double avgMicros = duration.count() / 1000.0 / iterations;
+    
+    std::cout << "Average weighted chord analysis time: " << avgMicros << " μs\n";
+    
+    EXPECT_LT(avgMicros, 2.0);
+}
+
+TEST_F(PerformanceBenchmark, LookupFasterThanExhaustiveSearch) {
+    constexpr int iterations = 10000;
+    
+    // Full template search (reference path)
+    auto searchStart = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        volatile Chord result = analyzer.analyzeExhaustive(testPattern);
+        (void)result;
+    }
+    auto searchEnd = std::chrono::high_resolution_clock::now();
+    
+    // Precomputed table read
+    auto lookupStart = std::chrono::high_resolution_clock::now();
     for (int i = 0; i < iterations; ++i) {
         volatile Chord result = analyzer.analyze(testPattern);
         (void)result;
     }
-    auto scalarEnd = std::chrono::high_resolution_clock::now();
+    auto lookupEnd = std::chrono::high_resolution_clock::now();
+    
+    auto searchDuration = std::chrono::duration_cast<std::chrono::nanoseconds>(searchEnd - searchStart);
+    auto lookupDuration = std::chrono::duration_cast<std::chrono::nanoseconds>(lookupEnd - lookupStart);
+    
+    double speedup = static_cast<double>(searchDuration.count()) / lookupDuration.count();
     
-    // SIMD version
-    auto simdStart = std::chrono::high_resolution_clock::now();
+    std::cout << "Lookup table speedup: " << speedup << "x\n";
+    
+    EXPECT_GT(speedup, 10.0);  // One table read vs 384 template scores
+}
+
+TEST_F(PerformanceBenchmark, ScaleMatrixFasterThanPerProfileCorrelation) {
+    constexpr int iterations = 10000;
+    ScaleDetector detector;
+    std::array<float, 12> histogram = {
+        3.0f, 0.2f, 1.1f, 0.1f, 1.6f, 1.2f, 0.3f, 2.1f, 0.2f, 1.0f, 0.1f, 0.9f
+    };
+    
+    // 84 Pearson correlations with per-call rotation and statistics
+    auto referenceStart = std::chrono::high_resolution_clock::now();
     for (int i = 0; i < iterations; ++i) {
-        volatile Chord result = analyzer.analyzeSIMD(testPattern);
+        histogram[i % 12] += 1e-3f;
+        volatile Scale result = detector.analyzeHistogramExhaustive(histogram);
         (void)result;
     }
-    auto simdEnd = std::chrono::high_resolution_clock::now();
+    auto referenceEnd = std::chrono::high_resolution_clock::now();
     
-    auto scalarDuration = std::chrono::duration_cast<std::chrono::microseconds>(scalarEnd - scalarStart);
-    auto simdDuration = std::chrono::duration_cast<std::chrono::microseconds>(simdEnd - simdStart);
+    // One 84x12 matrix-vector product against precomputed profiles
+    auto matrixStart = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        histogram[i % 12] += 1e-3f;
+        volatile Scale result = detector.analyzeHistogram(histogram);
+        (void)result;
+    }
+    auto matrixEnd = std::chrono::high_resolution_clock::now();
     
-    double speedup = static_cast<double>(scalarDuration.count()) / simdDuration.count();
+    auto referenceDuration = std::chrono::duration_cast<std::chrono::nanoseconds>(referenceEnd - referenceStart);
+    auto matrixDuration = std::chrono::duration_cast<std::chrono::nanoseconds>(matrixEnd - matrixStart);
     
-    std::cout << "SIMD speedup: " << speedup << "x\n";
+    double avgMicros = matrixDuration.count() / 1000.0 / iterations;
+    double speedup = static_cast<double>(referenceDuration.count()) / matrixDuration.count();
     
-#ifdef __AVX2__
-    EXPECT_GT(speedup, 1.5);  // Expect at least 1.5x speedup with AVX2
-#else
-    EXPECT_NEAR(speedup, 1.0, 0.1);  // Should be same without SIMD
-#endif
+    std::cout << "Average scale detection time: " << avgMicros << " μs ("
+              << speedup << "x faster than per-profile correlation)\n";
+    
+    EXPECT_LT(avgMicros, 5.0);
+    EXPECT_GT(speedup, 3.0);
+}
+
+TEST_F(PerformanceBenchmark, FullProfileBankUnder10Microseconds) {
+    constexpr int iterations = 10000;
+    
+    // 256 profiles x 12 tonics = 3072 correlation rows
+    KeyProfileBank bank = KeyProfileBank::extended();
+    for (int i = 0; bank.getNumProfiles() < KeyProfileBank::kMaxProfiles; ++i) {
+        std::array<float, 12> weights{};
+        for (int pc = 0; pc < 12; ++pc) {
+            weights[pc] = static_cast<float>((i * 7 + pc * 5) % 11);
+        }
+        bank.addProfile("Generated " + std::to_string(i), weights);
+    }
+    ScaleDetector detector(std::make_shared<const KeyProfileBank>(std::move(bank)));
+    
+    std::array<float, 12> histogram = {
+        3.0f, 0.2f, 1.1f, 0.1f, 1.6f, 1.2f, 0.3f, 2.1f, 0.2f, 1.0f, 0.1f, 0.9f
+    };
+    
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        histogram[i % 12] += 1e-3f;
+        volatile Scale result = detector.analyzeHistogram(histogram);
+        (void)result;
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    
+    auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+    double avgMicros = duration.count() / 1000.0 / iterations;
+    
+    std::cout << "Average 256-profile scale detection time: " << avgMicros << " μs\n";
+    
+    EXPECT_LT(avgMicros, 10.0);
+}
+
+TEST_F(PerformanceBenchmark, EightVoiceLeadingUnder100Microseconds) {
+    constexpr int iterations = 2000;
+    VoiceLeading voiceLeading;
+    
+    // Close-ish 8-voice C major voicing moving through a cycle of seventh chords
+    VoiceLeading::Voicing voicing;
+    voicing.count = 8;
+    voicing.pitches = {36, 48, 52, 55, 60, 64, 67, 72};
+    
+    std::array<Chord, 4> chords;
+    const int roots[] = {2, 7, 0, 9};
+    for (size_t c = 0; c < chords.size(); ++c) {
+        const int third = c == 1 || c == 2 ? 4 : 3;
+        chords[c].pitchClass = PitchClassSet::fromPitchClasses({
+            roots[c], (roots[c] + third) % 12, (roots[c] + 7) % 12, (roots[c] + 10) % 12
+        });
+    }
+    
+    double worstMicros = 0.0;
+    double worstCpuMicros = 0.0;
+    VoiceLeading::SearchStats stats;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        auto callStart = std::chrono::high_resolution_clock::now();
+        const std::clock_t cpuStart = std::clock();
+        VoiceLeading::Voicing next;
+        voiceLeading.solve(voicing, chords[i % chords.size()], next, &stats);
+        const std::clock_t cpuEnd = std::clock();
+        auto callEnd = std::chrono::high_resolution_clock::now();
+        worstMicros = std::max(worstMicros,
+            std::chrono::duration<double, std::micro>(callEnd - callStart).count());
+        worstCpuMicros = std::max(worstCpuMicros, 1e6 * static_cast<double>(cpuEnd - cpuStart) / CLOCKS_PER_SEC);
+        voicing = next;
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    
+    auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+    double avgMicros = duration.count() / 1000.0 / iterations;
+    
+    std::cout << "Average 8-voice leading time: " << avgMicros << " μs (worst "
+              << worstCpuMicros << " μs CPU, " << worstMicros << " μs wall, "
+              << stats.nodes << " nodes)\n";
+    
+    // Worst case in CPU time: wall time also counts preemption, which no
+    // deadline can bound. Allow the deadline plus one clock-check interval
+    // and headroom for a noisy host
+    EXPECT_LT(avgMicros, 100.0);
+    EXPECT_LT(worstCpuMicros, voiceLeading.getConfig().maxSearchMicros + 100.0);
+}
+
+TEST_F(PerformanceBenchmark, DeadlineBoundsWorstCaseEightVoiceSolve) {
+    constexpr int iterations = 1000;
+    VoiceLeading voiceLeading;
+    const auto& config = voiceLeading.getConfig();
+    
+    // Spread 8-voice C major into a 13th chord: too many near-optimal
+    // voicings to prove optimal before the default deadline
+    VoiceLeading::Voicing from;
+    from.count = 8;
+    from.pitches = {36, 48, 52, 55, 60, 64, 67, 72};
+    
+    Chord thirteenth;
+    thirteenth.pitchClass = PitchClassSet::fromPitchClasses({0, 2, 4, 5, 7, 9, 10});
+    
+    double worstMicros = 0.0;
+    double worstCpuMicros = 0.0;
+    VoiceLeading::SearchStats stats;
+    for (int i = 0; i < iterations; ++i) {
+        VoiceLeading::Voicing to;
+        auto callStart = std::chrono::high_resolution_clock::now();
+        const std::clock_t cpuStart = std::clock();
+        const float cost = voiceLeading.solve(from, thirteenth, to, &stats);
+        const std::clock_t cpuEnd = std::clock();
+        auto callEnd = std::chrono::high_resolution_clock::now();
+        worstMicros = std::max(worstMicros,
+            std::chrono::duration<double, std::micro>(callEnd - callStart).count());
+        worstCpuMicros = std::max(worstCpuMicros, 1e6 * static_cast<double>(cpuEnd - cpuStart) / CLOCKS_PER_SEC);
+        
+        ASSERT_TRUE(std::isfinite(cost));
+        ASSERT_FALSE(stats.exhaustive);
+        ASSERT_LE(stats.nodes, config.maxSearchNodes);
+    }
+    
+    std::cout << "Deadline-limited 8-voice leading time: worst " << worstCpuMicros
+              << " μs CPU, " << worstMicros << " μs wall (deadline "
+              << config.maxSearchMicros << " μs, " << stats.nodes << " nodes)\n";
+    
+    // As above: the deadline plus one clock-check interval and headroom,
+    // in CPU time
+    EXPECT_TRUE(stats.timedOut);
+    EXPECT_LT(worstCpuMicros, config.maxSearchMicros + 100.0);
+}
+
+TEST_F(PerformanceBenchmark, BatchedVoicingCostsUnder20Microseconds) {
+    constexpr int iterations = 1000;
+    constexpr size_t numCandidates = 512;
+    VoiceLeading voiceLeading;
+    
+    VoiceLeading::Voicing from;
+    from.count = 8;
+    from.pitches = {36, 48, 52, 55, 60, 64, 67, 72};
+    
+    // Every voice nudged by up to a few semitones, as a reharmonization search would
+    std::vector<VoiceLeading::Voicing> candidates(numCandidates, from);
+    uint32_t state = 7;
+    for (auto& candidate : candidates) {
+        for (size_t v = 0; v < candidate.count; ++v) {
+            state = state * 1664525u + 1013904223u;
+            candidate.pitches[v] = static_cast<uint8_t>(from.pitches[v] + static_cast<int>((state >> 8) % 9) - 4);
+        }
+    }
+    std::vector<float> costs(numCandidates);
+    
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        voiceLeading.calculateCosts(from, candidates.data(), candidates.size(), costs.data());
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    
+    auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+    double avgMicros = duration.count() / 1000.0 / iterations;
+    
+    std::cout << "Average 512-voicing batch cost time: " << avgMicros << " μs\n";
+    
+    EXPECT_LT(avgMicros, 20.0);
+}
+
+TEST_F(PerformanceBenchmark, SixteenChordPlanUnder1Millisecond) {
+    constexpr int iterations = 100;
+    VoiceLeading voiceLeading;
+    
+    VoiceLeading::Voicing from;
+    from.count = 5;
+    from.pitches = {48, 55, 60, 64, 67};
+    
+    // ii-V-I-vi turnaround of seventh chords, four times
+    std::vector<Chord> chords(16);
+    const int roots[] = {2, 7, 0, 9};
+    for (size_t c = 0; c < chords.size(); ++c) {
+        const int root = roots[c % 4];
+        const int third = c % 4 == 1 || c % 4 == 2 ? 4 : 3;
+        chords[c].pitchClass = PitchClassSet::fromPitchClasses({
+            root, (root + third) % 12, (root + 7) % 12, (root + 10) % 12
+        });
+    }
+    std::vector<VoiceLeading::Voicing> path(chords.size());
+    
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        voiceLeading.planProgression(chords.data(), chords.size(), from, path.data());
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    
+    auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+    double avgMicros = duration.count() / 1000.0 / iterations;
+    
+    std::cout << "Average 16-chord progression plan time: " << avgMicros << " μs\n";
+    
+    EXPECT_LT(avgMicros, 1000.0);
 }
 
 // ========== Original Tests ==========
@@ -176,6 +664,353 @@ TEST_F(HarmonyEngineTest, DetectsDMinorChord) {
     // Quality 1 should be minor
 }
 
+TEST_F(HarmonyEngineTest, AnalyzesTimelineInOneCall) {
+    constexpr uint64_t hop = 24000;
+    
+    // C major for one second, then G major
+    std::vector<Note> notes = {
+        Note{60, 80, 0, 0},
+        Note{64, 80, 0, 0},
+        Note{67, 80, 0, 0},
+        Note{60, 0, 0, 48000},
+        Note{64, 0, 0, 48000},
+        Note{67, 0, 0, 48000},
+        Note{67, 80, 0, 48000},
+        Note{71, 80, 0, 48000},
+        Note{74, 80, 0, 48000},
+    };
+    
+    auto frames = engine->analyzeTimeline(notes.data(), notes.size(), hop);
+    
+    ASSERT_EQ(frames.size(), 3u);
+    EXPECT_EQ(frames[0].samplePosition, 0u);
+    EXPECT_EQ(frames[1].samplePosition, hop);
+    EXPECT_EQ(frames[2].samplePosition, 2 * hop);
+    
+    EXPECT_EQ(frames[0].chord.root, 0);   // C
+    EXPECT_EQ(frames[0].chord.quality, 0);
+    EXPECT_EQ(frames[1].chord.root, 0);   // Still held
+    EXPECT_EQ(frames[2].chord.root, 7);   // G
+    EXPECT_EQ(frames[2].chord.quality, 0);
+    EXPECT_EQ(frames[2].chord.pitchClass, PitchClassSet::fromPitchClasses({7, 11, 2}));
+}
+
+TEST_F(HarmonyEngineTest, TimelineRespectsCallerBuffer) {
+    std::vector<Note> notes = {
+        Note{60, 80, 0, 0},
+        Note{64, 80, 0, 100000},
+    };
+    
+    EXPECT_EQ(HarmonyEngine::getTimelineFrameCount(notes.data(), notes.size(), 1000), 101u);
+    
+    std::array<HarmonyEngine::HarmonyFrame, 10> frames{};
+    size_t written = engine->analyzeTimeline(
+        notes.data(), notes.size(), 1000, frames.data(), frames.size());
+    
+    EXPECT_EQ(written, frames.size());
+    EXPECT_EQ(frames.back().samplePosition, 9000u);
+    EXPECT_EQ(engine->analyzeTimeline(notes.data(), notes.size(), 0).size(), 0u);
+}
+
+TEST_F(HarmonyEngineTest, TracksPitchClassCountsIncrementally) {
+    std::vector<Note> notes = {
+        Note{48, 100},  // C3
+        Note{60, 80},   // C4
+        Note{64, 70},   // E4
+    };
+    engine->processNotes(notes.data(), notes.size());
+    
+    EXPECT_EQ(engine->getActiveNoteCount(0), 2);
+    EXPECT_EQ(engine->getVelocitySum(0), 180);
+    EXPECT_EQ(engine->getActiveNoteCount(4), 1);
+    
+    // Releasing one octave keeps the pitch class; retriggering replaces velocity
+    std::vector<Note> changes = {
+        Note{48, 0},
+        Note{64, 30},
+    };
+    engine->processNotes(changes.data(), changes.size());
+    
+    EXPECT_EQ(engine->getActiveNoteCount(0), 1);
+    EXPECT_EQ(engine->getVelocitySum(0), 80);
+    EXPECT_EQ(engine->getVelocitySum(4), 30);
+    EXPECT_EQ(engine->getActivePitchClasses(), PitchClassSet::fromPitchClasses({0, 4}));
+    
+    // Note off for a note that isn't sounding is ignored
+    Note stray{50, 0};
+    engine->processNotes(&stray, 1);
+    EXPECT_EQ(engine->getActiveNoteCount(2), 0);
+}
+
+TEST_F(HarmonyEngineTest, SkipsAnalysisWhenPitchClassSetUnchanged) {
+    std::vector<Note> chord = {
+        Note{60, 80},
+        Note{64, 80},
+        Note{67, 80},
+    };
+    engine->processNotes(chord.data(), chord.size());
+    EXPECT_TRUE(engine->consumeHarmonyChanged());
+    EXPECT_FALSE(engine->consumeHarmonyChanged());
+    
+    // Arpeggiator re-striking chord tones in other octaves: same set
+    std::vector<Note> arp = {
+        Note{72, 90},
+        Note{72, 0},
+        Note{76, 90},
+        Note{76, 0},
+    };
+    engine->processNotes(arp.data(), arp.size());
+    EXPECT_FALSE(engine->consumeHarmonyChanged());
+    EXPECT_EQ(engine->getCurrentChord().root, 0);
+    
+    // Adding a seventh changes the set and triggers re-analysis
+    Note seventh{70, 80};
+    engine->processNotes(&seventh, 1);
+    EXPECT_TRUE(engine->consumeHarmonyChanged());
+    EXPECT_EQ(engine->getCurrentChord().pitchClass, PitchClassSet::fromPitchClasses({0, 4, 7, 10}));
+}
+
+TEST_F(HarmonyEngineTest, DoubledRootsDoNotOutweighTheChord) {
+    // C major with the root in three octaves
+    std::vector<Note> notes = {
+        Note{36, 100},
+        Note{48, 100},
+        Note{60, 100},
+        Note{64, 100},
+        Note{67, 100},
+    };
+    engine->processNotes(notes.data(), notes.size());
+    EXPECT_EQ(engine->getCurrentChord().root, 0);
+    EXPECT_EQ(engine->getCurrentChord().quality, 0);
+    EXPECT_GE(engine->getCurrentChord().confidence, 0.99f);
+    
+    // Uneven velocities take the weighted path; the tripled root still
+    // counts once
+    Note softerFifth{67, 70};
+    engine->processNotes(&softerFifth, 1);
+    EXPECT_EQ(engine->getCurrentChord().root, 0);
+    EXPECT_EQ(engine->getCurrentChord().quality, 0);
+}
+
+TEST_F(HarmonyEngineTest, ReanalyzesWhenVelocitiesChange) {
+    std::vector<Note> notes = {
+        Note{60, 100},
+        Note{64, 95},
+        Note{67, 100},
+        Note{70, 10},   // Ghosted seventh
+    };
+    engine->processNotes(notes.data(), notes.size());
+    EXPECT_TRUE(engine->consumeHarmonyChanged());
+    EXPECT_EQ(engine->getCurrentChord().quality, 0);
+    
+    // Re-striking the seventh hard keeps the set but changes the weights,
+    // and so the analysis
+    Note accent{70, 120};
+    engine->processNotes(&accent, 1);
+    EXPECT_TRUE(engine->consumeHarmonyChanged());
+    EXPECT_NE(engine->getCurrentChord().quality, 0);
+    
+    HarmonyEngine fresh;
+    notes.back() = accent;
+    fresh.processNotes(notes.data(), notes.size());
+    EXPECT_EQ(engine->getCurrentChord().root, fresh.getCurrentChord().root);
+    EXPECT_EQ(engine->getCurrentChord().quality, fresh.getCurrentChord().quality);
+    
+    // Presence-only analysis ignores velocity
+    HarmonyEngine::Config config;
+    config.weightedChordAnalysis = false;
+    HarmonyEngine unweighted(config);
+    unweighted.processNotes(notes.data(), notes.size());
+    EXPECT_TRUE(unweighted.consumeHarmonyChanged());
+    Note softer{70, 60};
+    unweighted.processNotes(&softer, 1);
+    EXPECT_FALSE(unweighted.consumeHarmonyChanged());
+}
+
+TEST_F(HarmonyEngineTest, TracksBassNoteAndInversion) {
+    EXPECT_EQ(engine->getBassNote(), -1);
+    
+    // C major with E in the bass
+    std::vector<Note> chord = {
+        Note{52, 80},  // E3
+        Note{60, 80},
+        Note{67, 80},
+    };
+    engine->processNotes(chord.data(), chord.size());
+    EXPECT_EQ(engine->getBassNote(), 52);
+    EXPECT_EQ(engine->getCurrentChord().root, 0);
+    EXPECT_EQ(engine->getCurrentChord().bass, 4);
+    EXPECT_EQ(engine->getCurrentChord().inversion, 1);
+    EXPECT_TRUE(engine->consumeHarmonyChanged());
+    
+    // A low C changes only the bass, which is enough to re-analyze
+    Note lowC{36, 80};
+    engine->processNotes(&lowC, 1);
+    EXPECT_EQ(engine->getBassNote(), 36);
+    EXPECT_TRUE(engine->consumeHarmonyChanged());
+    EXPECT_EQ(engine->getCurrentChord().inversion, 0);
+    
+    // Moving the bass down an octave is the same analysis
+    std::vector<Note> lowerC = {Note{36, 0}, Note{24, 80}};
+    engine->processNotes(lowerC.data(), lowerC.size());
+    EXPECT_EQ(engine->getBassNote(), 24);
+    EXPECT_FALSE(engine->consumeHarmonyChanged());
+    
+    // Releasing the C bass brings back the first inversion; a bass above
+    // 63 comes from the upper bitset word
+    std::vector<Note> release = {Note{24, 0}, Note{52, 0}, Note{60, 0}};
+    engine->processNotes(release.data(), release.size());
+    EXPECT_EQ(engine->getBassNote(), 67);
+    EXPECT_EQ(engine->getCurrentChord().bass, 7);
+    
+    engine->reset();
+    EXPECT_EQ(engine->getBassNote(), -1);
+}
+
+TEST_F(HarmonyEngineTest, ReadsThirdDyadOverItsRoot) {
+    for (bool weighted : {true, false}) {
+        HarmonyEngine::Config config;
+        config.weightedChordAnalysis = weighted;
+        HarmonyEngine dyadEngine(config);
+        
+        std::vector<Note> third = {Note{60, 80}, Note{64, 80}};
+        dyadEngine.processNotes(third.data(), third.size());
+        EXPECT_EQ(dyadEngine.getCurrentChord().root, 0) << "weighted " << weighted;
+        EXPECT_EQ(dyadEngine.getCurrentChord().quality, 0) << "weighted " << weighted;
+        EXPECT_EQ(dyadEngine.getCurrentChord().inversion, 0) << "weighted " << weighted;
+    }
+}
+
+TEST_F(HarmonyEngineTest, RecordsTimestampedHistoryOfChanges) {
+    std::vector<Note> cMajor = {
+        Note{60, 80, 0, 1000},
+        Note{64, 80, 0, 1000},
+        Note{67, 80, 0, 1000},
+    };
+    std::vector<Note> toG = {
+        Note{60, 0, 0, 5000},
+        Note{64, 0, 0, 5000},
+        Note{71, 80, 0, 5000},
+        Note{74, 80, 0, 5000},
+    };
+    Note repeat{79, 80, 0, 7000};  // Same pitch classes: no new entry
+    
+    engine->processNotes(cMajor.data(), cMajor.size());
+    engine->processNotes(toG.data(), toG.size());
+    engine->processNotes(&repeat, 1);
+    
+    std::array<HarmonyEngine::ChordEvent, 8> events{};
+    size_t count = engine->getChordHistory(events.data(), events.size());
+    
+    ASSERT_EQ(count, 2u);
+    EXPECT_EQ(events[0].samplePosition, 1000u);
+    EXPECT_EQ(events[0].chord.root, 0);
+    EXPECT_EQ(events[1].samplePosition, 5000u);
+    EXPECT_EQ(events[1].chord.root, 7);
+    
+    auto chords = engine->getChordHistory(1);
+    ASSERT_EQ(chords.size(), 1u);
+    EXPECT_EQ(chords[0].root, 7);
+    EXPECT_EQ(engine->getScaleHistory().size(), 2u);
+    
+    engine->reset();
+    EXPECT_TRUE(engine->getChordHistory().empty());
+}
+
+TEST(RTHistoryRingTest, KeepsNewestEntriesInOrder) {
+    RTHistoryRing<uint64_t, 8> ring;
+    for (uint64_t i = 0; i < 20; ++i) {
+        ring.push(i);
+    }
+    
+    std::array<uint64_t, 16> out{};
+    ASSERT_EQ(ring.snapshot(out.data(), out.size()), 8u);
+    for (size_t i = 0; i < 8; ++i) {
+        EXPECT_EQ(out[i], 12 + i);
+    }
+    
+    ASSERT_EQ(ring.snapshot(out.data(), 3), 3u);
+    EXPECT_EQ(out[0], 17u);
+    EXPECT_EQ(out[2], 19u);
+}
+
+TEST(RTHistoryRingTest, ConcurrentSnapshotsAreConsistent) {
+    struct Entry {
+        uint64_t sequence;
+        uint64_t check;  // Always ~sequence; a torn read breaks this
+    };
+    RTHistoryRing<Entry, 64> ring;
+    std::atomic<bool> done{false};
+    
+    std::thread writer([&]() {
+        for (uint64_t i = 0; i < 200000; ++i) {
+            ring.push({i, ~i});
+        }
+        done.store(true);
+    });
+    
+    std::array<Entry, 64> out{};
+    size_t snapshots = 0;
+    do {
+        size_t count = ring.snapshot(out.data(), out.size());
+        for (size_t i = 0; i < count; ++i) {
+            ASSERT_EQ(out[i].check, ~out[i].sequence);
+            if (i > 0) {
+                ASSERT_EQ(out[i].sequence, out[i - 1].sequence + 1);
+            }
+        }
+        ++snapshots;
+    } while (!done.load());
+    writer.join();
+    
+    EXPECT_GT(snapshots, 0u);
+    EXPECT_EQ(ring.snapshot(out.data(), out.size()), 64u);
+    EXPECT_EQ(out.back().sequence, 199999u);
+}
+
+TEST(RTEventQueueTest, DeliversInOrderAndDropsWhenFull) {
+    RTEventQueue<uint64_t, 4> queue;
+    for (uint64_t i = 0; i < 6; ++i) {
+        EXPECT_EQ(queue.push(i), i < 4);
+    }
+    EXPECT_EQ(queue.size(), 4u);
+    EXPECT_EQ(queue.getDroppedCount(), 2u);
+    
+    uint64_t value = 0;
+    for (uint64_t i = 0; i < 4; ++i) {
+        ASSERT_TRUE(queue.pop(value));
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_FALSE(queue.pop(value));
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(RTEventQueueTest, ConcurrentProducerAndConsumer) {
+    constexpr uint64_t kEvents = 100000;
+    RTEventQueue<uint64_t, 64> queue;
+    
+    std::thread producer([&queue]() {
+        for (uint64_t i = 0; i < kEvents; ++i) {
+            while (!queue.push(i)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+    
+    uint64_t expected = 0;
+    uint64_t value = 0;
+    while (expected < kEvents) {
+        if (queue.pop(value)) {
+            ASSERT_EQ(value, expected);
+            ++expected;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    EXPECT_TRUE(queue.empty());
+}
+
 TEST(ChordAnalyzerTest, AnalyzesPitchClassSet) {
     ChordAnalyzer analyzer;
     
@@ -207,3 +1042,861 @@ TEST(ScaleDetectorTest, DetectsCMajorScale) {
     EXPECT_EQ(scale.tonic, 0);  // C
     EXPECT_GT(scale.confidence, 0.0f);
 }
+
+TEST(ScaleDetectorTest, ProfileMatrixMatchesPerProfileCorrelation) {
+    ScaleDetector detector;
+    
+    // Deterministic pseudo-random histograms, plus a few sparse ones
+    uint32_t state = 12345;
+    auto next = [&state]() {
+        state = state * 1664525u + 1013904223u;
+        return static_cast<float>(state >> 8) / static_cast<float>(1u << 24);
+    };
+    
+    for (int trial = 0; trial < 500; ++trial) {
+        std::array<float, 12> histogram{};
+        for (auto& bin : histogram) {
+            bin = trial % 5 == 0 ? (next() > 0.6f ? 1.0f : 0.0f) : next() * 4.0f;
+        }
+        
+        Scale fast = detector.analyzeHistogram(histogram);
+        Scale reference = detector.analyzeHistogramExhaustive(histogram);
+        
+        ASSERT_NEAR(fast.confidence, reference.confidence, 1e-4f) << "trial " << trial;
+        ASSERT_EQ(fast.tonic, reference.tonic) << "trial " << trial;
+        ASSERT_EQ(fast.mode, reference.mode) << "trial " << trial;
+    }
+}
+
+TEST(ScaleDetectorTest, DetectsTransposedKeys) {
+    ScaleDetector detector;
+    
+    // Krumhansl-style emphasis on tonic and dominant, in every key
+    for (int tonic = 0; tonic < 12; ++tonic) {
+        std::array<float, 12> histogram{};
+        for (int degree : {0, 2, 4, 5, 7, 9, 11}) {
+            histogram[(tonic + degree) % 12] = 1.0f;
+        }
+        histogram[tonic] = 3.0f;
+        histogram[(tonic + 7) % 12] = 2.0f;
+        
+        Scale scale = detector.analyzeHistogram(histogram);
+        EXPECT_EQ(scale.tonic, tonic);
+        EXPECT_EQ(scale.mode, 0);  // Major
+    }
+}
+
+TEST(ScaleDetectorTest, ExtendedBankMatchesPerProfileCorrelation) {
+    // Built-ins plus enough generated profiles to span many SIMD blocks
+    KeyProfileBank bank = KeyProfileBank::extended();
+    ASSERT_TRUE(bank.append(KeyProfileBank::temperley()));
+    ASSERT_TRUE(bank.append(KeyProfileBank::aardenEssen()));
+    
+    uint32_t state = 777;
+    auto next = [&state]() {
+        state = state * 1664525u + 1013904223u;
+        return static_cast<float>(state >> 8) / static_cast<float>(1u << 24);
+    };
+    
+    while (bank.getNumProfiles() < KeyProfileBank::kMaxProfiles) {
+        std::array<float, 12> weights{};
+        for (auto& w : weights) w = next() * 5.0f;
+        ASSERT_GE(bank.addProfile("Random " + std::to_string(bank.getNumProfiles()), weights), 0);
+    }
+    EXPECT_EQ(bank.addProfile("Overflow", {}), -1);
+    EXPECT_EQ(bank.getNumRows(), KeyProfileBank::kMaxProfiles * 12);
+    
+    ScaleDetector detector(std::make_shared<const KeyProfileBank>(std::move(bank)));
+    
+    for (int trial = 0; trial < 200; ++trial) {
+        std::array<float, 12> histogram{};
+        for (auto& bin : histogram) {
+            bin = next() * 4.0f;
+        }
+        
+        Scale fast = detector.analyzeHistogram(histogram);
+        Scale reference = detector.analyzeHistogramExhaustive(histogram);
+        
+        ASSERT_NEAR(fast.confidence, reference.confidence, 1e-4f) << "trial " << trial;
+        ASSERT_EQ(fast.tonic, reference.tonic) << "trial " << trial;
+        ASSERT_EQ(fast.mode, reference.mode) << "trial " << trial;
+    }
+}
+
+TEST(ScaleDetectorTest, DetectsExoticScalesWithExtendedBank) {
+    auto bank = std::make_shared<const KeyProfileBank>(KeyProfileBank::extended());
+    ScaleDetector detector(bank);
+    
+    struct Case { const char* name; std::vector<int> degrees; int tonic; };
+    const std::vector<Case> cases = {
+        {"Harmonic Minor", {0, 2, 3, 5, 7, 8, 11}, 9},
+        {"Blues", {0, 3, 5, 6, 7, 10}, 4},
+        {"Whole Tone", {0, 2, 4, 6, 8, 10}, 1},
+        {"Octatonic (Half-Whole)", {0, 1, 3, 4, 6, 7, 9, 10}, 7},
+    };
+    
+    for (const auto& c : cases) {
+        std::array<float, 12> histogram{};
+        for (int degree : c.degrees) {
+            histogram[(c.tonic + degree) % 12] = 1.0f;
+        }
+        histogram[c.tonic] = 2.0f;
+        
+        Scale scale = detector.analyzeHistogram(histogram);
+        EXPECT_EQ(scale.tonic, c.tonic) << c.name;
+        EXPECT_EQ(bank->getProfile(scale.mode).name, c.name);
+        EXPECT_NEAR(scale.confidence, 1.0f, 1e-4f) << c.name;
+    }
+}
+
+TEST(ScaleDetectorTest, LoadsUserProfilesFromJson) {
+    KeyProfileBank bank;
+    std::string error;
+    
+    ASSERT_TRUE(bank.loadJson(R"({
+        "version": 1,
+        "profiles": [
+            {"name": "Hijaz", "degrees": [0, 1, 4, 5, 7, 8, 10]},
+            {"name": "Custom", "weights": [5, 0, 1, 0, 3, 1, 0, 4, 0, 1, 0, 2e0],
+             "comment": {"ignored": [true, null]}}
+        ]
+    })", &error)) << error;
+    
+    ASSERT_EQ(bank.getNumProfiles(), 2u);
+    EXPECT_EQ(bank.findProfile("Hijaz"), 0);
+    EXPECT_EQ(bank.findProfile("Custom"), 1);
+    EXPECT_FLOAT_EQ(bank.getProfile(0).weights[0], 2.0f);
+    EXPECT_FLOAT_EQ(bank.getProfile(0).weights[1], 1.0f);
+    EXPECT_FLOAT_EQ(bank.getProfile(0).weights[2], 0.0f);
+    EXPECT_FLOAT_EQ(bank.getProfile(1).weights[11], 2.0f);
+    
+    // Malformed input leaves the bank untouched
+    EXPECT_FALSE(bank.loadJson(R"({"profiles": [{"name": "Short", "weights": [1, 2, 3]}]})", &error));
+    EXPECT_NE(error.find("12 numbers"), std::string::npos);
+    EXPECT_FALSE(bank.loadJson(R"([{"name": "Ok", "degrees": [0, 4, 7]}, {"name": )", &error));
+    EXPECT_FALSE(bank.loadJson(R"({"profiles": [{"name": "Flat", "weights": [1,1,1,1,1,1,1,1,1,1,1,1]}]})", &error));
+    EXPECT_FALSE(bank.loadJsonFile("/nonexistent/profiles.json", &error));
+    
+    // Deeply nested unknown values fail instead of overflowing the stack
+    const std::string deep = R"({"extra": )" + std::string(100000, '[') + std::string(100000, ']') +
+                             R"(, "profiles": []})";
+    EXPECT_FALSE(bank.loadJson(deep, &error));
+    EXPECT_NE(error.find("nesting"), std::string::npos);
+    EXPECT_EQ(bank.getNumProfiles(), 2u);
+    
+    // Detector reports user profiles by index
+    ScaleDetector detector(std::make_shared<const KeyProfileBank>(bank));
+    std::array<float, 12> histogram{};
+    for (int degree : {0, 1, 4, 5, 7, 8, 10}) {
+        histogram[(2 + degree) % 12] = 1.0f;
+    }
+    histogram[2] = 2.0f;
+    
+    Scale scale = detector.analyzeHistogram(histogram);
+    EXPECT_EQ(scale.tonic, 2);
+    EXPECT_EQ(scale.mode, 0);
+}
+
+TEST_F(HarmonyEngineTest, UsesConfiguredKeyProfileBank) {
+    EXPECT_EQ(engine->getKeyProfileBank().getNumProfiles(), 7u);
+    
+    engine->setKeyProfileBank(std::make_shared<const KeyProfileBank>(KeyProfileBank::extended()));
+    EXPECT_GT(engine->getKeyProfileBank().getNumProfiles(), 7u);
+    
+    // E minor pentatonic, E held twice (two octaves)
+    std::vector<Note> notes = {
+        Note(52, 100, 0), Note(64, 100, 0), Note(55, 100, 0),
+        Note(57, 100, 0), Note(59, 100, 0), Note(62, 100, 0)
+    };
+    engine->processNotes(notes.data(), notes.size());
+    
+    const Scale& scale = engine->getCurrentScale();
+    EXPECT_EQ(scale.tonic, 4);
+    EXPECT_EQ(engine->getKeyProfileBank().getProfile(scale.mode).name, "Minor Pentatonic");
+}
+
+namespace {
+
+std::array<float, 12> majorScaleWeights(int tonic) {
+    std::array<float, 12> weights{};
+    for (int degree : {0, 2, 4, 5, 7, 9, 11}) {
+        weights[(tonic + degree) % 12] = 1.0f;
+    }
+    weights[tonic] = 2.0f;
+    weights[(tonic + 7) % 12] = 1.5f;
+    return weights;
+}
+
+} // anonymous namespace
+
+TEST(ScaleDetectorTest, TracksModulationWithHysteresis) {
+    ScaleDetector detector;
+    ScaleDetector::TrackingConfig config;
+    config.sampleRate = 48000.0;
+    detector.setTrackingConfig(config);
+    
+    constexpr uint64_t hop = 12000;  // 250 ms
+    uint64_t position = 0;
+    auto play = [&](int tonic, double seconds) {
+        const uint64_t end = position + static_cast<uint64_t>(seconds * 48000.0);
+        for (; position < end; position += hop) {
+            detector.track(majorScaleWeights(tonic), position);
+        }
+    };
+    
+    play(0, 20.0);
+    EXPECT_EQ(detector.getCurrentKey().tonic, 0);
+    EXPECT_EQ(detector.getTrackedScale(ScaleDetector::Timescale::Long).tonic, 0);
+    
+    // A two-second excursion moves the short timescale only
+    play(7, 2.0);
+    EXPECT_EQ(detector.getTrackedScale(ScaleDetector::Timescale::Short).tonic, 7);
+    play(0, 10.0);
+    
+    ScaleDetector::ModulationEvent event{};
+    EXPECT_FALSE(detector.popModulation(event));
+    EXPECT_EQ(detector.getCurrentKey().tonic, 0);
+    
+    // A sustained move to G is reported once, stamped where G took the lead
+    const uint64_t modulationStart = position;
+    play(7, 20.0);
+    
+    ASSERT_TRUE(detector.popModulation(event));
+    EXPECT_EQ(event.from.tonic, 0);
+    EXPECT_EQ(event.to.tonic, 7);
+    EXPECT_EQ(event.to.mode, 0);
+    EXPECT_GT(event.samplePosition, modulationStart);
+    EXPECT_GE(event.confirmedPosition - event.samplePosition,
+              static_cast<uint64_t>(config.minHoldSeconds * config.sampleRate));
+    EXPECT_FALSE(detector.popModulation(event));
+    EXPECT_EQ(detector.getCurrentKey().tonic, 7);
+    EXPECT_EQ(detector.getTrackedScale(ScaleDetector::Timescale::Medium).tonic, 7);
+}
+
+TEST_F(HarmonyEngineTest, ReportsKeyModulationsFromNoteStream) {
+    // I-IV-V-I in C, then in D, one chord per second
+    auto playCadence = [this](int tonic, uint64_t start) {
+        const int roots[] = {0, 5, 7, 0};
+        uint64_t time = start;
+        for (int repeat = 0; repeat < 4; ++repeat) {
+            for (int root : roots) {
+                const int base = 48 + (tonic + root) % 12;
+                const int third = root == 0 || root == 5 || root == 7 ? 4 : 3;
+                std::vector<Note> on = {
+                    Note(static_cast<uint8_t>(base), 100, 0, time),
+                    Note(static_cast<uint8_t>(base + third), 100, 0, time),
+                    Note(static_cast<uint8_t>(base + 7), 100, 0, time),
+                };
+                engine->processNotes(on.data(), on.size());
+                time += 48000;
+                for (auto& note : on) {
+                    note.velocity = 0;
+                    note.timestamp = time;
+                }
+                engine->processNotes(on.data(), on.size());
+            }
+        }
+        return time;
+    };
+    
+    uint64_t time = playCadence(0, 0);
+    EXPECT_EQ(engine->getCurrentKey().tonic, 0);
+    
+    HarmonyEngine::ModulationEvent event{};
+    EXPECT_FALSE(engine->popModulation(event));
+    
+    time = playCadence(2, time);
+    playCadence(2, time);
+    
+    ASSERT_TRUE(engine->popModulation(event));
+    EXPECT_EQ(event.from.tonic, 0);
+    EXPECT_EQ(event.to.tonic, 2);
+    EXPECT_EQ(engine->getCurrentKey().tonic, 2);
+}
+
+// ========== VoiceLeading Tests ==========
+
+namespace {
+
+// Exhaustive reference over the solver's search space
+float bruteForceVoiceLeading(
+    const VoiceLeading& voiceLeading,
+    const VoiceLeading::Voicing& from,
+    const Chord& chord
+) {
+    const size_t n = from.count;
+    const int required = std::min<int>(static_cast<int>(n), chord.pitchClass.count());
+    float best = std::numeric_limits<float>::infinity();
+    VoiceLeading::Voicing to = from;
+    
+    std::function<void(size_t)> recurse = [&](size_t voice) {
+        if (voice == n) {
+            PitchClassSet covered;
+            for (size_t i = 0; i < n; ++i) {
+                for (size_t j = 0; j < i; ++j) {
+                    if (to.pitches[i] == to.pitches[j]) return;
+                    const bool crossed = (from.pitches[i] < from.pitches[j]) != (to.pitches[i] < to.pitches[j]);
+                    if (crossed && from.pitches[i] != from.pitches[j] &&
+                        !voiceLeading.getConfig().allowVoiceCrossing) return;
+                }
+                covered.set(to.pitches[i] % 12, true);
+            }
+            if (static_cast<int>(covered.count()) < required) return;
+            best = std::min(best, voiceLeading.calculateCost(from, to));
+            return;
+        }
+        for (int d = -VoiceLeading::kMaxSearchRadius; d <= VoiceLeading::kMaxSearchRadius; ++d) {
+            const int pitch = from.pitches[voice] + d;
+            if (pitch < 0 || pitch > 127 || !chord.pitchClass.contains(pitch % 12)) continue;
+            to.pitches[voice] = static_cast<uint8_t>(pitch);
+            recurse(voice + 1);
+        }
+    };
+    recurse(0);
+    return best;
+}
+
+// Pairwise definition of calculateCost, straight from its documentation
+float referenceVoiceLeadingCost(
+    const VoiceLeading::Config& config,
+    const VoiceLeading::Voicing& from,
+    const VoiceLeading::Voicing& to
+) {
+    float cost = 0.0f;
+    for (size_t i = 0; i < from.count; ++i) {
+        const float distance = static_cast<float>(std::abs(to.pitches[i] - from.pitches[i]));
+        cost += distance > config.maxVoiceDistance ? distance * 2.0f : distance;
+    }
+    for (size_t i = 0; i < from.count; ++i) {
+        for (size_t j = i + 1; j < from.count; ++j) {
+            const int interval1 = std::abs(from.pitches[i] - from.pitches[j]);
+            const int interval2 = std::abs(to.pitches[i] - to.pitches[j]);
+            const int motion1 = to.pitches[i] - from.pitches[i];
+            const int motion2 = to.pitches[j] - from.pitches[j];
+            if ((interval1 == 7 || interval1 == 12) && interval1 == interval2 &&
+                motion1 == motion2 && motion1 != 0) {
+                cost += config.parallelPenalty;
+            }
+            if ((motion1 > 0 && motion2 < 0) || (motion1 < 0 && motion2 > 0)) {
+                cost -= config.contraryBonus;
+            }
+            const bool crossing = (from.pitches[i] < from.pitches[j] && to.pitches[i] > to.pitches[j]) ||
+                                  (from.pitches[i] > from.pitches[j] && to.pitches[i] < to.pitches[j]);
+            if (crossing && !config.allowVoiceCrossing) {
+                cost += config.parallelPenalty * 2.0f;
+            }
+        }
+    }
+    return cost;
+}
+
+} // anonymous namespace
+
+TEST(VoiceLeadingTest, SolverMatchesExhaustiveSearch) {
+    VoiceLeading::Config orderedConfig;
+    orderedConfig.maxSearchMicros = 0;  // Exact on any machine
+    VoiceLeading::Config crossingConfig = orderedConfig;
+    crossingConfig.allowVoiceCrossing = true;
+    VoiceLeading ordered(orderedConfig);
+    VoiceLeading crossing(crossingConfig);
+    
+    uint32_t state = 4242;
+    auto next = [&state](uint32_t range) {
+        state = state * 1664525u + 1013904223u;
+        return (state >> 8) % range;
+    };
+    
+    for (int trial = 0; trial < 60; ++trial) {
+        VoiceLeading::Voicing from;
+        from.count = static_cast<uint8_t>(2 + trial % 3);
+        for (size_t v = 0; v < from.count; ++v) {
+            from.pitches[v] = static_cast<uint8_t>(48 + v * 5 + next(6));
+        }
+        
+        Chord chord;
+        const int root = static_cast<int>(next(12));
+        const int third = next(2) ? 4 : 3;
+        chord.pitchClass = PitchClassSet::fromPitchClasses({root, (root + third) % 12, (root + 7) % 12});
+        
+        const VoiceLeading& voiceLeading = trial % 2 ? crossing : ordered;
+        VoiceLeading::Voicing to;
+        VoiceLeading::SearchStats stats;
+        const float cost = voiceLeading.solve(from, chord, to, &stats);
+        
+        ASSERT_TRUE(stats.exhaustive) << "trial " << trial;
+        ASSERT_EQ(to.count, from.count);
+        EXPECT_NEAR(cost, bruteForceVoiceLeading(voiceLeading, from, chord), 1e-4f) << "trial " << trial;
+        EXPECT_FLOAT_EQ(cost, voiceLeading.calculateCost(from, to));
+    }
+}
+
+TEST(VoiceLeadingTest, BatchedCostsMatchPairwiseDefinition) {
+    VoiceLeading::Config configs[3];
+    configs[1].allowVoiceCrossing = true;
+    configs[2].maxVoiceDistance = 4.0f;
+    configs[2].parallelPenalty = 3.0f;
+    configs[2].contraryBonus = 1.0f;
+    
+    uint32_t state = 99;
+    auto next = [&state](uint32_t range) {
+        state = state * 1664525u + 1013904223u;
+        return (state >> 8) % range;
+    };
+    
+    for (const auto& config : configs) {
+        VoiceLeading voiceLeading(config);
+        
+        for (uint8_t voices = 1; voices <= VoiceLeading::kMaxVoices; ++voices) {
+            // Narrow ranges so unisons, fifths, octaves and crossings all occur
+            VoiceLeading::Voicing from;
+            from.count = voices;
+            for (size_t v = 0; v < voices; ++v) {
+                from.pitches[v] = static_cast<uint8_t>(48 + next(25));
+            }
+            
+            std::vector<VoiceLeading::Voicing> candidates(37, from);
+            for (auto& candidate : candidates) {
+                for (size_t v = 0; v < voices; ++v) {
+                    candidate.pitches[v] = static_cast<uint8_t>(from.pitches[v] + static_cast<int>(next(15)) - 7);
+                }
+            }
+            candidates[5].count = static_cast<uint8_t>(voices - 1);  // Mismatched voice count
+            
+            std::vector<float> costs(candidates.size());
+            voiceLeading.calculateCosts(from, candidates.data(), candidates.size(), costs.data());
+            
+            for (size_t k = 0; k < candidates.size(); ++k) {
+                const float expected = k == 5
+                    ? std::numeric_limits<float>::max()
+                    : referenceVoiceLeadingCost(config, from, candidates[k]);
+                EXPECT_FLOAT_EQ(costs[k], expected) << "voices " << int(voices) << " candidate " << k;
+                EXPECT_FLOAT_EQ(voiceLeading.calculateCost(from, candidates[k]), expected);
+            }
+        }
+    }
+}
+
+TEST(VoiceLeadingTest, PlanMatchesExhaustivePathSearch) {
+    VoiceLeading::Config config;
+    config.beamWidth = 100000;
+    config.maxPlanCandidates = 100000;
+    VoiceLeading voiceLeading(config);
+    
+    VoiceLeading::Voicing start;
+    start.count = 3;
+    start.pitches = {55, 60, 64};
+    
+    std::vector<Chord> chords(4);
+    chords[0].pitchClass = PitchClassSet::fromPitchClasses({5, 9, 0});   // F
+    chords[1].pitchClass = PitchClassSet::fromPitchClasses({7, 11, 2});  // G
+    chords[2].pitchClass = PitchClassSet::fromPitchClasses({9, 0, 4});   // Am
+    chords[3].pitchClass = PitchClassSet::fromPitchClasses({2, 5, 9});   // Dm
+    
+    // Every voicing planProgression may pick after `previous`: ascending
+    // chord tones, each within kPlanRadius of the previous pitch, covering
+    // the triad
+    auto options = [](const Chord& chord, const VoiceLeading::Voicing& previous) {
+        std::vector<VoiceLeading::Voicing> result;
+        VoiceLeading::Voicing v = previous;
+        const int r = VoiceLeading::kPlanRadius;
+        const auto& p = previous.pitches;
+        for (int a = p[0] - r; a <= p[0] + r; ++a) {
+            for (int b = p[1] - r; b <= p[1] + r; ++b) {
+                for (int c = p[2] - r; c <= p[2] + r; ++c) {
+                    if (!(a < b && b < c)) continue;
+                    PitchClassSet covered = PitchClassSet::fromPitchClasses({a % 12, b % 12, c % 12});
+                    if (covered != chord.pitchClass) continue;
+                    v.pitches = {static_cast<uint8_t>(a), static_cast<uint8_t>(b), static_cast<uint8_t>(c)};
+                    result.push_back(v);
+                }
+            }
+        }
+        return result;
+    };
+    
+    float best = std::numeric_limits<float>::infinity();
+    std::function<void(size_t, const VoiceLeading::Voicing&, float)> walk =
+        [&](size_t t, const VoiceLeading::Voicing& previous, float cost) {
+            if (t == chords.size()) {
+                best = std::min(best, cost);
+                return;
+            }
+            for (const auto& option : options(chords[t], previous)) {
+                walk(t + 1, option, cost + voiceLeading.calculateCost(previous, option));
+            }
+        };
+    walk(0, start, 0.0f);
+    ASSERT_TRUE(std::isfinite(best));
+    
+    std::vector<VoiceLeading::Voicing> path(chords.size());
+    const float cost = voiceLeading.planProgression(chords.data(), chords.size(), start, path.data());
+    EXPECT_NEAR(cost, best, 1e-4f);
+    
+    // The reported cost is the cost of the returned path
+    float pathCost = 0.0f;
+    VoiceLeading::Voicing previous = start;
+    for (const auto& voicing : path) {
+        pathCost += voiceLeading.calculateCost(previous, voicing);
+        previous = voicing;
+    }
+    EXPECT_NEAR(cost, pathCost, 1e-4f);
+    
+    // A one-state beam is greedy and can only do worse
+    config.beamWidth = 1;
+    VoiceLeading greedy(config);
+    EXPECT_GE(greedy.planProgression(chords.data(), chords.size(), start, path.data()), cost);
+}
+
+TEST(VoiceLeadingTest, PlanFollowsProgressionsThatDriftAway) {
+    VoiceLeading voiceLeading;
+    
+    VoiceLeading::Voicing start;
+    start.count = 3;
+    start.pitches = {60, 61, 62};
+    
+    // A cluster climbing by whole steps for an octave and a half: the
+    // smooth path ends far from the starting register
+    std::vector<Chord> chords(9);
+    for (size_t t = 0; t < chords.size(); ++t) {
+        const int root = static_cast<int>(2 * (t + 1)) % 12;
+        chords[t].pitchClass = PitchClassSet::fromPitchClasses({root, (root + 1) % 12, (root + 2) % 12});
+    }
+    
+    // Chaining single solves is one feasible path; the plan can only do better
+    float greedyCost = 0.0f;
+    VoiceLeading::Voicing previous = start;
+    for (const auto& chord : chords) {
+        VoiceLeading::Voicing next;
+        greedyCost += voiceLeading.solve(previous, chord, next);
+        previous = next;
+    }
+    ASSERT_TRUE(std::isfinite(greedyCost));
+    
+    std::vector<VoiceLeading::Voicing> path(chords.size());
+    const float cost = voiceLeading.planProgression(chords.data(), chords.size(), start, path.data());
+    EXPECT_LE(cost, greedyCost + 1e-4f);
+    
+    previous = start;
+    for (const auto& voicing : path) {
+        for (size_t v = 0; v < start.count; ++v) {
+            EXPECT_LE(std::abs(voicing.pitches[v] - previous.pitches[v]), VoiceLeading::kPlanRadius);
+        }
+        previous = voicing;
+    }
+}
+
+TEST(VoiceLeadingTest, PlanFailsWhenAChordCannotBeVoiced) {
+    VoiceLeading voiceLeading;
+    
+    VoiceLeading::Voicing start;
+    start.count = 3;
+    start.pitches = {60, 64, 67};
+    
+    std::vector<Chord> chords(2);
+    chords[0].pitchClass = PitchClassSet::fromPitchClasses({5, 9, 0});
+    // chords[1] has no pitch classes
+    
+    std::vector<VoiceLeading::Voicing> path(chords.size());
+    EXPECT_TRUE(std::isinf(voiceLeading.planProgression(chords.data(), chords.size(), start, path.data())));
+    EXPECT_EQ(path[0].pitches, start.pitches);
+    EXPECT_EQ(path[1].pitches, start.pitches);
+}
+
+TEST(VoiceLeadingTest, CoversChordTonesWithoutUnisons) {
+    VoiceLeading voiceLeading;
+    
+    // C major (4 voices) to G7: every chord tone present, voices move little
+    VoiceLeading::Voicing from;
+    from.count = 4;
+    from.pitches = {48, 55, 64, 72};
+    
+    Chord g7;
+    g7.pitchClass = PitchClassSet::fromPitchClasses({7, 11, 2, 5});
+    
+    VoiceLeading::Voicing to;
+    ASSERT_TRUE(std::isfinite(voiceLeading.solve(from, g7, to)));
+    
+    PitchClassSet covered;
+    for (size_t v = 0; v < to.count; ++v) {
+        covered.set(to.pitches[v] % 12, true);
+        EXPECT_LE(std::abs(static_cast<int>(to.pitches[v]) - static_cast<int>(from.pitches[v])), 5);
+        for (size_t w = 0; w < v; ++w) {
+            EXPECT_NE(to.pitches[v], to.pitches[w]);
+        }
+    }
+    EXPECT_EQ(covered, g7.pitchClass);
+    
+    // No chord tones: no voicing
+    EXPECT_TRUE(std::isinf(voiceLeading.solve(from, Chord{}, to)));
+    EXPECT_EQ(to.pitches, from.pitches);
+}
+
+TEST(VoiceLeadingTest, NodeBudgetBoundsSearch) {
+    VoiceLeading::Config config;
+    config.maxSearchNodes = 16;
+    VoiceLeading voiceLeading(config);
+    
+    VoiceLeading::Voicing from;
+    from.count = 8;
+    from.pitches = {36, 43, 48, 52, 55, 60, 64, 67};
+    
+    Chord chord;
+    chord.pitchClass = PitchClassSet::fromPitchClasses({2, 5, 9, 0});
+    
+    VoiceLeading::Voicing to;
+    VoiceLeading::SearchStats stats;
+    voiceLeading.solve(from, chord, to, &stats);
+    EXPECT_LE(stats.nodes, 16u);
+    EXPECT_FALSE(stats.exhaustive);
+}
+
+TEST(VoiceLeadingTest, ConcurrentSolvesMatchSerialOnes) {
+    VoiceLeading::Config config;
+    config.maxSearchMicros = 0;  // Contended threads must not cut searches short
+    const VoiceLeading voiceLeading(config);
+    
+    // Every triad from a few source voicings, solved serially...
+    std::vector<VoiceLeading::Voicing> sources(4);
+    for (size_t i = 0; i < sources.size(); ++i) {
+        sources[i].count = 4;
+        sources[i].pitches = {
+            static_cast<uint8_t>(48 + i), static_cast<uint8_t>(55 + i),
+            static_cast<uint8_t>(60 + i), static_cast<uint8_t>(64 + i)
+        };
+    }
+    std::vector<Chord> chords(24);
+    for (size_t c = 0; c < chords.size(); ++c) {
+        const int root = static_cast<int>(c % 12);
+        const int third = c < 12 ? 4 : 3;
+        chords[c].pitchClass = PitchClassSet::fromPitchClasses({root, (root + third) % 12, (root + 7) % 12});
+    }
+    std::vector<VoiceLeading::Voicing> expected(sources.size() * chords.size());
+    for (size_t k = 0; k < expected.size(); ++k) {
+        voiceLeading.solve(sources[k % sources.size()], chords[k / sources.size()], expected[k]);
+    }
+    
+    // ...and again from several threads sharing the instance
+    std::vector<std::thread> threads;
+    std::atomic<int> mismatches{0};
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&] {
+            for (int round = 0; round < 50; ++round) {
+                for (size_t k = 0; k < expected.size(); ++k) {
+                    VoiceLeading::Voicing to;
+                    voiceLeading.solve(sources[k % sources.size()], chords[k / sources.size()], to);
+                    if (to.pitches != expected[k].pitches) {
+                        ++mismatches;
+                    }
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(mismatches.load(), 0);
+}
+
+TEST_F(HarmonyEngineTest, GhostNotesDoNotChangeTheChord) {
+    std::vector<Note> notes = {
+        Note{60, 100},  // C4
+        Note{64, 95},   // E4
+        Note{67, 100},  // G4
+        Note{70, 10},   // Bb4, ghosted
+    };
+    engine->processNotes(notes.data(), notes.size());
+    
+    EXPECT_EQ(engine->getCurrentChord().root, 0);
+    EXPECT_EQ(engine->getCurrentChord().quality, 0);  // Major, not Dom7
+    
+    // With presence-only analysis the ghost note counts in full
+    HarmonyEngine::Config config;
+    config.weightedChordAnalysis = false;
+    HarmonyEngine unweighted(config);
+    unweighted.processNotes(notes.data(), notes.size());
+    EXPECT_EQ(unweighted.getCurrentChord().quality, 4);
+}
+
+TEST_F(HarmonyEngineTest, PlansVoiceLeadingAcrossProgression) {
+    std::vector<Note> voices = {Note{60, 90}, Note{64, 90}, Note{67, 90}};
+    
+    std::vector<Chord> chords(3);
+    chords[0].pitchClass = PitchClassSet::fromPitchClasses({2, 5, 9});   // Dm
+    chords[1].pitchClass = PitchClassSet::fromPitchClasses({7, 11, 2});  // G
+    chords[2].pitchClass = PitchClassSet::fromPitchClasses({0, 4, 7});   // C
+    
+    auto plan = engine->planVoiceLeading(chords, voices);
+    ASSERT_EQ(plan.size(), chords.size());
+    for (size_t t = 0; t < plan.size(); ++t) {
+        ASSERT_EQ(plan[t].size(), voices.size());
+        PitchClassSet covered;
+        for (size_t i = 0; i < voices.size(); ++i) {
+            covered.set(plan[t][i].pitch % 12, true);
+            EXPECT_EQ(plan[t][i].velocity, 90);
+            if (i > 0) {
+                EXPECT_LT(plan[t][i - 1].pitch, plan[t][i].pitch);
+            }
+        }
+        EXPECT_EQ(covered, chords[t].pitchClass) << "chord " << t;
+    }
+}
+
+TEST_F(HarmonyEngineTest, SuggestsVoiceLeadingWithoutAllocating) {
+    VoiceLeading::Voicing current;
+    current.count = 3;
+    current.pitches[0] = 60;
+    current.pitches[1] = 64;
+    current.pitches[2] = 67;
+    
+    Chord f;
+    f.pitchClass = PitchClassSet::fromPitchClasses({5, 9, 0});
+    
+    VoiceLeading::Voicing next;
+    ASSERT_TRUE(engine->suggestVoiceLeading(f, current, next));
+    EXPECT_EQ(next.pitches[0], 60);  // Common tone held
+    EXPECT_EQ(next.pitches[1], 65);
+    EXPECT_EQ(next.pitches[2], 69);
+    
+    std::vector<Note> voices = {Note(60, 90), Note(64, 90), Note(67, 90)};
+    auto suggested = engine->suggestVoiceLeading(f, voices);
+    ASSERT_EQ(suggested.size(), 3u);
+    EXPECT_EQ(suggested[1].pitch, 65);
+    EXPECT_EQ(suggested[1].velocity, 90);
+}
+
+// ========== Audio Chroma Tests ==========
+
+namespace {
+
+// Sum of equal-amplitude sines at the given MIDI pitches
+std::vector<float> synthesizeTones(std::initializer_list<int> pitches, size_t frames, double sampleRate) {
+    std::vector<float> audio(frames, 0.0f);
+    for (int pitch : pitches) {
+        const double frequency = 440.0 * std::pow(2.0, (pitch - 69) / 12.0);
+        for (size_t n = 0; n < frames; ++n) {
+            audio[n] += 0.2f * static_cast<float>(std::sin(2.0 * M_PI * frequency * n / sampleRate));
+        }
+    }
+    return audio;
+}
+
+} // anonymous namespace
+
+TEST(RTFFTTest, MatchesNaiveDFT) {
+    for (size_t size : {4u, 8u, 64u, 1024u, 2048u}) {
+        RTFFT fft(size);
+        ASSERT_EQ(fft.getNumBins(), size / 2 + 1);
+        
+        std::vector<float> input(size);
+        for (size_t n = 0; n < size; ++n) {
+            input[n] = std::sin(0.37f * n) + 0.5f * std::cos(1.91f * n) + (n % 3 == 0 ? 0.25f : -0.1f);
+        }
+        
+        std::vector<float> real(fft.getNumBins());
+        std::vector<float> imag(fft.getNumBins());
+        std::vector<float> magnitude(fft.getNumBins());
+        fft.forward(input.data(), real.data(), imag.data());
+        fft.magnitudes(input.data(), magnitude.data());
+        
+        for (size_t k = 0; k < fft.getNumBins(); ++k) {
+            double expectedReal = 0.0;
+            double expectedImag = 0.0;
+            for (size_t n = 0; n < size; ++n) {
+                const double phase = 2.0 * M_PI * static_cast<double>(k * n) / size;
+                expectedReal += input[n] * std::cos(phase);
+                expectedImag -= input[n] * std::sin(phase);
+            }
+            const double tolerance = 1e-4 * size;
+            EXPECT_NEAR(real[k], expectedReal, tolerance) << "size " << size << " bin " << k;
+            EXPECT_NEAR(imag[k], expectedImag, tolerance) << "size " << size << " bin " << k;
+            EXPECT_NEAR(magnitude[k], std::hypot(expectedReal, expectedImag), tolerance);
+        }
+    }
+}
+
+TEST(ChromaExtractorTest, FoldsTriadOntoItsPitchClasses) {
+    ChromaExtractor::Config config;
+    config.sampleRate = 48000.0;
+    ChromaExtractor extractor(config);
+    EXPECT_GT(extractor.getMappingSize(), 0u);
+    
+    // A minor triad (A3 C4 E4) in 256-sample blocks
+    auto audio = synthesizeTones({57, 60, 64}, 8192, config.sampleRate);
+    size_t framesReady = 0;
+    for (size_t offset = 0; offset < audio.size(); offset += 256) {
+        framesReady += extractor.process(audio.data() + offset, 256) ? 1 : 0;
+    }
+    EXPECT_EQ(framesReady, audio.size() / config.hopSize);
+    EXPECT_EQ(extractor.getFramePosition(), audio.size());
+    
+    const auto& chroma = extractor.getChroma();
+    for (int pc = 0; pc < 12; ++pc) {
+        const bool chordTone = pc == 9 || pc == 0 || pc == 4;
+        if (chordTone) {
+            EXPECT_GT(chroma[pc], 0.5f) << "pitch class " << pc;
+        } else {
+            EXPECT_EQ(chroma[pc], 0.0f) << "pitch class " << pc;
+        }
+    }
+}
+
+TEST(ChromaExtractorTest, ComputesOnlyTheNewestFrameOfALargeBlock) {
+    ChromaExtractor::Config config;
+    config.sampleRate = 48000.0;
+    ChromaExtractor extractor(config);
+    
+    auto audio = synthesizeTones({62}, 8000, config.sampleRate);
+    EXPECT_TRUE(extractor.process(audio.data(), audio.size()));
+    EXPECT_EQ(extractor.getFramePosition(), 7168u);  // Last hop boundary
+    EXPECT_EQ(extractor.getChroma()[2], 1.0f);
+    
+    // Silence clears the chroma once the tone has left the window
+    std::vector<float> silence(config.fftSize + config.hopSize, 0.0f);
+    EXPECT_TRUE(extractor.process(silence.data(), silence.size()));
+    for (float value : extractor.getChroma()) {
+        EXPECT_EQ(value, 0.0f);
+    }
+}
+
+TEST_F(HarmonyEngineTest, DetectsChordFromAudio) {
+    // G major triad (G3 B3 D4), as an audio-only stem
+    auto audio = synthesizeTones({55, 59, 62}, 16384, 48000.0);
+    for (size_t offset = 0; offset < audio.size(); offset += 512) {
+        engine->processAudio(audio.data() + offset, 512);
+    }
+    
+    EXPECT_TRUE(engine->consumeHarmonyChanged());
+    const auto& chord = engine->getCurrentChord();
+    EXPECT_EQ(chord.root, 7);
+    EXPECT_EQ(chord.pitchClass, PitchClassSet::fromPitchClasses({7, 11, 2}));
+    EXPECT_GT(chord.confidence, 0.5f);
+    
+    std::array<HarmonyEngine::ChordEvent, 4> events;
+    ASSERT_GE(engine->getChordHistory(events.data(), events.size()), 1u);
+    EXPECT_EQ(events[0].samplePosition % 1024, 0u);  // Hop boundary
+}
+
+TEST_F(PerformanceBenchmark, ChromaFrameUnder100Microseconds) {
+    ChromaExtractor::Config config;
+    config.sampleRate = 48000.0;
+    ChromaExtractor extractor(config);
+    
+    // One hop per call, so every call computes one 4096-point frame
+    auto audio = synthesizeTones({60, 64, 67}, config.hopSize * 64, config.sampleRate);
+    constexpr int iterations = 1000;
+    
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        const float* block = audio.data() + (i % 64) * config.hopSize;
+        volatile bool ready = extractor.process(block, config.hopSize);
+        (void)ready;
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    
+    auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+    double avgMicros = duration.count() / 1000.0 / iterations;
+    
+    std::cout << "Average chroma frame time: " << avgMicros << " μs\n";
+    
+    EXPECT_LT(avgMicros, 100.0);
+}
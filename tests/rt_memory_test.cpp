@@ -1,5 +1,13 @@
 #include <gtest/gtest.h>
 #include "penta/common/RTMemoryPool.h"
+#include "penta/common/RTAllocator.h"
+#include "penta/common/RTTypes.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory_resource>
 #include <thread>
 #include <vector>
 
@@ -65,6 +73,351 @@ TEST(RTMemoryPoolTest, ThreadSafety) {
     EXPECT_EQ(pool.getAvailableBlocks(), 1000);
 }
 
+TEST(RTMemoryPoolTest, ManyThreadStressKeepsBlocksExclusive) {
+    constexpr size_t kBlockSize = 64;
+    constexpr size_t kNumBlocks = 256;
+    constexpr int kNumThreads = 16;
+    constexpr int kIterations = 20000;
+    RTMemoryPool pool(kBlockSize, kNumBlocks);
+    std::atomic<int> corruptions{0};
+    
+    // Each thread stamps its id into every block it holds; if the free list ever
+    // handed one block to two threads (ABA), a stamp would be overwritten
+    auto worker = [&](int id) {
+        std::vector<void*> held;
+        held.reserve(8);
+        for (int i = 0; i < kIterations; ++i) {
+            if (void* ptr = pool.allocate()) {
+                auto* words = static_cast<uint32_t*>(ptr);
+                for (size_t w = 0; w < kBlockSize / sizeof(uint32_t); ++w) {
+                    words[w] = static_cast<uint32_t>(id);
+                }
+                held.push_back(ptr);
+            }
+            
+            if (held.size() == 8 || (i % 3 == 0 && !held.empty())) {
+                void* ptr = held.back();
+                held.pop_back();
+                const auto* words = static_cast<const uint32_t*>(ptr);
+                for (size_t w = 0; w < kBlockSize / sizeof(uint32_t); ++w) {
+                    if (words[w] != static_cast<uint32_t>(id)) {
+                        corruptions.fetch_add(1, std::memory_order_relaxed);
+                        break;
+                    }
+                }
+                pool.deallocate(ptr);
+            }
+        }
+        for (void* ptr : held) {
+            pool.deallocate(ptr);
+        }
+    };
+    
+    std::vector<std::thread> threads;
+    for (int i = 0; i < kNumThreads; ++i) {
+        threads.emplace_back(worker, i);
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    
+    EXPECT_EQ(corruptions.load(), 0);
+    EXPECT_EQ(pool.getAvailableBlocks(), kNumBlocks);
+    
+    // Free list is intact: every block can be taken exactly once
+    std::vector<void*> ptrs;
+    while (void* ptr = pool.allocate()) {
+        ptrs.push_back(ptr);
+    }
+    EXPECT_EQ(ptrs.size(), kNumBlocks);
+    for (void* ptr : ptrs) {
+        pool.deallocate(ptr);
+    }
+}
+
+TEST(RTMemoryPoolTest, BlocksAreAligned) {
+    RTMemoryPool pool(64, 16);
+    EXPECT_EQ(pool.getBlockAlignment(), 64);
+    
+    for (int i = 0; i < 16; ++i) {
+        void* ptr = pool.allocate();
+        ASSERT_NE(ptr, nullptr);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % 64, 0u);
+    }
+}
+
+TEST(RTMemoryPoolTest, IgnoresForeignPointers) {
+    RTMemoryPool pool(64, 4);
+    int local = 0;
+    
+    EXPECT_FALSE(pool.owns(&local));
+    pool.deallocate(&local);
+    
+    EXPECT_EQ(pool.getAvailableBlocks(), 4);
+}
+
+// ========== Thread Cache Tests ==========
+
+TEST(RTMemoryPoolThreadCacheTest, RecyclesThroughMagazine) {
+    RTMemoryPool pool(64, 256, 4);
+    
+    for (int i = 0; i < 100; ++i) {
+        void* ptr = pool.allocate();
+        ASSERT_NE(ptr, nullptr);
+        pool.deallocate(ptr);
+    }
+    
+    auto stats = pool.getThreadCacheStats();
+    EXPECT_EQ(stats.misses, 1u);  // One refill, then every block comes back locally
+    EXPECT_EQ(stats.hits, 99u);
+    EXPECT_EQ(stats.cachedBlocks, RTMemoryPool::kTransferBatch);
+    EXPECT_EQ(pool.getAvailableBlocks(), 256);
+}
+
+TEST(RTMemoryPoolThreadCacheTest, OverflowReturnsToSharedList) {
+    RTMemoryPool pool(64, 256, 2);
+    
+    std::vector<void*> ptrs;
+    for (int i = 0; i < 128; ++i) {
+        ptrs.push_back(pool.allocate());
+        ASSERT_NE(ptrs.back(), nullptr);
+    }
+    for (void* ptr : ptrs) {
+        pool.deallocate(ptr);
+    }
+    
+    EXPECT_LE(pool.getThreadCacheStats().cachedBlocks, RTMemoryPool::kMagazineSize);
+    EXPECT_EQ(pool.getAvailableBlocks(), 256);
+}
+
+TEST(RTMemoryPoolThreadCacheTest, ThreadExitReturnsMagazine) {
+    constexpr size_t kNumBlocks = 512;
+    RTMemoryPool pool(64, kNumBlocks, 8);
+    std::atomic<int> corruptions{0};
+    
+    auto worker = [&](int id) {
+        std::vector<void*> held;
+        for (int i = 0; i < 5000; ++i) {
+            if (void* ptr = pool.allocate()) {
+                *static_cast<int*>(ptr) = id;
+                held.push_back(ptr);
+            }
+            if (held.size() > 20 || i % 2 == 0) {
+                while (!held.empty()) {
+                    if (*static_cast<int*>(held.back()) != id) {
+                        corruptions.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    pool.deallocate(held.back());
+                    held.pop_back();
+                }
+            }
+        }
+        for (void* ptr : held) {
+            pool.deallocate(ptr);
+        }
+        EXPECT_GT(pool.getThreadCacheStats().hits, 0u);
+    };
+    
+    // More threads than caches: the rest fall back to the shared list
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 12; ++i) {
+        threads.emplace_back(worker, i);
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    
+    EXPECT_EQ(corruptions.load(), 0);
+    EXPECT_EQ(pool.getAvailableBlocks(), kNumBlocks);
+    for (size_t i = 0; i < pool.getNumThreadCaches(); ++i) {
+        EXPECT_EQ(pool.getThreadCacheStats(i).cachedBlocks, 0u);
+    }
+}
+
+TEST(RTMemoryPoolThreadCacheTest, FullBindingTableFallsBackToSharedList) {
+    RTMemoryPool survivor(64, 64, 1);
+    
+    std::thread worker([&survivor]() {
+        {
+            std::vector<std::unique_ptr<RTMemoryPool>> pools;
+            for (size_t i = 0; i < RTMemoryPool::kMaxPoolsPerThread; ++i) {
+                pools.push_back(std::make_unique<RTMemoryPool>(64, 64, 1));
+            }
+            // Bind them all last, so constructing them evicts nothing
+            for (auto& pool : pools) {
+                pool->deallocate(pool->allocate());
+            }
+        }
+        
+        // Every slot holds a dead pool: the allocation path must not evict
+        survivor.deallocate(survivor.allocate());
+        EXPECT_EQ(survivor.getThreadCacheStats().misses, 0u);
+        
+        RTMemoryPool::releaseDeadThreadBindings();
+        survivor.deallocate(survivor.allocate());
+        EXPECT_EQ(survivor.getThreadCacheStats().misses, 1u);
+    });
+    worker.join();
+    
+    EXPECT_EQ(survivor.getAvailableBlocks(), 64);
+}
+
+// ========== RTAllocator Tests ==========
+
+TEST(RTAllocatorTest, RoutesToSmallestFittingClass) {
+    RTAllocator allocator({{16, 4}, {64, 4}, {256, 4}});
+    
+    void* small = allocator.allocate(10);
+    void* medium = allocator.allocate(40);
+    void* large = allocator.allocate(200);
+    
+    ASSERT_NE(small, nullptr);
+    ASSERT_NE(medium, nullptr);
+    ASSERT_NE(large, nullptr);
+    EXPECT_TRUE(allocator.getPool(0).owns(small));
+    EXPECT_TRUE(allocator.getPool(1).owns(medium));
+    EXPECT_TRUE(allocator.getPool(2).owns(large));
+    
+    // Too large for any class
+    EXPECT_EQ(allocator.allocate(1024), nullptr);
+    
+    allocator.deallocate(small, 10);
+    allocator.deallocate(medium);
+    allocator.deallocate(large, 200);
+    EXPECT_EQ(allocator.getPool(0).getAvailableBlocks(), 4);
+    EXPECT_EQ(allocator.getPool(1).getAvailableBlocks(), 4);
+    EXPECT_EQ(allocator.getPool(2).getAvailableBlocks(), 4);
+}
+
+TEST(RTAllocatorTest, HonorsAlignment) {
+    RTAllocator allocator({{16, 4}, {64, 4}});
+    
+    void* ptr = allocator.allocate(8, 64);
+    ASSERT_NE(ptr, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % 64, 0u);
+    EXPECT_TRUE(allocator.getPool(1).owns(ptr));
+    
+    allocator.deallocate(ptr, 8);
+    EXPECT_EQ(allocator.getPool(1).getAvailableBlocks(), 4);
+}
+
+TEST(RTAllocatorTest, ExhaustedClassReturnsNull) {
+    RTAllocator allocator({{32, 2}});
+    
+    void* a = allocator.allocate(32);
+    void* b = allocator.allocate(32);
+    EXPECT_NE(a, nullptr);
+    EXPECT_NE(b, nullptr);
+    EXPECT_EQ(allocator.allocate(32), nullptr);
+    
+    allocator.deallocate(a);
+    allocator.deallocate(b);
+}
+
+TEST(RTMemoryResourceTest, BacksPmrVector) {
+    RTAllocator allocator;
+    RTMemoryResource resource(allocator);
+    
+    {
+        std::pmr::vector<Note> notes(&resource);
+        notes.reserve(64);
+        for (uint8_t i = 0; i < 64; ++i) {
+            notes.emplace_back(static_cast<uint8_t>(60 + i % 12), 100, 0, i);
+        }
+        
+        EXPECT_TRUE(allocator.owns(notes.data()));
+        EXPECT_EQ(notes[13].pitch, 61);
+    }
+    
+    for (size_t i = 0; i < allocator.getNumSizeClasses(); ++i) {
+        const auto& pool = allocator.getPool(i);
+        EXPECT_EQ(pool.getAvailableBlocks(), pool.getTotalBlocks());
+    }
+}
+
+TEST(RTMemoryResourceTest, FallsBackToUpstream) {
+    RTAllocator allocator({{64, 1}});
+    RTMemoryResource strict(allocator);
+    RTMemoryResource fallback(allocator, std::pmr::new_delete_resource());
+    
+    // Default upstream never mallocs on the audio thread
+    EXPECT_THROW((void)strict.allocate(4096), std::bad_alloc);
+    
+    void* ptr = fallback.allocate(4096);
+    EXPECT_NE(ptr, nullptr);
+    EXPECT_FALSE(allocator.owns(ptr));
+    fallback.deallocate(ptr, 4096);
+    
+    EXPECT_TRUE(strict.is_equal(fallback));
+}
+
+// ========== Performance Benchmarks ==========
+
+namespace {
+
+// Allocations per second with every thread cycling a small working set
+double measureAllocsPerSecond(RTMemoryPool& pool, int numThreads) {
+    constexpr int kIterations = 200000;
+    constexpr size_t kWorkingSet = 8;
+    
+    std::atomic<int> ready{0};
+    std::atomic<bool> go{false};
+    
+    auto worker = [&]() {
+        std::array<void*, kWorkingSet> held{};
+        ready.fetch_add(1);
+        while (!go.load(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+        for (int i = 0; i < kIterations; ++i) {
+            auto& slot = held[static_cast<size_t>(i) % kWorkingSet];
+            if (slot) pool.deallocate(slot);
+            slot = pool.allocate();
+        }
+        for (void* ptr : held) {
+            pool.deallocate(ptr);
+        }
+    };
+    
+    std::vector<std::thread> threads;
+    for (int i = 0; i < numThreads; ++i) {
+        threads.emplace_back(worker);
+    }
+    while (ready.load() < numThreads) {
+        std::this_thread::yield();
+    }
+    
+    auto start = std::chrono::high_resolution_clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& t : threads) {
+        t.join();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    
+    double seconds = std::chrono::duration<double>(end - start).count();
+    return static_cast<double>(kIterations) * numThreads / seconds;
+}
+
+} // anonymous namespace
+
+TEST(RTMemoryPoolBenchmark, AllocationsPerSecond) {
+    for (int numThreads : {1, 4, 16}) {
+        const size_t numBlocks = static_cast<size_t>(numThreads) * (RTMemoryPool::kMagazineSize + 16);
+        RTMemoryPool shared(64, numBlocks);
+        RTMemoryPool cached(64, numBlocks, static_cast<size_t>(numThreads));
+        
+        double sharedRate = measureAllocsPerSecond(shared, numThreads);
+        double cachedRate = measureAllocsPerSecond(cached, numThreads);
+        
+        std::cout << numThreads << " thread(s): "
+                  << sharedRate / 1e6 << " M allocs/s shared, "
+                  << cachedRate / 1e6 << " M allocs/s with thread caches\n";
+        
+        EXPECT_EQ(shared.getAvailableBlocks(), numBlocks);
+        EXPECT_EQ(cached.getAvailableBlocks(), numBlocks);
+    }
+}
+
 struct TestStruct {
     int value;
     TestStruct() : value(42) {}
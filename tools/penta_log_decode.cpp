@@ -0,0 +1,36 @@
+// Decode a binary log written by RTLogger::setBinarySink into text
+//
+// Usage: penta-log-decode <log.bin> [output.txt]
+
+#include "penta/common/RTLogFormat.h"
+#include <fstream>
+#include <iostream>
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argc > 3) {
+        std::cerr << "Usage: " << argv[0] << " <log.bin> [output.txt]\n";
+        return 2;
+    }
+    
+    std::ifstream in(argv[1], std::ios::binary);
+    if (!in) {
+        std::cerr << "Cannot open " << argv[1] << "\n";
+        return 1;
+    }
+    
+    std::ofstream file;
+    if (argc == 3) {
+        file.open(argv[2]);
+        if (!file) {
+            std::cerr << "Cannot open " << argv[2] << "\n";
+            return 1;
+        }
+    }
+    std::ostream& out = argc == 3 ? file : std::cout;
+    
+    if (!penta::decodeBinaryLog(in, out)) {
+        std::cerr << "Malformed or truncated log: " << argv[1] << "\n";
+        return 1;
+    }
+    return 0;
+}